@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/coro/detached.hpp>
+#include <tacopie/coro/tcp_client.hpp>
+#include <tacopie/coro/tcp_server.hpp>
+#include <tacopie/tacopie>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! cost of the coroutine awaitables against raw callbacks
+//!
+//! usage: tacopie_coroutine_benchmark [nb_round_trips]
+//!
+//! loopback ping-pong of 64 bytes against an in-process coroutine echo server, each round trip being issued from the completion of the previous one (callbacks, coroutine)
+//! Reports the time and the number of heap allocations (client and server sides) per round trip.
+//!
+
+static std::atomic<std::size_t> nb_allocations(0);
+
+void*
+operator new(std::size_t size) {
+  ++nb_allocations;
+
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) { throw std::bad_alloc(); }
+
+  return ptr;
+}
+
+void
+operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+static const std::uint32_t port = 3003;
+
+static std::atomic<bool> done(false);
+static std::atomic<std::size_t> nb_connections(0);
+
+tacopie::coro::detached
+echo(std::shared_ptr<tacopie::tcp_client> client) {
+  ++nb_connections;
+
+  for (;;) {
+    auto res = co_await tacopie::coro::read(*client, 64);
+    if (!res.success) { break; }
+
+    auto written = co_await tacopie::coro::write(*client, std::move(res.buffer));
+    if (!written.success) { break; }
+  }
+
+  client.reset();
+  --nb_connections;
+}
+
+tacopie::coro::detached
+serve(tacopie::coro::acceptor& server) {
+  for (;;) {
+    auto client = co_await server.accept();
+    if (!client) { co_return; }
+
+    echo(std::move(client));
+  }
+}
+
+static void
+callback_round_trip(tacopie::tcp_client& client, std::size_t remaining) {
+  if (!remaining) {
+    done = true;
+    return;
+  }
+
+  client.async_write({std::vector<char>(64, 'a'), nullptr});
+  client.async_read({64, [&client, remaining](tacopie::tcp_client::read_result&) { callback_round_trip(client, remaining - 1); }});
+}
+
+tacopie::coro::detached
+coroutine_round_trips(tacopie::tcp_client& client, std::size_t nb_round_trips) {
+  for (std::size_t i = 0; i < nb_round_trips; ++i) {
+    co_await tacopie::coro::write(client, std::vector<char>(64, 'a'));
+    co_await tacopie::coro::read(client, 64);
+  }
+
+  done = true;
+}
+
+template <typename F>
+static void
+run_ping_pong(const char* name, F&& round_trips, std::size_t nb_round_trips) {
+  tacopie::tcp_client client;
+  client.connect("127.0.0.1", port);
+
+  //! let the server accept the connection first
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  done                              = false;
+  std::size_t nb_allocations_before = nb_allocations;
+  auto start                        = std::chrono::steady_clock::now();
+
+  round_trips(client, nb_round_trips);
+  while (!done) { std::this_thread::sleep_for(std::chrono::microseconds(100)); }
+
+  double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << name << elapsed_ns / nb_round_trips << " ns/round trip, " << static_cast<double>(nb_allocations - nb_allocations_before) / nb_round_trips << " allocations/round trip" << std::endl;
+
+  client.disconnect(true);
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_round_trips = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+
+  tacopie::coro::acceptor server;
+  server.start("127.0.0.1", port);
+  serve(server);
+
+  run_ping_pong("callbacks: ", &callback_round_trip, nb_round_trips);
+  run_ping_pong("coroutine: ", &coroutine_round_trips, nb_round_trips);
+
+  server.stop();
+
+  //! the echo coroutines complete once they see the disconnections
+  for (int i = 0; i < 1000 && nb_connections; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
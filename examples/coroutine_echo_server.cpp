@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/coro/detached.hpp>
+#include <tacopie/coro/tcp_client.hpp>
+#include <tacopie/coro/tcp_server.hpp>
+#include <tacopie/tacopie>
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <signal.h>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+std::condition_variable cv;
+
+void
+signint_handler(int) {
+  cv.notify_all();
+}
+
+//!
+//! echo handler: the frame keeps the client alive until the connection is closed
+//!
+tacopie::coro::detached
+echo(std::shared_ptr<tacopie::tcp_client> client) {
+  std::cout << "New client" << std::endl;
+
+  for (;;) {
+    auto res = co_await tacopie::coro::read(*client, 1024);
+    if (!res.success) { break; }
+
+    auto written = co_await tacopie::coro::write(*client, std::move(res.buffer));
+    if (!written.success) { break; }
+  }
+
+  std::cout << "Client disconnected" << std::endl;
+}
+
+tacopie::coro::detached
+serve(tacopie::coro::acceptor& server) {
+  for (;;) {
+    auto client = co_await server.accept();
+    if (!client) { co_return; }
+
+    echo(std::move(client));
+  }
+}
+
+int
+main(void) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  tacopie::coro::acceptor server;
+  server.start("127.0.0.1", 3001);
+  serve(server);
+
+  signal(SIGINT, &signint_handler);
+
+  std::mutex mtx;
+  std::unique_lock<std::mutex> lock(mtx);
+  cv.wait(lock);
+
+  server.stop();
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
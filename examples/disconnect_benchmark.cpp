@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/tacopie>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! cost of client disconnections on a server handling many clients
+//!
+//! usage: tacopie_disconnect_benchmark [max_clients]
+//!
+//! For 1/8, 1/4, 1/2 and all of max_clients (448 by default), connects that many peers to the server, closes them all at once, and times until the server no longer tracks any client.
+//! Tracking a disconnection costs O(1): the time per disconnection should not grow with the number of clients, apart from the select() scan of the io service.
+//! Peers and clients live in this process and the io service waits with select(): twice max_clients must stay below FD_SETSIZE (1024 on Linux).
+//!
+
+typedef std::chrono::steady_clock clock_type;
+
+static const std::uint32_t port = 3006;
+
+//! runs per number of clients, the fastest is reported
+static const std::size_t nb_runs = 10;
+
+static double
+run_once(tacopie::tcp_server& server, std::size_t nb_clients) {
+  std::vector<tacopie::tcp_socket> peers(nb_clients);
+
+  for (auto& peer : peers) { peer.connect("127.0.0.1", port); }
+  while (server.get_nb_clients() < nb_clients) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+  auto start = clock_type::now();
+
+  for (auto& peer : peers) { peer.close(); }
+  while (server.get_nb_clients() > 0) { std::this_thread::yield(); }
+
+  return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+static void
+run(tacopie::tcp_server& server, std::size_t nb_clients) {
+  double elapsed_s = run_once(server, nb_clients);
+  for (std::size_t i = 1; i < nb_runs; ++i) { elapsed_s = std::min(elapsed_s, run_once(server, nb_clients)); }
+
+  std::cout << nb_clients << " disconnections: " << elapsed_s * 1000 << " ms, " << elapsed_s * 1000000 / nb_clients << " us/disconnection" << std::endl;
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t max_clients = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 448;
+
+  //! the server keeps every client and reads from it, which is how it notices the peer closed the connection
+  auto on_read = [](tacopie::tcp_client::read_result&) {};
+
+  tacopie::tcp_server s;
+  s.start("127.0.0.1", port, [&](const std::shared_ptr<tacopie::tcp_client>& client) -> bool {
+    client->async_read({1024, on_read});
+    return false;
+  });
+
+  for (std::size_t nb_clients = std::max<std::size_t>(max_clients / 8, 1); nb_clients <= max_clients; nb_clients *= 2) { run(s, nb_clients); }
+
+  s.stop(true);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/tacopie>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! cost of utils::future against std::promise and raw callbacks
+//!
+//! usage: tacopie_future_benchmark [nb_round_trips]
+//!
+//! * promise/future primitive: create a promise, get its future, set and get the value (utils::promise, std::promise)
+//! * loopback ping-pong of 64 bytes against an in-process echo server, chaining each round trip from the completion of the previous read (callbacks, futures)
+//! Reports the time and the number of heap allocations per operation.
+//!
+
+static std::atomic<std::size_t> nb_allocations(0);
+
+void*
+operator new(std::size_t size) {
+  ++nb_allocations;
+
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) { throw std::bad_alloc(); }
+
+  return ptr;
+}
+
+void
+operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+typedef std::chrono::steady_clock clock_type;
+
+static const std::uint32_t port = 3002;
+
+static std::mutex done_mtx;
+static std::condition_variable done_cv;
+static bool done = false;
+
+static void
+complete(void) {
+  std::lock_guard<std::mutex> lock(done_mtx);
+  done = true;
+  done_cv.notify_all();
+}
+
+static void
+callback_round_trip(tacopie::tcp_client& client, std::size_t remaining) {
+  if (!remaining) { return complete(); }
+
+  client.async_write({std::vector<char>(64, 'a'), nullptr});
+  client.async_read({64, [&client, remaining](tacopie::tcp_client::read_result&) { callback_round_trip(client, remaining - 1); }});
+}
+
+static void
+future_round_trip(tacopie::tcp_client& client, std::size_t remaining) {
+  if (!remaining) { return complete(); }
+
+  client.async_write(std::vector<char>(64, 'a'));
+  client.async_read(64).then([&client, remaining](tacopie::tcp_client::read_result&) { future_round_trip(client, remaining - 1); });
+}
+
+static void
+on_new_message(const std::shared_ptr<tacopie::tcp_client>& client, tacopie::tcp_client::read_result& res) {
+  if (!res.success) { return; }
+
+  client->async_write({std::move(res.buffer), nullptr});
+  client->async_read({64, std::bind(&on_new_message, client, std::placeholders::_1)});
+}
+
+static void
+report(const char* name, const clock_type::time_point& start, std::size_t nb_allocations_before, std::size_t nb_ops) {
+  double elapsed_ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+  std::cout << name << elapsed_ns / nb_ops << " ns/op, " << static_cast<double>(nb_allocations - nb_allocations_before) / nb_ops << " allocations/op" << std::endl;
+}
+
+static void
+run_ping_pong(const char* name, void (*round_trip)(tacopie::tcp_client&, std::size_t), std::size_t nb_round_trips) {
+  tacopie::tcp_client client;
+  client.connect("127.0.0.1", port);
+
+  done                              = false;
+  std::size_t nb_allocations_before = nb_allocations;
+  auto start                        = clock_type::now();
+
+  round_trip(client, nb_round_trips);
+
+  {
+    std::unique_lock<std::mutex> lock(done_mtx);
+    done_cv.wait(lock, [] { return done; });
+  }
+
+  report(name, start, nb_allocations_before, nb_round_trips);
+  client.disconnect(true);
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_round_trips = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const std::size_t nb_ops   = 1000000;
+  std::size_t sum            = 0;
+
+  //! promise/future primitive
+  std::size_t nb_allocations_before = nb_allocations;
+  auto start                        = clock_type::now();
+
+  for (std::size_t i = 0; i < nb_ops; ++i) {
+    tacopie::utils::promise<std::size_t> p;
+    auto f = p.get_future();
+    p.set_value(i);
+    sum += f.get();
+  }
+
+  report("utils::promise:      ", start, nb_allocations_before, nb_ops);
+
+  nb_allocations_before = nb_allocations;
+  start                 = clock_type::now();
+
+  for (std::size_t i = 0; i < nb_ops; ++i) {
+    std::promise<std::size_t> p;
+    auto f = p.get_future();
+    p.set_value(i);
+    sum += f.get();
+  }
+
+  report("std::promise:        ", start, nb_allocations_before, nb_ops);
+
+  //! loopback ping-pong
+  tacopie::tcp_server s;
+  s.start("127.0.0.1", port, [](const std::shared_ptr<tacopie::tcp_client>& client) -> bool {
+    client->async_read({64, std::bind(&on_new_message, client, std::placeholders::_1)});
+    return true;
+  });
+
+  run_ping_pong("callback round trip: ", &callback_round_trip, nb_round_trips);
+  run_ping_pong("future round trip:   ", &future_round_trip, nb_round_trips);
+
+  s.stop(true);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return sum ? 0 : 1;
+}
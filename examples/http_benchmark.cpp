@@ -0,0 +1,172 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/http/server.hpp>
+#include <tacopie/tacopie>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! wrk-style local load benchmark of the http module
+//!
+//! usage: tacopie_http_benchmark [nb_connections] [duration_secs] [pipeline_depth]
+//!
+//! Each connection runs in its own thread on a blocking socket: it writes pipeline_depth keep-alive requests at once, then reads back as many responses.
+//! Reports the number of requests per second and the latency percentiles of the requests (measured from the batch write to the response).
+//!
+
+static const std::uint32_t port = 8081;
+
+typedef std::chrono::steady_clock clock_type;
+
+//!
+//! parse as many complete responses as possible from the beginning of the buffer
+//! return the number of responses parsed, and erase them from the buffer
+//!
+static std::size_t
+consume_responses(std::string& buffer) {
+  std::size_t nb_responses = 0;
+  std::size_t pos          = 0;
+
+  for (;;) {
+    std::size_t head_end = buffer.find("\r\n\r\n", pos);
+    if (head_end == std::string::npos) { break; }
+
+    std::size_t body_size      = 0;
+    std::size_t content_length = buffer.find("Content-Length: ", pos);
+    if (content_length != std::string::npos && content_length < head_end) { body_size = std::strtoul(buffer.c_str() + content_length + 16, nullptr, 10); }
+
+    std::size_t end = head_end + 4 + body_size;
+    if (end > buffer.size()) { break; }
+
+    pos = end;
+    ++nb_responses;
+  }
+
+  buffer.erase(0, pos);
+  return nb_responses;
+}
+
+static void
+run_connection(std::size_t pipeline_depth, const clock_type::time_point& deadline, std::vector<double>& latencies_usecs) {
+  tacopie::tcp_socket socket;
+  socket.connect("127.0.0.1", port);
+  socket.set_nodelay(true);
+
+  std::string request = "GET / HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+  std::string batch;
+  for (std::size_t i = 0; i < pipeline_depth; ++i) { batch += request; }
+  std::vector<char> batch_buffer(batch.begin(), batch.end());
+
+  std::string responses;
+  while (clock_type::now() < deadline) {
+    auto start = clock_type::now();
+    socket.send(batch_buffer, batch_buffer.size());
+
+    std::size_t nb_responses = 0;
+    while (nb_responses < pipeline_depth) {
+      std::vector<char> data = socket.recv(16384);
+      responses.append(data.begin(), data.end());
+
+      std::size_t nb_parsed = consume_responses(responses);
+      if (!nb_parsed) { continue; }
+
+      double latency = std::chrono::duration<double, std::micro>(clock_type::now() - start).count();
+      latencies_usecs.insert(latencies_usecs.end(), nb_parsed, latency);
+      nb_responses += nb_parsed;
+    }
+  }
+
+  socket.close();
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_connections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+  std::size_t duration_secs  = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5;
+  std::size_t pipeline_depth = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+
+  tacopie::http::server s;
+  s.start("127.0.0.1", port, [](const tacopie::http::request&, tacopie::http::response& response) {
+    response.add_header("Content-Type", "text/plain");
+    response.set_body("Hello, World!\n");
+  });
+
+  auto deadline = clock_type::now() + std::chrono::seconds(duration_secs);
+  std::vector<std::vector<double>> latencies(nb_connections);
+  std::vector<std::thread> connections;
+
+  for (std::size_t i = 0; i < nb_connections; ++i) {
+    connections.emplace_back(run_connection, pipeline_depth, deadline, std::ref(latencies[i]));
+  }
+
+  for (auto& connection : connections) { connection.join(); }
+
+  s.stop(true);
+
+  std::vector<double> all_latencies;
+  for (const auto& connection_latencies : latencies) { all_latencies.insert(all_latencies.end(), connection_latencies.begin(), connection_latencies.end()); }
+
+  if (all_latencies.empty()) {
+    std::cerr << "no response received" << std::endl;
+    return -1;
+  }
+
+  std::sort(all_latencies.begin(), all_latencies.end());
+  auto percentile = [&](double p) { return all_latencies[static_cast<std::size_t>(p * (all_latencies.size() - 1))]; };
+
+  std::cout << nb_connections << " connections, pipeline depth " << pipeline_depth << ", " << duration_secs << "s" << std::endl;
+  std::cout << "requests:     " << all_latencies.size() << std::endl;
+  std::cout << "requests/sec: " << static_cast<double>(all_latencies.size()) / duration_secs << std::endl;
+  std::cout << "latency p50:  " << percentile(0.50) << "us" << std::endl;
+  std::cout << "latency p99:  " << percentile(0.99) << "us" << std::endl;
+  std::cout << "latency max:  " << all_latencies.back() << "us" << std::endl;
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
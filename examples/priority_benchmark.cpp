@@ -0,0 +1,102 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/tacopie>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//!
+//! latency of control tasks under a flood of bulk tasks, with and without priority lanes
+//!
+//! usage: tacopie_priority_benchmark [nb_threads] [nb_bulk_tasks]
+//!
+//! nb_bulk_tasks CPU-bound bulk tasks are queued at once, then a control task is submitted every 2ms.
+//! The flood runs first with every task in the normal class, then with the bulk tasks in the low class and the control tasks in the high class.
+//! Reports the control tasks queueing latency percentiles (from submission to execution).
+//!
+
+typedef std::chrono::steady_clock clock_type;
+
+static void
+run_benchmark(std::size_t nb_threads, std::size_t nb_bulk_tasks, bool use_priorities) {
+  tacopie::utils::thread_pool pool(nb_threads);
+  tacopie::utils::thread_pool::priority bulk_priority    = use_priorities ? tacopie::utils::thread_pool::priority::low : tacopie::utils::thread_pool::priority::normal;
+  tacopie::utils::thread_pool::priority control_priority = use_priorities ? tacopie::utils::thread_pool::priority::high : tacopie::utils::thread_pool::priority::normal;
+
+  std::atomic<std::size_t> nb_bulk_done(0);
+
+  auto bulk_task = [&] {
+    volatile std::size_t sum = 0;
+    for (std::size_t j = 0; j < 20000; ++j) { sum += j; }
+    ++nb_bulk_done;
+  };
+
+  for (std::size_t i = 0; i < nb_bulk_tasks; ++i) { pool.add_task(bulk_task, bulk_priority); }
+
+  std::mutex latencies_mtx;
+  std::vector<double> latencies_usecs;
+
+  for (std::size_t i = 0; i < 200; ++i) {
+    auto submitted = clock_type::now();
+
+    auto control_task = [&, submitted] {
+      double latency = std::chrono::duration<double, std::micro>(clock_type::now() - submitted).count();
+
+      std::lock_guard<std::mutex> lock(latencies_mtx);
+      latencies_usecs.push_back(latency);
+    };
+
+    pool.add_task(control_task, control_priority);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  //! let the control tasks stuck behind the flood complete
+  while (nb_bulk_done < nb_bulk_tasks) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  pool.stop();
+
+  std::sort(latencies_usecs.begin(), latencies_usecs.end());
+  auto percentile = [&](double p) { return latencies_usecs[static_cast<std::size_t>(p * (latencies_usecs.size() - 1))]; };
+
+  std::cout << (use_priorities ? "priority lanes: " : "single class:   ")
+            << "control p50 " << percentile(0.50) << "us, p99 " << percentile(0.99) << "us, max " << latencies_usecs.back() << "us" << std::endl;
+}
+
+int
+main(int argc, char** argv) {
+  std::size_t nb_threads    = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2;
+  std::size_t nb_bulk_tasks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+
+  std::cout << nb_threads << " threads, " << nb_bulk_tasks << " bulk tasks" << std::endl;
+
+  run_benchmark(nb_threads, nb_bulk_tasks, false);
+  run_benchmark(nb_threads, nb_bulk_tasks, true);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/pubsub/hub.hpp>
+#include <tacopie/tacopie>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! fan-out throughput of the pub/sub hub
+//!
+//! usage: tacopie_pubsub_benchmark [nb_subscribers] [nb_messages] [payload_size] [nb_slow_subscribers]
+//!
+//! Subscribers are tcp_clients of a second io_service (2 workers), reading as fast as they can, except the slow ones which never read.
+//! The hub evicts subscribers (slow ones first) from the publishing thread once their pending bytes exceed 4MiB, its default, while their callbacks may be running.
+//! Reports the publish rate, the delivery rate once every reading subscriber got every message, and the number of evictions.
+//! Both sides of every connection are polled with select(): nb_subscribers is limited to FD_SETSIZE / 2.
+//!
+
+typedef std::chrono::steady_clock clock_type;
+
+static const std::uint32_t port    = 3006;
+static const std::string topic     = "bench";
+static const std::size_t read_size = 64 * 1024;
+
+static void
+read_next(tacopie::tcp_client& client, std::atomic<std::size_t>& nb_received) {
+  try {
+    client.async_read({read_size, [&client, &nb_received](tacopie::tcp_client::read_result& result) {
+                         if (!result.success) { return; }
+
+                         nb_received += result.buffer.size();
+                         read_next(client, nb_received);
+                       }});
+  }
+  catch (const tacopie::tacopie_error&) {
+    //! disconnected
+  }
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t nb_subscribers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+  std::size_t nb_messages    = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000;
+  std::size_t payload_size   = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+  std::size_t nb_slow        = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+
+  tacopie::pubsub::hub h;
+  h.start("127.0.0.1", port);
+
+  auto subscribers_service = std::make_shared<tacopie::io_service>();
+  subscribers_service->set_nb_workers(2);
+
+  std::atomic<std::size_t> nb_received(0);
+  std::vector<std::shared_ptr<tacopie::tcp_client>> subscribers;
+  std::string subscribe = "SUBSCRIBE " + topic + "\r\n";
+
+  for (std::size_t i = 0; i < nb_subscribers; ++i) {
+    auto client = std::make_shared<tacopie::tcp_client>(subscribers_service);
+    client->connect("127.0.0.1", port);
+    client->async_write({std::vector<char>(subscribe.begin(), subscribe.end()), nullptr});
+    if (i >= nb_slow) { read_next(*client, nb_received); }
+    subscribers.push_back(client);
+  }
+
+  while (h.get_nb_subscribers(topic) != nb_subscribers) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+  //! "MESSAGE <topic> <size>\r\n<payload>\r\n"
+  std::size_t message_size = 8 + topic.size() + 1 + std::to_string(payload_size).size() + 2 + payload_size + 2;
+  std::size_t expected     = message_size * nb_messages * (nb_subscribers - nb_slow);
+
+  auto start = clock_type::now();
+
+  for (std::size_t i = 0; i < nb_messages; ++i) { h.publish(topic, std::vector<char>(payload_size, 'x')); }
+
+  double publish_s = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  //! until everything is received, or nothing more comes
+  std::size_t last_received = 0;
+  auto last_progress        = clock_type::now();
+
+  while (nb_received < expected && clock_type::now() - last_progress < std::chrono::seconds(2)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (nb_received != last_received) {
+      last_received = nb_received;
+      last_progress = clock_type::now();
+    }
+  }
+
+  double delivery_s = std::chrono::duration<double>(last_progress - start).count();
+
+  std::cout << nb_subscribers << " subscribers (" << nb_slow << " slow), " << nb_messages << " messages of " << payload_size << " bytes" << std::endl;
+  std::cout << "publish:    " << nb_messages / publish_s << " msg/s" << std::endl;
+  std::cout << "deliveries: " << static_cast<double>(nb_received / message_size) / delivery_s << " msg/s (" << nb_received << " / " << expected << " bytes received)" << std::endl;
+  std::cout << "evictions:  " << h.get_nb_evictions() << std::endl;
+
+  for (auto& client : subscribers) { client->disconnect(true); }
+  h.stop(true, true);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
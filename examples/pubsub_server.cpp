@@ -0,0 +1,78 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/pubsub/hub.hpp>
+#include <tacopie/tacopie>
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <signal.h>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+std::condition_variable cv;
+
+void
+signint_handler(int) {
+  cv.notify_all();
+}
+
+int
+main(void) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  //! subscribe with: printf 'SUBSCRIBE clock\r\n' | nc 127.0.0.1 3002
+  tacopie::pubsub::hub h;
+  h.set_on_eviction_handler([](const std::shared_ptr<tacopie::tcp_client>& client) {
+    std::cout << "evicted slow consumer " << client->get_host() << ":" << client->get_port() << std::endl;
+  });
+  h.start("127.0.0.1", 3002);
+
+  signal(SIGINT, &signint_handler);
+
+  std::mutex mtx;
+  std::unique_lock<std::mutex> lock(mtx);
+  unsigned int tick = 0;
+
+  while (cv.wait_for(lock, std::chrono::seconds(1)) == std::cv_status::timeout) {
+    h.publish("clock", "tick " + std::to_string(++tick));
+  }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
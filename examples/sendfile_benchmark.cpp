@@ -0,0 +1,170 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/tacopie>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#include <io.h>
+#define fileno _fileno
+#endif /* _WIN32 */
+
+//!
+//! throughput of tcp_client::async_sendfile against async_write of the file content, next to a slow peer
+//!
+//! usage: tacopie_sendfile_benchmark [file_size_mib] [nb_readers]
+//!
+//! Each accepted connection is sent the whole file, by a single io service worker.
+//! Send buffers are limited to 256KiB, below the chunk sent per write availability, as a server handling many connections would.
+//! The first connection reads 64KiB every 10ms: its send buffer is full most of the time.
+//! The other connections read as fast as they can; their aggregated throughput is reported once they all got the file.
+//! A write waiting for space in the send buffer of the slow peer holds the worker, and the throughput of the other connections drops to the pace of the slow one.
+//!
+
+typedef std::chrono::steady_clock clock_type;
+
+static const std::uint32_t port = 3004;
+
+static void
+read_all(std::size_t size, std::atomic<std::size_t>& nb_done) {
+  tacopie::tcp_socket socket;
+  socket.connect("127.0.0.1", port);
+
+  std::vector<char> buffer(1024 * 1024);
+  std::size_t received = 0;
+
+  while (received < size) {
+    tacopie::tcp_socket::io_result io = socket.recv(buffer.data(), buffer.size(), std::nothrow);
+    if (!io.success() || io.eof) { break; }
+    received += io.size;
+  }
+
+  if (received == size) { ++nb_done; }
+
+  socket.close();
+}
+
+static void
+read_slowly(const std::atomic<bool>& stop) {
+  tacopie::tcp_socket socket;
+  socket.connect("127.0.0.1", port);
+
+  std::vector<char> buffer(64 * 1024);
+
+  while (!stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    tacopie::tcp_socket::io_result io = socket.recv(buffer.data(), buffer.size(), std::nothrow);
+    if (!io.success() || io.eof) { break; }
+  }
+
+  socket.close();
+}
+
+static void
+run(const char* name, bool use_sendfile, int file_fd, const std::shared_ptr<std::vector<char>>& content, std::size_t nb_readers) {
+  std::size_t size = content->size();
+
+  tacopie::tcp_server s;
+  s.start("127.0.0.1", port, [=](const std::shared_ptr<tacopie::tcp_client>& client) -> bool {
+    tacopie::tcp_socket::options opts;
+    opts.send_buffer_size = 256 * 1024;
+    client->get_socket().set_options(opts);
+
+    if (use_sendfile) {
+      client->async_sendfile({file_fd, 0, size, nullptr});
+    }
+    else {
+      client->async_write({*content, nullptr});
+    }
+
+    return false;
+  });
+
+  std::atomic<bool> stop(false);
+  std::thread slow_reader(read_slowly, std::cref(stop));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  std::atomic<std::size_t> nb_done(0);
+  std::vector<std::thread> readers;
+  auto start = clock_type::now();
+
+  for (std::size_t i = 0; i < nb_readers; ++i) { readers.emplace_back(read_all, size, std::ref(nb_done)); }
+  for (auto& reader : readers) { reader.join(); }
+
+  double elapsed_s = std::chrono::duration<double>(clock_type::now() - start).count();
+  double mib       = static_cast<double>(size * nb_readers) / (1024 * 1024);
+
+  std::cout << name << nb_done << "/" << nb_readers << " readers complete, " << mib / elapsed_s << " MiB/s" << std::endl;
+
+  stop = true;
+  s.stop(true);
+  slow_reader.join();
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t file_size_mib = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64;
+  std::size_t nb_readers    = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+
+  //! the same content is sent from the file and from memory
+  auto content = std::make_shared<std::vector<char>>(file_size_mib * 1024 * 1024);
+  for (std::size_t i = 0; i < content->size(); ++i) { (*content)[i] = static_cast<char>(i * 31); }
+
+  std::FILE* file = std::tmpfile();
+  if (!file || std::fwrite(content->data(), 1, content->size(), file) != content->size() || std::fflush(file)) {
+    std::cerr << "could not create the file to send" << std::endl;
+    return -1;
+  }
+
+  run("async_write:    ", false, fileno(file), content, nb_readers);
+  run("async_sendfile: ", true, fileno(file), content, nb_readers);
+
+  std::fclose(file);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/tacopie>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//!
+//! task throughput of utils::thread_pool for each scheduling policy, from 1 to 64 threads
+//!
+//! usage: tacopie_thread_pool_benchmark [nb_tasks]
+//!
+//! nb_tasks tasks are submitted from the main thread, and each of them submits a child task from its worker (as io_service callbacks do when they issue new reads and writes).
+//! Reports the number of tasks executed per second.
+//!
+
+typedef std::chrono::steady_clock clock_type;
+
+static double
+run_benchmark(std::size_t nb_threads, tacopie::utils::thread_pool::scheduling_policy policy, std::size_t nb_tasks) {
+  tacopie::utils::thread_pool pool(nb_threads, policy);
+  std::atomic<std::size_t> nb_executed(0);
+
+  auto start = clock_type::now();
+
+  for (std::size_t i = 0; i < nb_tasks; ++i) {
+    pool.add_task([&] {
+      ++nb_executed;
+      pool.add_task([&] { ++nb_executed; });
+    });
+  }
+
+  while (nb_executed < 2 * nb_tasks) { std::this_thread::yield(); }
+
+  double elapsed_secs = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  pool.stop();
+
+  return 2 * nb_tasks / elapsed_secs;
+}
+
+int
+main(int argc, char** argv) {
+  std::size_t nb_tasks = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+  std::cout << std::setw(8) << "threads" << std::setw(16) << "fifo" << std::setw(16) << "work_stealing" << std::setw(16) << "lock_free" << "   (tasks/sec)" << std::endl;
+
+  for (std::size_t nb_threads = 1; nb_threads <= 64; nb_threads *= 2) {
+    std::cout << std::setw(8) << nb_threads << std::fixed << std::setprecision(0)
+              << std::setw(16) << run_benchmark(nb_threads, tacopie::utils::thread_pool::scheduling_policy::fifo, nb_tasks)
+              << std::setw(16) << run_benchmark(nb_threads, tacopie::utils::thread_pool::scheduling_policy::work_stealing, nb_tasks)
+              << std::setw(16) << run_benchmark(nb_threads, tacopie::utils::thread_pool::scheduling_policy::lock_free, nb_tasks)
+              << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/tacopie>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <Winsock2.h>
+#endif /* _WIN32 */
+
+//!
+//! throughput of zero-copy writes against copied writes, for several write sizes
+//!
+//! usage: tacopie_zerocopy_benchmark [total_mib]
+//!
+//! A single connection writes total_mib MiB by writes of the same size, 8 of them in flight, to a peer reading as fast as it can.
+//! The peer first sends a byte which is never read, as a pipelining peer would: the socket stays readable while zero-copy buffers are held.
+//! Reports the throughput and the CPU time of the process (io service worker, reader, kernel) per GiB written.
+//! On loopback, the kernel copies zero-copy data anyway: the numbers show the overhead of zero-copy writes, not their gain on real network devices.
+//!
+
+typedef std::chrono::steady_clock clock_type;
+
+static const std::uint32_t port = 3005;
+
+//!
+//! last connection accepted by the server
+//!
+static std::shared_ptr<tacopie::tcp_client> accepted;
+static std::mutex accepted_mtx;
+static std::condition_variable accepted_cv;
+
+static void
+run(std::size_t write_size, std::size_t total_size, bool zerocopy) {
+  tacopie::tcp_socket reader;
+  reader.connect("127.0.0.1", port);
+  reader.send(std::vector<char>(1, 'x'), 1);
+
+  std::shared_ptr<tacopie::tcp_client> writer;
+
+  {
+    std::unique_lock<std::mutex> lock(accepted_mtx);
+    accepted_cv.wait(lock, [] { return accepted != nullptr; });
+    writer = std::move(accepted);
+  }
+
+  if (zerocopy) {
+    try {
+      writer->set_zerocopy_threshold(write_size);
+    }
+    catch (const tacopie::tacopie_error&) {
+      std::cout << "zero-copy writes not supported" << std::endl;
+      reader.close();
+      writer->disconnect(true);
+      return;
+    }
+  }
+
+  std::size_t nb_writes = total_size / write_size;
+  std::vector<char> payload(write_size, 'a');
+  std::atomic<std::size_t> nb_issued(0);
+
+  std::function<void(tacopie::tcp_client::write_result&)> on_written = [&](tacopie::tcp_client::write_result& result) {
+    if (result.success && ++nb_issued <= nb_writes) { writer->async_write({payload, on_written}); }
+  };
+
+  std::clock_t cpu_start = std::clock();
+  auto start             = clock_type::now();
+
+  for (std::size_t i = 0; i < 8 && i < nb_writes; ++i) {
+    ++nb_issued;
+    writer->async_write({payload, on_written});
+  }
+
+  std::vector<char> buffer(4 * 1024 * 1024);
+  std::size_t received = 0;
+
+  while (received < nb_writes * write_size) {
+    tacopie::tcp_socket::io_result io = reader.recv(buffer.data(), buffer.size(), std::nothrow);
+    if (!io.success() || io.eof) { break; }
+    received += io.size;
+  }
+
+  double elapsed_s = std::chrono::duration<double>(clock_type::now() - start).count();
+  double cpu_s     = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  double mib       = static_cast<double>(received) / (1024 * 1024);
+
+  std::cout << (zerocopy ? "zero-copy " : "copy      ") << write_size / 1024 << "KiB writes: " << mib / elapsed_s << " MiB/s, " << cpu_s * 1000 * 1024 / mib << " ms CPU/GiB" << std::endl;
+
+  reader.close();
+  writer->disconnect(true);
+}
+
+int
+main(int argc, char** argv) {
+#ifdef _WIN32
+  //! Windows netword DLL init
+  WORD version = MAKEWORD(2, 2);
+  WSADATA data;
+
+  if (WSAStartup(version, &data) != 0) {
+    std::cerr << "WSAStartup() failure" << std::endl;
+    return -1;
+  }
+#endif /* _WIN32 */
+
+  std::size_t total_size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024) * 1024 * 1024;
+
+  tacopie::tcp_server s;
+  s.start("127.0.0.1", port, [](const std::shared_ptr<tacopie::tcp_client>& client) -> bool {
+    std::lock_guard<std::mutex> lock(accepted_mtx);
+    accepted = client;
+    accepted_cv.notify_all();
+    return true;
+  });
+
+  for (std::size_t write_size : {64 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024}) {
+    run(write_size, total_size, false);
+    run(write_size, total_size, true);
+  }
+
+  s.stop(true);
+
+#ifdef _WIN32
+  WSACleanup();
+#endif /* _WIN32 */
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#ifndef __cpp_impl_coroutine
+#error "tacopie coroutine support requires a C++20 compiler"
+#endif /* __cpp_impl_coroutine */
+
+#include <coroutine>
+#include <exception>
+
+#include <tacopie/utils/logger.hpp>
+
+namespace tacopie {
+
+namespace coro {
+
+//!
+//! return type of fire-and-forget coroutines, typically connection handlers
+//!
+//! the coroutine starts immediately and runs until its first suspension, its frame is destroyed when it completes
+//! exceptions escaping the coroutine are logged and dropped
+//!
+struct detached {
+  struct promise_type {
+    detached
+    get_return_object(void) noexcept {
+      return {};
+    }
+
+    std::suspend_never
+    initial_suspend(void) noexcept {
+      return {};
+    }
+
+    std::suspend_never
+    final_suspend(void) noexcept {
+      return {};
+    }
+
+    void
+    return_void(void) noexcept {}
+
+    void
+    unhandled_exception(void) noexcept {
+      __TACOPIE_LOG(error, "unhandled exception in detached coroutine");
+    }
+  };
+};
+
+} // namespace coro
+
+} // namespace tacopie
@@ -0,0 +1,217 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#ifndef __cpp_impl_coroutine
+#error "tacopie coroutine support requires a C++20 compiler"
+#endif /* __cpp_impl_coroutine */
+
+#include <coroutine>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tacopie/network/tcp_client.hpp>
+
+namespace tacopie {
+
+namespace coro {
+
+//!
+//! awaitables on top of the tcp_client callbacks
+//!
+//! the coroutine is resumed directly by the io_service worker completing the operation
+//! awaitables live in the coroutine frame and the completion callbacks only capture the awaitable address: awaiting does not allocate
+//! the client must outlive the operation, and must not be released by the coroutine while it is resumed from a successful operation (the worker is still executing the client callback)
+//!
+//! a coroutine resumed by a worker runs inside the io_service callback of the client: until it suspends again or returns, it holds the client callback guard and the strand of the socket (no other callback of this client runs meanwhile), so it must not block
+//! an operation dropped by tcp_client::disconnect still resumes the coroutine, with a failed result, from the thread calling disconnect (see tcp_client::complete_on_disconnect_t)
+//! the tcp_client destructor resumes nothing: the coroutine frame would leak, hence the client outliving the operation
+//!
+
+//!
+//! read awaitable, see read
+//!
+class read_awaitable {
+public:
+  //! ctor
+  read_awaitable(tcp_client& client, std::size_t size)
+  : m_client(client)
+  , m_size(size) {}
+
+  bool
+  await_ready(void) const noexcept {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle) {
+    m_handle = handle;
+
+    auto on_read = [this](tcp_client::read_result& result) {
+      m_result = std::move(result);
+      m_handle.resume();
+    };
+
+    //! the coroutine may be resumed by a worker before async_read returns: nothing is accessed afterwards
+    m_client.async_read({m_size, on_read}, tcp_client::complete_on_disconnect_t{});
+  }
+
+  tcp_client::read_result
+  await_resume(void) {
+    return std::move(m_result);
+  }
+
+private:
+  tcp_client& m_client;
+  std::size_t m_size;
+  std::coroutine_handle<> m_handle;
+  tcp_client::read_result m_result;
+};
+
+//!
+//! write awaitable, see write
+//!
+class write_awaitable {
+public:
+  //! ctor
+  write_awaitable(tcp_client& client, std::vector<char>&& buffer)
+  : m_client(client)
+  , m_buffer(std::move(buffer)) {}
+
+  bool
+  await_ready(void) const noexcept {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle) {
+    m_handle = handle;
+
+    auto on_written = [this](tcp_client::write_result& result) {
+      m_result = std::move(result);
+      m_handle.resume();
+    };
+
+    m_client.async_write(tcp_client::write_request{std::move(m_buffer), on_written}, tcp_client::complete_on_disconnect_t{});
+  }
+
+  tcp_client::write_result
+  await_resume(void) noexcept {
+    return std::move(m_result);
+  }
+
+private:
+  tcp_client& m_client;
+  std::vector<char> m_buffer;
+  std::coroutine_handle<> m_handle;
+  tcp_client::write_result m_result;
+};
+
+//!
+//! connect awaitable, see async_connect
+//!
+class connect_awaitable {
+public:
+  //! ctor
+  connect_awaitable(tcp_client& client, const std::string& host, std::uint32_t port)
+  : m_client(client)
+  , m_host(host)
+  , m_port(port)
+  , m_success(false) {}
+
+  bool
+  await_ready(void) const noexcept {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle) {
+    m_handle = handle;
+
+    auto on_connected = [this](bool success) {
+      m_success = success;
+      m_handle.resume();
+    };
+
+    m_client.async_connect(m_host, m_port, on_connected, tcp_client::complete_on_disconnect_t{});
+  }
+
+  bool
+  await_resume(void) const noexcept {
+    return m_success;
+  }
+
+private:
+  tcp_client& m_client;
+  std::string m_host;
+  std::uint32_t m_port;
+  std::coroutine_handle<> m_handle;
+  bool m_success;
+};
+
+//!
+//! co_await read(client, size): read up to size bytes
+//! throws if the client is disconnected when the read is requested
+//!
+//! \param client client to read from
+//! \param size number of bytes to read
+//! \return awaitable producing the tcp_client::read_result
+//!
+inline read_awaitable
+read(tcp_client& client, std::size_t size) {
+  return read_awaitable(client, size);
+}
+
+//!
+//! co_await write(client, buffer): write a buffer
+//! throws if the client is disconnected when the write is requested
+//!
+//! \param client client to write to
+//! \param buffer bytes to write
+//! \return awaitable producing the tcp_client::write_result
+//!
+inline write_awaitable
+write(tcp_client& client, std::vector<char> buffer) {
+  return write_awaitable(client, std::move(buffer));
+}
+
+//!
+//! co_await async_connect(client, host, port): connect without blocking a thread
+//! throws if the connection can not be initiated
+//!
+//! \param client client to connect
+//! \param host Hostname of the target server
+//! \param port Port of the target server
+//! \return awaitable producing whether the connection succeeded
+//!
+inline connect_awaitable
+async_connect(tcp_client& client, const std::string& host, std::uint32_t port) {
+  return connect_awaitable(client, host, port);
+}
+
+} // namespace coro
+
+} // namespace tacopie
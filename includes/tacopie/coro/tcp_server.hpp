@@ -0,0 +1,253 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#ifndef __cpp_impl_coroutine
+#error "tacopie coroutine support requires a C++20 compiler"
+#endif /* __cpp_impl_coroutine */
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <tacopie/network/tcp_server.hpp>
+
+namespace tacopie {
+
+namespace coro {
+
+class acceptor;
+
+//!
+//! accept awaitable, see acceptor::accept
+//!
+class accept_awaitable {
+public:
+  //! ctor
+  explicit accept_awaitable(acceptor& server)
+  : m_server(server)
+  , m_next(nullptr) {}
+
+  bool
+  await_ready(void) const noexcept {
+    return false;
+  }
+
+  inline bool await_suspend(std::coroutine_handle<> handle);
+
+  std::shared_ptr<tcp_client>
+  await_resume(void) noexcept {
+    return std::move(m_client);
+  }
+
+private:
+  friend class acceptor;
+
+  acceptor& m_server;
+  std::coroutine_handle<> m_handle;
+  std::shared_ptr<tcp_client> m_client;
+
+  //! next waiting coroutine
+  accept_awaitable* m_next;
+};
+
+//!
+//! tcp_server accepting connections through co_await accept()
+//!
+//! connections accepted while no coroutine is waiting are queued
+//! waiting coroutines are resumed directly by the io_service worker accepting the connection, in the order they started waiting
+//! the returned clients are owned by the caller (they are not tracked by the underlying tcp_server)
+//!
+class acceptor {
+public:
+  //! ctor
+  acceptor(void) = default;
+
+  //!
+  //! custom ctor
+  //! build an acceptor monitored by the given io_service instead of the default one
+  //!
+  //! \param io_service io_service monitoring the connections
+  //!
+  explicit acceptor(const std::shared_ptr<tacopie::io_service>& io_service)
+  : m_server(io_service) {}
+
+  //! dtor
+  ~acceptor(void) {
+    stop();
+  }
+
+  //! copy ctor
+  acceptor(const acceptor&) = delete;
+  //! assignment operator
+  acceptor& operator=(const acceptor&) = delete;
+
+public:
+  //!
+  //! start listening
+  //!
+  //! \param host hostname to be connected to
+  //! \param port port to be connected to
+  //!
+  void
+  start(const std::string& host, std::uint32_t port) {
+    m_server.start(host, port, [this](const std::shared_ptr<tcp_client>& client) {
+      on_new_connection(client);
+      return true;
+    });
+  }
+
+  //!
+  //! stop listening
+  //! waiting coroutines are resumed (by the calling thread) with a null client, and so are the ones waiting afterwards
+  //!
+  void
+  stop(void) {
+    m_server.stop(true);
+
+    accept_awaitable* waiters;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      waiters = m_waiters;
+      m_waiters = m_last_waiter = nullptr;
+      m_pending.clear();
+    }
+
+    while (waiters) {
+      auto waiter = waiters;
+      waiters     = waiters->m_next;
+      waiter->m_handle.resume();
+    }
+  }
+
+  //!
+  //! co_await accept(): wait for a new connection
+  //!
+  //! \return awaitable producing the new client (null once the acceptor is stopped)
+  //!
+  accept_awaitable
+  accept(void) {
+    return accept_awaitable(*this);
+  }
+
+  //!
+  //! \return underlying tcp_server
+  //!
+  tcp_server&
+  get_server(void) {
+    return m_server;
+  }
+
+private:
+  friend class accept_awaitable;
+
+  //!
+  //! hand the connection to the first waiting coroutine, or queue it
+  //!
+  void
+  on_new_connection(const std::shared_ptr<tcp_client>& client) {
+    accept_awaitable* waiter;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+
+      if (!m_waiters) {
+        m_pending.push_back(client);
+        return;
+      }
+
+      waiter    = m_waiters;
+      m_waiters = waiter->m_next;
+      if (!m_waiters) { m_last_waiter = nullptr; }
+    }
+
+    waiter->m_client = client;
+    waiter->m_handle.resume();
+  }
+
+  //!
+  //! take a queued connection, or register the awaitable as waiting
+  //!
+  //! \return whether the awaitable is waiting (the coroutine must be suspended)
+  //!
+  bool
+  wait(accept_awaitable& waiter) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+
+    if (!m_pending.empty()) {
+      waiter.m_client = std::move(m_pending.front());
+      m_pending.pop_front();
+      return false;
+    }
+
+    if (!m_server.is_running()) { return false; }
+
+    if (m_last_waiter) {
+      m_last_waiter->m_next = &waiter;
+    }
+    else {
+      m_waiters = &waiter;
+    }
+
+    m_last_waiter = &waiter;
+    return true;
+  }
+
+private:
+  //!
+  //! underlying server
+  //!
+  tcp_server m_server;
+
+  //!
+  //! connections accepted while no coroutine was waiting
+  //!
+  std::deque<std::shared_ptr<tcp_client>> m_pending;
+
+  //!
+  //! waiting coroutines (intrusive list of the awaitables, stored in the coroutine frames)
+  //!
+  accept_awaitable* m_waiters     = nullptr;
+  accept_awaitable* m_last_waiter = nullptr;
+
+  //!
+  //! thread safety
+  //!
+  std::mutex m_mtx;
+};
+
+inline bool
+accept_awaitable::await_suspend(std::coroutine_handle<> handle) {
+  m_handle = handle;
+
+  return m_server.wait(*this);
+}
+
+} // namespace coro
+
+} // namespace tacopie
@@ -0,0 +1,168 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <tacopie/http/request.hpp>
+#include <tacopie/http/request_parser.hpp>
+#include <tacopie/http/response.hpp>
+#include <tacopie/network/tcp_client.hpp>
+
+#ifndef __TACOPIE_HTTP_READ_SIZE
+#define __TACOPIE_HTTP_READ_SIZE 4096
+#endif /* __TACOPIE_HTTP_READ_SIZE */
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! HTTP/1.x server-side connection
+//!
+//! requests are parsed as bytes are received and handled in order (pipelining)
+//! the connection is kept alive unless the client asks otherwise or the request is invalid
+//!
+class connection : public std::enable_shared_from_this<connection> {
+public:
+  //!
+  //! request handler
+  //! called synchronously for each request, the response is sent as soon as the handler returns
+  //!
+  typedef std::function<void(const request&, response&)> request_handler_t;
+
+  //!
+  //! close handler
+  //! called once, whenever the connection is closed
+  //!
+  typedef std::function<void(const std::shared_ptr<connection>&)> close_handler_t;
+
+public:
+  //!
+  //! ctor
+  //!
+  //! \param client underlying tcp client
+  //! \param request_handler handler to be called for each request
+  //! \param close_handler handler to be called when the connection is closed (may be null)
+  //!
+  connection(const std::shared_ptr<tcp_client>& client, const request_handler_t& request_handler, const close_handler_t& close_handler);
+
+  //! dtor
+  ~connection(void) = default;
+
+  //! copy ctor
+  connection(const connection&) = delete;
+  //! assignment operator
+  connection& operator=(const connection&) = delete;
+
+public:
+  //!
+  //! start reading requests
+  //!
+  void start(void);
+
+  //!
+  //! close the connection
+  //! pending responses are dropped
+  //!
+  void close(void);
+
+  //!
+  //! \return underlying tcp client
+  //!
+  const std::shared_ptr<tcp_client>& get_client(void) const;
+
+private:
+  //!
+  //! schedule the next read operation
+  //!
+  void async_read(void);
+
+  //!
+  //! tcp_client read callback
+  //!
+  //! \param result read result
+  //!
+  void on_read(tcp_client::read_result& result);
+
+  //!
+  //! write the response: head and body are queued together and sent with a single gather write
+  //!
+  //! \param response response to be sent
+  //! \param send_body whether the body should be sent (false for HEAD requests)
+  //! \param keep_alive whether the connection should be closed once the response has been sent
+  //!
+  void send_response(response& response, bool send_body, bool keep_alive);
+
+  //!
+  //! send an error response and close the connection
+  //!
+  //! \param status status code
+  //!
+  void send_error(unsigned int status);
+
+  //!
+  //! write callback of the last response, close the connection
+  //!
+  //! \param result write result
+  //!
+  void on_last_write(tcp_client::write_result& result);
+
+private:
+  //!
+  //! underlying tcp client
+  //!
+  std::shared_ptr<tcp_client> m_client;
+
+  //!
+  //! request handler
+  //!
+  request_handler_t m_request_handler;
+
+  //!
+  //! close handler
+  //!
+  close_handler_t m_close_handler;
+
+  //!
+  //! request parser, only accessed from the read callback
+  //!
+  request_parser m_parser;
+
+  //!
+  //! current request, only accessed from the read callback
+  //!
+  request m_request;
+
+  //!
+  //! whether the connection has been closed
+  //!
+  std::atomic<bool> m_is_closed = ATOMIC_VAR_INIT(false);
+};
+
+} // namespace http
+
+} // namespace tacopie
@@ -0,0 +1,215 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifndef __TACOPIE_HTTP_MAX_HEADERS
+#define __TACOPIE_HTTP_MAX_HEADERS 32
+#endif /* __TACOPIE_HTTP_MAX_HEADERS */
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! non-owning reference to a range of bytes of the connection buffer
+//!
+struct slice {
+  //!
+  //! first byte of the range
+  //!
+  const char* data;
+  //!
+  //! number of bytes
+  //!
+  std::size_t size;
+
+  //!
+  //! \return a copy of the range as a std::string
+  //!
+  std::string to_string(void) const;
+
+  //!
+  //! \param str null-terminated string to compare with
+  //! \return whether the range is equal to the given string (case insensitive)
+  //!
+  bool iequals(const char* str) const;
+};
+
+//!
+//! HTTP/1.x request
+//!
+//! the request does not own any byte: method, target, headers and body reference the connection buffer
+//! headers are stored in a fixed-size array, so parsing a request never allocates
+//!
+class request {
+public:
+  //!
+  //! header field
+  //!
+  struct header {
+    //!
+    //! field name
+    //!
+    slice name;
+    //!
+    //! field value, without surrounding whitespaces
+    //!
+    slice value;
+  };
+
+public:
+  //! ctor
+  request(void);
+  //! dtor
+  ~request(void) = default;
+
+  //! copy ctor
+  request(const request&) = default;
+  //! assignment operator
+  request& operator=(const request&) = default;
+
+public:
+  //!
+  //! reset the request to its initial state
+  //!
+  void reset(void);
+
+  //!
+  //! set request line information
+  //!
+  //! \param method request method
+  //! \param target request target
+  //! \param version_minor minor version of the protocol (HTTP/1.x)
+  //!
+  void set_request_line(const slice& method, const slice& target, unsigned int version_minor);
+
+  //!
+  //! append a header field
+  //!
+  //! \param name field name
+  //! \param value field value
+  //! \return false if the maximum number of headers (__TACOPIE_HTTP_MAX_HEADERS) has been reached
+  //!
+  bool add_header(const slice& name, const slice& value);
+
+  //!
+  //! set the request body
+  //!
+  //! \param body body of the request
+  //!
+  void set_body(const slice& body);
+
+  //!
+  //! set whether the connection should be kept alive after this request
+  //!
+  //! \param keep_alive keep-alive flag
+  //!
+  void set_keep_alive(bool keep_alive);
+
+public:
+  //!
+  //! \return the request method
+  //!
+  const slice& get_method(void) const;
+
+  //!
+  //! \return the request target
+  //!
+  const slice& get_target(void) const;
+
+  //!
+  //! \return the minor version of the protocol (HTTP/1.x)
+  //!
+  unsigned int get_version_minor(void) const;
+
+  //!
+  //! \return the number of header fields
+  //!
+  std::size_t get_nb_headers(void) const;
+
+  //!
+  //! \param index index of the header field (must be lower than get_nb_headers())
+  //! \return the header field at the given index
+  //!
+  const header& get_header(std::size_t index) const;
+
+  //!
+  //! \param name name of the header field to look for (case insensitive)
+  //! \return the value of the first matching header field, or nullptr if there is none
+  //!
+  const slice* find_header(const char* name) const;
+
+  //!
+  //! \return the request body
+  //!
+  const slice& get_body(void) const;
+
+  //!
+  //! \return whether the connection should be kept alive after this request
+  //!
+  bool keep_alive(void) const;
+
+private:
+  //!
+  //! request method
+  //!
+  slice m_method;
+
+  //!
+  //! request target
+  //!
+  slice m_target;
+
+  //!
+  //! minor version of the protocol
+  //!
+  unsigned int m_version_minor;
+
+  //!
+  //! header fields
+  //!
+  header m_headers[__TACOPIE_HTTP_MAX_HEADERS];
+
+  //!
+  //! number of header fields
+  //!
+  std::size_t m_nb_headers;
+
+  //!
+  //! request body
+  //!
+  slice m_body;
+
+  //!
+  //! whether the connection should be kept alive
+  //!
+  bool m_keep_alive;
+};
+
+} // namespace http
+
+} // namespace tacopie
@@ -0,0 +1,168 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <tacopie/http/request.hpp>
+
+#ifndef __TACOPIE_HTTP_MAX_HEADER_SIZE
+#define __TACOPIE_HTTP_MAX_HEADER_SIZE 8192
+#endif /* __TACOPIE_HTTP_MAX_HEADER_SIZE */
+
+#ifndef __TACOPIE_HTTP_MAX_BODY_SIZE
+#define __TACOPIE_HTTP_MAX_BODY_SIZE (1024 * 1024)
+#endif /* __TACOPIE_HTTP_MAX_BODY_SIZE */
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! incremental HTTP/1.x request parser
+//!
+//! bytes are fed as they are received and requests are extracted one by one (pipelining)
+//! parsing never allocates: requests reference the internal buffer of the parser
+//!
+//! when all the previously fed bytes have been consumed, feeding a buffer by rvalue simply takes ownership of it (no copy at all)
+//! otherwise, the consumed bytes are discarded and the new bytes are appended to the pending partial request
+//!
+class request_parser {
+public:
+  //!
+  //! result of a parse operation
+  //!
+  enum class status {
+    complete,
+    incomplete,
+    bad_request,
+    header_too_large,
+    payload_too_large,
+    not_implemented
+  };
+
+public:
+  //! ctor
+  request_parser(void);
+  //! dtor
+  ~request_parser(void) = default;
+
+  //! copy ctor
+  request_parser(const request_parser&) = delete;
+  //! assignment operator
+  request_parser& operator=(const request_parser&) = delete;
+
+public:
+  //!
+  //! feed the parser with received bytes
+  //! invalidates all the requests previously returned by parse(): their slices must not be used anymore
+  //!
+  //! allocation-free only when no partial request is pending
+  //! otherwise, the consumed bytes are erased and the received bytes are copied after the pending ones, which may reallocate the internal buffer
+  //!
+  //! \param buffer received bytes (moved into the parser when possible)
+  //!
+  void feed(std::vector<char>&& buffer);
+
+  //!
+  //! feed the parser with received bytes
+  //! invalidates all the requests previously returned by parse(): their slices must not be used anymore
+  //!
+  //! the consumed bytes are erased and the received bytes are always copied, which may reallocate the internal buffer
+  //!
+  //! \param data received bytes (copied into the parser)
+  //! \param size number of bytes
+  //!
+  void feed(const char* data, std::size_t size);
+
+  //!
+  //! extract the next request
+  //! on success, the request bytes are consumed and the request remains valid until the next call to feed()
+  //!
+  //! \param request request to be filled
+  //! \return status::complete if a request has been extracted, status::incomplete if more bytes are needed, an error status otherwise
+  //!
+  status parse(request& request);
+
+  //!
+  //! drop all buffered bytes
+  //!
+  void reset(void);
+
+private:
+  //!
+  //! parse the request line and the header fields
+  //!
+  //! \param end position of the empty line terminating the header section
+  //! \param request request to be filled
+  //! \param content_length set to the value of the Content-Length header (0 if none)
+  //! \return status::complete on success, an error status otherwise
+  //!
+  status parse_head(std::size_t end, request& request, std::size_t& content_length);
+
+  //!
+  //! parse the request line
+  //!
+  //! \param begin position of the first byte of the line
+  //! \param end position of the terminating \r
+  //! \param request request to be filled
+  //! \return whether the request line is valid
+  //!
+  bool parse_request_line(std::size_t begin, std::size_t end, request& request);
+
+  //!
+  //! locate the empty line terminating the header section
+  //!
+  //! \param head_end set to the position of the first byte following the header section on success
+  //! \return whether the header section is complete
+  //!
+  bool find_head_end(std::size_t& head_end);
+
+private:
+  //!
+  //! received bytes
+  //!
+  std::vector<char> m_buffer;
+
+  //!
+  //! position of the first byte not consumed yet
+  //!
+  std::size_t m_offset;
+
+  //!
+  //! position up to which the pending header section has already been scanned
+  //!
+  std::size_t m_scanned;
+
+  //!
+  //! minimum buffer size required before it is worth trying to parse the pending request again
+  //! avoid re-parsing the header section on each partial body read
+  //!
+  std::size_t m_needed;
+};
+
+} // namespace http
+
+} // namespace tacopie
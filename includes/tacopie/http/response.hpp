@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! HTTP/1.x response
+//!
+//! header fields are serialized as soon as they are added, and the body is kept in a separate buffer
+//! the head and the body are then written with a single gather write
+//!
+class response {
+public:
+  //! ctor
+  response(void);
+  //! dtor
+  ~response(void) = default;
+
+  //! copy ctor
+  response(const response&) = default;
+  //! assignment operator
+  response& operator=(const response&) = default;
+
+public:
+  //!
+  //! set the status of the response, using the standard reason phrase
+  //!
+  //! \param status status code
+  //!
+  void set_status(unsigned int status);
+
+  //!
+  //! set the status of the response
+  //!
+  //! \param status status code
+  //! \param reason reason phrase
+  //!
+  void set_status(unsigned int status, const std::string& reason);
+
+  //!
+  //! append a header field
+  //! Content-Length and Connection are managed by the server and should not be set
+  //!
+  //! \param name field name
+  //! \param value field value
+  //!
+  void add_header(const std::string& name, const std::string& value);
+
+  //!
+  //! set the response body
+  //!
+  //! \param body body of the response
+  //!
+  void set_body(const std::string& body);
+
+  //!
+  //! set the response body
+  //!
+  //! \param body body of the response (moved)
+  //!
+  void set_body(std::vector<char>&& body);
+
+public:
+  //!
+  //! \return the status code of the response
+  //!
+  unsigned int get_status(void) const;
+
+  //!
+  //! \return the response body (non-const version)
+  //!
+  std::vector<char>& get_body(void);
+
+  //!
+  //! \return the response body (const version)
+  //!
+  const std::vector<char>& get_body(void) const;
+
+public:
+  //!
+  //! serialize the status line and the header fields
+  //!
+  //! \param version_minor minor version of the protocol (HTTP/1.x)
+  //! \param keep_alive whether the connection is kept alive after this response
+  //! \return the serialized head, including Content-Length and Connection fields
+  //!
+  std::vector<char> build_head(unsigned int version_minor, bool keep_alive) const;
+
+  //!
+  //! \param status status code
+  //! \return the standard reason phrase for the given status code
+  //!
+  static const char* get_reason_phrase(unsigned int status);
+
+private:
+  //!
+  //! status code
+  //!
+  unsigned int m_status;
+
+  //!
+  //! reason phrase
+  //!
+  std::string m_reason;
+
+  //!
+  //! serialized header fields
+  //!
+  std::vector<char> m_headers;
+
+  //!
+  //! body
+  //!
+  std::vector<char> m_body;
+};
+
+} // namespace http
+
+} // namespace tacopie
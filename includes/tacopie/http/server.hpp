@@ -0,0 +1,146 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include <tacopie/http/connection.hpp>
+#include <tacopie/http/request.hpp>
+#include <tacopie/http/response.hpp>
+#include <tacopie/network/tcp_server.hpp>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! minimal HTTP/1.1 server built on top of tcp_server
+//! supports keep-alive and pipelining, request bodies must be sent with a Content-Length
+//!
+class server {
+public:
+  //!
+  //! request handler
+  //! called synchronously for each request, the response is sent as soon as the handler returns
+  //!
+  typedef connection::request_handler_t request_handler_t;
+
+public:
+  //! ctor
+  server(void);
+  //! dtor
+  ~server(void);
+
+  //!
+  //! custom ctor
+  //! build a server monitored by the given io_service instead of the default one
+  //!
+  //! \param io_service io_service monitoring the connections
+  //!
+  explicit server(const std::shared_ptr<tacopie::io_service>& io_service);
+
+  //! copy ctor
+  server(const server&) = delete;
+  //! assignment operator
+  server& operator=(const server&) = delete;
+
+public:
+  //!
+  //! Start the server at the given host and port.
+  //!
+  //! \param host hostname to be connected to
+  //! \param port port to be connected to
+  //! \param request_handler handler to be called for each request
+  //!
+  void start(const std::string& host, std::uint32_t port, const request_handler_t& request_handler);
+
+  //!
+  //! Stop the server if it was currently running and close all the connections.
+  //!
+  //! \param wait_for_removal When sets to true, stop blocks until the underlying TCP server has been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //! \param recursive_wait_for_removal When sets to true and wait_for_removal is also set to true, blocks until all the connections have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void stop(bool wait_for_removal = false, bool recursive_wait_for_removal = true);
+
+  //!
+  //! \return whether the server is currently running or not
+  //!
+  bool is_running(void) const;
+
+  //!
+  //! \return the number of open connections
+  //!
+  std::size_t get_nb_connections(void) const;
+
+public:
+  //!
+  //! \return the underlying tcp_server
+  //!
+  tcp_server& get_tcp_server(void);
+
+private:
+  //!
+  //! tcp_server new connection callback
+  //!
+  //! \param client newly accepted client
+  //! \return true, connections are handled by the http server
+  //!
+  bool on_new_connection(const std::shared_ptr<tcp_client>& client);
+
+  //!
+  //! connection close handler
+  //!
+  //! \param connection closed connection
+  //!
+  void on_connection_closed(const std::shared_ptr<connection>& connection);
+
+private:
+  //!
+  //! underlying tcp server
+  //!
+  tcp_server m_server;
+
+  //!
+  //! request handler
+  //!
+  request_handler_t m_request_handler;
+
+  //!
+  //! open connections
+  //!
+  std::unordered_set<std::shared_ptr<connection>> m_connections;
+
+  //!
+  //! connections thread safety
+  //!
+  mutable std::mutex m_connections_mtx;
+};
+
+} // namespace http
+
+} // namespace tacopie
@@ -23,10 +23,13 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -39,6 +42,8 @@
 
 #include <tacopie/network/self_pipe.hpp>
 #include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/utils/cpu_affinity.hpp>
+#include <tacopie/utils/strand.hpp>
 #include <tacopie/utils/thread_pool.hpp>
 
 #ifndef __TACOPIE_IO_SERVICE_NB_WORKERS
@@ -52,12 +57,45 @@ namespace tacopie {
 //! It polls sockets for input and output, processes read and write operations and calls the appropriate callbacks.
 //!
 class io_service {
+public:
+  //!
+  //! how the io_service is driven
+  //!  * poll_thread: a background thread polls the sockets and the callbacks run on the callback workers
+  //!  * caller_driven: no thread is created, the sockets are polled and the callbacks run on the thread calling run, run_once or poll_nonblocking
+  //!
+  enum class run_mode {
+    poll_thread,
+    caller_driven
+  };
+
 public:
   //!
   //! ctor
   //!
   io_service(void);
 
+  //!
+  //! ctor
+  //!
+  //! \param policy scheduling policy of the thread pool executing the callbacks
+  //!
+  explicit io_service(utils::thread_pool::scheduling_policy policy);
+
+  //!
+  //! ctor
+  //!
+  //! \param mode how the io_service is driven
+  //!
+  explicit io_service(run_mode mode);
+
+  //!
+  //! ctor
+  //!
+  //! \param policy scheduling policy of the thread pool executing the callbacks (caller_driven: the tasks submitted to get_callback_workers)
+  //! \param mode how the io_service is driven
+  //!
+  io_service(utils::thread_pool::scheduling_policy policy, run_mode mode);
+
   //! dtor
   ~io_service(void);
 
@@ -76,6 +114,86 @@ public:
   //!
   void set_nb_workers(std::size_t nb_threads);
 
+  //!
+  //! restrict the poll thread to a set of cpus
+  //! this can be safely called at runtime: the poll thread applies the change itself on its next wake up
+  //! caller_driven mode: the thread driving the io_service is restricted instead
+  //!
+  //! \param cpus allowed cpus (empty list: no restriction)
+  //! \param relocate_state if true, the poll thread reallocates its polling state once pinned so that it lands on the local numa node (first-touch allocation): tracked sockets, select structures, pending tasks and strands, which are then created by the poll thread
+  //!
+  void set_poll_cpu_affinity(const utils::cpu_list_t& cpus, bool relocate_state = true);
+
+  //!
+  //! restrict the callback workers to a set of cpus
+  //!
+  //! \param cpus allowed cpus (empty list: no restriction)
+  //! \param pin_each_worker if true, each worker is pinned to a single cpu of the list (round robin), otherwise each worker may run on any cpu of the list
+  //!
+  void set_workers_cpu_affinity(const utils::cpu_list_t& cpus, bool pin_each_worker = false);
+
+  //!
+  //! compact placement on the numa node of a network interface, read from sysfs (linux only)
+  //! the poll thread is pinned to the first cpu local to the interface, and each callback worker to one of the remaining local cpus
+  //!
+  //! \param network_interface network interface name (for example "eth0")
+  //! \param relocate_state see set_poll_cpu_affinity
+  //!
+  void set_numa_affinity(const std::string& network_interface, bool relocate_state = true);
+
+  //!
+  //! \return thread pool executing the callbacks
+  //! tasks submitted to it run alongside the socket callbacks, for example future continuations
+  //!
+  utils::thread_pool& get_callback_workers(void);
+
+  //!
+  //! \return how the io_service is driven
+  //!
+  run_mode get_run_mode(void) const;
+
+public:
+  //!
+  //! caller_driven mode only: poll the sockets and execute the callbacks on the calling thread until stop is called
+  //! must not be called concurrently with run_once or poll_nonblocking
+  //!
+  void run(void);
+
+  //!
+  //! caller_driven mode only: wait for events, then execute the callbacks of the detected events and the tasks pending in the callback workers on the calling thread
+  //! returns early when woken up by another thread (tracking update, task submitted to get_callback_workers, or stop)
+  //!
+  //! socket callbacks run inline, one after the other: they need no strand and are never concurrent
+  //!
+  //! \param timeout_msecs maximum time to wait for events (0 will block undefinitely)
+  //! \return number of callbacks and tasks executed
+  //!
+  std::size_t run_once(std::uint32_t timeout_msecs = 0);
+
+  //!
+  //! caller_driven mode only: same as run_once, without waiting for events
+  //!
+  //! \return number of callbacks and tasks executed
+  //!
+  std::size_t poll_nonblocking(void);
+
+  //!
+  //! caller_driven mode only: make run return
+  //! can be called from any thread, including from a callback; if run is not being executed, the next call to run returns immediately
+  //!
+  void stop(void);
+
+public:
+  //!
+  //! execute a task on the callback workers once the given delay elapsed
+  //! the deadline is checked whenever the poll thread (or the driving thread in caller_driven mode) wakes up: the task never runs early, but may run late if the callback workers are busy
+  //! the tasks pending when the io_service is destroyed are dropped
+  //!
+  //! \param delay_msecs delay before execution
+  //! \param task task to be executed
+  //!
+  void schedule(std::uint32_t delay_msecs, utils::thread_pool::task_t&& task);
+
 public:
   //! callback handler typedef
   //! called on new socket event if register to io_service
@@ -89,8 +207,19 @@ public:
   //! \param socket socket to be tracked
   //! \param rd_callback callback to be executed on read event
   //! \param wr_callback callback to be executed on write event
+  //! \param prio priority class of the socket callbacks in the callback workers
+  //!
+  void track(const tcp_socket& socket, const event_callback_t& rd_callback = nullptr, const event_callback_t& wr_callback = nullptr, utils::thread_pool::priority prio = utils::thread_pool::priority::normal);
+
+  //!
+  //! update the priority class of the socket callbacks in the callback workers
+  //! latency-sensitive (control) connections should use the high priority, bulk transfers the low priority
+  //! if socket is not tracked yet, track it
   //!
-  void track(const tcp_socket& socket, const event_callback_t& rd_callback = nullptr, const event_callback_t& wr_callback = nullptr);
+  //! \param socket socket to be updated
+  //! \param prio priority class
+  //!
+  void set_priority(const tcp_socket& socket, utils::thread_pool::priority prio);
 
   //!
   //! update the read callback
@@ -101,6 +230,30 @@ public:
   //!
   void set_rd_callback(const tcp_socket& socket, const event_callback_t& event_callback);
 
+  //!
+  //! same as set_rd_callback, moving the callback
+  //!
+  //! \param socket socket to be tracked
+  //! \param event_callback callback to be executed on read event
+  //!
+  void set_rd_callback(const tcp_socket& socket, event_callback_t&& event_callback);
+
+  //!
+  //! same as set_rd_callback, sharing an existing callback
+  //! callers setting the same callback repeatedly can build it once, so that updating the tracking does not allocate
+  //!
+  //! \param socket socket to be tracked
+  //! \param event_callback callback to be executed on read event (may be null)
+  //!
+  void set_rd_callback(const tcp_socket& socket, const std::shared_ptr<event_callback_t>& event_callback);
+
+  //!
+  //! reset the read callback
+  //!
+  //! \param socket socket to be tracked
+  //!
+  void set_rd_callback(const tcp_socket& socket, std::nullptr_t);
+
   //!
   //! update the write callback
   //! if socket is not tracked yet, track it
@@ -110,6 +263,30 @@ public:
   //!
   void set_wr_callback(const tcp_socket& socket, const event_callback_t& event_callback);
 
+  //!
+  //! same as set_wr_callback, moving the callback
+  //!
+  //! \param socket socket to be tracked
+  //! \param event_callback callback to be executed on write event
+  //!
+  void set_wr_callback(const tcp_socket& socket, event_callback_t&& event_callback);
+
+  //!
+  //! same as set_wr_callback, sharing an existing callback
+  //! callers setting the same callback repeatedly can build it once, so that updating the tracking does not allocate
+  //!
+  //! \param socket socket to be tracked
+  //! \param event_callback callback to be executed on write event (may be null)
+  //!
+  void set_wr_callback(const tcp_socket& socket, const std::shared_ptr<event_callback_t>& event_callback);
+
+  //!
+  //! reset the write callback
+  //!
+  //! \param socket socket to be tracked
+  //!
+  void set_wr_callback(const tcp_socket& socket, std::nullptr_t);
+
   //!
   //! remove socket from io_service tracking
   //! socket is marked for untracking and will effectively be removed asynchronously from tracking once
@@ -126,6 +303,8 @@ public:
   //! wait until the socket has been effectively removed
   //! basically wait until all pending callbacks are executed
   //!
+  //! caller_driven mode: from another thread, this blocks until the driving thread executes the pending callbacks
+  //!
   //! \param socket socket to wait for
   //!
   void wait_for_removal(const tcp_socket& socket);
@@ -139,7 +318,11 @@ private:
   //!  * wr_callback: callback to be executed on write availability
   //!  * is_executing_wr_callback: whether the wr callback is currently being executed or not
   //!  * marked_for_untrack: whether the socket is marked for being untrack (that is, will be untracked whenever all the callback completed their execution)
+  //!  * priority: priority class of the callbacks in the callback workers
+  //!  * strand: strand on which the callbacks are executed (created on first event)
   //!
+  //! callbacks are shared so that dispatching an event only copies a pointer, even if the callback is replaced while being executed
+  //! callbacks of a given socket go through its strand: read and write callbacks of a socket never run concurrently, while different sockets are processed in parallel
   //!
   struct tracked_socket {
     //! ctor
@@ -148,15 +331,21 @@ private:
     , wr_callback(nullptr) {}
 
     //! rd event
-    event_callback_t rd_callback;
+    std::shared_ptr<event_callback_t> rd_callback;
     std::atomic<bool> is_executing_rd_callback = ATOMIC_VAR_INIT(false);
 
     //! wr event
-    event_callback_t wr_callback;
+    std::shared_ptr<event_callback_t> wr_callback;
     std::atomic<bool> is_executing_wr_callback = ATOMIC_VAR_INIT(false);
 
     //! marked for untrack
     std::atomic<bool> marked_for_untrack = ATOMIC_VAR_INIT(false);
+
+    //! priority of the callbacks
+    utils::thread_pool::priority priority = utils::thread_pool::priority::normal;
+
+    //! serial execution of the callbacks
+    std::shared_ptr<utils::strand> strand;
   };
 
 private:
@@ -166,6 +355,45 @@ private:
   //!
   void poll(void);
 
+  //!
+  //! caller_driven mode: poll and execute the callbacks and the pending tasks on the calling thread
+  //!
+  //! \param timeout maximum time to wait for events (null will block undefinitely)
+  //! \return number of callbacks and tasks executed
+  //!
+  std::size_t run_caller_driven(struct timeval* timeout);
+
+  //!
+  //! wait for events with select/poll
+  //!
+  //! \param timeout maximum time to wait for events (null will block undefinitely)
+  //! \return whether some events have been detected
+  //!
+  bool wait_for_events(struct timeval* timeout);
+
+  //!
+  //! wake up the poll call, unless the calling thread is the one driving the io_service: it rebuilds the polled fds before polling again anyway
+  //!
+  void wake_up(void);
+
+  //!
+  //! caller_driven mode: wake up the poll call for tasks submitted to the callback workers, unless already done since the last wake up
+  //! tasks submitted by the driving thread are executed before it polls again anyway
+  //!
+  void wake_up_for_tasks(void);
+
+  //!
+  //! apply the poll thread cpu affinity, if it has been changed since last call
+  //! called by the poll thread
+  //!
+  void apply_poll_cpu_affinity(void);
+
+  //!
+  //! reallocate the polling state from the calling thread, so that it lands on its numa node (first-touch allocation)
+  //! tracked sockets, select structures and pending tasks are reallocated, idle strands are dropped and created again on their next event
+  //!
+  void relocate_poll_state(void);
+
   //!
   //! init m_poll_fds_info
   //! simply initialize m_polled_fds variable based on m_tracked_sockets information
@@ -177,9 +405,21 @@ private:
   //!
   //! process poll detected events
   //! called whenever select/poll completed to check read and write availablity
+  //! the callbacks and the scheduled tasks whose deadline elapsed are collected and submitted to the callback workers as a single batch
   //!
   void process_events(void);
 
+  //!
+  //! collect the callbacks of the events detected by select/poll into m_pending_tasks
+  //! executed under m_tracked_sockets_mtx
+  //!
+  void collect_events(void);
+
+  //!
+  //! collect the scheduled tasks whose deadline elapsed into m_pending_tasks
+  //!
+  void collect_timers(void);
+
   //!
   //! process read event reported by select/poll for a given socket
   //!
@@ -196,17 +436,53 @@ private:
   //!
   void process_wr_event(const fd_t& fd, tracked_socket& socket);
 
+  //!
+  //! submit the callback of an event: to the socket strand, or inline in caller_driven mode
+  //!
+  //! \param socket tracked_socket for which the event has been detected
+  //! \param task callback execution
+  //!
+  void dispatch(tracked_socket& socket, utils::thread_pool::task_t&& task);
+
+  //!
+  //! \return the strand of the given socket, created if necessary
+  //!
+  //! \param socket tracked_socket for which the strand is requested
+  //!
+  utils::strand& get_strand(tracked_socket& socket);
+
 private:
   //!
   //! tracked sockets
   //!
   std::unordered_map<fd_t, tracked_socket> m_tracked_sockets;
 
+  //!
+  //! how the io_service is driven
+  //!
+  run_mode m_run_mode;
+
   //!
   //! whether the worker should stop or not
   //!
   std::atomic<bool> m_should_stop;
 
+  //!
+  //! caller_driven mode: whether run should return or not
+  //!
+  std::atomic<bool> m_run_should_stop = ATOMIC_VAR_INIT(false);
+
+  //!
+  //! caller_driven mode: whether the driving thread has already been notified of tasks submitted since its last wake up
+  //! a burst of submissions writes a single byte to the notifier, which could otherwise fill up while nobody drives the io_service
+  //!
+  std::atomic<bool> m_tasks_notified = ATOMIC_VAR_INIT(false);
+
+  //!
+  //! io_service driven by the current thread, if any (caller_driven mode)
+  //!
+  static thread_local io_service* s_current_io_service;
+
   //!
   //! poll thread
   //!
@@ -228,14 +504,18 @@ private:
   std::vector<fd_t> m_polled_fds;
 
   //!
-  //! data structure given to select (list of fds to poll for read)
+  //! data structures given to select (lists of fds to poll for read and for write)
+  //! allocated separately from the io_service, so that the poll thread can reallocate them once pinned
   //!
-  fd_set m_rd_set;
+  struct select_sets {
+    fd_set rd_set;
+    fd_set wr_set;
+  };
 
   //!
-  //! data structure given to select (list of fds to poll for write)
+  //! data structures given to select
   //!
-  fd_set m_wr_set;
+  std::unique_ptr<select_sets> m_select_sets;
 
   //!
   //! condition variable to wait on removal
@@ -246,17 +526,56 @@ private:
   //! fd associated to the pipe used to wake up the poll call
   //!
   tacopie::self_pipe m_notifier;
+
+  //!
+  //! callbacks collected by process_events, submitted at once to the callback workers (poll thread only)
+  //! caller_driven mode: executed inline by the driving thread
+  //!
+  utils::thread_pool::task_batch_t m_pending_tasks;
+
+  //!
+  //! scheduled tasks, by deadline
+  //!
+  std::multimap<std::chrono::steady_clock::time_point, utils::thread_pool::task_t> m_timers;
+
+  //!
+  //! scheduled tasks thread safety
+  //!
+  std::mutex m_timers_mtx;
+
+  //!
+  //! poll thread cpu affinity, applied by the poll thread
+  //!
+  utils::cpu_list_t m_poll_cpu_affinity;
+
+  //!
+  //! whether the poll thread should reallocate its state after applying its cpu affinity
+  //!
+  bool m_relocate_poll_state = false;
+
+  //!
+  //! whether the poll thread cpu affinity has been changed since last applied
+  //!
+  std::atomic<bool> m_poll_cpu_affinity_changed = ATOMIC_VAR_INIT(false);
+
+  //!
+  //! poll thread cpu affinity thread safety
+  //!
+  std::mutex m_poll_cpu_affinity_mtx;
 };
 
 //!
 //! default io_service getter & setter
+//! thread-safe: the default instance is created once, on first use
+//! clients and servers built with an explicit io_service do not use it
 //!
 //! \return shared_ptr to the default instance of the io_service
 //!
-const std::shared_ptr<io_service>& get_default_io_service(void);
+std::shared_ptr<io_service> get_default_io_service(void);
 
 //!
 //! set the default io_service to be returned by get_default_io_service
+//! thread-safe: clients and servers already built keep the io_service they were built with
 //!
 //! \param service the service to be used as the default io_service instance
 //!
@@ -0,0 +1,129 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tacopie {
+
+//!
+//! tacopie::shared_buffer is an immutable, reference-counted chain of byte slices.
+//! Copying a shared_buffer never copies the bytes: the same message can be written to many tcp_client at the cost of a single allocation (fan-out).
+//!
+class shared_buffer {
+public:
+  //! ctor: null buffer
+  shared_buffer(void) = default;
+  //! dtor
+  ~shared_buffer(void) = default;
+
+  //!
+  //! custom ctor
+  //! build a buffer made of a single slice
+  //!
+  //! \param bytes content of the buffer (moved)
+  //!
+  explicit shared_buffer(std::vector<char> bytes);
+
+  //!
+  //! custom ctor
+  //! build a buffer made of a single slice
+  //!
+  //! \param bytes content of the buffer (copied)
+  //!
+  explicit shared_buffer(const std::string& bytes);
+
+  //!
+  //! custom ctor
+  //! build a buffer made of a chain of slices, written in order (a header and a payload for example)
+  //!
+  //! \param slices content of the buffer (moved)
+  //!
+  explicit shared_buffer(std::vector<std::vector<char>> slices);
+
+  //! copy ctor
+  shared_buffer(const shared_buffer&) = default;
+  //! assignment operator
+  shared_buffer& operator=(const shared_buffer&) = default;
+
+public:
+  //!
+  //! \return whether the buffer has been built (a default-constructed buffer is null)
+  //!
+  explicit operator bool(void) const;
+
+  //!
+  //! \return total number of bytes, over all slices
+  //!
+  std::size_t size(void) const;
+
+  //!
+  //! \return number of slices
+  //!
+  std::size_t nb_slices(void) const;
+
+  //!
+  //! \param index index of the slice, lower than nb_slices()
+  //! \return the requested slice
+  //!
+  const std::vector<char>& get_slice(std::size_t index) const;
+
+  //!
+  //! \return number of shared_buffer instances sharing the content, including pending writes (0 for a null buffer)
+  //! the value may be outdated as soon as it is returned if other threads hold copies
+  //!
+  std::size_t use_count(void) const;
+
+private:
+  //!
+  //! shared content: slices and their total size
+  //!
+  struct storage {
+    //!
+    //! slices, in order
+    //!
+    std::vector<std::vector<char>> slices;
+    //!
+    //! total number of bytes
+    //!
+    std::size_t size;
+  };
+
+  //!
+  //! build the shared storage
+  //!
+  //! \param slices slices of the buffer (moved)
+  //!
+  void init(std::vector<std::vector<char>>&& slices);
+
+private:
+  //!
+  //! shared, immutable content
+  //!
+  std::shared_ptr<const storage> m_storage;
+};
+
+} // namespace tacopie
@@ -24,14 +24,24 @@
 
 #include <atomic>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <utility>
+#include <vector>
 #include <string>
 
 #include <tacopie/network/io_service.hpp>
+#include <tacopie/network/shared_buffer.hpp>
 #include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/utils/future.hpp>
 #include <tacopie/utils/typedefs.hpp>
 
+#ifndef __TACOPIE_SENDFILE_CHUNK_SIZE
+#define __TACOPIE_SENDFILE_CHUNK_SIZE (1024 * 1024)
+#endif /* __TACOPIE_SENDFILE_CHUNK_SIZE */
+
 namespace tacopie {
 
 //!
@@ -40,10 +50,23 @@ namespace tacopie {
 //!
 class tcp_client {
 public:
-  //! ctor & dtor
+  //! ctor
   tcp_client(void);
+
+  //!
+  //! dtor
+  //! disconnects without waiting for the removal from the io_service (the client may be released from one of its own callbacks) and without calling any callback: the pending requests are dropped, their futures broken
+  //!
   ~tcp_client(void);
 
+  //!
+  //! custom ctor
+  //! build a client monitored by the given io_service instead of the default one
+  //!
+  //! \param io_service io_service monitoring the connection
+  //!
+  explicit tcp_client(const std::shared_ptr<tacopie::io_service>& io_service);
+
   //!
   //! custom ctor
   //! build socket from existing socket
@@ -52,6 +75,15 @@ public:
   //!
   explicit tcp_client(tcp_socket&& socket);
 
+  //!
+  //! custom ctor
+  //! build socket from existing socket, monitored by the given io_service instead of the default one
+  //!
+  //! \param socket tcp_socket instance to be used for building the client (socket will be moved)
+  //! \param io_service io_service monitoring the connection
+  //!
+  tcp_client(tcp_socket&& socket, const std::shared_ptr<tacopie::io_service>& io_service);
+
   //! copy ctor
   tcp_client(const tcp_client&) = delete;
   //! assignment operator
@@ -95,27 +127,58 @@ public:
 
   //!
   //! Disconnect the tcp_client if it was currently connected.
+  //! The pending requests are dropped: their callbacks are not called and their futures are broken. Requests issued with complete_on_disconnect are completed by the calling thread before returning instead: their callbacks are called with a failed result (false for async_connect).
   //!
   //! \param wait_for_removal When sets to true, disconnect blocks until the underlying TCP client has been effectively removed from the io_service and that all the underlying callbacks have completed.
   //!
   void disconnect(bool wait_for_removal = false);
 
   //!
-  //! \return whether the client is currently connected or not
+  //! tag requesting that the callback of a request is still called when the request is dropped by disconnect (see disconnect)
+  //! meant for operations that must always complete, such as the coroutine awaitables: the callback runs on the thread calling disconnect, and must not throw
+  //! the destructor drops these requests without calling them: the client must outlive them
   //!
-  bool is_connected(void) const;
+  struct complete_on_disconnect_t {};
 
-private:
   //!
-  //! Call the user-defined disconnection handler
+  //! callback to be called on async connect completion
+  //! takes whether the connection succeeded as a parameter
   //!
-  void call_disconnection_handler(void);
+  typedef std::function<void(bool)> async_connect_callback_t;
+
+  //!
+  //! Connect the socket to the remote server without blocking
+  //! the connection is monitored by the io_service, and the callback is executed by the io_service worker observing its completion
+  //! the client is connected when the callback is called with true, on failure the socket is closed
+  //! a pending connection is cancelled by disconnect (the callback is then called with false if the connection completes concurrently)
+  //!
+  //! \param host Hostname of the target server
+  //! \param port Port of the target server
+  //! \param callback callback to be executed on connection completion
+  //!
+  void async_connect(const std::string& host, std::uint32_t port, const async_connect_callback_t& callback);
+
+  //!
+  //! same as async_connect, but the callback is called with false if the connection is cancelled by disconnect
+  //!
+  //! \param host Hostname of the target server
+  //! \param port Port of the target server
+  //! \param callback callback to be executed on connection completion or cancellation
+  //!
+  void async_connect(const std::string& host, std::uint32_t port, const async_connect_callback_t& callback, complete_on_disconnect_t);
+
+  //!
+  //! \return whether the client is currently connected or not
+  //!
+  bool is_connected(void) const;
 
 public:
   //!
   //! structure to store read requests result
   //!  * success: Whether the read operation has succeeded or not. If false, the client has been disconnected
   //!  * buffer: Vector containing the read bytes
+  //!  * error: System error code of the failure (errno, WSAGetLastError() on windows), 0 if the read succeeded or the connection was closed by the remote host
+  //!  * eof: Whether the failure is due to the connection being closed by the remote host
   //!
   struct read_result {
     //!
@@ -126,12 +189,22 @@ public:
     //! read bytes
     //!
     std::vector<char> buffer;
+    //!
+    //! system error code, 0 if none
+    //!
+    int error;
+    //!
+    //! whether the connection was closed by the remote host
+    //!
+    bool eof;
   };
 
   //!
   //! structure to store write requests result
   //!  * success: Whether the write operation has succeeded or not. If false, the client has been disconnected
   //!  * size: Number of bytes written
+  //!  * error: System error code of the failure (errno, WSAGetLastError() on windows), 0 if the write succeeded
+  //!  * buffer: Written bytes of a write_request (or of a future-returning async_write), handed back once entirely written so that their storage can be reused. Empty for other requests.
   //!
   struct write_result {
     //!
@@ -142,6 +215,14 @@ public:
     //! number of bytes written
     //!
     std::size_t size;
+    //!
+    //! system error code, 0 if none
+    //!
+    int error;
+    //!
+    //! written bytes, handed back to be reused
+    //!
+    std::vector<char> buffer;
   };
 
 public:
@@ -190,6 +271,48 @@ public:
     async_write_callback_t async_write_callback;
   };
 
+  //!
+  //! structure to store shared write requests information
+  //!  * buffer: Shared bytes to be written, possibly made of several slices. The bytes are referenced, never copied: the same buffer can be written to many clients.
+  //!  * async_write_callback: Callback to be called once the whole buffer has been written or the operation failed.
+  //!
+  struct shared_write_request {
+    //!
+    //! shared bytes to write
+    //!
+    shared_buffer buffer;
+    //!
+    //! callback to be executed on write operation completion
+    //!
+    async_write_callback_t async_write_callback;
+  };
+
+  //!
+  //! structure to store file write requests information
+  //!  * fd: File descriptor of the file to send, must stay open until the request completes
+  //!  * offset: Offset of the first byte to send in the file
+  //!  * size: Number of bytes to send
+  //!  * async_write_callback: Callback to be called once the whole range has been sent, the end of the file has been reached or the operation failed.
+  //!
+  struct sendfile_request {
+    //!
+    //! file to send
+    //!
+    int fd;
+    //!
+    //! offset of the first byte to send
+    //!
+    std::uint64_t offset;
+    //!
+    //! number of bytes to send
+    //!
+    std::size_t size;
+    //!
+    //! callback to be executed on write operation completion
+    //!
+    async_write_callback_t async_write_callback;
+  };
+
 public:
   //!
   //! async read operation
@@ -198,6 +321,14 @@ public:
   //!
   void async_read(const read_request& request);
 
+  //!
+  //! async read operation
+  //! same as async_read(const read_request&), but the callback is called with a failed result if the request is dropped by disconnect
+  //!
+  //! \param request read request information
+  //!
+  void async_read(const read_request& request, complete_on_disconnect_t);
+
   //!
   //! async write operation
   //!
@@ -205,6 +336,81 @@ public:
   //!
   void async_write(const write_request& request);
 
+  //!
+  //! async write operation
+  //! same as async_write(const write_request&), but the request (and its buffer) is moved into the write queue instead of being copied
+  //!
+  //! \param request write request information
+  //!
+  void async_write(write_request&& request);
+
+  //!
+  //! async write operation
+  //! same as async_write(write_request&&), but the callback is called with a failed result if the request is dropped by disconnect
+  //!
+  //! \param request write request information
+  //!
+  void async_write(write_request&& request, complete_on_disconnect_t);
+
+  //!
+  //! async write operation of a shared buffer
+  //! the slices of the buffer are gathered with the other pending writes in a single system call
+  //! the request completes once the whole buffer has been written, write_result::size is the total number of bytes written
+  //!
+  //! \param request shared write request information
+  //!
+  void async_write(const shared_write_request& request);
+
+  //!
+  //! async read operation returning a future instead of calling a callback
+  //! the future is completed by the io_service worker performing the read, continuations attached after completion run on the io_service workers
+  //! the promise is broken (get throws) if the client disconnects before the read is performed
+  //!
+  //! \param size number of bytes to read
+  //! \return future of the read result
+  //!
+  utils::future<read_result> async_read(std::size_t size);
+
+  //!
+  //! async write operation returning a future instead of calling a callback
+  //! the future is completed by the io_service worker performing the write, continuations attached after completion run on the io_service workers
+  //! the promise is broken (get throws) if the client disconnects before the write is performed
+  //!
+  //! \param buffer bytes to write, moved into the write queue
+  //! \return future of the write result
+  //!
+  utils::future<write_result> async_write(std::vector<char> buffer);
+
+  //!
+  //! async write operation of a shared buffer returning a future instead of calling a callback
+  //! same as async_write(const shared_write_request&) otherwise
+  //!
+  //! \param buffer shared bytes to write
+  //! \return future of the write result
+  //!
+  utils::future<write_result> async_write(const shared_buffer& buffer);
+
+  //!
+  //! async file write operation
+  //! the range is sent without copying it to user space when the platform allows it (see tcp_socket::sendfile), by chunks of at most __TACOPIE_SENDFILE_CHUNK_SIZE bytes per write availability
+  //! file requests are queued with the buffered write requests and sent in order
+  //! unlike buffered writes, the request completes only once the whole range has been sent (or the end of the file has been reached), write_result::size is the total number of bytes sent
+  //!
+  //! \param request file write request information
+  //!
+  void async_sendfile(const sendfile_request& request);
+
+  //!
+  //! async file write operation returning a future instead of calling a callback
+  //! same as async_sendfile(const sendfile_request&) otherwise
+  //!
+  //! \param fd file descriptor of the file to send, must stay open until the request completes
+  //! \param offset offset of the first byte to send in the file
+  //! \param size number of bytes to send
+  //! \return future of the write result
+  //!
+  utils::future<write_result> async_sendfile(int fd, std::uint64_t offset, std::size_t size);
+
 public:
   //!
   //! \return underlying tcp_socket (non-const version)
@@ -220,7 +426,42 @@ public:
   //!
   //! \return io service monitoring this tcp connection
   //!
-  const std::shared_ptr<tacopie::io_service>& get_io_service(void) const;
+  std::shared_ptr<tacopie::io_service> get_io_service(void) const;
+
+  //!
+  //! Migrate the connection to another io_service, for example to move a busy connection away from an overloaded poll thread.
+  //! Pending read and write requests are kept: they are processed by the new io_service, in order.
+  //! Callbacks already queued by the previous io_service may still run afterwards (never concurrently with the callbacks of the new one), futures returned before the migration run their continuations on the previous io_service workers: the previous io_service must outlive them.
+  //! Can be called from any thread, including from a callback of this client, but not while an async_connect is pending.
+  //!
+  //! \param io_service io_service monitoring the connection from now on
+  //!
+  void set_io_service(const std::shared_ptr<tacopie::io_service>& io_service);
+
+  //!
+  //! set the priority class of this connection callbacks in the io_service workers
+  //! latency-sensitive (control) connections should use the high priority, bulk transfers the low priority
+  //! can be called before or after connecting
+  //!
+  //! \param prio priority class
+  //!
+  void set_priority(utils::thread_pool::priority prio);
+
+  //!
+  //! enable zero-copy writes (MSG_ZEROCOPY, linux only) for buffers of at least threshold bytes
+  //! such a buffer is sent on its own and held by the client until the kernel releases it: the write completes as soon as the data is sent, as other writes
+  //! zero-copy only pays off for large payloads on real network devices (the kernel copies the data anyway on loopback), tens of kilobytes being a typical threshold
+  //! must be called once connected, throws if zero-copy is not supported
+  //!
+  //! \param threshold minimum size of zero-copy writes, 0 disables zero-copy writes
+  //!
+  void set_zerocopy_threshold(std::size_t threshold);
+
+  //!
+  //! \return number of bytes of the pending write requests (requests queued and not completed yet)
+  //! useful to apply backpressure: a peer reading slower than data is written makes it grow
+  //!
+  std::size_t get_pending_write_size(void) const;
 
 public:
   //!
@@ -238,61 +479,400 @@ public:
   void set_on_disconnection_handler(const disconnection_handler_t& disconnection_handler);
 
 private:
+  //!
+  //! shared with the io service callbacks, so that releasing the last reference to a client is safe from any thread, even right after disconnect(false)
+  //!
+  struct callback_guard {
+    //!
+    //! set while a callback executes code of the client (never user callbacks), and for good once the client is destroyed
+    //! a callback finding it set does nothing: the client is being destroyed, or the callback was queued by the io_service the client has just migrated from (the event is reported again)
+    //!
+    std::atomic<bool> busy;
+    //!
+    //! guarded client
+    //!
+    tcp_client* client;
+  };
+
+  //!
+  //! execution of the client code of a callback: the guard is held until leave() is called (or the scope destroyed)
+  //! user callbacks are called once left: the destructor never waits for them, and they may release any client
+  //!
+  class callback_scope {
+  public:
+    //! ctor: try to take the guard
+    explicit callback_scope(callback_guard& guard);
+    //! dtor: leave if not done yet
+    ~callback_scope(void);
+
+    //! copy ctor & assignment operator
+    callback_scope(const callback_scope&) = delete;
+    callback_scope& operator=(const callback_scope&) = delete;
+
+  public:
+    //!
+    //! \return whether the guard was taken: the client can be used until leave() is called
+    //!
+    bool entered(void) const;
+
+    //!
+    //! stop using the client: it may be destroyed from now on
+    //!
+    void leave(void);
+
+  private:
+    //!
+    //! guard taken, null if not taken or already left
+    //!
+    callback_guard* m_guard;
+  };
+
   //!
   //! io service read callback
   //! called by the io service whenever the socket is readable
   //!
   //! \param fd file description of the socket for which the read is available
+  //! \param scope guard of the callback, left before calling user callbacks
   //!
-  void on_read_available(fd_t fd);
+  void on_read_available(fd_t fd, callback_scope& scope);
 
   //!
   //! io service write callback
   //! called by the io service whenever the socket is writable
   //!
   //! \param fd file description of the socket for which the write is available
+  //! \param scope guard of the callback, left before calling user callbacks
+  //!
+  void on_write_available(fd_t fd, callback_scope& scope);
+
+  //!
+  //! io service write callback while connecting
+  //! called by the io service whenever the socket becomes writable after async_connect, completes the connection
+  //!
+  //! \param fd file description of the socket
+  //! \param scope guard of the callback, left before calling user callbacks
+  //!
+  void on_connect_available(fd_t fd, callback_scope& scope);
+
+  //!
+  //! build an io service callback calling the given member function through the callback guard
+  //!
+  //! \param callback member function to be called
+  //! \return io service callback, which does nothing once this instance has been destroyed
+  //!
+  io_service::event_callback_t make_io_callback(void (tcp_client::*callback)(fd_t, callback_scope&));
+
   //!
-  void on_write_available(fd_t fd);
+  //! start an async_connect
+  //!
+  //! \param host Hostname of the target server
+  //! \param port Port of the target server
+  //! \param callback callback to be executed on connection completion
+  //! \param complete_on_disconnect whether the callback is called with false if the connection is cancelled by disconnect
+  //!
+  void start_async_connect(const std::string& host, std::uint32_t port, const async_connect_callback_t& callback, bool complete_on_disconnect);
 
 private:
+  //!
+  //! completion of a request: the callback of a callback-based request, or the promise of a future-returning request
+  //!
+  template <typename T>
+  struct completion {
+    //! ctor: no completion
+    completion(void)
+    : promise(nullptr)
+    , complete_on_disconnect(false) {}
+
+    //! ctor from a callback
+    explicit completion(std::function<void(T&)>&& callback, bool complete_on_disconnect = false)
+    : callback(std::move(callback))
+    , promise(nullptr)
+    , complete_on_disconnect(complete_on_disconnect) {}
+
+    //! ctor from a promise
+    explicit completion(utils::promise<T>&& promise)
+    : promise(std::move(promise))
+    , complete_on_disconnect(false) {}
+
+    //! \return whether there is something to complete
+    explicit operator bool(void) const {
+      return callback || promise.valid();
+    }
+
+    //!
+    //! complete the request
+    //! the result is moved to the future: only its success flag may be checked afterwards
+    //!
+    //! \param result result of the operation
+    //!
+    void
+    operator()(T& result) {
+      if (callback) { callback(result); }
+      else if (promise.valid()) {
+        promise.set_value(std::move(result));
+      }
+    }
+
+    //!
+    //! complete a request dropped by a disconnection: the promise is broken, the callback is called with a failed result only if requested (complete_on_disconnect)
+    //!
+    void
+    fail(void) {
+      T result = {};
+
+      if (callback && complete_on_disconnect) { callback(result); }
+
+      callback = nullptr;
+      promise  = nullptr;
+    }
+
+    //!
+    //! callback to be executed
+    //!
+    std::function<void(T&)> callback;
+
+    //!
+    //! promise to be fulfilled
+    //!
+    utils::promise<T> promise;
+
+    //!
+    //! whether the callback is called when the request is dropped by a disconnection
+    //!
+    bool complete_on_disconnect;
+  };
+
+  //!
+  //! requests dropped by a disconnection, failed once the client is not used anymore
+  //!
+  struct dropped_requests {
+    //!
+    //! callback of the pending async_connect, if issued with complete_on_disconnect
+    //!
+    async_connect_callback_t connect_callback;
+    //!
+    //! completions of the pending read and write requests
+    //!
+    std::vector<completion<read_result>> reads;
+    std::vector<completion<write_result>> writes;
+
+    //!
+    //! complete every request exactly once: the connect callback is called with false, the requests fail
+    //! not called by the destructor: the requests are then dropped without calling any callback
+    //!
+    void fail(void);
+  };
+
+  //!
+  //! disconnect, without completing the dropped requests
+  //! used by the io service callbacks, which complete them once out of the callback guard
+  //!
+  //! \param wait_for_removal whether to wait for the removal of the socket from the io_service
+  //! \param dropped filled with the requests dropped by the disconnection
+  //!
+  void disconnect(bool wait_for_removal, dropped_requests& dropped);
+
   //!
   //! Clear pending read requests (basically empty the queue of read requests)
   //!
-  void clear_read_requests(void);
+  //! \param completions completions of the cleared requests, to be failed by the caller once the locks are released
+  //!
+  void clear_read_requests(std::vector<completion<read_result>>& completions);
 
   //!
   //! Clear pending write requests (basically empty the queue of write requests)
   //!
-  void clear_write_requests(void);
+  //! \param completions completions of the cleared requests, to be failed by the caller once the locks are released
+  //!
+  void clear_write_requests(std::vector<completion<write_result>>& completions);
+
+  //!
+  //! queued read request
+  //!
+  struct pending_read_request {
+    //!
+    //! number of bytes to read
+    //!
+    std::size_t size;
+    //!
+    //! to be completed on read operation completion
+    //!
+    completion<read_result> on_completion;
+  };
+
+  //!
+  //! range of a file being sent, updated as chunks are sent
+  //!
+  struct file_range {
+    //!
+    //! file to send
+    //!
+    int fd;
+    //!
+    //! offset of the next byte to send
+    //!
+    std::uint64_t offset;
+    //!
+    //! number of bytes remaining to send
+    //!
+    std::size_t remaining;
+    //!
+    //! number of bytes sent so far
+    //!
+    std::size_t sent;
+  };
+
+  //!
+  //! queued write request
+  //!
+  struct pending_write_request {
+    //!
+    //! bytes to write
+    //!
+    std::vector<char> buffer;
+    //!
+    //! to be completed on write operation completion
+    //!
+    completion<write_result> on_completion;
+    //!
+    //! file to send instead of the buffer, null for buffered writes
+    //!
+    std::unique_ptr<file_range> file;
+    //!
+    //! shared bytes to write instead of the buffer, null for owned buffers
+    //!
+    shared_buffer shared;
+    //!
+    //! number of bytes of the buffer (or of the shared buffer) written so far
+    //!
+    std::size_t written;
+
+    //!
+    //! \return number of bytes requested to be written, whatever the kind of request
+    //!
+    std::size_t
+    size(void) const {
+      return buffer.size() + shared.size() + (file ? file->remaining + file->sent : 0);
+    }
+  };
+
+  //!
+  //! buffer of a zero-copy write, held until the kernel releases it
+  //! a buffer partially sent is sent again from its first unsent byte: it is released once all its sends (consecutive ids) are
+  //!
+  struct zerocopy_buffer {
+    //!
+    //! id of the first send of the buffer, as reported by the kernel notification
+    //!
+    std::uint32_t first_id;
+    //!
+    //! number of sends of the buffer so far, and number of them released by the kernel
+    //!
+    std::uint32_t nb_sends;
+    std::uint32_t nb_released;
+    //!
+    //! whether the write request still owns the buffer, not entirely sent yet
+    //!
+    bool sending;
+    //!
+    //! bytes sent, empty while sending
+    //!
+    std::vector<char> buffer;
+  };
+
+  //!
+  //! queue a read request and make sure the socket is polled for read
+  //!
+  //! \param request read request
+  //!
+  void push_read_request(pending_read_request&& request);
+
+  //!
+  //! queue a write request and make sure the socket is polled for write
+  //!
+  //! \param request write request
+  //!
+  void push_write_request(pending_write_request&& request);
 
 private:
   //!
   //! process read operations when available
   //! basically called whenever on_read_available is called and try to read from the socket
   //! handle possible case of failure and fill in the result
+  //! socket errors are reported through the result, without exceptions: disconnections are frequent and must stay cheap
   //!
   //! \param result result of the read operation
-  //! \return the callback to be executed (set in the read request) on read completion (may be null)
+  //! \return the completion of the read request (empty if there was nothing to read, the request then stays queued)
   //!
-  async_read_callback_t process_read(read_result& result);
+  completion<read_result> process_read(read_result& result);
+
+  //!
+  //! write request completion: completion to be executed (may be empty) and result of the operation
+  //!
+  typedef std::pair<completion<write_result>, write_result> write_completion_t;
 
   //!
   //! process write operations when available
   //! basically called whenever on_write_available is called and try to write to the socket
-  //! handle possible case of failure and fill in the result
+  //! pending write requests are coalesced and sent in a single gather write, handle possible case of failure and fill in the results
+  //!
+  //! the socket is never waited on: a partially written request stays in front of the queue until entirely written
+  //! if nothing could be sent without blocking, no request completes
+  //! file requests are never gathered: they are processed by process_file_write once they reach the front of the queue
+  //!
+  //! \param completions filled with the completed requests, in order
+  //! \return whether the write operation succeeded or not
+  //!
+  bool process_write(std::vector<write_completion_t>& completions);
+
+  //!
+  //! send the next chunk of the file request at the front of the write queue
+  //! the request stays queued until the whole range has been sent, the end of the file has been reached or the operation failed
+  //! the write requests lock must be held
+  //!
+  //! \param completions filled with the request if it completed
+  //! \return whether the write operation succeeded or not
   //!
-  //! \param result result of the write operation
-  //! \return the callback to be executed (set in the write request) on read completion (may be null)
+  bool process_file_write(std::vector<write_completion_t>& completions);
+
+  //!
+  //! send the buffer of the request at the front of the write queue without copying it, and hold the buffer until the kernel releases it
+  //! the write requests lock must be held
+  //!
+  //! \param completions filled with the request if it completed
+  //! \return whether the write operation succeeded or not
+  //!
+  bool process_zerocopy_write(std::vector<write_completion_t>& completions);
+
   //!
-  async_write_callback_t process_write(write_result& result);
+  //! read the zero-copy notifications of the socket and release the corresponding buffers
+  //! the read requests lock must be held
+  //!
+  //! \return whether at least one notification was read
+  //!
+  bool release_zerocopy_buffers(void);
+
+  //!
+  //! set or unset the read callback in the io service, if not done yet
+  //! the read requests lock must be held
+  //!
+  //! \param polled whether the socket should be polled for read
+  //!
+  void poll_for_read(bool polled);
 
 private:
   //!
   //! store io_service
   //! prevent deletion of io_service before the tcp_client itself
+  //! replaced by set_io_service while holding m_io_service_mtx and the requests locks: code holding one of them can use it directly
   //!
   std::shared_ptr<io_service> m_io_service;
 
+  //!
+  //! io_service thread safety
+  //!
+  mutable std::mutex m_io_service_mtx;
+
   //!
   //! client socket
   //!
@@ -303,14 +883,46 @@ private:
   //!
   std::atomic<bool> m_is_connected = ATOMIC_VAR_INIT(false);
 
+  //!
+  //! priority class of the callbacks
+  //!
+  std::atomic<utils::thread_pool::priority> m_priority = ATOMIC_VAR_INIT(utils::thread_pool::priority::normal);
+
   //!
   //! read requests
   //!
-  std::queue<read_request> m_read_requests;
+  std::deque<pending_read_request> m_read_requests;
   //!
   //! write requests
   //!
-  std::queue<write_request> m_write_requests;
+  std::deque<pending_write_request> m_write_requests;
+
+  //!
+  //! buffers of zero-copy writes not released by the kernel yet, in order of their first send
+  //! released by the read path (notifications make the socket readable) and by the next zero-copy writes, guarded by the read requests mutex
+  //! the socket is polled for read as long as read requests are pending, or buffers are held and notifications keep coming
+  //!
+  std::deque<zerocopy_buffer> m_zerocopy_buffers;
+
+  //!
+  //! whether the read callback is set in the io service, guarded by the read requests mutex
+  //!
+  bool m_polled_for_read;
+
+  //!
+  //! minimum size of zero-copy writes, 0 if disabled
+  //!
+  std::atomic<std::size_t> m_zerocopy_threshold = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! number of bytes of the pending write requests
+  //!
+  std::atomic<std::size_t> m_pending_write_size = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! id of the next zero-copy send, guarded by the write requests mutex
+  //!
+  std::uint32_t m_zerocopy_next_id;
 
   //!
   //! read requests thread safety
@@ -325,6 +937,37 @@ private:
   //! disconnection handler
   //!
   disconnection_handler_t m_disconnection_handler;
+
+  //!
+  //! guard of the io service callbacks
+  //!
+  std::shared_ptr<callback_guard> m_callback_guard;
+
+  //!
+  //! io service callbacks, built once: the socket is polled for read (resp. write) only while read (resp. write) requests are pending
+  //!
+  std::shared_ptr<io_service::event_callback_t> m_rd_callback;
+  std::shared_ptr<io_service::event_callback_t> m_wr_callback;
+
+  //!
+  //! whether an async_connect is pending
+  //!
+  bool m_is_connecting;
+
+  //!
+  //! callback of the pending async_connect
+  //!
+  async_connect_callback_t m_connect_callback;
+
+  //!
+  //! whether the pending async_connect was issued with complete_on_disconnect
+  //!
+  bool m_connect_complete_on_disconnect;
+
+  //!
+  //! async_connect completion thread safety
+  //!
+  std::mutex m_connect_mtx;
 };
 
 } // namespace tacopie
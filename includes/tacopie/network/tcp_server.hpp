@@ -23,19 +23,31 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
-#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <tacopie/network/io_service.hpp>
 #include <tacopie/network/tcp_client.hpp>
 #include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/utils/atomic_shared_ptr.hpp>
 #include <tacopie/utils/typedefs.hpp>
 
 #define __TACOPIE_CONNECTION_QUEUE_SIZE 1024
 
+#ifndef __TACOPIE_HAND_OVER_TIMEOUT_MSECS
+#define __TACOPIE_HAND_OVER_TIMEOUT_MSECS 30000
+#endif /* __TACOPIE_HAND_OVER_TIMEOUT_MSECS */
+
+#ifndef __TACOPIE_DRAIN_READ_SIZE
+#define __TACOPIE_DRAIN_READ_SIZE 4096
+#endif /* __TACOPIE_DRAIN_READ_SIZE */
+
 namespace tacopie {
 
 //!
@@ -49,6 +61,14 @@ public:
   //! dtor
   ~tcp_server(void);
 
+  //!
+  //! custom ctor
+  //! build a server monitored by the given io_service instead of the default one, the accepted clients are monitored by the same io_service
+  //!
+  //! \param io_service io_service monitoring the server and its clients
+  //!
+  explicit tcp_server(const std::shared_ptr<tacopie::io_service>& io_service);
+
   //! copy ctor
   tcp_server(const tcp_server&) = delete;
   //! assignment operator
@@ -87,6 +107,31 @@ public:
   //!
   void start(const std::string& host, std::uint32_t port, const on_new_connection_callback_t& callback = nullptr);
 
+  //!
+  //! Start the tcp_server on the server socket of another process, handed over with hand_over, instead of binding a new one.
+  //! Connect to the unix domain socket at the given path and block until the server socket is received.
+  //! Not supported on windows.
+  //!
+  //! \param path path of the unix domain socket the other process hands its server socket over on
+  //! \param callback callback to be called on new connections (may be null, connections are then handled automatically by the tcp_server object)
+  //!
+  void take_over(const std::string& path, const on_new_connection_callback_t& callback = nullptr);
+
+  //!
+  //! Hand the server socket over to another process calling take_over, for restarts without downtime.
+  //! Listen on a unix domain socket at the given path, wait for a single process to connect and pass it the server socket (SCM_RIGHTS). The path is removed afterwards.
+  //!
+  //! The server socket is shared and never closed in between: connections keep queuing in its backlog, and are accepted by either process until this tcp_server stops accepting with drain() or stop().
+  //! Once a process connected, the server socket is switched to non-blocking mode in both processes, so that the process losing the race for a new connection does not block in accept(). Its mode is restored if the hand over fails.
+  //!
+  //! Blocks the calling thread until the server socket has been handed over or the timeout expired: must not be called from an io_service callback.
+  //! The tcp_server must be running, and keeps running if the hand over fails. Not supported on windows.
+  //!
+  //! \param path path of the unix domain socket to listen on, replaced if it already exists
+  //! \param timeout_msecs maximum time to wait for a process to connect, 0 waits indefinitely
+  //!
+  void hand_over(const std::string& path, std::uint32_t timeout_msecs = __TACOPIE_HAND_OVER_TIMEOUT_MSECS);
+
   //!
   //! Disconnect the tcp_server if it was currently running.
   //!
@@ -95,6 +140,50 @@ public:
   //!
   void stop(bool wait_for_removal = false, bool recursive_wait_for_removal = true);
 
+  //!
+  //! progress of a drain
+  //!
+  struct drain_progress {
+    //!
+    //! clients being drained
+    //!
+    std::size_t nb_clients;
+    //!
+    //! clients whose pending writes have been flushed, then half-closed (or which disconnected meanwhile)
+    //!
+    std::size_t nb_flushed;
+    //!
+    //! clients disconnected: closed by the peer after being flushed, disconnected meanwhile, or still open at the deadline
+    //! the drain is complete once all clients are closed
+    //!
+    std::size_t nb_closed;
+    //!
+    //! bytes still queued for writing to the clients not flushed yet
+    //!
+    std::size_t nb_pending_write_bytes;
+  };
+
+  //!
+  //! called from the io_service workers whenever a client is flushed or closed, the last call reporting the completion of the drain (nb_closed == nb_clients)
+  //! calls are never concurrent
+  //!
+  typedef std::function<void(const drain_progress&)> drain_progress_handler_t;
+
+  //!
+  //! Gracefully stop the tcp_server, for shutdowns and deploys.
+  //! Stop accepting new connections and let each client handled by the tcp_server flush its pending writes, then half-close it and discard its incoming data until the peer closes the connection.
+  //! Closing only once the peer did lets it read everything sent: closing with unread incoming data would reset the connection instead.
+  //! Clients still open at the deadline are disconnected anyway, dropping their pending writes (nb_clients - nb_flushed clients in the final progress).
+  //! Clients handed over to the new connection callback are left untouched.
+  //!
+  //! Returns once the server stopped accepting: the drain is then driven by the io_service and reported through the progress handler. Calling stop() meanwhile disconnects the remaining clients right away.
+  //! Must not be called from the new connection callback.
+  //!
+  //! \param timeout_msecs maximum time given to the clients to flush their pending writes and to their peers to close the connections
+  //! \param progress_handler progress handler (may be null)
+  //!
+  void drain(std::uint32_t timeout_msecs, const drain_progress_handler_t& progress_handler = nullptr);
+
   //!
   //! \return whether the server is currently running or not
   ///!
@@ -111,6 +200,20 @@ public:
   //!
   const tcp_socket& get_socket(void) const;
 
+public:
+  //!
+  //! Set the socket options applied to every accepted client, before it is passed to the new connection callback and before its first read.
+  //! Failing to apply an option is logged and does not reject the client.
+  //!
+  //! \param opts options template, negative values leave the corresponding option unchanged
+  //!
+  void set_client_options(const tcp_socket::options& opts);
+
+  //!
+  //! \return the socket options applied to every accepted client
+  //!
+  tcp_socket::options get_client_options(void) const;
+
 public:
   //!
   //! \return io service monitoring this tcp connection
@@ -119,11 +222,144 @@ public:
 
 public:
   //!
-  //! \return the list of tacopie::tcp_client connected to the server.
+  //! limits applied to incoming connections, 0 means unlimited
+  //!
+  struct admission_options {
+    //!
+    //! maximum number of concurrent connections, handled by the tcp_server or not
+    //! a connection counts until its tcp_client is released
+    //!
+    std::size_t max_connections = 0;
+    //!
+    //! maximum number of concurrent connections from a same remote host
+    //!
+    std::size_t max_connections_per_host = 0;
+    //!
+    //! sustained accept rate, in connections per second (token bucket)
+    //!
+    std::uint32_t accept_rate = 0;
+    //!
+    //! maximum number of connections accepted at once above the sustained rate (bucket size), accept_rate if 0
+    //!
+    std::uint32_t accept_burst = 0;
+  };
+
+  //!
+  //! number of rejected connections, by reason
+  //!
+  struct admission_stats {
+    std::size_t nb_rejected_max_connections;
+    std::size_t nb_rejected_max_connections_per_host;
+    std::size_t nb_rejected_accept_rate;
+    //!
+    //! connections dropped because the process ran out of file descriptors (EMFILE, ENFILE)
+    //!
+    std::size_t nb_rejected_fd_exhaustion;
+  };
+
+  //!
+  //! Set the limits applied to incoming connections.
+  //! Connections over a limit are accepted and immediately closed, so that they do not fill the listen backlog. They never reach the new connection callback.
+  //!
+  //! \param opts admission limits
+  //!
+  void set_admission_options(const admission_options& opts);
+
+  //!
+  //! \return the limits applied to incoming connections
+  //!
+  admission_options get_admission_options(void) const;
+
+  //!
+  //! \return the number of connections rejected since the server was created, by reason
+  //!
+  admission_stats get_admission_stats(void) const;
+
+  //!
+  //! \return the number of accepted connections whose tcp_client has not been released yet, handled by the tcp_server or not
+  //!
+  std::size_t get_nb_connections(void) const;
+
+public:
+  //!
+  //! immutable list of clients, safe to iterate without any lock
+  //! it shares the ownership of the list: the value returned by get_clients() can be iterated directly
   //!
-  const std::list<std::shared_ptr<tacopie::tcp_client>>& get_clients(void) const;
+  class clients_snapshot {
+  public:
+    typedef std::vector<std::shared_ptr<tacopie::tcp_client>> clients_t;
+    typedef clients_t::const_iterator const_iterator;
+
+    //! ctor
+    explicit clients_snapshot(const std::shared_ptr<const clients_t>& clients)
+    : m_clients(clients) {}
+
+    const_iterator
+    begin(void) const {
+      return m_clients->begin();
+    }
+
+    const_iterator
+    end(void) const {
+      return m_clients->end();
+    }
+
+    std::size_t
+    size(void) const {
+      return m_clients->size();
+    }
+
+    bool
+    empty(void) const {
+      return m_clients->empty();
+    }
+
+  private:
+    std::shared_ptr<const clients_t> m_clients;
+  };
+
+  //!
+  //! Snapshot of the tacopie::tcp_client connected to the server and handled by it (whose new connection callback returned false).
+  //! A connection or disconnection only drops the current snapshot: it is rebuilt by the first call following a change, then shared until the next one.
+  //! Getting an up-to-date snapshot never takes a lock nor copies the list.
+  //!
+  //! \return the tacopie::tcp_client connected to the server.
+  //!
+  clients_snapshot get_clients(void) const;
+
+  //!
+  //! \return the number of tacopie::tcp_client connected to the server and handled by it.
+  //!
+  std::size_t get_nb_clients(void) const;
 
 private:
+  //!
+  //! start accepting new connections on the listening server socket: track it in the io service
+  //!
+  //! \param callback callback to be called on new connections
+  //!
+  void start_accepting(const on_new_connection_callback_t& callback);
+
+  //!
+  //! stop accepting new connections: remove the server socket from the io service and close it
+  //!
+  //! \param wait_for_removal whether to wait for the server socket callbacks to complete
+  //! \return false if the server was not running
+  //!
+  bool stop_accepting(bool wait_for_removal);
+
+  //!
+  //! \return the clients handled by the server, which no longer tracks them
+  //!
+  std::unordered_set<std::shared_ptr<tacopie::tcp_client>> take_clients(void);
+
+  //!
+  //! drop the snapshot returned by get_clients, in O(1): it is rebuilt on the next get_clients call
+  //! dropping it releases the references it holds to disconnected clients
+  //! must be called with m_clients_mtx held, after each change of m_clients
+  //!
+  void invalidate_clients_snapshot(void);
+
   //!
   //! io service read callback
   //!
@@ -131,6 +367,29 @@ private:
   //!
   void on_read_available(fd_t fd);
 
+  //!
+  //! handle an accept() failure: connection aborted, file descriptors exhaustion or unrecoverable error (stops the server)
+  //!
+  //! \param error system error code
+  //!
+  void on_accept_failure(int error);
+
+  //!
+  //! check the admission limits for a new connection and account for it if admitted
+  //!
+  //! \param host remote host of the new connection
+  //! \return whether the connection is admitted
+  //!
+  bool admit(const std::string& host);
+
+  //!
+  //! build a tcp_client for an admitted connection, which releases its admission slot on destruction
+  //!
+  //! \param socket accepted socket
+  //! \return client
+  //!
+  std::shared_ptr<tcp_client> make_client(tcp_socket&& socket);
+
   //!
   //! client disconnected
   //! called whenever a client disconnected from the tcp_server
@@ -139,6 +398,72 @@ private:
   //!
   void on_client_disconnected(const std::shared_ptr<tcp_client>& client);
 
+private:
+  //!
+  //! state of a drain, shared with the callbacks of the drained clients and the deadline: the drain may outlive the tcp_server
+  //!
+  struct drain_state {
+    std::mutex mtx;
+    //!
+    //! clients not closed yet, and whether they have been flushed
+    //!
+    std::unordered_map<std::shared_ptr<tcp_client>, bool> clients;
+    drain_progress progress;
+    //!
+    //! progress handler, called with report_mtx held
+    //!
+    std::mutex report_mtx;
+    drain_progress_handler_t progress_handler;
+    bool is_complete_reported;
+  };
+
+  //!
+  //! queue an empty write behind the pending writes of a drained client: it completes once they are all flushed
+  //!
+  //! \param drain drain state
+  //! \param client drained client
+  //!
+  static void flush_drained_client(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client);
+
+  //!
+  //! pending writes of a drained client flushed (or failed): half-close it and wait for the peer to close
+  //!
+  //! \param drain drain state
+  //! \param client drained client
+  //! \param success whether the pending writes have been flushed or the client disconnected
+  //!
+  static void on_drained_client_flushed(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client, bool success);
+
+  //!
+  //! read and discard the incoming data of a half-closed client until the peer closes the connection
+  //!
+  //! \param drain drain state
+  //! \param client drained client
+  //!
+  static void discard_until_eof(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client);
+
+  //!
+  //! disconnect a drained client, if not closed yet
+  //!
+  //! \param drain drain state
+  //! \param client drained client
+  //!
+  static void close_drained_client(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client);
+
+  //!
+  //! deadline of a drain, or stop() called meanwhile: disconnect the clients not closed yet
+  //!
+  //! \param drain drain state
+  //!
+  static void end_drain(const std::shared_ptr<drain_state>& drain);
+
+  //!
+  //! call the progress handler of a drain, until it has reported the completion
+  //!
+  //! \param drain drain state
+  //!
+  static void report_drain_progress(const std::shared_ptr<drain_state>& drain);
+
 private:
   //!
   //! store io_service
@@ -157,19 +482,70 @@ private:
   std::atomic<bool> m_is_running = ATOMIC_VAR_INIT(false);
 
   //!
-  //! clients
+  //! clients: O(1) insertion and removal
   //!
-  std::list<std::shared_ptr<tacopie::tcp_client>> m_clients;
+  std::unordered_set<std::shared_ptr<tacopie::tcp_client>> m_clients;
+
+  //!
+  //! snapshot of m_clients, null once m_clients changed and until get_clients rebuilds it (both with m_clients_mtx held)
+  //!
+  mutable utils::atomic_shared_ptr<const clients_snapshot::clients_t> m_clients_snapshot;
 
   //!
   //! clients thread safety
   //!
-  std::mutex m_clients_mtx;
+  mutable std::mutex m_clients_mtx;
+
+  //!
+  //! last drain started, ended by stop() if still in progress (guarded by m_clients_mtx)
+  //!
+  std::shared_ptr<drain_state> m_drain;
 
   //!
   //! on new connection callback
   //!
   on_new_connection_callback_t m_on_new_connection_callback;
+
+  //!
+  //! socket options applied to accepted clients
+  //!
+  tcp_socket::options m_client_options;
+
+  //!
+  //! client options thread safety
+  //!
+  mutable std::mutex m_client_options_mtx;
+
+  //!
+  //! admission control state
+  //! shared with the accepted clients, which release their slot on destruction and may outlive the server
+  //!
+  struct admission_state {
+    std::mutex mtx;
+    admission_options options;
+    admission_stats stats = {0, 0, 0, 0};
+
+    //!
+    //! token bucket
+    //!
+    double tokens = 0;
+    std::chrono::steady_clock::time_point last_refill;
+
+    //!
+    //! live connections
+    //!
+    std::size_t nb_connections = 0;
+    std::unordered_map<std::string, std::size_t> nb_connections_per_host;
+  };
+
+  std::shared_ptr<admission_state> m_admission;
+
+#ifndef _WIN32
+  //!
+  //! file descriptor kept open while the server is running: released when accept() fails with EMFILE/ENFILE to accept and close the pending connection, so that the server keeps running
+  //!
+  fd_t m_reserve_fd = __TACOPIE_INVALID_FD;
+#endif /* _WIN32 */
 };
 
 } // namespace tacopie
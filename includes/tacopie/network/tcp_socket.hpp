@@ -22,12 +22,22 @@
 
 #pragma once
 
+#include <cerrno>
 #include <cstdint>
+#include <new>
 #include <string>
 #include <vector>
 
 #include <tacopie/utils/typedefs.hpp>
 
+#ifndef __TACOPIE_MAX_IOVEC
+#define __TACOPIE_MAX_IOVEC 64
+#endif /* __TACOPIE_MAX_IOVEC */
+
+#ifndef __TACOPIE_SENDFILE_COPY_BUFFER_SIZE
+#define __TACOPIE_SENDFILE_COPY_BUFFER_SIZE 65536
+#endif /* __TACOPIE_SENDFILE_COPY_BUFFER_SIZE */
+
 namespace tacopie {
 
 //!
@@ -49,6 +59,137 @@ public:
     UNKNOWN
   };
 
+  //!
+  //! directions of the connection to be shut down
+  //!
+  enum class shutdown_type {
+    READ,
+    WRITE,
+    BOTH
+  };
+
+public:
+  //!
+  //! contiguous range of bytes, used for vectored operations
+  //!
+  struct const_buffer {
+    //!
+    //! first byte of the range
+    //!
+    const char* data;
+    //!
+    //! number of bytes
+    //!
+    std::size_t size;
+  };
+
+  //!
+  //! result of a non-throwing read or write operation
+  //!
+  struct io_result {
+    //!
+    //! number of bytes transferred
+    //!
+    std::size_t size;
+    //!
+    //! system error code (errno, WSAGetLastError() on windows), 0 if no error occurred
+    //!
+    int error;
+    //!
+    //! whether the connection has been closed by the remote host (read operations only)
+    //!
+    bool eof;
+
+    //!
+    //! \return whether the operation succeeded
+    //!
+    bool
+    success(void) const {
+      return error == 0 && !eof;
+    }
+
+    //!
+    //! \return whether the operation failed temporarily (interrupted, or nothing could be transferred without blocking) and should be retried
+    //!
+    bool
+    would_block(void) const {
+#ifdef _WIN32
+      return error == WSAEWOULDBLOCK || error == WSAEINTR;
+#else
+      return error == EAGAIN || error == EWOULDBLOCK || error == EINTR;
+#endif /* _WIN32 */
+    }
+  };
+
+  //!
+  //! range of zero-copy sends released by the kernel (see send_zerocopy)
+  //!
+  struct zerocopy_completion {
+    //!
+    //! id of the first released send
+    //!
+    std::uint32_t first;
+    //!
+    //! id of the last released send (included)
+    //!
+    std::uint32_t last;
+    //!
+    //! whether the kernel had to copy the data anyway (loopback, unsupported device...)
+    //!
+    bool copied;
+  };
+
+  //!
+  //! set of socket options applied at once by set_options
+  //! negative values leave the corresponding option unchanged
+  //!
+  struct options {
+    //!
+    //! TCP_NODELAY: 1 disables Nagle's algorithm, 0 enables it
+    //!
+    int nodelay = -1;
+    //!
+    //! SO_SNDBUF: size of the kernel send buffer, in bytes
+    //!
+    int send_buffer_size = -1;
+    //!
+    //! SO_RCVBUF: size of the kernel receive buffer, in bytes
+    //!
+    int receive_buffer_size = -1;
+    //!
+    //! SO_KEEPALIVE: 1 enables keepalive probes, 0 disables them
+    //!
+    int keepalive = -1;
+    //!
+    //! TCP_KEEPIDLE: idle time before the first keepalive probe, in seconds
+    //!
+    int keepalive_idle_secs = -1;
+    //!
+    //! TCP_KEEPINTVL: interval between keepalive probes, in seconds
+    //!
+    int keepalive_interval_secs = -1;
+    //!
+    //! TCP_KEEPCNT: number of unanswered keepalive probes before the connection is dropped
+    //!
+    int keepalive_count = -1;
+    //!
+    //! TCP_QUICKACK: 1 sends acks immediately instead of delaying them, 0 delays them
+    //!
+    int quickack = -1;
+    //!
+    //! TCP_NOTSENT_LOWAT: amount of unsent bytes in the send buffer below which the socket is reported writable
+    //!
+    int notsent_lowat = -1;
+    //!
+    //! TCP_USER_TIMEOUT: maximum time transmitted data may remain unacknowledged before the connection is dropped, in milliseconds
+    //!
+    int user_timeout_msecs = -1;
+    //!
+    //! SO_BUSY_POLL: time to busy poll the device queue on blocking receive, in microseconds
+    //!
+    int busy_poll_usecs = -1;
+  };
+
 public:
   //! ctor
   tcp_socket(void);
@@ -67,6 +208,8 @@ public:
 
   //! move ctor
   tcp_socket(tcp_socket&&);
+  //! move assignment operator, the descriptor previously held is not closed (as on destruction)
+  tcp_socket& operator=(tcp_socket&&);
 
   //! copy ctor
   tcp_socket(const tcp_socket&) = delete;
@@ -98,6 +241,17 @@ public:
   //!
   std::vector<char> recv(std::size_t size_to_read);
 
+  //!
+  //! Read data synchronously from the underlying socket, without throwing on failure nor on connection closed by the remote host.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param buffer Buffer receiving the read bytes, at least size_to_read bytes long
+  //! \param size_to_read Number of bytes to read (might read less than requested)
+  //! \param non_blocking fail with a would-block error instead of waiting when nothing can be read (ignored on platforms without MSG_DONTWAIT)
+  //! \return Returns the number of bytes read, the error code and whether the connection has been closed
+  //!
+  io_result recv(char* buffer, std::size_t size_to_read, std::nothrow_t, bool non_blocking = false);
+
   //!
   //! Send data synchronously to the underlying socket.
   //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
@@ -108,6 +262,108 @@ public:
   //!
   std::size_t send(const std::vector<char>& data, std::size_t size_to_write);
 
+  //!
+  //! Send data synchronously to the underlying socket, without throwing on failure.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param data Buffer containing bytes to be written
+  //! \param size_to_write Number of bytes to send
+  //! \return Returns the number of bytes that were effectively sent and the error code
+  //!
+  io_result send(const char* data, std::size_t size_to_write, std::nothrow_t);
+
+  //!
+  //! Send several buffers synchronously to the underlying socket, in a single system call (gather write).
+  //! At most __TACOPIE_MAX_IOVEC buffers are sent, remaining buffers are ignored.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param buffers Buffers to be written, in order
+  //! \param nb_buffers Number of buffers
+  //! \return Returns the total number of bytes that were effectively sent (might be less than requested).
+  //!
+  std::size_t sendv(const const_buffer* buffers, std::size_t nb_buffers);
+
+  //!
+  //! Send several buffers synchronously to the underlying socket, in a single system call (gather write), without throwing on failure.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param buffers Buffers to be written, in order
+  //! \param nb_buffers Number of buffers
+  //! \param non_blocking fail with a would-block error, or send less than requested, instead of waiting for space in the send buffer (ignored on platforms without MSG_DONTWAIT)
+  //! \return Returns the total number of bytes that were effectively sent and the error code
+  //!
+  io_result sendv(const const_buffer* buffers, std::size_t nb_buffers, std::nothrow_t, bool non_blocking = false);
+
+  //!
+  //! Send data synchronously to the underlying socket without copying it to the kernel (MSG_ZEROCOPY, linux only), without throwing on failure.
+  //! Zero-copy must have been enabled on the socket with set_zerocopy.
+  //! The data must stay valid and unmodified until the kernel releases it: each successful call gets an id (0 for the first call, then incremented by one), reported by recv_zerocopy_completion once released.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param data Buffer containing bytes to be written
+  //! \param size_to_write Number of bytes to send
+  //! \param non_blocking fail with a would-block error, or send less than requested, instead of waiting for space in the send buffer
+  //! \return Returns the number of bytes that were effectively sent and the error code
+  //!
+  io_result send_zerocopy(const char* data, std::size_t size_to_write, std::nothrow_t, bool non_blocking = false);
+
+  //!
+  //! Read the next zero-copy completion notification from the socket error queue, without blocking nor throwing.
+  //! Pending notifications make the socket readable.
+  //!
+  //! \param completion filled with the range of released sends
+  //! \return Returns a size of 1 if a notification was read, 0 if an unrelated error queue message was consumed, a would-block error if there was none
+  //!
+  io_result recv_zerocopy_completion(zerocopy_completion& completion, std::nothrow_t);
+
+  //!
+  //! Send a range of a file synchronously to the underlying socket.
+  //! On linux, bytes are moved by the kernel without being copied to user space: sendfile is used, or splice through a pipe for files sendfile does not support.
+  //! Other platforms (and files supported by neither) read the file by chunks of __TACOPIE_SENDFILE_COPY_BUFFER_SIZE bytes and send them.
+  //! The file position is left unchanged, except on windows.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param file_fd File descriptor of the file to be sent
+  //! \param offset Offset of the first byte to send in the file
+  //! \param size Number of bytes to send
+  //! \return Returns the number of bytes that were effectively sent (might be less than requested, 0 once the end of the file is reached).
+  //!
+  std::size_t sendfile(int file_fd, std::uint64_t offset, std::size_t size);
+
+  //!
+  //! Send a range of a file synchronously to the underlying socket, without throwing on failure.
+  //! Same as sendfile(int, std::uint64_t, std::size_t) otherwise.
+  //! In non-blocking mode, the bytes moved to the splice pipe but not accepted by the socket stay in the pipe: they are sent first by the next call for the same file and offset, and dropped otherwise.
+  //!
+  //! \param file_fd File descriptor of the file to be sent
+  //! \param offset Offset of the first byte to send in the file
+  //! \param size Number of bytes to send
+  //! \param non_blocking fail with a would-block error, or send less than requested, instead of waiting for space in the send buffer (ignored on windows)
+  //! \return Returns the number of bytes that were effectively sent and the error code
+  //!
+  io_result sendfile(int file_fd, std::uint64_t offset, std::size_t size, std::nothrow_t, bool non_blocking = false);
+
+  //!
+  //! Pass a socket to the process connected to the other end of this unix domain socket (SCM_RIGHTS), along with its host, port and type.
+  //! The passed socket is duplicated into the peer process: both processes share it until one of them closes its own descriptor.
+  //! Its host must not exceed NI_MAXHOST bytes.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //! Not supported on windows.
+  //!
+  //! \param socket socket to be passed, still owned by the caller
+  //!
+  void send_socket(const tcp_socket& socket);
+
+  //!
+  //! Receive a socket passed by the process connected to the other end of this unix domain socket with send_socket.
+  //! Blocks until the socket is received. A description with an unknown type or a host longer than NI_MAXHOST bytes is rejected (and the received descriptor closed).
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //! Not supported on windows.
+  //!
+  //! \return Returns the received socket, with the host, port and type it had in the sending process
+  //!
+  tcp_socket recv_socket(void);
+
   //!
   //! Connect the socket to the remote server.
   //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
@@ -118,6 +374,22 @@ public:
   //!
   void connect(const std::string& host, std::uint32_t port, std::uint32_t timeout_msecs = 0);
 
+  //!
+  //! Initiate a non-blocking connection to the remote server.
+  //! The connection completes when the socket becomes writable, finish_connect must then be called to check its status.
+  //! The socket must be of type client to process this operation. If the type of the socket is unknown, the socket type will be set to client.
+  //!
+  //! \param host Hostname of the target server
+  //! \param port Port of the target server
+  //!
+  void connect_async(const std::string& host, std::uint32_t port);
+
+  //!
+  //! Complete a connection initiated by connect_async, once the socket is writable: check the connection status and set the socket back to blocking mode.
+  //! Throws if the connection failed, the socket is left open so that the caller can stop tracking it before closing it.
+  //!
+  void finish_connect(void);
+
   //!
   //! Binds the socket to the given host and port.
   //! The socket must be of type server to process this operation. If the type of the socket is unknown, the socket type will be set to server.
@@ -143,11 +415,106 @@ public:
   //!
   tcp_socket accept(void);
 
+  //!
+  //! Accept a new incoming connection, without throwing on failure.
+  //!
+  //! \param error set to the system error code (errno, WSAGetLastError() on windows) on failure, to 0 on success
+  //! \return Return the tcp_socket associated to the newly accepted connection, an invalid socket on failure.
+  //!
+  tcp_socket accept(std::nothrow_t, int& error);
+
   //!
   //! Close the underlying socket.
   //!
   void close(void);
 
+  //!
+  //! Shut down one or both directions of the connection, without closing the socket.
+  //! Shutting down WRITE half-closes the connection: the peer receives the data already sent, then end of file, and can still send data.
+  //! Shutting down BOTH also wakes up a thread blocked sending or receiving on the socket.
+  //!
+  //! \param how directions to be shut down
+  //!
+  void shutdown(shutdown_type how);
+
+public:
+  //!
+  //! Enable or disable Nagle's algorithm (TCP_NODELAY).
+  //! All the socket option setters require the socket to be created (connected, listening or accepted) and throw on failure, including when the option is not supported by the platform.
+  //!
+  //! \param enabled true to send small segments immediately (disable Nagle's algorithm)
+  //!
+  void set_nodelay(bool enabled);
+
+  //!
+  //! Set the size of the kernel send buffer (SO_SNDBUF).
+  //!
+  //! \param size buffer size, in bytes
+  //!
+  void set_send_buffer_size(std::size_t size);
+
+  //!
+  //! Set the size of the kernel receive buffer (SO_RCVBUF).
+  //!
+  //! \param size buffer size, in bytes
+  //!
+  void set_receive_buffer_size(std::size_t size);
+
+  //!
+  //! Enable or disable keepalive probes (SO_KEEPALIVE) and set their timings.
+  //!
+  //! \param enabled whether keepalive probes are sent on idle connections
+  //! \param idle_secs idle time before the first probe (TCP_KEEPIDLE), 0 keeps the system default
+  //! \param interval_secs interval between probes (TCP_KEEPINTVL), 0 keeps the system default
+  //! \param count number of unanswered probes before the connection is dropped (TCP_KEEPCNT), 0 keeps the system default
+  //!
+  void set_keepalive(bool enabled, std::uint32_t idle_secs = 0, std::uint32_t interval_secs = 0, std::uint32_t count = 0);
+
+  //!
+  //! Enable or disable quick acks (TCP_QUICKACK, linux only).
+  //! The kernel may switch back to delayed acks by itself, so this is usually set again after each read.
+  //!
+  //! \param enabled true to send acks immediately
+  //!
+  void set_quickack(bool enabled);
+
+  //!
+  //! Limit the amount of unsent data in the send buffer (TCP_NOTSENT_LOWAT): the socket is only reported writable below this threshold.
+  //!
+  //! \param size threshold, in bytes
+  //!
+  void set_notsent_lowat(std::size_t size);
+
+  //!
+  //! Set the maximum time transmitted data may remain unacknowledged before the connection is dropped (TCP_USER_TIMEOUT, linux only).
+  //!
+  //! \param timeout_msecs timeout in milliseconds, 0 keeps the system default
+  //!
+  void set_user_timeout(std::uint32_t timeout_msecs);
+
+  //!
+  //! Set the time to busy poll the device queue on blocking receive (SO_BUSY_POLL, linux only).
+  //!
+  //! \param usecs busy poll duration in microseconds, 0 disables busy polling
+  //!
+  void set_busy_poll(std::uint32_t usecs);
+
+  //!
+  //! Enable or disable zero-copy sends (SO_ZEROCOPY, linux only), required by send_zerocopy.
+  //!
+  //! \param enabled whether send_zerocopy may be used on this socket
+  //!
+  void set_zerocopy(bool enabled);
+
+  //!
+  //! Apply a set of socket options, leaving unset (negative) options unchanged.
+  //! Each option is applied independently: the failure of one option (unsupported by the platform for instance) is logged and the next options are still applied.
+  //! Throws once all the options have been tried if any of them failed, the error message lists the options that could not be applied.
+  //!
+  //! \param opts options to be applied
+  //!
+  void set_options(const options& opts);
+
 public:
   //!
   //! \return the hostname associated with the underlying socket.
@@ -186,6 +553,16 @@ public:
   bool is_ipv6(void) const;
 
 private:
+  //!
+  //! resolve the remote address and call connect
+  //! in non-blocking mode, the connection may still be in progress when this function returns
+  //!
+  //! \param host Hostname of the target server
+  //! \param port Port of the target server
+  //! \param non_blocking whether the socket is set to non-blocking mode (otherwise, it is set to blocking mode)
+  //!
+  void start_connect(const std::string& host, std::uint32_t port, bool non_blocking);
+
   //!
   //! create a new socket if no socket has been initialized yet
   //!
@@ -199,7 +576,34 @@ private:
   //!
   void check_or_set_type(type t);
 
+  //!
+  //! close the splice pipe of sendfile, dropping the bytes it still holds (linux only)
+  //!
+  void close_splice_pipe(void);
+
 private:
+  //!
+  //! pipe used by sendfile to splice files that sendfile(2) does not support, kept open between calls
+  //!
+  struct splice_pipe {
+    //!
+    //! read and write ends of the pipe, -1 when not created yet
+    //!
+    int read_fd;
+    int write_fd;
+
+    //!
+    //! file the bytes still held in the pipe come from, and offset of the first of them in that file
+    //!
+    int file_fd;
+    std::uint64_t offset;
+
+    //!
+    //! number of bytes held in the pipe, not sent yet
+    //!
+    std::size_t size;
+  };
+
   //!
   //! fd associated to the socket
   //!
@@ -218,6 +622,11 @@ private:
   //! type of the socket
   //!
   type m_type;
+
+  //!
+  //! splice pipe of sendfile
+  //!
+  splice_pipe m_splice_pipe;
 };
 
 } // namespace tacopie
@@ -0,0 +1,312 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <tacopie/network/shared_buffer.hpp>
+#include <tacopie/network/tcp_server.hpp>
+
+#ifndef __TACOPIE_PUBSUB_READ_SIZE
+#define __TACOPIE_PUBSUB_READ_SIZE 1024
+#endif /* __TACOPIE_PUBSUB_READ_SIZE */
+
+#ifndef __TACOPIE_PUBSUB_MAX_COMMAND_SIZE
+#define __TACOPIE_PUBSUB_MAX_COMMAND_SIZE 1024
+#endif /* __TACOPIE_PUBSUB_MAX_COMMAND_SIZE */
+
+#ifndef __TACOPIE_PUBSUB_MAX_PENDING_BYTES
+#define __TACOPIE_PUBSUB_MAX_PENDING_BYTES (4 * 1024 * 1024)
+#endif /* __TACOPIE_PUBSUB_MAX_PENDING_BYTES */
+
+namespace tacopie {
+
+namespace pubsub {
+
+//!
+//! topic-based broadcast hub built on top of tcp_server
+//!
+//! subscribers send line-based commands, terminated by \n (a trailing \r is ignored):
+//!  * SUBSCRIBE <topic>
+//!  * UNSUBSCRIBE <topic>
+//!
+//! each published message is encoded once and the same shared buffer is written to all the subscribers of its topic:
+//!  * MESSAGE <topic> <payload size>\r\n<payload>\r\n
+//!
+//! subscribers whose pending writes exceed a limit are slow consumers: they are either evicted (disconnected) or miss messages until they catch up
+//!
+class hub {
+public:
+  //!
+  //! what to do with a subscriber that does not read fast enough
+  //!  * evict: disconnect the subscriber
+  //!  * drop: do not send the message to the subscriber, it keeps its subscriptions
+  //!
+  enum class slow_consumer_policy {
+    evict,
+    drop
+  };
+
+  //!
+  //! called whenever a slow consumer is evicted, after it has been disconnected
+  //!
+  typedef std::function<void(const std::shared_ptr<tcp_client>&)> eviction_handler_t;
+
+public:
+  //! ctor
+  hub(void);
+  //! dtor
+  ~hub(void);
+
+  //!
+  //! custom ctor
+  //! build a hub monitored by the given io_service instead of the default one
+  //!
+  //! \param io_service io_service monitoring the connections
+  //!
+  explicit hub(const std::shared_ptr<tacopie::io_service>& io_service);
+
+  //! copy ctor
+  hub(const hub&) = delete;
+  //! assignment operator
+  hub& operator=(const hub&) = delete;
+
+public:
+  //!
+  //! Start accepting subscribers at the given host and port.
+  //!
+  //! \param host hostname to be connected to
+  //! \param port port to be connected to
+  //!
+  void start(const std::string& host, std::uint32_t port);
+
+  //!
+  //! Stop the hub if it was currently running and disconnect all the subscribers.
+  //!
+  //! \param wait_for_removal When sets to true, stop blocks until the underlying TCP server has been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //! \param recursive_wait_for_removal When sets to true and wait_for_removal is also set to true, blocks until all the subscribers have been effectively removed from the io_service and that all the underlying callbacks have completed.
+  //!
+  void stop(bool wait_for_removal = false, bool recursive_wait_for_removal = true);
+
+  //!
+  //! \return whether the hub is currently running or not
+  //!
+  bool is_running(void) const;
+
+public:
+  //!
+  //! Publish a message to all the subscribers of a topic.
+  //! The message is encoded once, in a shared buffer referenced by every subscriber write request.
+  //!
+  //! \param topic topic of the message
+  //! \param payload content of the message (moved, never copied)
+  //! \return the number of subscribers the message has been queued for
+  //!
+  std::size_t publish(const std::string& topic, std::vector<char> payload);
+
+  //!
+  //! Publish a message to all the subscribers of a topic.
+  //!
+  //! \param topic topic of the message
+  //! \param payload content of the message
+  //! \return the number of subscribers the message has been queued for
+  //!
+  std::size_t publish(const std::string& topic, const std::string& payload);
+
+public:
+  //!
+  //! set the maximum number of bytes pending to be written to a subscriber, beyond which it is considered a slow consumer
+  //!
+  //! \param max_pending_bytes limit, in bytes (__TACOPIE_PUBSUB_MAX_PENDING_BYTES by default)
+  //!
+  void set_max_pending_bytes(std::size_t max_pending_bytes);
+
+  //!
+  //! set how slow consumers are handled (evicted by default)
+  //!
+  //! \param policy slow consumer policy
+  //!
+  void set_slow_consumer_policy(slow_consumer_policy policy);
+
+  //!
+  //! set the handler called whenever a slow consumer is evicted
+  //!
+  //! \param handler handler to be called, may be null
+  //!
+  void set_on_eviction_handler(const eviction_handler_t& handler);
+
+public:
+  //!
+  //! \return the number of connected subscribers (subscribed to a topic or not)
+  //!
+  std::size_t get_nb_subscribers(void) const;
+
+  //!
+  //! \param topic topic
+  //! \return the number of subscribers of the given topic
+  //!
+  std::size_t get_nb_subscribers(const std::string& topic) const;
+
+  //!
+  //! \return the number of messages not sent to slow consumers (drop policy)
+  //!
+  std::size_t get_nb_dropped_messages(void) const;
+
+  //!
+  //! \return the number of evicted slow consumers (evict policy)
+  //!
+  std::size_t get_nb_evictions(void) const;
+
+  //!
+  //! \return the underlying tcp_server
+  //!
+  tcp_server& get_tcp_server(void);
+
+private:
+  //!
+  //! connected subscriber
+  //!
+  struct subscriber {
+    //!
+    //! subscriber connection
+    //!
+    std::shared_ptr<tcp_client> client;
+    //!
+    //! subscribed topics, guarded by the hub mutex
+    //!
+    std::unordered_set<std::string> topics;
+    //!
+    //! bytes of the command being received
+    //!
+    std::string command;
+  };
+
+  //!
+  //! tcp_server new connection callback
+  //!
+  //! \param client newly accepted client
+  //! \return true, connections are handled by the hub
+  //!
+  bool on_new_connection(const std::shared_ptr<tcp_client>& client);
+
+  //!
+  //! read the next commands of a subscriber
+  //!
+  //! \param sub subscriber
+  //!
+  void async_read(const std::shared_ptr<subscriber>& sub);
+
+  //!
+  //! subscriber read callback: parse and execute the received commands
+  //!
+  //! \param sub subscriber
+  //! \param result read result
+  //!
+  void on_read(const std::shared_ptr<subscriber>& sub, tcp_client::read_result& result);
+
+  //!
+  //! execute a subscriber command
+  //!
+  //! \param sub subscriber
+  //! \param command command line, without its terminator
+  //!
+  void execute_command(const std::shared_ptr<subscriber>& sub, const std::string& command);
+
+  //!
+  //! remove a subscriber from all its topics and from the hub, and disconnect it
+  //!
+  //! \param sub subscriber
+  //!
+  void remove_subscriber(const std::shared_ptr<subscriber>& sub);
+
+  //!
+  //! remove a subscriber from a topic, the hub mutex must be held
+  //!
+  //! \param sub subscriber
+  //! \param topic topic
+  //!
+  void remove_from_topic(const std::shared_ptr<subscriber>& sub, const std::string& topic);
+
+  //!
+  //! encode a message
+  //!
+  //! \param topic topic of the message
+  //! \param payload content of the message (moved)
+  //! \return the encoded message, made of the header, the payload and the trailer slices
+  //!
+  static shared_buffer encode(const std::string& topic, std::vector<char>&& payload);
+
+private:
+  //!
+  //! underlying tcp server
+  //!
+  tcp_server m_server;
+
+  //!
+  //! connected subscribers
+  //!
+  std::unordered_set<std::shared_ptr<subscriber>> m_subscribers;
+
+  //!
+  //! subscribers of each topic
+  //!
+  std::unordered_map<std::string, std::vector<std::shared_ptr<subscriber>>> m_topics;
+
+  //!
+  //! subscribers and topics thread safety
+  //!
+  mutable std::mutex m_mtx;
+
+  //!
+  //! slow consumer detection threshold
+  //!
+  std::atomic<std::size_t> m_max_pending_bytes = ATOMIC_VAR_INIT(__TACOPIE_PUBSUB_MAX_PENDING_BYTES);
+
+  //!
+  //! slow consumer policy
+  //!
+  std::atomic<slow_consumer_policy> m_slow_consumer_policy = ATOMIC_VAR_INIT(slow_consumer_policy::evict);
+
+  //!
+  //! eviction handler, guarded by the hub mutex
+  //!
+  eviction_handler_t m_eviction_handler;
+
+  //!
+  //! statistics
+  //!
+  std::atomic<std::size_t> m_nb_dropped_messages = ATOMIC_VAR_INIT(0);
+  std::atomic<std::size_t> m_nb_evictions        = ATOMIC_VAR_INIT(0);
+};
+
+} // namespace pubsub
+
+} // namespace tacopie
@@ -0,0 +1,215 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <tacopie/network/tcp_client.hpp>
+#include <tacopie/resp/encoder.hpp>
+#include <tacopie/resp/parser.hpp>
+#include <tacopie/resp/reply.hpp>
+
+#ifndef __TACOPIE_RESP_READ_SIZE
+#define __TACOPIE_RESP_READ_SIZE 4096
+#endif /* __TACOPIE_RESP_READ_SIZE */
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! pipelined RESP client built on top of tcp_client
+//!
+//! commands are encoded directly into a write batch
+//! while a write is in flight, new commands are appended to the batch, which is flushed as a single write request on the next write completion
+//! that way, all the commands sent during one reactor iteration end up in one send() call
+//!
+//! replies are matched with their callbacks in FIFO order
+//!
+class client {
+public:
+  //! ctor
+  client(void);
+  //! dtor
+  ~client(void);
+
+  //!
+  //! custom ctor
+  //! build a client monitored by the given io_service instead of the default one
+  //!
+  //! \param io_service io_service monitoring the connections
+  //!
+  explicit client(const std::shared_ptr<tacopie::io_service>& io_service);
+
+  //! copy ctor
+  client(const client&) = delete;
+  //! assignment operator
+  client& operator=(const client&) = delete;
+
+public:
+  //!
+  //! callback called on reply reception
+  //! the reply is only valid during the callback execution
+  //!
+  typedef std::function<void(reply&)> reply_callback_t;
+
+  //!
+  //! disconnection handler
+  //! called whenever a disconnection occured
+  //!
+  typedef tcp_client::disconnection_handler_t disconnection_handler_t;
+
+public:
+  //!
+  //! Connect to the remote server.
+  //!
+  //! \param host Hostname of the target server
+  //! \param port Port of the target server
+  //! \param timeout_msecs maximum time to connect (will block until connect succeed or timeout expire). 0 will block undefinitely. If timeout expires, connection fails
+  //!
+  void connect(const std::string& host, std::uint32_t port, std::uint32_t timeout_msecs = 0);
+
+  //!
+  //! Disconnect the client if it was currently connected.
+  //! pending commands and callbacks are dropped
+  //!
+  //! \param wait_for_removal When sets to true, disconnect blocks until all the underlying callbacks have completed.
+  //!
+  void disconnect(bool wait_for_removal = false);
+
+  //!
+  //! \return whether the client is currently connected or not
+  //!
+  bool is_connected(void) const;
+
+  //!
+  //! set on disconnection handler
+  //!
+  //! \param disconnection_handler the handler to be called on disconnection
+  //!
+  void set_on_disconnection_handler(const disconnection_handler_t& disconnection_handler);
+
+public:
+  //!
+  //! send a command
+  //! the command is appended to the current write batch and is written as soon as no other write is in flight
+  //!
+  //! \param command command name followed by its arguments
+  //! \param callback callback to be called on reply reception (may be null)
+  //! \return current instance
+  //!
+  client& send(const std::vector<std::string>& command, const reply_callback_t& callback = nullptr);
+
+  //!
+  //! \return underlying tcp_client
+  //!
+  tcp_client& get_tcp_client(void);
+
+private:
+  //!
+  //! write the current batch if no write is in flight
+  //! m_mtx must be held
+  //!
+  void flush_batch(void);
+
+  //!
+  //! schedule the next read operation
+  //!
+  void async_read(void);
+
+  //!
+  //! tcp_client read callback
+  //!
+  //! \param result read result
+  //!
+  void on_read(tcp_client::read_result& result);
+
+  //!
+  //! tcp_client write callback
+  //!
+  //! \param expected_size size of the batch that has been written
+  //! \param result write result
+  //!
+  void on_write(std::size_t expected_size, tcp_client::write_result& result);
+
+  //!
+  //! tcp_client disconnection handler
+  //!
+  void on_disconnection(void);
+
+  //!
+  //! drop pending batch and callbacks
+  //!
+  void clear_pending(void);
+
+private:
+  //!
+  //! underlying tcp client
+  //!
+  tcp_client m_client;
+
+  //!
+  //! reply parser, only accessed from the read callback
+  //!
+  parser m_parser;
+
+  //!
+  //! commands encoded but not yet written
+  //!
+  std::vector<char> m_batch;
+
+  //!
+  //! buffer of the last completed write, handed back by tcp_client: becomes the next batch, so that batches reuse their capacity
+  //!
+  std::vector<char> m_spare_batch;
+
+  //!
+  //! whether a write request is currently in flight
+  //!
+  bool m_is_writing;
+
+  //!
+  //! callbacks of the commands waiting for a reply
+  //!
+  std::queue<reply_callback_t> m_callbacks;
+
+  //!
+  //! batch and callbacks thread safety
+  //!
+  std::mutex m_mtx;
+
+  //!
+  //! user disconnection handler
+  //!
+  disconnection_handler_t m_disconnection_handler;
+};
+
+} // namespace resp
+
+} // namespace tacopie
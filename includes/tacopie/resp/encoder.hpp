@@ -0,0 +1,68 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! RESP encoder
+//! commands are encoded as arrays of bulk strings and appended directly to the given write buffer (no intermediate string)
+//!
+class encoder {
+public:
+  //!
+  //! append a command to the write buffer
+  //!
+  //! \param buffer write buffer the command is appended to
+  //! \param command command name followed by its arguments
+  //!
+  static void encode(std::vector<char>& buffer, const std::vector<std::string>& command);
+
+  //!
+  //! \return the number of bytes required to encode the given command
+  //!
+  //! \param command command name followed by its arguments
+  //!
+  static std::size_t encoded_size(const std::vector<std::string>& command);
+
+private:
+  //!
+  //! append a RESP header line (prefix, integer and CRLF) to the write buffer
+  //!
+  //! \param buffer write buffer
+  //! \param prefix RESP type prefix
+  //! \param value integer to be written
+  //!
+  static void encode_header(std::vector<char>& buffer, char prefix, std::size_t value);
+};
+
+} // namespace resp
+
+} // namespace tacopie
@@ -0,0 +1,200 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <tacopie/resp/reply.hpp>
+
+#ifndef __TACOPIE_RESP_MAX_NESTING
+#define __TACOPIE_RESP_MAX_NESTING 32
+#endif /* __TACOPIE_RESP_MAX_NESTING */
+
+#ifndef __TACOPIE_RESP_MAX_ARRAY_SIZE
+#define __TACOPIE_RESP_MAX_ARRAY_SIZE (1024 * 1024)
+#endif /* __TACOPIE_RESP_MAX_ARRAY_SIZE */
+
+#ifndef __TACOPIE_RESP_MAX_BULK_SIZE
+#define __TACOPIE_RESP_MAX_BULK_SIZE (512 * 1024 * 1024)
+#endif /* __TACOPIE_RESP_MAX_BULK_SIZE */
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! incremental RESP parser
+//!
+//! bytes are fed as they are received (typically directly from tcp_client::read_result::buffer) and replies are built as soon as they are complete
+//! string replies are not copied: they point into the internal buffer of the parser
+//!
+//! when all the previously fed bytes have been consumed, feeding a buffer by rvalue simply takes ownership of it (no copy at all)
+//! otherwise, the consumed bytes are discarded and the new bytes are appended to the remaining partial reply
+//!
+//! a partial array reply is resumed where parsing stopped: the elements already parsed are not parsed again when more bytes are fed
+//! arrays of more than __TACOPIE_RESP_MAX_ARRAY_SIZE elements and bulk strings of more than __TACOPIE_RESP_MAX_BULK_SIZE bytes are rejected as invalid
+//!
+class parser {
+public:
+  //! ctor
+  parser(void);
+  //! dtor
+  ~parser(void) = default;
+
+  //! copy ctor
+  parser(const parser&) = delete;
+  //! assignment operator
+  parser& operator=(const parser&) = delete;
+
+public:
+  //!
+  //! feed the parser with received bytes
+  //! invalidates all the replies previously returned by get_reply()
+  //!
+  //! \param buffer received bytes (moved into the parser when possible)
+  //!
+  void feed(std::vector<char>&& buffer);
+
+  //!
+  //! feed the parser with received bytes
+  //! invalidates all the replies previously returned by get_reply()
+  //!
+  //! \param data received bytes (copied into the parser)
+  //! \param size number of bytes
+  //!
+  void feed(const char* data, std::size_t size);
+
+  //!
+  //! retrieve the next complete reply, if any
+  //! throws a tacopie_error if the stream is not valid RESP (the parser must then be reset)
+  //!
+  //! \param reply reply to be filled
+  //! \return whether a complete reply has been extracted
+  //!
+  bool get_reply(reply& reply);
+
+  //!
+  //! drop all buffered bytes
+  //!
+  void reset(void);
+
+private:
+  //!
+  //! result of the parsing of a single element
+  //!  * incomplete: more bytes are needed, nothing has been consumed
+  //!  * complete: the element has been parsed
+  //!  * array_started: the header of a non-empty array has been parsed, its elements come next
+  //!
+  enum class parse_status {
+    incomplete,
+    complete,
+    array_started
+  };
+
+  //!
+  //! try to parse a single element starting at the given position
+  //! arrays are not parsed recursively: only their header is, the elements are parsed by get_reply
+  //!
+  //! \param pos position of the first byte of the element, updated to the position following the element (or the array header) on success
+  //! \param reply reply to be filled
+  //! \return parsing status
+  //!
+  parse_status parse(std::size_t& pos, reply& reply);
+
+  //!
+  //! locate the end of the line starting at the given position
+  //!
+  //! \param pos position of the first byte of the line
+  //! \param line_end set to the position of the terminating \r on success
+  //! \return whether a full line is available
+  //!
+  bool find_line_end(std::size_t pos, std::size_t& line_end) const;
+
+  //!
+  //! parse an integer line
+  //!
+  //! \param begin position of the first digit (or sign)
+  //! \param end position of the terminating \r
+  //! \return parsed value
+  //!
+  std::int64_t parse_integer(std::size_t begin, std::size_t end) const;
+
+private:
+  //!
+  //! received bytes
+  //!
+  std::vector<char> m_buffer;
+
+  //!
+  //! position of the first byte not consumed yet
+  //!
+  std::size_t m_offset;
+
+  //!
+  //! minimum buffer size required before it is worth trying to parse the pending reply again
+  //! avoid re-scanning large bulk strings on each partial read
+  //!
+  std::size_t m_needed;
+
+  //!
+  //! array being filled, and index of its next element to be parsed
+  //!
+  struct frame {
+    //!
+    //! array reply (an element of the parent frame, or m_pending)
+    //!
+    reply* array;
+    //!
+    //! index of the next element to be parsed
+    //!
+    std::size_t index;
+  };
+
+  //!
+  //! reply being parsed, moved to the caller once complete
+  //!
+  reply m_pending;
+
+  //!
+  //! arrays of m_pending being filled, outermost first (empty if m_pending is not a partial array)
+  //!
+  std::vector<frame> m_frames;
+
+  //!
+  //! position of the next element of m_pending to be parsed, relative to m_offset
+  //!
+  std::size_t m_pending_pos;
+
+  //!
+  //! string replies of m_pending and the position of their bytes relative to m_offset
+  //! the buffer may be reallocated by feed while the reply is partial: their pointers are only set once the reply is complete
+  //!
+  std::vector<std::pair<reply*, std::size_t>> m_strings;
+};
+
+} // namespace resp
+
+} // namespace tacopie
@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! reply parsed from a RESP (REdis Serialization Protocol) stream
+//!
+//! string replies do not own their bytes: they point directly into the buffer of the parser that built them
+//! as a consequence, a reply is only valid until the next call to parser::feed()
+//!
+class reply {
+public:
+  //!
+  //! type of the reply, matching the RESP types
+  //!
+  enum class type {
+    simple_string,
+    error,
+    integer,
+    bulk_string,
+    array,
+    null
+  };
+
+public:
+  //! ctor
+  reply(void);
+  //! dtor
+  ~reply(void) = default;
+
+  //! copy ctor
+  reply(const reply&) = default;
+  //! assignment operator
+  reply& operator=(const reply&) = default;
+
+  //! move ctor
+  reply(reply&&) = default;
+  //! move assignment operator
+  reply& operator=(reply&&) = default;
+
+public:
+  //!
+  //! reset the reply to a string-like type (simple_string, error or bulk_string)
+  //!
+  //! \param t type of the reply
+  //! \param data pointer to the first byte of the string (not copied)
+  //! \param size size of the string
+  //!
+  void set_string(type t, const char* data, std::size_t size);
+
+  //!
+  //! reset the reply to an integer
+  //!
+  //! \param value integer value
+  //!
+  void set_integer(std::int64_t value);
+
+  //!
+  //! reset the reply to an empty array
+  //! elements are then appended through get_elements()
+  //!
+  void set_array(void);
+
+  //!
+  //! reset the reply to a null reply
+  //!
+  void set_null(void);
+
+public:
+  //!
+  //! \return the type of the reply
+  //!
+  type get_type(void) const;
+
+  //!
+  //! \return whether the reply is an error
+  //!
+  bool is_error(void) const;
+
+  //!
+  //! \return whether the reply is null
+  //!
+  bool is_null(void) const;
+
+public:
+  //!
+  //! \return pointer to the first byte of a string-like reply (nullptr for other types)
+  //!
+  const char* data(void) const;
+
+  //!
+  //! \return size of a string-like reply (0 for other types)
+  //!
+  std::size_t size(void) const;
+
+  //!
+  //! \return a copy of the string-like reply as a std::string
+  //!
+  std::string as_string(void) const;
+
+  //!
+  //! \return the integer value of an integer reply (0 for other types)
+  //!
+  std::int64_t as_integer(void) const;
+
+  //!
+  //! \return the elements of an array reply (non-const version)
+  //!
+  std::vector<reply>& get_elements(void);
+
+  //!
+  //! \return the elements of an array reply (const version)
+  //!
+  const std::vector<reply>& get_elements(void) const;
+
+private:
+  //!
+  //! type of the reply
+  //!
+  type m_type;
+
+  //!
+  //! string-like replies: bytes, owned by the parser
+  //!
+  const char* m_data;
+
+  //!
+  //! string-like replies: number of bytes
+  //!
+  std::size_t m_size;
+
+  //!
+  //! integer replies: value
+  //!
+  std::int64_t m_integer;
+
+  //!
+  //! array replies: elements
+  //!
+  std::vector<reply> m_elements;
+};
+
+} // namespace resp
+
+} // namespace tacopie
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! shared_ptr that can be loaded and stored concurrently
+//!
+//! relies on std::atomic<std::shared_ptr<T>> when the standard library provides it, on the std::atomic_load/std::atomic_store overloads for shared_ptr otherwise (deprecated since C++20)
+//!
+template <typename T>
+class atomic_shared_ptr {
+public:
+  //! ctor
+  atomic_shared_ptr(void) = default;
+  //! dtor
+  ~atomic_shared_ptr(void) = default;
+
+  //!
+  //! custom ctor
+  //!
+  //! \param ptr initial value
+  //!
+  explicit atomic_shared_ptr(std::shared_ptr<T> ptr)
+  : m_ptr(std::move(ptr)) {}
+
+  //! copy ctor
+  atomic_shared_ptr(const atomic_shared_ptr&) = delete;
+  //! assignment operator
+  atomic_shared_ptr& operator=(const atomic_shared_ptr&) = delete;
+
+public:
+  //!
+  //! \return current value
+  //!
+  std::shared_ptr<T>
+  load(void) const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    return m_ptr.load(std::memory_order_acquire);
+#else
+    return std::atomic_load_explicit(&m_ptr, std::memory_order_acquire);
+#endif /* __cpp_lib_atomic_shared_ptr */
+  }
+
+  //!
+  //! replace the current value
+  //!
+  //! \param ptr new value
+  //!
+  void
+  store(std::shared_ptr<T> ptr) {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    m_ptr.store(std::move(ptr), std::memory_order_release);
+#else
+    std::atomic_store_explicit(&m_ptr, std::move(ptr), std::memory_order_release);
+#endif /* __cpp_lib_atomic_shared_ptr */
+  }
+
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+  std::atomic<std::shared_ptr<T>> m_ptr;
+#else
+  std::shared_ptr<T> m_ptr;
+#endif /* __cpp_lib_atomic_shared_ptr */
+};
+
+} // namespace utils
+
+} // namespace tacopie
@@ -0,0 +1,143 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#ifndef __TACOPIE_CIRCULAR_QUEUE_INITIAL_CAPACITY
+#define __TACOPIE_CIRCULAR_QUEUE_INITIAL_CAPACITY 64
+#endif /* __TACOPIE_CIRCULAR_QUEUE_INITIAL_CAPACITY */
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! FIFO queue backed by a growable circular buffer
+//!
+//! unlike std::queue (backed by std::deque), storage is never released while the queue is in use: once the queue reached its working size, push and pop do not allocate
+//! T must be default constructible and move assignable, __TACOPIE_CIRCULAR_QUEUE_INITIAL_CAPACITY must be a power of 2
+//!
+template <typename T>
+class circular_queue {
+public:
+  //! ctor
+  circular_queue(void)
+  : m_elements(__TACOPIE_CIRCULAR_QUEUE_INITIAL_CAPACITY)
+  , m_head(0)
+  , m_size(0) {}
+
+  //! dtor
+  ~circular_queue(void) = default;
+
+  //! copy ctor
+  circular_queue(const circular_queue&) = delete;
+  //! assignment operator
+  circular_queue& operator=(const circular_queue&) = delete;
+
+public:
+  //!
+  //! push an element at the back of the queue
+  //!
+  //! \param value element to be pushed
+  //!
+  void
+  push(T&& value) {
+    if (m_size == m_elements.size()) { grow(); }
+
+    m_elements[(m_head + m_size) & (m_elements.size() - 1)] = std::move(value);
+    ++m_size;
+  }
+
+  //!
+  //! \return first element of the queue (the queue must not be empty)
+  //!
+  T&
+  front(void) {
+    return m_elements[m_head];
+  }
+
+  //!
+  //! remove the first element of the queue (the queue must not be empty)
+  //!
+  void
+  pop(void) {
+    //! release the resources held by the element right away
+    m_elements[m_head] = T();
+    m_head             = (m_head + 1) & (m_elements.size() - 1);
+    --m_size;
+  }
+
+  //!
+  //! \return whether the queue is empty
+  //!
+  bool
+  empty(void) const {
+    return m_size == 0;
+  }
+
+  //!
+  //! \return number of elements in the queue
+  //!
+  std::size_t
+  size(void) const {
+    return m_size;
+  }
+
+private:
+  //!
+  //! double the capacity, moving the elements at the beginning of the new buffer
+  //!
+  void
+  grow(void) {
+    std::vector<T> elements(m_elements.size() * 2);
+
+    for (std::size_t i = 0; i < m_size; ++i) { elements[i] = std::move(m_elements[(m_head + i) & (m_elements.size() - 1)]); }
+
+    m_elements.swap(elements);
+    m_head = 0;
+  }
+
+private:
+  //!
+  //! buffer (size is a power of 2)
+  //!
+  std::vector<T> m_elements;
+
+  //!
+  //! index of the first element
+  //!
+  std::size_t m_head;
+
+  //!
+  //! number of elements
+  //!
+  std::size_t m_size;
+};
+
+} // namespace utils
+
+} // namespace tacopie
@@ -0,0 +1,86 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! list of cpu ids
+//!
+typedef std::vector<std::size_t> cpu_list_t;
+
+//!
+//! restrict the given thread to a set of cpus
+//! supported on linux and windows (cpus < 64 on windows)
+//!
+//! \param thread thread to be pinned (must be running)
+//! \param cpus allowed cpus (empty list: no restriction)
+//! \return whether the affinity has been applied
+//!
+bool set_thread_affinity(std::thread& thread, const cpu_list_t& cpus);
+
+//!
+//! restrict the current thread to a set of cpus
+//!
+//! \param cpus allowed cpus (empty list: no restriction)
+//! \return whether the affinity has been applied
+//!
+bool set_current_thread_affinity(const cpu_list_t& cpus);
+
+//!
+//! parse a cpu list in the linux sysfs format (for example "0-3,8,10-11")
+//!
+//! \param list cpu list to be parsed
+//! \return parsed cpus
+//!
+cpu_list_t parse_cpu_list(const std::string& list);
+
+//!
+//! \param node numa node
+//! \return cpus of the given numa node, read from sysfs (empty if unavailable)
+//!
+cpu_list_t get_numa_node_cpus(int node);
+
+//!
+//! \param network_interface network interface name (for example "eth0")
+//! \return numa node of the device behind the network interface, read from sysfs (-1 if unknown)
+//!
+int get_network_interface_numa_node(const std::string& network_interface);
+
+//!
+//! \param network_interface network interface name (for example "eth0")
+//! \return cpus local to the device behind the network interface, read from sysfs (empty if unavailable)
+//!
+cpu_list_t get_network_interface_cpus(const std::string& network_interface);
+
+} // namespace utils
+
+} // namespace tacopie
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! eventcount: lets threads wait for a condition checked outside of any lock
+//!
+//! waiting is done in two steps:
+//!  * prepare_wait registers the thread as a waiter and returns a key
+//!  * the condition is checked again: cancel_wait if it became true, commit_wait(key) otherwise
+//! notifiers first publish the state change, then call notify_one/notify_all, which cost a single atomic operation when no thread waits
+//!
+class event_count {
+public:
+  //! ctor
+  event_count(void) = default;
+  //! dtor
+  ~event_count(void) = default;
+
+  //! copy ctor
+  event_count(const event_count&) = delete;
+  //! assignment operator
+  event_count& operator=(const event_count&) = delete;
+
+public:
+  //!
+  //! register the current thread as a waiter
+  //!
+  //! \return key to be given to commit_wait
+  //!
+  std::uint32_t prepare_wait(void);
+
+  //!
+  //! unregister the current thread after prepare_wait, without waiting
+  //!
+  void cancel_wait(void);
+
+  //!
+  //! block until a notification occurred since prepare_wait
+  //!
+  //! \param key key returned by prepare_wait
+  //!
+  void commit_wait(std::uint32_t key);
+
+  //!
+  //! wake up one waiter, if any
+  //!
+  void notify_one(void);
+
+  //!
+  //! wake up all waiters, if any
+  //!
+  void notify_all(void);
+
+private:
+  //!
+  //! wake up waiters, if any
+  //!
+  //! \param all whether all waiters or only one should be woken up
+  //!
+  void notify(bool all);
+
+private:
+  //!
+  //! state: epoch in the high 32 bits (incremented on each notification), number of waiters in the low 32 bits
+  //!
+  std::atomic<std::uint64_t> m_state = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! blocking primitives, only used when threads are actually waiting
+  //!
+  std::mutex m_mtx;
+  std::condition_variable m_condvar;
+};
+
+} // namespace utils
+
+} // namespace tacopie
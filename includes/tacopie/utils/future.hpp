@@ -0,0 +1,709 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/task.hpp>
+#include <tacopie/utils/thread_pool.hpp>
+
+#ifndef __TACOPIE_FUTURE_POOL_SIZE
+#define __TACOPIE_FUTURE_POOL_SIZE 256
+#endif /* __TACOPIE_FUTURE_POOL_SIZE */
+
+namespace tacopie {
+
+namespace utils {
+
+template <typename T>
+class future;
+
+template <typename T>
+class promise;
+
+//!
+//! state shared by a promise and its future
+//!
+//! states are recycled through a per-thread free list (up to __TACOPIE_FUTURE_POOL_SIZE states per thread): creating a promise does not allocate once the pool is warm
+//! readiness is tracked with a single atomic word, the mutex and condition variable are only used when a thread blocks in future::wait
+//!
+template <typename T>
+class future_state {
+public:
+  //!
+  //! \return a state taken from the pool of the calling thread (or allocated if the pool is empty), referenced once
+  //!
+  //! \param executor thread pool executing the continuations attached after completion (nullptr: executed by the thread attaching them)
+  //!
+  static future_state*
+  acquire(thread_pool* executor) {
+    auto& pool = local_pool();
+    future_state* state;
+
+    if (pool.states.empty()) {
+      state = new future_state;
+    }
+    else {
+      state = pool.states.back();
+      pool.states.pop_back();
+    }
+
+    state->m_flags    = 0;
+    state->m_refs     = 1;
+    state->m_executor = executor;
+
+    return state;
+  }
+
+  //! add a reference to the state
+  void
+  add_ref(void) {
+    m_refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //! remove a reference to the state, recycling it if this was the last one
+  void
+  release(void) {
+    if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) { recycle(); }
+  }
+
+public:
+  //!
+  //! store the value, wake up the waiters and execute the continuation (if any) in the calling thread
+  //!
+  //! \param value value of the future
+  //!
+  template <typename U>
+  void
+  set_value(U&& value) {
+    new (&m_storage) T(std::forward<U>(value));
+    complete(has_value);
+  }
+
+  //!
+  //! mark the state as broken: the promise has been destroyed without providing a value
+  //! waiters are woken up and the continuation (if any) is dropped
+  //!
+  void
+  set_broken(void) {
+    complete(is_broken);
+  }
+
+  //!
+  //! attach the continuation
+  //! the reference held by the caller is transferred to the continuation and released once the continuation has been executed (or dropped)
+  //!
+  //! \param continuation continuation to be executed once the value is available
+  //!
+  void
+  set_continuation(task&& continuation) {
+    m_continuation = std::move(continuation);
+
+    if (m_flags.fetch_or(has_continuation, std::memory_order_acq_rel) & (has_value | is_broken)) { dispatch_continuation(); }
+  }
+
+public:
+  //! \return whether a value (or a broken promise) is available
+  bool
+  is_ready(void) const {
+    return (m_flags.load(std::memory_order_acquire) & (has_value | is_broken)) != 0;
+  }
+
+  //! \return whether the promise has been destroyed without providing a value
+  bool
+  broken(void) const {
+    return (m_flags.load(std::memory_order_acquire) & is_broken) != 0;
+  }
+
+  //! block until the state is ready
+  void
+  wait(void) {
+    if (is_ready()) { return; }
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_flags.fetch_or(has_waiter, std::memory_order_acq_rel);
+    m_condvar.wait(lock, [&] { return is_ready(); });
+  }
+
+  //!
+  //! block until the state is ready or the timeout expires
+  //!
+  //! \param timeout maximum time to wait
+  //! \return whether the state is ready
+  //!
+  template <typename Rep, typename Period>
+  bool
+  wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+    if (is_ready()) { return true; }
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_flags.fetch_or(has_waiter, std::memory_order_acq_rel);
+    return m_condvar.wait_for(lock, timeout, [&] { return is_ready(); });
+  }
+
+  //! \return executor of the continuations attached after completion
+  thread_pool*
+  executor(void) const {
+    return m_executor;
+  }
+
+  //! \return the stored value, the state must hold a value
+  T&
+  value(void) {
+    return *reinterpret_cast<T*>(&m_storage);
+  }
+
+private:
+  //! readiness flags
+  enum flag : std::uint32_t {
+    has_value        = 1,
+    is_broken        = 2,
+    has_continuation = 4,
+    has_waiter       = 8
+  };
+
+  //! ctor, states are created by acquire
+  future_state(void)
+  : m_flags(0)
+  , m_refs(0)
+  , m_executor(nullptr) {}
+
+  //! dtor
+  ~future_state(void) = default;
+
+  //! copy ctor
+  future_state(const future_state&) = delete;
+  //! assignment operator
+  future_state& operator=(const future_state&) = delete;
+
+private:
+  //!
+  //! publish the completion flag, then wake up the waiters and execute the continuation
+  //! the continuation is executed inline: the caller is the one completing the operation (typically an io_service worker)
+  //!
+  //! \param flag has_value or is_broken
+  //!
+  void
+  complete(std::uint32_t flag) {
+    std::uint32_t previous = m_flags.fetch_or(flag, std::memory_order_acq_rel);
+
+    //! taking the lock guarantees that a waiter that registered itself is already blocked in the condition variable
+    if (previous & has_waiter) {
+      std::lock_guard<std::mutex> lock(m_mtx);
+      m_condvar.notify_all();
+    }
+
+    if (previous & has_continuation) { run_continuation(); }
+  }
+
+  //!
+  //! continuation attached after completion: executed by the executor if any, inline otherwise
+  //!
+  void
+  dispatch_continuation(void) {
+    if (m_executor) {
+      task continuation = continuation_task(this);
+
+      try {
+        m_executor->add_task(std::move(continuation));
+        return;
+      }
+      catch (const tacopie_error&) {
+        //! executor queue full: execute it inline rather than dropping it (the rejected task is left untouched)
+      }
+
+      if (continuation) { continuation(); }
+      return;
+    }
+
+    run_continuation();
+  }
+
+  //! execute (or drop, if broken) the continuation, and release its reference
+  void
+  run_continuation(void) {
+    if (!broken()) { m_continuation(); }
+
+    m_continuation = nullptr;
+    release();
+  }
+
+  //! drop the continuation without executing it, and release its reference
+  void
+  drop_continuation(void) {
+    m_continuation = nullptr;
+    release();
+  }
+
+  //!
+  //! continuation posted to the executor
+  //! owns the reference of the continuation: if the executor destroys the task without executing it (stopped pool), the continuation is dropped and the state released
+  //!
+  class continuation_task {
+  public:
+    //! ctor
+    explicit continuation_task(future_state* state)
+    : m_state(state) {}
+
+    //! move ctor
+    continuation_task(continuation_task&& other) noexcept
+    : m_state(other.m_state) {
+      other.m_state = nullptr;
+    }
+
+    //! dtor
+    ~continuation_task(void) {
+      if (m_state) { m_state->drop_continuation(); }
+    }
+
+    //! copy ctor
+    continuation_task(const continuation_task&) = delete;
+    //! assignment operator
+    continuation_task& operator=(const continuation_task&) = delete;
+
+  public:
+    //! execute the continuation
+    void
+    operator()(void) {
+      future_state* state = m_state;
+      m_state             = nullptr;
+
+      state->run_continuation();
+    }
+
+  private:
+    //! state of the continuation, null once executed or moved from
+    future_state* m_state;
+  };
+
+  //! destroy the value and give the state back to the pool of the calling thread
+  void
+  recycle(void) {
+    if (m_flags.load(std::memory_order_relaxed) & has_value) { value().~T(); }
+
+    m_continuation = nullptr;
+
+    auto& pool = local_pool();
+
+    if (pool.states.size() < __TACOPIE_FUTURE_POOL_SIZE) {
+      pool.states.push_back(this);
+    }
+    else {
+      delete this;
+    }
+  }
+
+private:
+  //!
+  //! per-thread free list of states, freed on thread exit
+  //!
+  struct state_pool {
+    //! dtor
+    ~state_pool(void) {
+      for (auto state : states) { delete state; }
+    }
+
+    //! available states
+    std::vector<future_state*> states;
+  };
+
+  //! \return the free list of the calling thread
+  static state_pool&
+  local_pool(void) {
+    static thread_local state_pool pool;
+    return pool;
+  }
+
+private:
+  //!
+  //! readiness flags
+  //!
+  std::atomic<std::uint32_t> m_flags;
+
+  //!
+  //! number of references (promise, future and attached continuation)
+  //!
+  std::atomic<std::uint32_t> m_refs;
+
+  //!
+  //! executor of the continuations attached after completion
+  //!
+  thread_pool* m_executor;
+
+  //!
+  //! storage of the value, constructed by set_value
+  //!
+  typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type m_storage;
+
+  //!
+  //! continuation to be executed once ready
+  //!
+  task m_continuation;
+
+  //!
+  //! used by blocking waits only
+  //!
+  std::mutex m_mtx;
+  std::condition_variable m_condvar;
+};
+
+//!
+//! lightweight future: single consumer, move-only
+//!
+//! the value is either retrieved with get (blocking) or consumed by a continuation attached with then
+//!
+template <typename T>
+class future {
+public:
+  //! ctor: invalid future
+  future(void)
+  : m_state(nullptr) {}
+
+  //! move ctor
+  future(future&& other) noexcept
+  : m_state(other.m_state) {
+    other.m_state = nullptr;
+  }
+
+  //! move assignment operator
+  future&
+  operator=(future&& other) noexcept {
+    if (this != &other) {
+      reset();
+      m_state       = other.m_state;
+      other.m_state = nullptr;
+    }
+
+    return *this;
+  }
+
+  //! dtor
+  ~future(void) {
+    reset();
+  }
+
+  //! copy ctor
+  future(const future&) = delete;
+  //! assignment operator
+  future& operator=(const future&) = delete;
+
+public:
+  //!
+  //! \return whether the future is associated to a state (it has not been consumed by get or then)
+  //!
+  bool
+  valid(void) const {
+    return m_state != nullptr;
+  }
+
+  //!
+  //! \return whether the value is available (or the promise broken), the future must be valid
+  //!
+  bool
+  is_ready(void) const {
+    return m_state->is_ready();
+  }
+
+  //!
+  //! block until the value is available (or the promise broken), the future must be valid
+  //!
+  void
+  wait(void) const {
+    m_state->wait();
+  }
+
+  //!
+  //! block until the value is available (or the promise broken) or the timeout expires, the future must be valid
+  //!
+  //! \param timeout maximum time to wait
+  //! \return whether the future is ready
+  //!
+  template <typename Rep, typename Period>
+  bool
+  wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+    return m_state->wait_for(timeout);
+  }
+
+  //!
+  //! block until the value is available and retrieve it
+  //! the future is no longer valid afterwards
+  //! throws a tacopie_error if the promise was destroyed without providing a value
+  //!
+  //! \return the value
+  //!
+  T
+  get(void) {
+    if (!m_state) { __TACOPIE_THROW(error, "future has no state"); }
+
+    m_state->wait();
+
+    if (m_state->broken()) {
+      reset();
+      __TACOPIE_THROW(error, "broken promise");
+    }
+
+    T value = std::move(m_state->value());
+    reset();
+
+    return value;
+  }
+
+  //!
+  //! attach a continuation, called with the value (as T&) once available
+  //! the future is no longer valid afterwards
+  //!
+  //! the continuation is executed by the thread providing the value (io_service worker for tcp_client operations)
+  //! if the value is already available, it is executed by the executor of the promise (or inline if the promise has none)
+  //! the continuation is dropped if the promise is destroyed without providing a value
+  //!
+  //! \param f continuation returning void
+  //!
+  template <typename F, typename R = decltype(std::declval<F&>()(std::declval<T&>()))>
+  typename std::enable_if<std::is_void<R>::value>::type
+  then(F&& f) {
+    attach(void_continuation<typename std::decay<F>::type>{m_state, std::forward<F>(f)});
+  }
+
+  //!
+  //! attach a continuation, called with the value (as T&) once available
+  //! same as above, but the continuation returns a value: the returned future is fulfilled with it (or broken if this future is broken)
+  //!
+  //! \param f continuation returning a value
+  //! \return future of the value returned by the continuation
+  //!
+  template <typename F, typename R = decltype(std::declval<F&>()(std::declval<T&>()))>
+  typename std::enable_if<!std::is_void<R>::value, future<R>>::type
+  then(F&& f) {
+    if (!m_state) { __TACOPIE_THROW(error, "future has no state"); }
+
+    //! the continuation runs where this future completes, so does the completion of the returned future
+    promise<R> next(m_state->executor());
+    future<R> result = next.get_future();
+
+    attach(value_continuation<typename std::decay<F>::type, R>{m_state, std::forward<F>(f), std::move(next)});
+
+    return result;
+  }
+
+private:
+  friend class promise<T>;
+
+  //! ctor from a state, referenced by the caller
+  explicit future(future_state<T>* state)
+  : m_state(state) {}
+
+  //! release the state
+  void
+  reset(void) {
+    if (m_state) {
+      m_state->release();
+      m_state = nullptr;
+    }
+  }
+
+  //! transfer the reference of this future to the continuation
+  template <typename C>
+  void
+  attach(C&& continuation) {
+    if (!m_state) { __TACOPIE_THROW(error, "future has no state"); }
+
+    future_state<T>* state = m_state;
+    m_state                = nullptr;
+    state->set_continuation(std::forward<C>(continuation));
+  }
+
+  //!
+  //! continuations: the state is kept alive by the reference held by the continuation
+  //!
+  template <typename F>
+  struct void_continuation {
+    future_state<T>* state;
+    F f;
+
+    void
+    operator()(void) {
+      f(state->value());
+    }
+  };
+
+  template <typename F, typename R>
+  struct value_continuation {
+    future_state<T>* state;
+    F f;
+    promise<R> next;
+
+    void
+    operator()(void) {
+      next.set_value(f(state->value()));
+    }
+  };
+
+private:
+  //!
+  //! shared state, null if the future is not valid
+  //!
+  future_state<T>* m_state;
+};
+
+//!
+//! lightweight promise: move-only, provides the value of a single future
+//!
+//! destroying a promise without providing a value breaks it: waiters are woken up (get throws) and continuations are dropped
+//!
+template <typename T>
+class promise {
+public:
+  //!
+  //! ctor
+  //! continuations attached after completion are executed by the thread attaching them
+  //!
+  promise(void)
+  : promise(static_cast<thread_pool*>(nullptr)) {}
+
+  //!
+  //! ctor
+  //!
+  //! \param executor thread pool executing the continuations attached after completion, must outlive them
+  //!
+  explicit promise(thread_pool& executor)
+  : promise(&executor) {}
+
+  //! ctor from nullptr: promise without state, to be move-assigned
+  promise(std::nullptr_t)
+  : m_state(nullptr)
+  , m_future_retrieved(false) {}
+
+  //! move ctor
+  promise(promise&& other) noexcept
+  : m_state(other.m_state)
+  , m_future_retrieved(other.m_future_retrieved) {
+    other.m_state = nullptr;
+  }
+
+  //! move assignment operator
+  promise&
+  operator=(promise&& other) noexcept {
+    if (this != &other) {
+      reset();
+      m_state            = other.m_state;
+      m_future_retrieved = other.m_future_retrieved;
+      other.m_state      = nullptr;
+    }
+
+    return *this;
+  }
+
+  //! dtor
+  ~promise(void) {
+    reset();
+  }
+
+  //! copy ctor
+  promise(const promise&) = delete;
+  //! assignment operator
+  promise& operator=(const promise&) = delete;
+
+public:
+  //!
+  //! \return whether the promise is associated to a state (it has not been fulfilled yet)
+  //!
+  bool
+  valid(void) const {
+    return m_state != nullptr;
+  }
+
+  //!
+  //! \return the future associated to this promise, can only be called once
+  //!
+  future<T>
+  get_future(void) {
+    if (!m_state || m_future_retrieved) { __TACOPIE_THROW(error, "future already retrieved"); }
+
+    m_future_retrieved = true;
+    m_state->add_ref();
+
+    return future<T>(m_state);
+  }
+
+  //!
+  //! provide the value: wake up the waiters and execute the continuation (if any) in the calling thread
+  //! the promise is no longer valid afterwards
+  //!
+  //! \param value value of the future
+  //!
+  template <typename U>
+  void
+  set_value(U&& value) {
+    if (!m_state) { __TACOPIE_THROW(error, "promise already satisfied"); }
+
+    future_state<T>* state = m_state;
+    m_state                = nullptr;
+
+    state->set_value(std::forward<U>(value));
+    state->release();
+  }
+
+private:
+  template <typename U>
+  friend class future;
+
+  //! ctor from an optional executor
+  explicit promise(thread_pool* executor)
+  : m_state(future_state<T>::acquire(executor))
+  , m_future_retrieved(false) {}
+
+  //! break the promise if it has not been fulfilled, and release the state
+  void
+  reset(void) {
+    if (m_state) {
+      m_state->set_broken();
+      m_state->release();
+      m_state = nullptr;
+    }
+  }
+
+private:
+  //!
+  //! shared state, null once fulfilled
+  //!
+  future_state<T>* m_state;
+
+  //!
+  //! whether get_future has been called
+  //!
+  bool m_future_retrieved;
+};
+
+} // namespace utils
+
+} // namespace tacopie
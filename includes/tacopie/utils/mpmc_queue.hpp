@@ -0,0 +1,208 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#ifndef __TACOPIE_CACHE_LINE_SIZE
+#define __TACOPIE_CACHE_LINE_SIZE 64
+#endif /* __TACOPIE_CACHE_LINE_SIZE */
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! bounded multi-producer multi-consumer queue (Dmitry Vyukov's design)
+//!
+//! each cell carries a sequence number telling whether it is ready to be written or read for a given position
+//! producers and consumers only contend on their own position counter: push and pop are lock-free and never block
+//!
+template <typename T>
+class mpmc_queue {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param capacity maximum number of elements, rounded up to the next power of 2 (at least 2)
+  //!
+  explicit mpmc_queue(std::size_t capacity)
+  : m_capacity(round_capacity(capacity))
+  , m_mask(m_capacity - 1)
+  , m_cells(new cell[m_capacity])
+  , m_enqueue_pos(0)
+  , m_dequeue_pos(0) {
+    for (std::size_t i = 0; i < m_capacity; ++i) { m_cells[i].sequence.store(i, std::memory_order_relaxed); }
+  }
+
+  //! dtor
+  ~mpmc_queue(void) = default;
+
+  //! copy ctor
+  mpmc_queue(const mpmc_queue&) = delete;
+  //! assignment operator
+  mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+public:
+  //!
+  //! try to push an element
+  //!
+  //! \param value element to be pushed, moved from only on success
+  //! \return whether the element has been pushed (false if the queue is full)
+  //!
+  bool
+  try_push(T& value) {
+    cell* c;
+    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+      c                = &m_cells[pos & m_mask];
+      std::size_t seq  = c->sequence.load(std::memory_order_acquire);
+      std::ptrdiff_t d = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+      if (d == 0) {
+        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+      }
+      else if (d < 0) {
+        //! cell not consumed yet: full
+        return false;
+      }
+      else {
+        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+
+    c->data = std::move(value);
+    c->sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  //!
+  //! try to pop an element
+  //!
+  //! \param value set to the popped element on success
+  //! \return whether an element has been popped (false if the queue is empty)
+  //!
+  bool
+  try_pop(T& value) {
+    cell* c;
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+    while (true) {
+      c                = &m_cells[pos & m_mask];
+      std::size_t seq  = c->sequence.load(std::memory_order_acquire);
+      std::ptrdiff_t d = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+      if (d == 0) {
+        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+      }
+      else if (d < 0) {
+        //! cell not produced yet: empty
+        return false;
+      }
+      else {
+        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+
+    value   = std::move(c->data);
+    c->data = T();
+    c->sequence.store(pos + m_capacity, std::memory_order_release);
+
+    return true;
+  }
+
+  //!
+  //! \return whether the queue looks empty (approximation when called concurrently)
+  //!
+  bool
+  empty(void) const {
+    return m_enqueue_pos.load(std::memory_order_acquire) == m_dequeue_pos.load(std::memory_order_acquire);
+  }
+
+  //!
+  //! \return capacity of the queue
+  //!
+  std::size_t
+  capacity(void) const {
+    return m_capacity;
+  }
+
+private:
+  //!
+  //! \return capacity rounded up to the next power of 2
+  //!
+  static std::size_t
+  round_capacity(std::size_t capacity) {
+    std::size_t rounded = 2;
+    while (rounded < capacity) { rounded <<= 1; }
+    return rounded;
+  }
+
+private:
+  //!
+  //! queue cell
+  //!
+  struct cell {
+    //! position for which the cell is ready (pos: writable, pos + 1: readable)
+    std::atomic<std::size_t> sequence;
+    //! stored element
+    T data;
+  };
+
+  //!
+  //! capacity (power of 2)
+  //!
+  const std::size_t m_capacity;
+
+  //!
+  //! capacity - 1, used for wrapping positions
+  //!
+  const std::size_t m_mask;
+
+  //!
+  //! cells
+  //!
+  std::unique_ptr<cell[]> m_cells;
+
+  //!
+  //! producers position, on its own cache line
+  //!
+  char m_pad0[__TACOPIE_CACHE_LINE_SIZE];
+  std::atomic<std::size_t> m_enqueue_pos;
+
+  //!
+  //! consumers position, on its own cache line
+  //!
+  char m_pad1[__TACOPIE_CACHE_LINE_SIZE];
+  std::atomic<std::size_t> m_dequeue_pos;
+  char m_pad2[__TACOPIE_CACHE_LINE_SIZE];
+};
+
+} // namespace utils
+
+} // namespace tacopie
@@ -0,0 +1,167 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include <tacopie/utils/circular_queue.hpp>
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! FIFO lanes served by weighted round robin
+//!
+//! lane 0 has the highest priority
+//! each lane has a weight: within a round, a lane is served at most weight times before lower lanes get their turn, and a new round starts once every non-empty lane used its credits
+//! under contention, a lane therefore gets at least weight / sum(weights) of the pops: lower lanes are never starved
+//!
+//! not thread safe
+//!
+template <typename T, std::size_t NbLanes>
+class priority_lanes {
+public:
+  //! ctor
+  priority_lanes(void)
+  : m_size(0) {
+    for (std::size_t i = 0; i < NbLanes; ++i) {
+      m_weights[i] = 1;
+      m_credits[i] = 1;
+    }
+  }
+
+  //! dtor
+  ~priority_lanes(void) = default;
+
+  //! copy ctor
+  priority_lanes(const priority_lanes&) = delete;
+  //! assignment operator
+  priority_lanes& operator=(const priority_lanes&) = delete;
+
+public:
+  //!
+  //! set the weight of a lane (at least 1)
+  //!
+  //! \param lane lane index
+  //! \param weight number of pops the lane gets per round
+  //!
+  void
+  set_weight(std::size_t lane, std::size_t weight) {
+    m_weights[lane] = weight ? weight : 1;
+    m_credits[lane] = m_weights[lane];
+  }
+
+  //!
+  //! push an element at the back of a lane
+  //!
+  //! \param value element to be pushed
+  //! \param lane lane index
+  //!
+  void
+  push(T&& value, std::size_t lane) {
+    m_lanes[lane].push(std::move(value));
+    ++m_size;
+  }
+
+  //!
+  //! \return first element to be served (the lanes must not be empty)
+  //!
+  T&
+  front(void) {
+    return m_lanes[next_lane()].front();
+  }
+
+  //!
+  //! remove the first element to be served (the lanes must not be empty)
+  //!
+  void
+  pop(void) {
+    std::size_t lane = next_lane();
+
+    m_lanes[lane].pop();
+    --m_credits[lane];
+    --m_size;
+  }
+
+  //!
+  //! \return whether all the lanes are empty
+  //!
+  bool
+  empty(void) const {
+    return m_size == 0;
+  }
+
+  //!
+  //! \return number of elements in all the lanes
+  //!
+  std::size_t
+  size(void) const {
+    return m_size;
+  }
+
+private:
+  //!
+  //! \return lane to be served next, starting a new round if necessary
+  //!
+  std::size_t
+  next_lane(void) {
+    for (std::size_t round = 0; round < 2; ++round) {
+      for (std::size_t i = 0; i < NbLanes; ++i) {
+        if (!m_lanes[i].empty() && m_credits[i] > 0) { return i; }
+      }
+
+      for (std::size_t i = 0; i < NbLanes; ++i) { m_credits[i] = m_weights[i]; }
+    }
+
+    //! unreachable when the lanes are not empty
+    return 0;
+  }
+
+private:
+  //!
+  //! lanes
+  //!
+  circular_queue<T> m_lanes[NbLanes];
+
+  //!
+  //! weight of each lane
+  //!
+  std::size_t m_weights[NbLanes];
+
+  //!
+  //! remaining pops of each lane in the current round
+  //!
+  std::size_t m_credits[NbLanes];
+
+  //!
+  //! number of elements in all the lanes
+  //!
+  std::size_t m_size;
+};
+
+} // namespace utils
+
+} // namespace tacopie
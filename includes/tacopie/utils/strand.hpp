@@ -0,0 +1,185 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <tacopie/utils/circular_queue.hpp>
+#include <tacopie/utils/thread_pool.hpp>
+
+#ifndef __TACOPIE_STRAND_MAX_BATCH_SIZE
+#define __TACOPIE_STRAND_MAX_BATCH_SIZE 16
+#endif /* __TACOPIE_STRAND_MAX_BATCH_SIZE */
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! strand: executes the tasks posted to it one at a time, in order, on the workers of a thread_pool
+//!
+//! different strands sharing the same thread_pool run in parallel
+//! at most one worker executes the tasks of a given strand at any time: it runs up to __TACOPIE_STRAND_MAX_BATCH_SIZE tasks before giving the worker back to the pool
+//!
+//! strands must be managed by a std::shared_ptr: pending executions keep the strand alive
+//!
+class strand : public std::enable_shared_from_this<strand> {
+public:
+  //!
+  //! ctor
+  //!
+  //! \param pool thread pool executing the tasks, must outlive the strand pending executions
+  //! \param prio priority class of the strand executions in the thread pool
+  //!
+  explicit strand(thread_pool& pool, thread_pool::priority prio = thread_pool::priority::normal);
+
+  //! dtor
+  ~strand(void) = default;
+
+  //! copy ctor
+  strand(const strand&) = delete;
+  //! assignment operator
+  strand& operator=(const strand&) = delete;
+
+public:
+  //!
+  //! enqueue a task, executed after all the tasks previously posted to this strand
+  //! if the thread pool rejects the execution of the strand (lock_free policy with the reject overflow policy), the error is thrown: the task stays queued and is executed along with the next task successfully posted
+  //!
+  //! \param task task to be executed
+  //!
+  void post(thread_pool::task_t&& task);
+
+  //!
+  //! same as post, but if the strand needs to be scheduled, its execution is appended to a batch instead of being submitted right away
+  //! the batch is expected to be submitted with thread_pool::add_tasks
+  //!
+  //! \param task task to be executed
+  //! \param batch batch to which the strand execution is appended
+  //!
+  void post(thread_pool::task_t&& task, thread_pool::task_batch_t& batch);
+
+  //!
+  //! same as post
+  //!
+  //! \param task task to be executed
+  //! \return current instance
+  //!
+  strand& operator<<(thread_pool::task_t&& task);
+
+  //!
+  //! set the priority class of the strand executions in the thread pool (applies to the next executions)
+  //!
+  //! \param prio priority class
+  //!
+  void set_priority(thread_pool::priority prio);
+
+private:
+  //!
+  //! execute the pending tasks (at most __TACOPIE_STRAND_MAX_BATCH_SIZE), then reschedule if some tasks remain
+  //!
+  void run(void);
+
+  //!
+  //! schedule an execution of the strand on the thread pool
+  //!
+  void schedule(void);
+
+  //!
+  //! enqueue a task
+  //!
+  //! \param task task to be executed
+  //! \return whether the strand needs to be scheduled
+  //!
+  bool enqueue(thread_pool::task_t&& task);
+
+  //!
+  //! \return a task executing the strand
+  //!
+  thread_pool::task_t make_run_task(void);
+
+  //!
+  //! clear the scheduled flag after an execution was dropped without running, so that the next post schedules the strand again
+  //!
+  void unschedule(void);
+
+  //!
+  //! execution of the strand submitted to the thread pool
+  //! if destroyed without having been executed (rejected by the thread pool, or dropped when it stops), the strand is unscheduled
+  //!
+  class run_task {
+  public:
+    //! ctor
+    explicit run_task(const std::shared_ptr<strand>& owner);
+    //! move ctor
+    run_task(run_task&& other) noexcept;
+    //! dtor
+    ~run_task(void);
+
+    //! copy ctor
+    run_task(const run_task&) = delete;
+    //! assignment operator
+    run_task& operator=(const run_task&) = delete;
+
+  public:
+    //! execute the strand
+    void operator()(void);
+
+  private:
+    //! strand to be executed, null once executed or moved from
+    std::shared_ptr<strand> m_strand;
+  };
+
+private:
+  //!
+  //! thread pool executing the tasks
+  //!
+  thread_pool& m_pool;
+
+  //!
+  //! pending tasks
+  //!
+  circular_queue<thread_pool::task_t> m_tasks;
+
+  //!
+  //! priority class of the executions
+  //!
+  std::atomic<thread_pool::priority> m_priority;
+
+  //!
+  //! whether an execution is scheduled or in progress
+  //!
+  bool m_is_scheduled;
+
+  //!
+  //! tasks thread safety
+  //!
+  std::mutex m_tasks_mtx;
+};
+
+} // namespace utils
+
+} // namespace tacopie
@@ -0,0 +1,264 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef __TACOPIE_TASK_INLINE_SIZE
+#define __TACOPIE_TASK_INLINE_SIZE 64
+#endif /* __TACOPIE_TASK_INLINE_SIZE */
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! move-only type-erased callable taking no parameter
+//!
+//! callables up to __TACOPIE_TASK_INLINE_SIZE bytes (with a nothrow move ctor) are stored inline, so that building and moving a task does not allocate
+//! bigger callables are stored on the heap
+//!
+class task {
+public:
+  //! ctor
+  task(void)
+  : m_ops(nullptr) {}
+
+  //! ctor from nullptr: empty task
+  task(std::nullptr_t)
+  : m_ops(nullptr) {}
+
+  //!
+  //! ctor from any callable
+  //!
+  //! \param f callable to be stored
+  //!
+  template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, task>::value>::type>
+  task(F&& f)
+  : m_ops(nullptr) {
+    typedef typename std::decay<F>::type callable_t;
+
+    if (is_empty(f)) { return; }
+
+    store<callable_t>(std::forward<F>(f), std::integral_constant<bool, fits_inline<callable_t>::value>());
+  }
+
+  //! move ctor
+  task(task&& other) noexcept
+  : m_ops(other.m_ops) {
+    if (m_ops) {
+      m_ops->move(&m_storage, &other.m_storage);
+      other.m_ops = nullptr;
+    }
+  }
+
+  //! move assignment operator
+  task&
+  operator=(task&& other) noexcept {
+    if (this != &other) {
+      reset();
+
+      if (other.m_ops) {
+        m_ops = other.m_ops;
+        m_ops->move(&m_storage, &other.m_storage);
+        other.m_ops = nullptr;
+      }
+    }
+
+    return *this;
+  }
+
+  //! nullptr assignment operator: reset the task
+  task&
+  operator=(std::nullptr_t) {
+    reset();
+    return *this;
+  }
+
+  //! dtor
+  ~task(void) {
+    reset();
+  }
+
+  //! copy ctor
+  task(const task&) = delete;
+  //! assignment operator
+  task& operator=(const task&) = delete;
+
+public:
+  //!
+  //! execute the stored callable
+  //! the task must not be empty
+  //!
+  void
+  operator()(void) {
+    m_ops->invoke(&m_storage);
+  }
+
+  //!
+  //! \return whether a callable is stored
+  //!
+  explicit operator bool(void) const {
+    return m_ops != nullptr;
+  }
+
+private:
+  //!
+  //! type-erased operations on the stored callable
+  //!
+  struct ops {
+    //! call the callable
+    void (*invoke)(void* storage);
+    //! move-construct the callable from src storage to dst storage, and destroy the source
+    void (*move)(void* dst, void* src);
+    //! destroy the callable
+    void (*destroy)(void* storage);
+  };
+
+  //!
+  //! whether a callable can be stored inline
+  //!
+  template <typename F>
+  struct fits_inline {
+    static const bool value = sizeof(F) <= __TACOPIE_TASK_INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<F>::value;
+  };
+
+  //!
+  //! operations for callables stored inline
+  //!
+  template <typename F>
+  struct inline_ops {
+    static void
+    invoke(void* storage) {
+      (*static_cast<F*>(storage))();
+    }
+
+    static void
+    move(void* dst, void* src) {
+      new (dst) F(std::move(*static_cast<F*>(src)));
+      static_cast<F*>(src)->~F();
+    }
+
+    static void
+    destroy(void* storage) {
+      static_cast<F*>(storage)->~F();
+    }
+
+    static const ops*
+    get(void) {
+      static const ops instance = {&invoke, &move, &destroy};
+      return &instance;
+    }
+  };
+
+  //!
+  //! operations for callables stored on the heap (the storage holds a pointer)
+  //!
+  template <typename F>
+  struct heap_ops {
+    static void
+    invoke(void* storage) {
+      (**static_cast<F**>(storage))();
+    }
+
+    static void
+    move(void* dst, void* src) {
+      *static_cast<F**>(dst) = *static_cast<F**>(src);
+    }
+
+    static void
+    destroy(void* storage) {
+      delete *static_cast<F**>(storage);
+    }
+
+    static const ops*
+    get(void) {
+      static const ops instance = {&invoke, &move, &destroy};
+      return &instance;
+    }
+  };
+
+  //! store a callable inline
+  template <typename F, typename Arg>
+  void
+  store(Arg&& f, std::true_type) {
+    new (&m_storage) F(std::forward<Arg>(f));
+    m_ops = inline_ops<F>::get();
+  }
+
+  //! store a callable on the heap
+  template <typename F, typename Arg>
+  void
+  store(Arg&& f, std::false_type) {
+    *reinterpret_cast<F**>(&m_storage) = new F(std::forward<Arg>(f));
+    m_ops = heap_ops<F>::get();
+  }
+
+  //! destroy the stored callable, if any
+  void
+  reset(void) {
+    if (m_ops) {
+      m_ops->destroy(&m_storage);
+      m_ops = nullptr;
+    }
+  }
+
+  //! empty std::function and null function pointers give an empty task
+  template <typename F>
+  static bool
+  is_empty(const F&) {
+    return false;
+  }
+
+  template <typename R, typename... Args>
+  static bool
+  is_empty(const std::function<R(Args...)>& f) {
+    return !f;
+  }
+
+  template <typename R, typename... Args>
+  static bool
+  is_empty(R (*f)(Args...)) {
+    return f == nullptr;
+  }
+
+private:
+  //!
+  //! callable storage
+  //!
+  typename std::aligned_storage<__TACOPIE_TASK_INLINE_SIZE, alignof(std::max_align_t)>::type m_storage;
+
+  //!
+  //! operations on the stored callable, null for an empty task
+  //!
+  const ops* m_ops;
+};
+
+} // namespace utils
+
+} // namespace tacopie
@@ -23,14 +23,56 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
+#include <tacopie/utils/circular_queue.hpp>
+#include <tacopie/utils/cpu_affinity.hpp>
+#include <tacopie/utils/event_count.hpp>
+#include <tacopie/utils/mpmc_queue.hpp>
+#include <tacopie/utils/priority_lanes.hpp>
+#include <tacopie/utils/task.hpp>
+#include <tacopie/utils/work_stealing_deque.hpp>
+
+#ifndef __TACOPIE_THREAD_POOL_MAX_STEALING_WORKERS
+#define __TACOPIE_THREAD_POOL_MAX_STEALING_WORKERS 64
+#endif /* __TACOPIE_THREAD_POOL_MAX_STEALING_WORKERS */
+
+#ifndef __TACOPIE_THREAD_POOL_SPIN_COUNT
+#define __TACOPIE_THREAD_POOL_SPIN_COUNT 64
+#endif /* __TACOPIE_THREAD_POOL_SPIN_COUNT */
+
+#ifndef __TACOPIE_THREAD_POOL_INJECTION_BATCH_SIZE
+#define __TACOPIE_THREAD_POOL_INJECTION_BATCH_SIZE 32
+#endif /* __TACOPIE_THREAD_POOL_INJECTION_BATCH_SIZE */
+
+#ifndef __TACOPIE_THREAD_POOL_AUTOSCALING_INTERVAL_MS
+#define __TACOPIE_THREAD_POOL_AUTOSCALING_INTERVAL_MS 100
+#endif /* __TACOPIE_THREAD_POOL_AUTOSCALING_INTERVAL_MS */
+
+#ifndef __TACOPIE_THREAD_POOL_HIGH_PRIORITY_WEIGHT
+#define __TACOPIE_THREAD_POOL_HIGH_PRIORITY_WEIGHT 8
+#endif /* __TACOPIE_THREAD_POOL_HIGH_PRIORITY_WEIGHT */
+
+#ifndef __TACOPIE_THREAD_POOL_NORMAL_PRIORITY_WEIGHT
+#define __TACOPIE_THREAD_POOL_NORMAL_PRIORITY_WEIGHT 4
+#endif /* __TACOPIE_THREAD_POOL_NORMAL_PRIORITY_WEIGHT */
+
+#ifndef __TACOPIE_THREAD_POOL_LOW_PRIORITY_WEIGHT
+#define __TACOPIE_THREAD_POOL_LOW_PRIORITY_WEIGHT 1
+#endif /* __TACOPIE_THREAD_POOL_LOW_PRIORITY_WEIGHT */
+
+#ifndef __TACOPIE_THREAD_POOL_LOCK_FREE_QUEUE_SIZE
+#define __TACOPIE_THREAD_POOL_LOCK_FREE_QUEUE_SIZE 4096
+#endif /* __TACOPIE_THREAD_POOL_LOCK_FREE_QUEUE_SIZE */
+
 namespace tacopie {
 
 namespace utils {
@@ -39,14 +81,109 @@ namespace utils {
 //! basic thread pool used to push async tasks from the io_service
 //!
 class thread_pool {
+public:
+  //!
+  //! scheduling policy of the thread pool
+  //!  * fifo: all tasks go through a single queue protected by a mutex
+  //!  * work_stealing: each worker owns a deque in which the tasks it submits are pushed, idle workers steal from the other workers' deques. Tasks submitted from outside the pool go through a global injection queue, drained by batches. Idle workers spin briefly before parking.
+  //!  * lock_free: all tasks go through a bounded lock-free MPMC ring, idle workers park on an eventcount. Producers never wait for a lock held by a worker.
+  //!
+  enum class scheduling_policy {
+    fifo,
+    work_stealing,
+    lock_free
+  };
+
+  //!
+  //! behavior of add_task when the lock_free ring is full
+  //!  * spill: the task is pushed to an unbounded mutex-protected queue, drained by the workers once the ring is empty (tasks may be executed out of order)
+  //!  * block: add_task waits for a free cell
+  //!  * reject: add_task throws a tacopie_error
+  //!
+  enum class overflow_policy {
+    spill,
+    block,
+    reject
+  };
+
+  //!
+  //! priority classes of the tasks
+  //! tasks of the shared queue are served by weighted round robin: under contention, each class gets a share of the workers proportional to its weight (see set_priority_weights), so that latency-sensitive tasks are not delayed by bulk tasks while bulk tasks are never starved
+  //!
+  //! priorities apply to the tasks going through the shared queue: all tasks with the fifo policy, tasks submitted from outside the pool (and non-normal tasks) with the work_stealing policy
+  //! the lock_free ring is FIFO and ignores priorities
+  //!
+  enum class priority {
+    high   = 0,
+    normal = 1,
+    low    = 2
+  };
+
+  //!
+  //! autoscaling configuration
+  //! the pool grows by one worker when the estimated queueing delay or the workers utilization stays above its threshold for scale_up_samples consecutive samples
+  //! it shrinks by one worker when the utilization stays below scale_down_utilization with an empty queue for scale_down_samples consecutive samples
+  //! scale_down_samples being larger than scale_up_samples gives the hysteresis: the pool reacts quickly to load and releases threads slowly
+  //!
+  struct autoscaling_config {
+    //! minimum number of workers
+    std::size_t min_nb_threads = 1;
+    //! maximum number of workers
+    std::size_t max_nb_threads = 16;
+    //! sampling interval
+    std::chrono::milliseconds interval = std::chrono::milliseconds(__TACOPIE_THREAD_POOL_AUTOSCALING_INTERVAL_MS);
+    //! estimated queueing delay above which the pool should grow
+    std::chrono::microseconds scale_up_queueing_delay = std::chrono::microseconds(1000);
+    //! workers utilization (0 to 1) above which the pool should grow
+    double scale_up_utilization = 0.9;
+    //! workers utilization (0 to 1) below which the pool may shrink
+    double scale_down_utilization = 0.5;
+    //! number of consecutive samples required to grow
+    std::size_t scale_up_samples = 2;
+    //! number of consecutive samples required to shrink
+    std::size_t scale_down_samples = 20;
+  };
+
+  //!
+  //! autoscaling decision taken on a sample
+  //!
+  enum class autoscaling_decision {
+    none,
+    scale_up,
+    scale_down
+  };
+
+  //!
+  //! autoscaling metrics, updated on each sample
+  //!
+  struct autoscaling_metrics {
+    //! number of workers after the last decision
+    std::size_t nb_threads = 0;
+    //! number of tasks waiting for execution
+    std::size_t nb_queued_tasks = 0;
+    //! fraction of the sampling interval the workers spent executing tasks (0 to 1)
+    double utilization = 0;
+    //! queueing delay estimated from the queue length and the dequeue rate (Little's law)
+    std::chrono::microseconds queueing_delay = std::chrono::microseconds(0);
+    //! last decision
+    autoscaling_decision last_decision = autoscaling_decision::none;
+    //! number of workers added by the autoscaler
+    std::uint64_t nb_scale_ups = 0;
+    //! number of workers retired by the autoscaler
+    std::uint64_t nb_scale_downs = 0;
+  };
+
 public:
   //!
   //! ctor
   //! created the worker thread that start working immediately
   //!
   //! \param nb_threads number of threads to start the thread pool
+  //! \param policy scheduling policy of the thread pool
+  //! \param queue_size lock_free policy: capacity of the ring (rounded up to a power of 2)
+  //! \param overflow lock_free policy: behavior of add_task when the ring is full
   //!
-  explicit thread_pool(std::size_t nb_threads);
+  explicit thread_pool(std::size_t nb_threads, scheduling_policy policy = scheduling_policy::fifo, std::size_t queue_size = __TACOPIE_THREAD_POOL_LOCK_FREE_QUEUE_SIZE, overflow_policy overflow = overflow_policy::spill);
 
   //! dtor
   ~thread_pool(void);
@@ -60,16 +197,19 @@ public:
   //!
   //! task typedef
   ///! simply a callable taking no parameter
+  //! move-only, small callables (such as the lambdas dispatched by the io_service) are stored without allocation
+  //! any callable (including std::function<void()>) is implicitly converted
   //!
-  typedef std::function<void()> task_t;
+  typedef utils::task task_t;
 
   //!
   //! add tasks to thread pool
   //! task is enqueued and will be executed whenever all previously executed tasked have been executed (or are currently being executed)
   //!
   //! \param task task to be executed by the threadpool
+  //! \param prio priority class of the task
   //!
-  void add_task(const task_t& task);
+  void add_task(task_t&& task, priority prio = priority::normal);
 
   //!
   //! same as add_task
@@ -77,7 +217,54 @@ public:
   //! \param task task to be executed by the threadpool
   //! \return current instance
   //!
-  thread_pool& operator<<(const task_t& task);
+  thread_pool& operator<<(task_t&& task);
+
+  //!
+  //! batch of tasks with their priority class
+  //!
+  typedef std::vector<std::pair<task_t, priority>> task_batch_t;
+
+  //!
+  //! add a batch of tasks to the thread pool
+  //! tasks are enqueued under a single lock acquisition and only as many workers as needed are woken up
+  //!
+  //! with the work_stealing policy, batches always go through the injection queue
+  //! with the lock_free policy and the reject overflow policy, the tasks that do not fit are dropped and a tacopie_error is thrown once the others are enqueued
+  //!
+  //! \param tasks tasks to be executed by the threadpool, moved from: the vector is cleared (its capacity is kept, so that it can be reused for the next batch)
+  //!
+  void add_tasks(task_batch_t& tasks);
+
+  //!
+  //! add a batch of tasks of the same priority class to the thread pool
+  //!
+  //! \param tasks tasks to be executed by the threadpool, moved from: the vector is cleared
+  //! \param prio priority class of the tasks
+  //!
+  void add_tasks(std::vector<task_t>& tasks, priority prio = priority::normal);
+
+  //!
+  //! execute the pending tasks on the calling thread, without waiting for new ones
+  //! lets the owner of a thread_pool without workers (nb_threads = 0) drive it
+  //!
+  //! \param max_nb_tasks maximum number of tasks to execute (0: until no task is pending, including the ones submitted meanwhile)
+  //! \return number of executed tasks
+  //!
+  std::size_t run_pending_tasks(std::size_t max_nb_tasks = 0);
+
+  //!
+  //! handler called on the submitting thread once tasks have been enqueued (add_task, add_tasks)
+  //!
+  typedef std::function<void(void)> task_added_handler_t;
+
+  //!
+  //! set the handler called once tasks have been enqueued
+  //! lets the owner of a thread_pool without workers be woken up to run them (see run_pending_tasks)
+  //! not synchronized: must be set before any task is submitted
+  //!
+  //! \param handler handler to be called, nullptr to unset it
+  //!
+  void set_task_added_handler(const task_added_handler_t& handler);
 
   //!
   //! stop the thread pool and wait for workers completion
@@ -91,6 +278,16 @@ public:
   //!
   bool is_running(void) const;
 
+  //!
+  //! \return the scheduling policy of the thread_pool
+  //!
+  scheduling_policy get_scheduling_policy(void) const;
+
+  //!
+  //! \return the overflow policy of the thread_pool (only relevant for the lock_free policy)
+  //!
+  overflow_policy get_overflow_policy(void) const;
+
 public:
   //!
   //! reset the number of threads working in the thread pool
@@ -106,12 +303,70 @@ public:
   //!
   void set_nb_threads(std::size_t nb_threads);
 
+  //!
+  //! restrict the workers to a set of cpus
+  //! applies to the running workers and to the workers spawned later
+  //!
+  //! \param cpus allowed cpus (empty list: no restriction)
+  //! \param pin_each_worker if true, each worker is pinned to a single cpu of the list (round robin), otherwise each worker may run on any cpu of the list
+  //!
+  void set_cpu_affinity(const cpu_list_t& cpus, bool pin_each_worker = false);
+
+  //!
+  //! set the weights of the priority classes (at least 1)
+  //! within a round of the weighted round robin, a class is served at most weight times before lower classes get their turn
+  //!
+  //! \param high weight of the high priority class
+  //! \param normal weight of the normal priority class
+  //! \param low weight of the low priority class
+  //!
+  void set_priority_weights(std::size_t high, std::size_t normal, std::size_t low);
+
+public:
+  //!
+  //! start adjusting the number of workers to the load, between config.min_nb_threads and config.max_nb_threads
+  //! a background thread samples the queue and the workers on each interval
+  //! calling it again while autoscaling is enabled replaces the configuration
+  //!
+  //! \param config autoscaling configuration
+  //!
+  void enable_autoscaling(const autoscaling_config& config);
+
+  //!
+  //! stop adjusting the number of workers (current number of workers is kept)
+  //!
+  void disable_autoscaling(void);
+
+  //!
+  //! \return whether autoscaling is enabled
+  //!
+  bool is_autoscaling(void) const;
+
+  //!
+  //! \return autoscaling metrics of the last sample
+  //!
+  autoscaling_metrics get_autoscaling_metrics(void);
+
 private:
   //!
   //! worker main loop
   //!
   void run(void);
 
+  //!
+  //! autoscaler main loop
+  //!
+  void autoscale(void);
+
+  //!
+  //! apply the configured cpu affinity to a worker
+  //! m_workers_mtx must be held
+  //!
+  //! \param worker worker thread
+  //! \param index index of the worker (used to pick a cpu when pinning each worker)
+  //!
+  void apply_cpu_affinity(std::thread& worker, std::size_t index);
+
   //!
   //! retrieve a new task
   //! fetch the first element in the queue, or wait if no task are available
@@ -127,6 +382,131 @@ private:
   //!
   bool should_stop(void) const;
 
+private:
+  //!
+  //! per-worker state used by the work_stealing policy
+  //!
+  struct worker_slot {
+    //!
+    //! tasks submitted by the worker owning the slot
+    //!
+    work_stealing_deque<task_t*> deque;
+
+    //!
+    //! whether the slot is owned by a worker
+    //!
+    std::atomic<bool> in_use = ATOMIC_VAR_INIT(false);
+
+    //!
+    //! thread pool the slot belongs to
+    //!
+    thread_pool* pool = nullptr;
+  };
+
+  //!
+  //! work_stealing policy: enqueue a task
+  //! pushed to the deque of the current worker if called from a worker of this pool with the normal priority, to the injection queue otherwise
+  //!
+  //! \param task task to be executed by the threadpool
+  //! \param prio priority class of the task
+  //!
+  void add_task_work_stealing(task_t&& task, priority prio);
+
+  //!
+  //! work_stealing policy: retrieve a new task
+  //! look in the own deque, then in the injection queue, then in the other workers' deques, spin and finally park
+  //!
+  //! \return a pair <stopped, task>, see fetch_task_or_stop
+  //!
+  std::pair<bool, task_t> fetch_task_or_stop_work_stealing(void);
+
+  //!
+  //! work_stealing policy: try to retrieve a task without blocking
+  //!
+  //! \param slot slot of the current worker (may be null)
+  //! \param task set to the retrieved task on success
+  //! \return whether a task has been retrieved
+  //!
+  bool try_fetch_task(worker_slot* slot, task_t& task);
+
+  //!
+  //! work_stealing policy: take ownership of a free slot for the current worker
+  //!
+  //! \return the acquired slot, or null if all slots are in use
+  //!
+  worker_slot* acquire_slot(void);
+
+  //!
+  //! work_stealing policy: give the slot of a retiring worker back, moving its pending tasks to the injection queue
+  //!
+  //! \param slot slot to be released (may be null)
+  //!
+  void release_slot(worker_slot* slot);
+
+  //!
+  //! work_stealing policy: delete the tasks left in the workers' deques, once all workers have been joined
+  //!
+  void clear_slots(void);
+
+  //!
+  //! work_stealing policy: slot owned by the current thread, if it is a worker of this pool
+  //! the current thread may be a worker of another pool (a callback of one pool calling run_pending_tasks or add_task on another one): its slot must not be used here
+  //!
+  //! \return slot of the current worker, null if the current thread is not a worker of this pool
+  //!
+  worker_slot* get_current_slot(void) const;
+
+  //!
+  //! slot owned by the current thread, if it is a work_stealing worker (of any pool)
+  //!
+  static thread_local worker_slot* s_current_slot;
+
+private:
+  //!
+  //! lock_free policy: enqueue a task, applying the overflow policy if the ring is full
+  //!
+  //! \param task task to be executed by the threadpool
+  //! \param prio priority class of the task (only used if the task is spilled)
+  //!
+  void add_task_lock_free(task_t&& task, priority prio);
+
+  //!
+  //! lock_free policy: enqueue a task, applying the overflow policy if the ring is full, without waking up any worker
+  //!
+  //! \param task task to be executed by the threadpool
+  //! \param prio priority class of the task (only used if the task is spilled)
+  //! \return false if the task has been rejected (reject overflow policy)
+  //!
+  bool push_task_lock_free(task_t&& task, priority prio);
+
+  //!
+  //! lock_free policy: retrieve a new task
+  //! pop from the ring, then from the spill queue, spin and finally park on the eventcount
+  //!
+  //! \return a pair <stopped, task>, see fetch_task_or_stop
+  //!
+  std::pair<bool, task_t> fetch_task_or_stop_lock_free(void);
+
+  //!
+  //! lock_free policy: try to retrieve a task without blocking
+  //!
+  //! \param task set to the retrieved task on success
+  //! \return whether a task has been retrieved
+  //!
+  bool try_fetch_task_lock_free(task_t& task);
+
+  //!
+  //! wake up all the workers, whatever they are parked on
+  //!
+  void notify_all_workers(void);
+
+  //!
+  //! wake up the workers needed to process a batch of tasks
+  //!
+  //! \param nb_tasks number of tasks in the batch
+  //!
+  void notify_workers(std::size_t nb_tasks);
+
 private:
   //!
   //! threads
@@ -149,9 +529,9 @@ private:
   std::atomic<bool> m_should_stop = ATOMIC_VAR_INIT(false);
 
   //!
-  //! tasks
+  //! tasks, one lane per priority class
   //!
-  std::queue<task_t> m_tasks;
+  priority_lanes<task_t, 3> m_tasks;
 
   //!
   //! tasks thread safety
@@ -162,6 +542,110 @@ private:
   //! task condvar to sync on tasks changes
   //!
   std::condition_variable m_tasks_condvar;
+
+  //!
+  //! cpus the workers are restricted to (empty: no restriction)
+  //!
+  cpu_list_t m_cpu_affinity;
+
+  //!
+  //! whether each worker is pinned to a single cpu
+  //!
+  bool m_pin_each_worker = false;
+
+  //!
+  //! ids of the workers that exited after the pool shrank, to be joined
+  //!
+  std::vector<std::thread::id> m_retired_workers;
+
+  //!
+  //! workers, retired workers & cpu affinity thread safety
+  //!
+  std::mutex m_workers_mtx;
+
+  //!
+  //! autoscaling: whether it is enabled
+  //!
+  std::atomic<bool> m_is_autoscaling = ATOMIC_VAR_INIT(false);
+
+  //!
+  //! autoscaling: number of tasks submitted and started, the difference being the number of queued tasks
+  //!
+  std::atomic<std::uint64_t> m_nb_submitted_tasks = ATOMIC_VAR_INIT(0);
+  std::atomic<std::uint64_t> m_nb_started_tasks   = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! autoscaling: total time spent executing tasks, in nanoseconds
+  //!
+  std::atomic<std::uint64_t> m_busy_time_ns = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! autoscaling: configuration, metrics and background thread
+  //!
+  autoscaling_config m_autoscaling_config;
+  autoscaling_metrics m_autoscaling_metrics;
+  std::thread m_autoscaler;
+
+  //!
+  //! autoscaling: thread safety & wake up of the background thread
+  //!
+  std::mutex m_autoscaling_mtx;
+  std::condition_variable m_autoscaling_condvar;
+
+  //!
+  //! scheduling policy
+  //!
+  scheduling_policy m_policy;
+
+  //!
+  //! work_stealing policy: workers slots
+  //!
+  std::unique_ptr<worker_slot[]> m_slots;
+
+  //!
+  //! work_stealing policy: number of slots ever used (upper bound of the slots to steal from)
+  //!
+  std::atomic<std::size_t> m_nb_used_slots = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! work_stealing and lock_free policies: number of tasks in m_tasks (injection queue or spill queue)
+  //!
+  std::atomic<std::size_t> m_nb_injected_tasks = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! work_stealing policy: number of tasks waiting for execution (injection queue and deques)
+  //!
+  std::atomic<std::size_t> m_nb_queued_tasks = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! work_stealing policy: number of parked workers
+  //!
+  std::atomic<std::size_t> m_nb_sleeping_threads = ATOMIC_VAR_INIT(0);
+
+  //!
+  //! lock_free policy: overflow policy
+  //!
+  overflow_policy m_overflow;
+
+  //!
+  //! lock_free policy: tasks ring
+  //!
+  std::unique_ptr<mpmc_queue<task_t>> m_queue;
+
+  //!
+  //! lock_free policy: parking of workers waiting for tasks
+  //!
+  event_count m_not_empty_event;
+
+  //!
+  //! lock_free policy: parking of producers waiting for a free cell (block overflow policy)
+  //!
+  event_count m_not_full_event;
+
+  //!
+  //! called once tasks have been enqueued
+  //!
+  task_added_handler_t m_task_added_handler;
 };
 
 } // namespace utils
@@ -0,0 +1,230 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifndef __TACOPIE_WORK_STEALING_DEQUE_INITIAL_CAPACITY
+#define __TACOPIE_WORK_STEALING_DEQUE_INITIAL_CAPACITY 256
+#endif /* __TACOPIE_WORK_STEALING_DEQUE_INITIAL_CAPACITY */
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! Chase-Lev work-stealing deque
+//!
+//! the owner thread pushes and pops at the bottom, other threads steal from the top
+//! push and pop are wait-free (except when the underlying array grows), steal is lock-free
+//!
+//! T must be trivially copyable (typically a pointer)
+//! arrays replaced when growing are kept until destruction, so that concurrent thieves never read freed memory
+//!
+template <typename T>
+class work_stealing_deque {
+public:
+  //! ctor
+  work_stealing_deque(void)
+  : m_top(0)
+  , m_bottom(0) {
+    m_arrays.emplace_back(new circular_array(__TACOPIE_WORK_STEALING_DEQUE_INITIAL_CAPACITY));
+    m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+  }
+
+  //! dtor
+  ~work_stealing_deque(void) = default;
+
+  //! copy ctor
+  work_stealing_deque(const work_stealing_deque&) = delete;
+  //! assignment operator
+  work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+public:
+  //!
+  //! push an element at the bottom of the deque
+  //! must only be called by the owner thread
+  //!
+  //! \param value element to be pushed
+  //!
+  void
+  push(T value) {
+    std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    std::int64_t top    = m_top.load(std::memory_order_acquire);
+    circular_array* a   = m_array.load(std::memory_order_relaxed);
+
+    if (bottom - top > static_cast<std::int64_t>(a->capacity()) - 1) {
+      a = grow(a, top, bottom);
+    }
+
+    a->put(bottom, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  //!
+  //! pop an element from the bottom of the deque
+  //! must only be called by the owner thread
+  //!
+  //! \param value set to the popped element on success
+  //! \return whether an element has been popped
+  //!
+  bool
+  pop(T& value) {
+    std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    circular_array* a   = m_array.load(std::memory_order_relaxed);
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      //! empty deque
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    value = a->get(bottom);
+
+    if (top == bottom) {
+      //! last element: race against thieves
+      bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      m_bottom.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+
+    return true;
+  }
+
+  //!
+  //! steal an element from the top of the deque
+  //! can be called by any thread
+  //!
+  //! \param value set to the stolen element on success
+  //! \return whether an element has been stolen (false if the deque is empty or if another thread won the race)
+  //!
+  bool
+  steal(T& value) {
+    std::int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) { return false; }
+
+    circular_array* a = m_array.load(std::memory_order_acquire);
+    value             = a->get(top);
+
+    return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+  //!
+  //! \return whether the deque looks empty (approximation when called concurrently)
+  //!
+  bool
+  empty(void) const {
+    return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+  }
+
+private:
+  //!
+  //! growable circular array of atomic slots
+  //!
+  class circular_array {
+  public:
+    //! ctor
+    explicit circular_array(std::size_t capacity)
+    : m_capacity(capacity)
+    , m_mask(capacity - 1)
+    , m_slots(new std::atomic<T>[capacity]) {}
+
+    //! \return capacity of the array (power of 2)
+    std::size_t
+    capacity(void) const {
+      return m_capacity;
+    }
+
+    //! \return element at the given logical index
+    T
+    get(std::int64_t index) const {
+      return m_slots[static_cast<std::size_t>(index) & m_mask].load(std::memory_order_relaxed);
+    }
+
+    //! store an element at the given logical index
+    void
+    put(std::int64_t index, T value) {
+      m_slots[static_cast<std::size_t>(index) & m_mask].store(value, std::memory_order_relaxed);
+    }
+
+  private:
+    //! capacity of the array
+    std::size_t m_capacity;
+    //! capacity - 1, used for wrapping indexes
+    std::size_t m_mask;
+    //! slots
+    std::unique_ptr<std::atomic<T>[]> m_slots;
+  };
+
+  //!
+  //! double the capacity of the array, copying the live elements
+  //! owner thread only
+  //!
+  circular_array*
+  grow(circular_array* a, std::int64_t top, std::int64_t bottom) {
+    m_arrays.emplace_back(new circular_array(a->capacity() * 2));
+    circular_array* new_array = m_arrays.back().get();
+
+    for (std::int64_t i = top; i < bottom; ++i) { new_array->put(i, a->get(i)); }
+
+    m_array.store(new_array, std::memory_order_release);
+
+    return new_array;
+  }
+
+private:
+  //!
+  //! index of the next element to be stolen
+  //!
+  std::atomic<std::int64_t> m_top;
+
+  //!
+  //! index of the next element to be pushed
+  //!
+  std::atomic<std::int64_t> m_bottom;
+
+  //!
+  //! current array
+  //!
+  std::atomic<circular_array*> m_array;
+
+  //!
+  //! all the arrays ever allocated (owner thread only)
+  //!
+  std::vector<std::unique_ptr<circular_array>> m_arrays;
+};
+
+} // namespace utils
+
+} // namespace tacopie
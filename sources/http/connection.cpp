@@ -0,0 +1,177 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/http/connection.hpp>
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/logger.hpp>
+
+#include <cstring>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! ctor
+//!
+
+connection::connection(const std::shared_ptr<tcp_client>& client, const request_handler_t& request_handler, const close_handler_t& close_handler)
+: m_client(client)
+, m_request_handler(request_handler)
+, m_close_handler(close_handler) {
+  __TACOPIE_LOG(debug, "create http connection");
+}
+
+//!
+//! connection lifecycle
+//!
+
+void
+connection::start(void) {
+  //! weak reference: the client must not keep the connection alive
+  std::weak_ptr<connection> weak_self = shared_from_this();
+
+  m_client->set_on_disconnection_handler([weak_self] {
+    auto self = weak_self.lock();
+    if (self) { self->close(); }
+  });
+
+  async_read();
+}
+
+void
+connection::close(void) {
+  if (m_is_closed.exchange(true)) { return; }
+
+  __TACOPIE_LOG(debug, "close http connection");
+
+  m_client->disconnect();
+
+  if (m_close_handler) { m_close_handler(shared_from_this()); }
+}
+
+const std::shared_ptr<tcp_client>&
+connection::get_client(void) const {
+  return m_client;
+}
+
+//!
+//! read & handle requests
+//!
+
+void
+connection::async_read(void) {
+  try {
+    m_client->async_read({__TACOPIE_HTTP_READ_SIZE, std::bind(&connection::on_read, shared_from_this(), std::placeholders::_1)});
+  }
+  catch (const tacopie_error&) {
+    close();
+  }
+}
+
+void
+connection::on_read(tcp_client::read_result& result) {
+  if (!result.success) {
+    close();
+    return;
+  }
+
+  m_parser.feed(std::move(result.buffer));
+
+  //! handle all the pipelined requests received so far
+  while (true) {
+    switch (m_parser.parse(m_request)) {
+    case request_parser::status::complete: break;
+    case request_parser::status::incomplete: async_read(); return;
+    case request_parser::status::bad_request: send_error(400); return;
+    case request_parser::status::header_too_large: send_error(431); return;
+    case request_parser::status::payload_too_large: send_error(413); return;
+    case request_parser::status::not_implemented: send_error(501); return;
+    }
+
+    response res;
+
+    try {
+      m_request_handler(m_request, res);
+    }
+    catch (const std::exception&) {
+      __TACOPIE_LOG(warn, "http request handler raised an exception");
+      res = response();
+      res.set_status(500);
+    }
+
+    const auto& method = m_request.get_method();
+    bool is_head       = method.size == 4 && std::memcmp(method.data, "HEAD", 4) == 0;
+    bool keep_alive    = m_request.keep_alive();
+
+    send_response(res, !is_head, keep_alive);
+
+    if (!keep_alive) { return; }
+  }
+}
+
+//!
+//! send responses
+//!
+
+void
+connection::send_response(response& response, bool send_body, bool keep_alive) {
+  auto head = response.build_head(m_request.get_version_minor(), keep_alive);
+
+  tcp_client::async_write_callback_t on_sent = nullptr;
+  if (!keep_alive) { on_sent = std::bind(&connection::on_last_write, shared_from_this(), std::placeholders::_1); }
+
+  try {
+    if (!send_body || response.get_body().empty()) {
+      m_client->async_write({std::move(head), on_sent});
+    }
+    else {
+      //! both requests are queued back to back: tcp_client coalesces them in a single gather write
+      m_client->async_write({std::move(head), nullptr});
+      m_client->async_write({std::move(response.get_body()), on_sent});
+    }
+  }
+  catch (const tacopie_error&) {
+    close();
+  }
+}
+
+void
+connection::send_error(unsigned int status) {
+  __TACOPIE_LOG(warn, "invalid http request");
+
+  response res;
+  res.set_status(status);
+
+  m_request.reset();
+  send_response(res, false, false);
+}
+
+void
+connection::on_last_write(tcp_client::write_result&) {
+  close();
+}
+
+} // namespace http
+
+} // namespace tacopie
@@ -0,0 +1,152 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/http/request.hpp>
+
+#include <cctype>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! slice
+//!
+
+std::string
+slice::to_string(void) const {
+  return data ? std::string(data, size) : std::string();
+}
+
+bool
+slice::iequals(const char* str) const {
+  std::size_t i = 0;
+
+  for (; i < size && str[i]; ++i) {
+    if (std::tolower(static_cast<unsigned char>(data[i])) != std::tolower(static_cast<unsigned char>(str[i]))) { return false; }
+  }
+
+  return i == size && !str[i];
+}
+
+//!
+//! ctor
+//!
+
+request::request(void) {
+  reset();
+}
+
+void
+request::reset(void) {
+  m_method        = {nullptr, 0};
+  m_target        = {nullptr, 0};
+  m_version_minor = 1;
+  m_nb_headers    = 0;
+  m_body          = {nullptr, 0};
+  m_keep_alive    = true;
+}
+
+//!
+//! setters
+//!
+
+void
+request::set_request_line(const slice& method, const slice& target, unsigned int version_minor) {
+  m_method        = method;
+  m_target        = target;
+  m_version_minor = version_minor;
+}
+
+bool
+request::add_header(const slice& name, const slice& value) {
+  if (m_nb_headers == __TACOPIE_HTTP_MAX_HEADERS) { return false; }
+
+  m_headers[m_nb_headers].name  = name;
+  m_headers[m_nb_headers].value = value;
+  ++m_nb_headers;
+
+  return true;
+}
+
+void
+request::set_body(const slice& body) {
+  m_body = body;
+}
+
+void
+request::set_keep_alive(bool keep_alive) {
+  m_keep_alive = keep_alive;
+}
+
+//!
+//! getters
+//!
+
+const slice&
+request::get_method(void) const {
+  return m_method;
+}
+
+const slice&
+request::get_target(void) const {
+  return m_target;
+}
+
+unsigned int
+request::get_version_minor(void) const {
+  return m_version_minor;
+}
+
+std::size_t
+request::get_nb_headers(void) const {
+  return m_nb_headers;
+}
+
+const request::header&
+request::get_header(std::size_t index) const {
+  return m_headers[index];
+}
+
+const slice*
+request::find_header(const char* name) const {
+  for (std::size_t i = 0; i < m_nb_headers; ++i) {
+    if (m_headers[i].name.iequals(name)) { return &m_headers[i].value; }
+  }
+
+  return nullptr;
+}
+
+const slice&
+request::get_body(void) const {
+  return m_body;
+}
+
+bool
+request::keep_alive(void) const {
+  return m_keep_alive;
+}
+
+} // namespace http
+
+} // namespace tacopie
@@ -0,0 +1,293 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/http/request_parser.hpp>
+
+#include <cstring>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! helpers
+//!
+
+static bool
+is_whitespace(char c) {
+  return c == ' ' || c == '\t';
+}
+
+static bool
+is_token_char(char c) {
+  return c > 32 && c < 127 && !std::strchr("()<>@,;:\\\"/[]?={}", c);
+}
+
+//!
+//! \return whether the comma-separated list contains the given token (case insensitive)
+//!
+static bool
+list_contains(const slice& list, const char* token) {
+  std::size_t token_size = std::strlen(token);
+  std::size_t i          = 0;
+
+  while (i < list.size) {
+    while (i < list.size && (is_whitespace(list.data[i]) || list.data[i] == ',')) { ++i; }
+
+    std::size_t begin = i;
+    while (i < list.size && list.data[i] != ',') { ++i; }
+
+    std::size_t end = i;
+    while (end > begin && is_whitespace(list.data[end - 1])) { --end; }
+
+    slice item = {list.data + begin, end - begin};
+    if (item.size == token_size && item.iequals(token)) { return true; }
+  }
+
+  return false;
+}
+
+//!
+//! ctor
+//!
+
+request_parser::request_parser(void)
+: m_offset(0)
+, m_scanned(0)
+, m_needed(0) {}
+
+//!
+//! feed bytes
+//!
+
+void
+request_parser::feed(std::vector<char>&& buffer) {
+  if (m_offset == m_buffer.size()) {
+    //! nothing pending: take ownership of the received buffer
+    m_buffer  = std::move(buffer);
+    m_offset  = 0;
+    m_scanned = 0;
+    m_needed  = 0;
+    return;
+  }
+
+  feed(buffer.data(), buffer.size());
+}
+
+void
+request_parser::feed(const char* data, std::size_t size) {
+  //! discard consumed bytes, only the pending partial request is moved
+  if (m_offset > 0) {
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_offset);
+    m_scanned = m_scanned > m_offset ? m_scanned - m_offset : 0;
+    m_needed  = m_needed > m_offset ? m_needed - m_offset : 0;
+    m_offset  = 0;
+  }
+
+  m_buffer.insert(m_buffer.end(), data, data + size);
+}
+
+void
+request_parser::reset(void) {
+  m_buffer.clear();
+  m_offset  = 0;
+  m_scanned = 0;
+  m_needed  = 0;
+}
+
+//!
+//! parse requests
+//!
+
+bool
+request_parser::find_head_end(std::size_t& head_end) {
+  std::size_t pos = m_scanned > m_offset + 3 ? m_scanned - 3 : m_offset;
+  std::size_t end = m_buffer.size();
+
+  while (pos + 3 < end) {
+    const char* cr = static_cast<const char*>(std::memchr(m_buffer.data() + pos, '\r', end - pos - 3));
+
+    if (!cr) { break; }
+
+    pos = cr - m_buffer.data();
+
+    if (m_buffer[pos + 1] == '\n' && m_buffer[pos + 2] == '\r' && m_buffer[pos + 3] == '\n') {
+      head_end = pos + 4;
+      return true;
+    }
+
+    ++pos;
+  }
+
+  m_scanned = end;
+  return false;
+}
+
+request_parser::status
+request_parser::parse(request& request) {
+  if (m_buffer.size() < m_needed) { return status::incomplete; }
+
+  //! empty lines preceding the request line are tolerated: consume them
+  //! otherwise, the first CRLF CRLF sequence would be taken for the end of the header section
+  if (!m_needed) {
+    while (m_offset + 1 < m_buffer.size() && m_buffer[m_offset] == '\r' && m_buffer[m_offset + 1] == '\n') { m_offset += 2; }
+    if (m_scanned < m_offset) { m_scanned = m_offset; }
+  }
+
+  if (m_offset == m_buffer.size()) { return status::incomplete; }
+
+  std::size_t head_end;
+  if (!find_head_end(head_end)) {
+    return m_buffer.size() - m_offset > __TACOPIE_HTTP_MAX_HEADER_SIZE ? status::header_too_large : status::incomplete;
+  }
+
+  if (head_end - m_offset > __TACOPIE_HTTP_MAX_HEADER_SIZE) { return status::header_too_large; }
+
+  std::size_t content_length = 0;
+  status head_status         = parse_head(head_end, request, content_length);
+  if (head_status != status::complete) { return head_status; }
+
+  //! wait for the full body, without parsing the header section again until then
+  std::size_t request_end = head_end + content_length;
+  if (request_end > m_buffer.size()) {
+    m_needed = request_end;
+    return status::incomplete;
+  }
+
+  request.set_body({m_buffer.data() + head_end, content_length});
+
+  m_offset  = request_end;
+  m_scanned = request_end;
+  m_needed  = 0;
+
+  return status::complete;
+}
+
+bool
+request_parser::parse_request_line(std::size_t begin, std::size_t end, request& request) {
+  const char* line = m_buffer.data();
+
+  //! method
+  std::size_t method_end = begin;
+  while (method_end < end && is_token_char(line[method_end])) { ++method_end; }
+  if (method_end == begin || method_end == end || line[method_end] != ' ') { return false; }
+
+  //! target
+  std::size_t target_begin = method_end + 1;
+  std::size_t target_end   = target_begin;
+  while (target_end < end && line[target_end] > 32 && line[target_end] != 127) { ++target_end; }
+  if (target_end == target_begin || target_end == end || line[target_end] != ' ') { return false; }
+
+  //! version: HTTP/1.x
+  std::size_t version_begin = target_end + 1;
+  if (end - version_begin != 8 || std::memcmp(line + version_begin, "HTTP/1.", 7) != 0) { return false; }
+
+  char minor = line[version_begin + 7];
+  if (minor != '0' && minor != '1') { return false; }
+
+  request.set_request_line({line + begin, method_end - begin}, {line + target_begin, target_end - target_begin}, static_cast<unsigned int>(minor - '0'));
+
+  return true;
+}
+
+request_parser::status
+request_parser::parse_head(std::size_t head_end, request& request, std::size_t& content_length) {
+  const char* data = m_buffer.data();
+
+  request.reset();
+  content_length = 0;
+
+  //! request line (leading empty lines have already been consumed)
+  std::size_t pos = m_offset;
+
+  const char* cr = static_cast<const char*>(std::memchr(data + pos, '\r', head_end - pos));
+  if (!cr || cr[1] != '\n') { return status::bad_request; }
+
+  std::size_t line_end = cr - data;
+  if (!parse_request_line(pos, line_end, request)) { return status::bad_request; }
+
+  bool keep_alive          = request.get_version_minor() == 1;
+  bool has_content_length  = false;
+  bool has_transfer_coding = false;
+
+  //! header fields, up to the empty line
+  for (pos = line_end + 2; pos < head_end - 2; pos = line_end + 2) {
+    line_end = static_cast<const char*>(std::memchr(data + pos, '\r', head_end - pos)) - data;
+
+    if (data[line_end + 1] != '\n') { return status::bad_request; }
+
+    //! field name (obsolete line folding is rejected)
+    std::size_t name_end = pos;
+    while (name_end < line_end && is_token_char(data[name_end])) { ++name_end; }
+    if (name_end == pos || name_end == line_end || data[name_end] != ':') { return status::bad_request; }
+
+    //! field value, trimmed
+    std::size_t value_begin = name_end + 1;
+    std::size_t value_end   = line_end;
+    while (value_begin < value_end && is_whitespace(data[value_begin])) { ++value_begin; }
+    while (value_end > value_begin && is_whitespace(data[value_end - 1])) { --value_end; }
+
+    slice name  = {data + pos, name_end - pos};
+    slice value = {data + value_begin, value_end - value_begin};
+
+    if (!request.add_header(name, value)) { return status::header_too_large; }
+
+    if (name.iequals("content-length")) {
+      if (value.size == 0 || has_content_length) { return status::bad_request; }
+
+      for (std::size_t i = 0; i < value.size; ++i) {
+        if (value.data[i] < '0' || value.data[i] > '9') { return status::bad_request; }
+
+        //! bounded as each digit is accumulated, so the value can never overflow
+        std::size_t digit = static_cast<std::size_t>(value.data[i] - '0');
+        if (content_length > (__TACOPIE_HTTP_MAX_BODY_SIZE - digit) / 10) { return status::payload_too_large; }
+
+        content_length = content_length * 10 + digit;
+      }
+
+      has_content_length = true;
+    }
+    else if (name.iequals("transfer-encoding")) {
+      has_transfer_coding = true;
+    }
+    else if (name.iequals("connection")) {
+      if (list_contains(value, "close")) {
+        keep_alive = false;
+      }
+      else if (list_contains(value, "keep-alive")) {
+        keep_alive = true;
+      }
+    }
+  }
+
+  //! chunked request bodies are not supported
+  if (has_transfer_coding) { return status::not_implemented; }
+
+  request.set_keep_alive(keep_alive);
+
+  return status::complete;
+}
+
+} // namespace http
+
+} // namespace tacopie
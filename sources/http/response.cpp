@@ -0,0 +1,193 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/http/response.hpp>
+
+#include <cstring>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! helpers
+//!
+
+static void
+append(std::vector<char>& buffer, const char* str, std::size_t size) {
+  buffer.insert(buffer.end(), str, str + size);
+}
+
+static void
+append(std::vector<char>& buffer, const char* str) {
+  append(buffer, str, std::strlen(str));
+}
+
+static void
+append_number(std::vector<char>& buffer, std::size_t value) {
+  char digits[24];
+  std::size_t nb = 0;
+
+  do {
+    digits[nb++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  while (nb) { buffer.push_back(digits[--nb]); }
+}
+
+//!
+//! ctor
+//!
+
+response::response(void)
+: m_status(200)
+, m_reason(get_reason_phrase(200)) {}
+
+//!
+//! setters
+//!
+
+void
+response::set_status(unsigned int status) {
+  set_status(status, get_reason_phrase(status));
+}
+
+void
+response::set_status(unsigned int status, const std::string& reason) {
+  m_status = status;
+  m_reason = reason;
+}
+
+void
+response::add_header(const std::string& name, const std::string& value) {
+  append(m_headers, name.data(), name.size());
+  append(m_headers, ": ", 2);
+  append(m_headers, value.data(), value.size());
+  append(m_headers, "\r\n", 2);
+}
+
+void
+response::set_body(const std::string& body) {
+  m_body.assign(body.begin(), body.end());
+}
+
+void
+response::set_body(std::vector<char>&& body) {
+  m_body = std::move(body);
+}
+
+//!
+//! getters
+//!
+
+unsigned int
+response::get_status(void) const {
+  return m_status;
+}
+
+std::vector<char>&
+response::get_body(void) {
+  return m_body;
+}
+
+const std::vector<char>&
+response::get_body(void) const {
+  return m_body;
+}
+
+//!
+//! serialization
+//!
+
+std::vector<char>
+response::build_head(unsigned int version_minor, bool keep_alive) const {
+  std::vector<char> head;
+  head.reserve(128 + m_reason.size() + m_headers.size());
+
+  //! status line
+  append(head, version_minor == 0 ? "HTTP/1.0 " : "HTTP/1.1 ", 9);
+  append_number(head, m_status);
+  head.push_back(' ');
+  append(head, m_reason.data(), m_reason.size());
+  append(head, "\r\n", 2);
+
+  //! user header fields
+  head.insert(head.end(), m_headers.begin(), m_headers.end());
+
+  //! managed header fields
+  append(head, "Content-Length: ");
+  append_number(head, m_body.size());
+  append(head, "\r\n", 2);
+
+  if (!keep_alive) {
+    append(head, "Connection: close\r\n");
+  }
+  else if (version_minor == 0) {
+    append(head, "Connection: keep-alive\r\n");
+  }
+
+  append(head, "\r\n", 2);
+
+  return head;
+}
+
+const char*
+response::get_reason_phrase(unsigned int status) {
+  switch (status) {
+  case 100: return "Continue";
+  case 101: return "Switching Protocols";
+  case 200: return "OK";
+  case 201: return "Created";
+  case 202: return "Accepted";
+  case 204: return "No Content";
+  case 206: return "Partial Content";
+  case 301: return "Moved Permanently";
+  case 302: return "Found";
+  case 304: return "Not Modified";
+  case 307: return "Temporary Redirect";
+  case 308: return "Permanent Redirect";
+  case 400: return "Bad Request";
+  case 401: return "Unauthorized";
+  case 403: return "Forbidden";
+  case 404: return "Not Found";
+  case 405: return "Method Not Allowed";
+  case 408: return "Request Timeout";
+  case 409: return "Conflict";
+  case 411: return "Length Required";
+  case 413: return "Payload Too Large";
+  case 414: return "URI Too Long";
+  case 429: return "Too Many Requests";
+  case 431: return "Request Header Fields Too Large";
+  case 500: return "Internal Server Error";
+  case 501: return "Not Implemented";
+  case 502: return "Bad Gateway";
+  case 503: return "Service Unavailable";
+  case 504: return "Gateway Timeout";
+  default: return "Unknown";
+  }
+}
+
+} // namespace http
+
+} // namespace tacopie
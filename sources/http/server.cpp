@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/http/server.hpp>
+#include <tacopie/utils/logger.hpp>
+
+namespace tacopie {
+
+namespace http {
+
+//!
+//! ctor & dtor
+//!
+
+server::server(void)
+: m_request_handler(nullptr) {
+  __TACOPIE_LOG(debug, "create http server");
+}
+
+server::server(const std::shared_ptr<tacopie::io_service>& io_service)
+: m_server(io_service)
+, m_request_handler(nullptr) {
+  __TACOPIE_LOG(debug, "create http server");
+}
+
+server::~server(void) {
+  __TACOPIE_LOG(debug, "destroy http server");
+
+  //! connections reference this instance in their close handler: wait for all of them
+  stop(true, true);
+}
+
+//!
+//! start & stop
+//!
+
+void
+server::start(const std::string& host, std::uint32_t port, const request_handler_t& request_handler) {
+  m_request_handler = request_handler;
+  m_server.start(host, port, std::bind(&server::on_new_connection, this, std::placeholders::_1));
+
+  __TACOPIE_LOG(info, "http server running");
+}
+
+void
+server::stop(bool wait_for_removal, bool recursive_wait_for_removal) {
+  //! stop accepting connections first
+  m_server.stop(wait_for_removal, recursive_wait_for_removal);
+
+  std::unordered_set<std::shared_ptr<connection>> connections;
+
+  {
+    std::lock_guard<std::mutex> lock(m_connections_mtx);
+    std::swap(connections, m_connections);
+  }
+
+  for (const auto& connection : connections) {
+    connection->get_client()->disconnect(wait_for_removal && recursive_wait_for_removal);
+    connection->close();
+  }
+}
+
+bool
+server::is_running(void) const {
+  return m_server.is_running();
+}
+
+std::size_t
+server::get_nb_connections(void) const {
+  std::lock_guard<std::mutex> lock(m_connections_mtx);
+
+  return m_connections.size();
+}
+
+tcp_server&
+server::get_tcp_server(void) {
+  return m_server;
+}
+
+//!
+//! connections handling
+//!
+
+bool
+server::on_new_connection(const std::shared_ptr<tcp_client>& client) {
+  auto conn = std::make_shared<connection>(client, m_request_handler, std::bind(&server::on_connection_closed, this, std::placeholders::_1));
+
+  {
+    std::lock_guard<std::mutex> lock(m_connections_mtx);
+    m_connections.insert(conn);
+  }
+
+  conn->start();
+
+  return true;
+}
+
+void
+server::on_connection_closed(const std::shared_ptr<connection>& connection) {
+  std::lock_guard<std::mutex> lock(m_connections_mtx);
+
+  m_connections.erase(connection);
+}
+
+} // namespace http
+
+} // namespace tacopie
@@ -46,6 +46,7 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -57,6 +58,12 @@
 #define SOCKET_ERROR -1
 #endif /* SOCKET_ERROR */
 
+#if _WIN32
+#define __TACOPIE_LAST_ERROR WSAGetLastError()
+#else
+#define __TACOPIE_LAST_ERROR errno
+#endif /* _WIN32 */
+
 #if _WIN32
 #define __TACOPIE_LENGTH(size) static_cast<int>(size) // for Windows, convert buffer size to `int`
 #pragma warning(disable : 4996)                       // for Windows, `inet_ntoa` is deprecated as it does not support IPv6
@@ -64,6 +71,13 @@
 #define __TACOPIE_LENGTH(size) size // for Unix, keep buffer size as `size_t`
 #endif                              /* _WIN32 */
 
+//! writing to a connection reset by the peer fails with EPIPE instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define __TACOPIE_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define __TACOPIE_SEND_FLAGS 0
+#endif /* MSG_NOSIGNAL */
+
 namespace tacopie {
 
 //!
@@ -74,7 +88,8 @@ tcp_socket::tcp_socket(void)
 : m_fd(__TACOPIE_INVALID_FD)
 , m_host("")
 , m_port(0)
-, m_type(type::UNKNOWN) { __TACOPIE_LOG(debug, "create tcp_socket"); }
+, m_type(type::UNKNOWN)
+, m_splice_pipe{-1, -1, -1, 0, 0} { __TACOPIE_LOG(debug, "create tcp_socket"); }
 
 //!
 //! custom ctor
@@ -85,7 +100,8 @@ tcp_socket::tcp_socket(fd_t fd, const std::string& host, std::uint32_t port, typ
 : m_fd(fd)
 , m_host(host)
 , m_port(port)
-, m_type(t) { __TACOPIE_LOG(debug, "create tcp_socket"); }
+, m_type(t)
+, m_splice_pipe{-1, -1, -1, 0, 0} { __TACOPIE_LOG(debug, "create tcp_socket"); }
 
 //!
 //! Move constructor
@@ -95,13 +111,35 @@ tcp_socket::tcp_socket(tcp_socket&& socket)
 : m_fd(std::move(socket.m_fd))
 , m_host(socket.m_host)
 , m_port(socket.m_port)
-, m_type(socket.m_type) {
-  socket.m_fd   = __TACOPIE_INVALID_FD;
-  socket.m_type = type::UNKNOWN;
+, m_type(socket.m_type)
+, m_splice_pipe(socket.m_splice_pipe) {
+  socket.m_fd          = __TACOPIE_INVALID_FD;
+  socket.m_type        = type::UNKNOWN;
+  socket.m_splice_pipe = {-1, -1, -1, 0, 0};
 
   __TACOPIE_LOG(debug, "moved tcp_socket");
 }
 
+tcp_socket&
+tcp_socket::operator=(tcp_socket&& socket) {
+  if (this == &socket) { return *this; }
+
+  //! the pipe belongs to the replaced socket: nothing will ever be sent from it
+  close_splice_pipe();
+
+  m_fd          = socket.m_fd;
+  m_host        = std::move(socket.m_host);
+  m_port        = socket.m_port;
+  m_type        = socket.m_type;
+  m_splice_pipe = socket.m_splice_pipe;
+
+  socket.m_fd          = __TACOPIE_INVALID_FD;
+  socket.m_type        = type::UNKNOWN;
+  socket.m_splice_pipe = {-1, -1, -1, 0, 0};
+
+  return *this;
+}
+
 //!
 //! client socket operations
 //!
@@ -113,27 +151,72 @@ tcp_socket::recv(std::size_t size_to_read) {
 
   std::vector<char> data(size_to_read, 0);
 
-  ssize_t rd_size = ::recv(m_fd, const_cast<char*>(data.data()), __TACOPIE_LENGTH(size_to_read), 0);
+  io_result result = recv(data.data(), size_to_read, std::nothrow, false);
 
-  if (rd_size == SOCKET_ERROR) { __TACOPIE_THROW(error, "recv() failure"); }
+  if (result.error) { __TACOPIE_THROW(error, "recv() failure"); }
 
-  if (rd_size == 0) { __TACOPIE_THROW(warn, "nothing to read, socket has been closed by remote host"); }
+  if (result.eof) { __TACOPIE_THROW(warn, "nothing to read, socket has been closed by remote host"); }
 
-  data.resize(rd_size);
+  data.resize(result.size);
 
   return data;
 }
 
+tcp_socket::io_result
+tcp_socket::recv(char* buffer, std::size_t size_to_read, std::nothrow_t, bool non_blocking) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  io_result result = {0, 0, false};
+
+#ifdef MSG_DONTWAIT
+  int flags = non_blocking ? MSG_DONTWAIT : 0;
+#else
+  (void) non_blocking;
+  int flags = 0;
+#endif /* MSG_DONTWAIT */
+
+  ssize_t rd_size = ::recv(m_fd, buffer, __TACOPIE_LENGTH(size_to_read), flags);
+
+  if (rd_size == SOCKET_ERROR) {
+    result.error = __TACOPIE_LAST_ERROR;
+  }
+  else if (rd_size == 0 && size_to_read > 0) {
+    result.eof = true;
+  }
+  else {
+    result.size = rd_size;
+  }
+
+  return result;
+}
+
 std::size_t
 tcp_socket::send(const std::vector<char>& data, std::size_t size_to_write) {
+  io_result result = send(data.data(), size_to_write, std::nothrow);
+
+  if (result.error) { __TACOPIE_THROW(error, "send() failure"); }
+
+  return result.size;
+}
+
+tcp_socket::io_result
+tcp_socket::send(const char* data, std::size_t size_to_write, std::nothrow_t) {
   create_socket_if_necessary();
   check_or_set_type(type::CLIENT);
 
-  ssize_t wr_size = ::send(m_fd, data.data(), __TACOPIE_LENGTH(size_to_write), 0);
+  io_result result = {0, 0, false};
 
-  if (wr_size == SOCKET_ERROR) { __TACOPIE_THROW(error, "send() failure"); }
+  ssize_t wr_size = ::send(m_fd, data, __TACOPIE_LENGTH(size_to_write), __TACOPIE_SEND_FLAGS);
 
-  return wr_size;
+  if (wr_size == SOCKET_ERROR) {
+    result.error = __TACOPIE_LAST_ERROR;
+  }
+  else {
+    result.size = wr_size;
+  }
+
+  return result;
 }
 
 //!
@@ -150,6 +233,16 @@ tcp_socket::listen(std::size_t max_connection_queue) {
 
 tcp_socket
 tcp_socket::accept(void) {
+  int error;
+  tcp_socket client = accept(std::nothrow, error);
+
+  if (error) { __TACOPIE_THROW(error, "accept() failure"); }
+
+  return client;
+}
+
+tcp_socket
+tcp_socket::accept(std::nothrow_t, int& error) {
   create_socket_if_necessary();
   check_or_set_type(type::SERVER);
 
@@ -158,7 +251,18 @@ tcp_socket::accept(void) {
 
   fd_t client_fd = ::accept(m_fd, reinterpret_cast<struct sockaddr*>(&ss), &addrlen);
 
-  if (client_fd == __TACOPIE_INVALID_FD) { __TACOPIE_THROW(error, "accept() failure"); }
+  if (client_fd == __TACOPIE_INVALID_FD) {
+    error = __TACOPIE_LAST_ERROR;
+    return tcp_socket();
+  }
+
+  error = 0;
+
+#if !defined(_WIN32) && !defined(__linux__)
+  //! BSD systems propagate O_NONBLOCK from the server socket (set when it is shared between processes): accepted sockets are blocking
+  int fd_flags = ::fcntl(client_fd, F_GETFL, 0);
+  if (fd_flags != -1 && (fd_flags & O_NONBLOCK)) { ::fcntl(client_fd, F_SETFL, fd_flags & ~O_NONBLOCK); }
+#endif /* !_WIN32 && !__linux__ */
 
   //! now determine host and port based on socket type
   std::string saddr;
@@ -191,6 +295,177 @@ tcp_socket::accept(void) {
   return {client_fd, saddr, port, type::CLIENT};
 }
 
+//!
+//! shutdown
+//!
+
+void
+tcp_socket::shutdown(shutdown_type how) {
+  if (m_fd == __TACOPIE_INVALID_FD) { __TACOPIE_THROW(error, "shutdown() failure: socket not created"); }
+
+#ifdef _WIN32
+  int native_how = how == shutdown_type::READ ? SD_RECEIVE : how == shutdown_type::WRITE ? SD_SEND : SD_BOTH;
+#else
+  int native_how = how == shutdown_type::READ ? SHUT_RD : how == shutdown_type::WRITE ? SHUT_WR : SHUT_RDWR;
+#endif /* _WIN32 */
+
+  if (::shutdown(m_fd, native_how) == SOCKET_ERROR) { __TACOPIE_THROW(error, "shutdown() failure"); }
+}
+
+//!
+//! socket options
+//!
+
+static void
+set_int_option(fd_t fd, int level, int name, int value, const std::string& option) {
+  if (fd == __TACOPIE_INVALID_FD) { __TACOPIE_THROW(error, "setsockopt(" + option + ") failure: socket not created"); }
+
+  if (::setsockopt(fd, level, name, reinterpret_cast<const char*>(&value), sizeof(value)) == SOCKET_ERROR) { __TACOPIE_THROW(error, "setsockopt(" + option + ") failure"); }
+}
+
+//! 0 keeps the system default
+static void
+set_keepalive_timings(fd_t fd, std::uint32_t idle_secs, std::uint32_t interval_secs, std::uint32_t count) {
+  if (idle_secs) {
+#if defined(TCP_KEEPIDLE)
+    set_int_option(fd, IPPROTO_TCP, TCP_KEEPIDLE, static_cast<int>(idle_secs), "TCP_KEEPIDLE");
+#elif defined(TCP_KEEPALIVE)
+    //! apple equivalent of TCP_KEEPIDLE
+    set_int_option(fd, IPPROTO_TCP, TCP_KEEPALIVE, static_cast<int>(idle_secs), "TCP_KEEPALIVE");
+#else
+    __TACOPIE_THROW(error, "TCP_KEEPIDLE not supported on this platform");
+#endif /* TCP_KEEPIDLE */
+  }
+
+  if (interval_secs) {
+#ifdef TCP_KEEPINTVL
+    set_int_option(fd, IPPROTO_TCP, TCP_KEEPINTVL, static_cast<int>(interval_secs), "TCP_KEEPINTVL");
+#else
+    __TACOPIE_THROW(error, "TCP_KEEPINTVL not supported on this platform");
+#endif /* TCP_KEEPINTVL */
+  }
+
+  if (count) {
+#ifdef TCP_KEEPCNT
+    set_int_option(fd, IPPROTO_TCP, TCP_KEEPCNT, static_cast<int>(count), "TCP_KEEPCNT");
+#else
+    __TACOPIE_THROW(error, "TCP_KEEPCNT not supported on this platform");
+#endif /* TCP_KEEPCNT */
+  }
+}
+
+void
+tcp_socket::set_nodelay(bool enabled) {
+  set_int_option(m_fd, IPPROTO_TCP, TCP_NODELAY, enabled ? 1 : 0, "TCP_NODELAY");
+}
+
+void
+tcp_socket::set_send_buffer_size(std::size_t size) {
+  set_int_option(m_fd, SOL_SOCKET, SO_SNDBUF, static_cast<int>(size), "SO_SNDBUF");
+}
+
+void
+tcp_socket::set_receive_buffer_size(std::size_t size) {
+  set_int_option(m_fd, SOL_SOCKET, SO_RCVBUF, static_cast<int>(size), "SO_RCVBUF");
+}
+
+void
+tcp_socket::set_keepalive(bool enabled, std::uint32_t idle_secs, std::uint32_t interval_secs, std::uint32_t count) {
+  set_int_option(m_fd, SOL_SOCKET, SO_KEEPALIVE, enabled ? 1 : 0, "SO_KEEPALIVE");
+
+  if (enabled) { set_keepalive_timings(m_fd, idle_secs, interval_secs, count); }
+}
+
+void
+tcp_socket::set_quickack(bool enabled) {
+#ifdef TCP_QUICKACK
+  set_int_option(m_fd, IPPROTO_TCP, TCP_QUICKACK, enabled ? 1 : 0, "TCP_QUICKACK");
+#else
+  (void) enabled;
+  __TACOPIE_THROW(error, "TCP_QUICKACK not supported on this platform");
+#endif /* TCP_QUICKACK */
+}
+
+void
+tcp_socket::set_notsent_lowat(std::size_t size) {
+#ifdef TCP_NOTSENT_LOWAT
+  set_int_option(m_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, static_cast<int>(size), "TCP_NOTSENT_LOWAT");
+#else
+  (void) size;
+  __TACOPIE_THROW(error, "TCP_NOTSENT_LOWAT not supported on this platform");
+#endif /* TCP_NOTSENT_LOWAT */
+}
+
+void
+tcp_socket::set_user_timeout(std::uint32_t timeout_msecs) {
+#ifdef TCP_USER_TIMEOUT
+  set_int_option(m_fd, IPPROTO_TCP, TCP_USER_TIMEOUT, static_cast<int>(timeout_msecs), "TCP_USER_TIMEOUT");
+#else
+  (void) timeout_msecs;
+  __TACOPIE_THROW(error, "TCP_USER_TIMEOUT not supported on this platform");
+#endif /* TCP_USER_TIMEOUT */
+}
+
+void
+tcp_socket::set_busy_poll(std::uint32_t usecs) {
+#ifdef SO_BUSY_POLL
+  set_int_option(m_fd, SOL_SOCKET, SO_BUSY_POLL, static_cast<int>(usecs), "SO_BUSY_POLL");
+#else
+  (void) usecs;
+  __TACOPIE_THROW(error, "SO_BUSY_POLL not supported on this platform");
+#endif /* SO_BUSY_POLL */
+}
+
+void
+tcp_socket::set_zerocopy(bool enabled) {
+#ifdef SO_ZEROCOPY
+  set_int_option(m_fd, SOL_SOCKET, SO_ZEROCOPY, enabled ? 1 : 0, "SO_ZEROCOPY");
+#else
+  (void) enabled;
+  __TACOPIE_THROW(error, "SO_ZEROCOPY not supported on this platform");
+#endif /* SO_ZEROCOPY */
+}
+
+//!
+//! apply a single option of set_options: its failure is logged and recorded instead of being propagated
+//!
+template <typename F>
+static void
+apply_option(bool is_set, const char* option, F&& setter, std::string& failures) {
+  if (!is_set) { return; }
+
+  try {
+    setter();
+  }
+  catch (const tacopie_error& e) {
+    __TACOPIE_LOG(warn, std::string("could not apply socket option ") + option + ": " + e.what());
+    failures += (failures.empty() ? "" : ", ") + std::string(option);
+  }
+}
+
+void
+tcp_socket::set_options(const options& opts) {
+  std::string failures;
+
+  //! each option is applied independently: an option unsupported by the platform does not prevent the others from being applied
+  apply_option(opts.nodelay >= 0, "TCP_NODELAY", [&] { set_nodelay(opts.nodelay != 0); }, failures);
+  apply_option(opts.send_buffer_size >= 0, "SO_SNDBUF", [&] { set_send_buffer_size(static_cast<std::size_t>(opts.send_buffer_size)); }, failures);
+  apply_option(opts.receive_buffer_size >= 0, "SO_RCVBUF", [&] { set_receive_buffer_size(static_cast<std::size_t>(opts.receive_buffer_size)); }, failures);
+  apply_option(opts.keepalive >= 0, "SO_KEEPALIVE", [&] { set_int_option(m_fd, SOL_SOCKET, SO_KEEPALIVE, opts.keepalive ? 1 : 0, "SO_KEEPALIVE"); }, failures);
+
+  //! negative timings are left unchanged, like 0
+  apply_option(opts.keepalive_idle_secs > 0, "TCP_KEEPIDLE", [&] { set_keepalive_timings(m_fd, static_cast<std::uint32_t>(opts.keepalive_idle_secs), 0, 0); }, failures);
+  apply_option(opts.keepalive_interval_secs > 0, "TCP_KEEPINTVL", [&] { set_keepalive_timings(m_fd, 0, static_cast<std::uint32_t>(opts.keepalive_interval_secs), 0); }, failures);
+  apply_option(opts.keepalive_count > 0, "TCP_KEEPCNT", [&] { set_keepalive_timings(m_fd, 0, 0, static_cast<std::uint32_t>(opts.keepalive_count)); }, failures);
+
+  apply_option(opts.quickack >= 0, "TCP_QUICKACK", [&] { set_quickack(opts.quickack != 0); }, failures);
+  apply_option(opts.notsent_lowat >= 0, "TCP_NOTSENT_LOWAT", [&] { set_notsent_lowat(static_cast<std::size_t>(opts.notsent_lowat)); }, failures);
+  apply_option(opts.user_timeout_msecs >= 0, "TCP_USER_TIMEOUT", [&] { set_user_timeout(static_cast<std::uint32_t>(opts.user_timeout_msecs)); }, failures);
+  apply_option(opts.busy_poll_usecs >= 0, "SO_BUSY_POLL", [&] { set_busy_poll(static_cast<std::uint32_t>(opts.busy_poll_usecs)); }, failures);
+
+  if (!failures.empty()) { __TACOPIE_THROW(warn, "could not apply socket options: " + failures); }
+}
+
 //!
 //! check whether the current socket has an appropriate type for that kind of operation
 //! if current type is UNKNOWN, update internal type with given type
@@ -39,9 +39,12 @@ namespace tacopie {
 //!
 
 static std::shared_ptr<io_service> io_service_default_instance = nullptr;
+static std::mutex io_service_default_instance_mtx;
 
-const std::shared_ptr<io_service>&
+std::shared_ptr<io_service>
 get_default_io_service(void) {
+  std::lock_guard<std::mutex> lock(io_service_default_instance_mtx);
+
   if (io_service_default_instance == nullptr) {
     io_service_default_instance = std::make_shared<io_service>();
   }
@@ -52,7 +55,12 @@ get_default_io_service(void) {
 void
 set_default_io_service(const std::shared_ptr<io_service>& service) {
   __TACOPIE_LOG(debug, "setting new default_io_service");
-  io_service_default_instance = service;
+
+  //! the previous instance is released outside of the lock: its destruction joins its threads
+  std::shared_ptr<io_service> previous = service;
+
+  std::lock_guard<std::mutex> lock(io_service_default_instance_mtx);
+  std::swap(io_service_default_instance, previous);
 }
 
 //!
@@ -60,14 +68,31 @@ set_default_io_service(const std::shared_ptr<io_service>& service) {
 //!
 
 io_service::io_service(void)
+: io_service(utils::thread_pool::scheduling_policy::fifo, run_mode::poll_thread) {}
+
+io_service::io_service(utils::thread_pool::scheduling_policy policy)
+: io_service(policy, run_mode::poll_thread) {}
+
+io_service::io_service(run_mode mode)
+: io_service(utils::thread_pool::scheduling_policy::fifo, mode) {}
+
+io_service::io_service(utils::thread_pool::scheduling_policy policy, run_mode mode)
+: m_run_mode(mode)
 #ifdef _WIN32
-: m_should_stop(ATOMIC_VAR_INIT(false))
+, m_should_stop(ATOMIC_VAR_INIT(false))
 #else
-: m_should_stop(false)
+, m_should_stop(false)
 #endif /* _WIN32 */
-, m_callback_workers(__TACOPIE_IO_SERVICE_NB_WORKERS) {
+, m_callback_workers(mode == run_mode::caller_driven ? 0 : __TACOPIE_IO_SERVICE_NB_WORKERS, policy)
+, m_select_sets(new select_sets) {
   __TACOPIE_LOG(debug, "create io_service");
 
+  //! caller_driven: the owner polls from its own thread, and is woken up when tasks are submitted from another thread
+  if (m_run_mode == run_mode::caller_driven) {
+    m_callback_workers.set_task_added_handler(std::bind(&io_service::wake_up_for_tasks, this));
+    return;
+  }
+
   //! Start worker after everything has been initialized
   m_poll_worker = std::thread(std::bind(&io_service::poll, this));
 }
@@ -92,6 +117,113 @@ io_service::set_nb_workers(std::size_t nb_threads) {
   m_callback_workers.set_nb_threads(nb_threads);
 }
 
+//!
+//! cpu affinity
+//!
+
+void
+io_service::set_poll_cpu_affinity(const utils::cpu_list_t& cpus, bool relocate_state) {
+  {
+    std::lock_guard<std::mutex> lock(m_poll_cpu_affinity_mtx);
+
+    m_poll_cpu_affinity         = cpus;
+    m_relocate_poll_state       = relocate_state;
+    m_poll_cpu_affinity_changed = true;
+  }
+
+  wake_up();
+}
+
+void
+io_service::set_workers_cpu_affinity(const utils::cpu_list_t& cpus, bool pin_each_worker) {
+  m_callback_workers.set_cpu_affinity(cpus, pin_each_worker);
+}
+
+void
+io_service::set_numa_affinity(const std::string& network_interface, bool relocate_state) {
+  utils::cpu_list_t cpus = utils::get_network_interface_cpus(network_interface);
+
+  if (cpus.empty()) { __TACOPIE_THROW(error, "could not find the cpus local to network interface " + network_interface); }
+
+  set_poll_cpu_affinity({cpus.front()}, relocate_state);
+
+  //! keep the first cpu for the poll thread, unless it is the only one
+  if (cpus.size() > 1) { cpus.erase(cpus.begin()); }
+
+  set_workers_cpu_affinity(cpus, true);
+}
+
+utils::thread_pool&
+io_service::get_callback_workers(void) {
+  return m_callback_workers;
+}
+
+io_service::run_mode
+io_service::get_run_mode(void) const {
+  return m_run_mode;
+}
+
+void
+io_service::apply_poll_cpu_affinity(void) {
+  if (!m_poll_cpu_affinity_changed) { return; }
+
+  utils::cpu_list_t cpus;
+  bool relocate_state;
+
+  {
+    std::lock_guard<std::mutex> lock(m_poll_cpu_affinity_mtx);
+
+    cpus                        = m_poll_cpu_affinity;
+    relocate_state              = m_relocate_poll_state;
+    m_poll_cpu_affinity_changed = false;
+  }
+
+  if (!utils::set_current_thread_affinity(cpus)) {
+    __TACOPIE_LOG(warn, "could not set poll thread cpu affinity");
+    return;
+  }
+
+  if (relocate_state) { relocate_poll_state(); }
+}
+
+void
+io_service::relocate_poll_state(void) {
+  std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
+
+  //! tracked sockets: the callbacks look them up by fd under the lock, no reference to an entry outlives it
+  std::unordered_map<fd_t, tracked_socket> tracked_sockets(m_tracked_sockets.bucket_count());
+
+  for (auto& entry : m_tracked_sockets) {
+    auto& from = entry.second;
+    auto& to   = tracked_sockets[entry.first];
+
+    to.rd_callback              = std::move(from.rd_callback);
+    to.is_executing_rd_callback = from.is_executing_rd_callback.load();
+    to.wr_callback              = std::move(from.wr_callback);
+    to.is_executing_wr_callback = from.is_executing_wr_callback.load();
+    to.marked_for_untrack       = from.marked_for_untrack.load();
+    to.priority                 = from.priority;
+
+    //! idle strands are dropped: get_strand creates them again from the poll thread on the next event
+    //! a strand with a callback in flight is kept, the callbacks of the socket must stay serialized
+    if (to.is_executing_rd_callback || to.is_executing_wr_callback) { to.strand = std::move(from.strand); }
+  }
+
+  m_tracked_sockets.swap(tracked_sockets);
+
+  //! select state, filled again by init_poll_fds_info before the next select
+  std::vector<fd_t> polled_fds;
+  polled_fds.reserve(m_polled_fds.capacity());
+  m_polled_fds.swap(polled_fds);
+  m_select_sets.reset(new select_sets);
+
+  //! pending tasks, usually none between two iterations
+  utils::thread_pool::task_batch_t pending_tasks;
+  pending_tasks.reserve(m_pending_tasks.capacity());
+  for (auto& task : m_pending_tasks) { pending_tasks.push_back(std::move(task)); }
+  m_pending_tasks.swap(pending_tasks);
+}
+
 
 //!
 //! poll worker function
@@ -102,7 +234,7 @@ io_service::poll(void) {
   __TACOPIE_LOG(debug, "starting poll() worker");
 
   while (!m_should_stop) {
-    int ndfs = init_poll_fds_info();
+    apply_poll_cpu_affinity();
 
     //! setup timeout
     struct timeval* timeout_ptr = NULL;
@@ -112,30 +244,165 @@ io_service::poll(void) {
     timeout_ptr     = &timeout;
 #endif /* __TACOPIE_TIMEOUT */
 
-    __TACOPIE_LOG(debug, "polling fds");
-    if (select(ndfs, &m_rd_set, &m_wr_set, NULL, timeout_ptr) > 0) {
+    if (wait_for_events(timeout_ptr)) {
       process_events();
     }
     else {
       __TACOPIE_LOG(debug, "poll woke up, but nothing to process");
+      collect_timers();
+      m_callback_workers.add_tasks(m_pending_tasks);
     }
   }
 
   __TACOPIE_LOG(debug, "stop poll() worker");
 }
 
+//!
+//! caller_driven mode
+//!
+
+thread_local io_service* io_service::s_current_io_service = nullptr;
+
+void
+io_service::run(void) {
+  while (!m_run_should_stop) { run_caller_driven(NULL); }
+
+  m_run_should_stop = false;
+}
+
+std::size_t
+io_service::run_once(std::uint32_t timeout_msecs) {
+  if (!timeout_msecs) { return run_caller_driven(NULL); }
+
+  struct timeval timeout;
+  timeout.tv_sec  = timeout_msecs / 1000;
+  timeout.tv_usec = (timeout_msecs % 1000) * 1000;
+
+  return run_caller_driven(&timeout);
+}
+
+std::size_t
+io_service::poll_nonblocking(void) {
+  struct timeval timeout;
+  timeout.tv_sec  = 0;
+  timeout.tv_usec = 0;
+
+  return run_caller_driven(&timeout);
+}
+
+void
+io_service::stop(void) {
+  m_run_should_stop = true;
+  wake_up();
+}
+
+std::size_t
+io_service::run_caller_driven(struct timeval* timeout) {
+  if (m_run_mode != run_mode::caller_driven) { __TACOPIE_THROW(error, "io_service is driven by its poll thread"); }
+
+  io_service* previous = s_current_io_service;
+  s_current_io_service = this;
+
+  std::size_t nb_executed = 0;
+
+  try {
+    //! the driving thread stands for the poll thread
+    apply_poll_cpu_affinity();
+
+    //! reset before running the pending tasks: the ones submitted from now on notify again
+    m_tasks_notified = false;
+
+    //! tasks submitted since last call (future continuations for example) may update the tracking before polling
+    nb_executed += m_callback_workers.run_pending_tasks();
+
+    if (wait_for_events(timeout)) { collect_events(); }
+    collect_timers();
+
+    //! executed outside of the lock: callbacks need it
+    for (auto& task : m_pending_tasks) {
+      try {
+        task.first();
+      }
+      catch (const std::exception&) {
+        __TACOPIE_LOG(warn, "uncatched exception propagated up to the io_service.")
+      }
+    }
+
+    nb_executed += m_pending_tasks.size();
+    m_pending_tasks.clear();
+
+    nb_executed += m_callback_workers.run_pending_tasks();
+  }
+  catch (...) {
+    s_current_io_service = previous;
+    throw;
+  }
+
+  s_current_io_service = previous;
+
+  return nb_executed;
+}
+
+bool
+io_service::wait_for_events(struct timeval* timeout) {
+  int ndfs = init_poll_fds_info();
+
+  //! wake up in time for the next scheduled task
+  struct timeval timer_timeout;
+  {
+    std::lock_guard<std::mutex> lock(m_timers_mtx);
+
+    if (!m_timers.empty()) {
+      auto delay = std::chrono::duration_cast<std::chrono::microseconds>(m_timers.begin()->first - std::chrono::steady_clock::now()).count();
+      if (delay < 0) { delay = 0; }
+
+      if (!timeout || delay < (long long) timeout->tv_sec * 1000000 + timeout->tv_usec) {
+        timer_timeout.tv_sec  = (long) (delay / 1000000);
+        timer_timeout.tv_usec = (long) (delay % 1000000);
+        timeout               = &timer_timeout;
+      }
+    }
+  }
+
+  __TACOPIE_LOG(debug, "polling fds");
+  return select(ndfs, &m_select_sets->rd_set, &m_select_sets->wr_set, NULL, timeout) > 0;
+}
+
+void
+io_service::wake_up(void) {
+  if (s_current_io_service == this) { return; }
+
+  m_notifier.notify();
+}
+
+void
+io_service::wake_up_for_tasks(void) {
+  if (s_current_io_service == this || m_tasks_notified.exchange(true)) { return; }
+
+  m_notifier.notify();
+}
+
 //!
 //! process poll detected events
 //!
 
 void
 io_service::process_events(void) {
+  collect_events();
+  collect_timers();
+
+  //! submitted outside of the lock: callbacks need it, and the callback workers may block when full
+  m_callback_workers.add_tasks(m_pending_tasks);
+}
+
+void
+io_service::collect_events(void) {
   std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
 
   __TACOPIE_LOG(debug, "processing events");
 
   for (const auto& fd : m_polled_fds) {
-    if (fd == m_notifier.get_read_fd() && FD_ISSET(fd, &m_rd_set)) {
+    if (fd == m_notifier.get_read_fd() && FD_ISSET(fd, &m_select_sets->rd_set)) {
       m_notifier.clr_buffer();
       continue;
     }
@@ -146,10 +413,10 @@ io_service::process_events(void) {
 
     auto& socket = it->second;
 
-    if (FD_ISSET(fd, &m_rd_set) && socket.rd_callback && !socket.is_executing_rd_callback) {
+    if (FD_ISSET(fd, &m_select_sets->rd_set) && socket.rd_callback && !socket.is_executing_rd_callback) {
       process_rd_event(fd, socket);
     }
-    if (FD_ISSET(fd, &m_wr_set) && socket.wr_callback && !socket.is_executing_wr_callback) {
+    if (FD_ISSET(fd, &m_select_sets->wr_set) && socket.wr_callback && !socket.is_executing_wr_callback) {
       process_wr_event(fd, socket);
     }
 
@@ -161,6 +428,18 @@ io_service::process_events(void) {
   }
 }
 
+void
+io_service::collect_timers(void) {
+  std::lock_guard<std::mutex> lock(m_timers_mtx);
+
+  auto now = std::chrono::steady_clock::now();
+
+  while (!m_timers.empty() && m_timers.begin()->first <= now) {
+    m_pending_tasks.emplace_back(std::move(m_timers.begin()->second), utils::thread_pool::priority::normal);
+    m_timers.erase(m_timers.begin());
+  }
+}
+
 void
 io_service::process_rd_event(const fd_t& fd, tracked_socket& socket) {
   __TACOPIE_LOG(debug, "processing read event");
@@ -169,9 +448,10 @@ io_service::process_rd_event(const fd_t& fd, tracked_socket& socket) {
 
   socket.is_executing_rd_callback = true;
 
-  m_callback_workers << [=] {
+  //! the task only holds a pointer to the callback: it is stored inline and dispatching does not allocate
+  dispatch(socket, [this, fd, rd_callback] {
     __TACOPIE_LOG(debug, "execute read callback");
-    rd_callback(fd);
+    (*rd_callback)(fd);
 
     std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
     auto it = m_tracked_sockets.find(fd);
@@ -187,8 +467,8 @@ io_service::process_rd_event(const fd_t& fd, tracked_socket& socket) {
       m_wait_for_removal_condvar.notify_all();
     }
 
-    m_notifier.notify();
-  };
+    wake_up();
+  });
 }
 
 void
@@ -199,9 +479,9 @@ io_service::process_wr_event(const fd_t& fd, tracked_socket& socket) {
 
   socket.is_executing_wr_callback = true;
 
-  m_callback_workers << [=] {
+  dispatch(socket, [this, fd, wr_callback] {
     __TACOPIE_LOG(debug, "execute write callback");
-    wr_callback(fd);
+    (*wr_callback)(fd);
 
     std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
     auto it = m_tracked_sockets.find(fd);
@@ -217,8 +497,26 @@ io_service::process_wr_event(const fd_t& fd, tracked_socket& socket) {
       m_wait_for_removal_condvar.notify_all();
     }
 
-    m_notifier.notify();
-  };
+    wake_up();
+  });
+}
+
+void
+io_service::dispatch(tracked_socket& socket, utils::thread_pool::task_t&& task) {
+  //! caller_driven: the driving thread executes the callbacks one after the other, no strand needed
+  if (m_run_mode == run_mode::caller_driven) {
+    m_pending_tasks.emplace_back(std::move(task), socket.priority);
+    return;
+  }
+
+  get_strand(socket).post(std::move(task), m_pending_tasks);
+}
+
+utils::strand&
+io_service::get_strand(tracked_socket& socket) {
+  if (!socket.strand) { socket.strand = std::make_shared<utils::strand>(m_callback_workers, socket.priority); }
+
+  return *socket.strand;
 }
 
 //!
@@ -230,25 +528,26 @@ io_service::init_poll_fds_info(void) {
   std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
 
   m_polled_fds.clear();
-  FD_ZERO(&m_rd_set);
-  FD_ZERO(&m_wr_set);
+  FD_ZERO(&m_select_sets->rd_set);
+  FD_ZERO(&m_select_sets->wr_set);
 
   int ndfs = (int) m_notifier.get_read_fd();
-  FD_SET(m_notifier.get_read_fd(), &m_rd_set);
+  FD_SET(m_notifier.get_read_fd(), &m_select_sets->rd_set);
   m_polled_fds.push_back(m_notifier.get_read_fd());
 
   for (const auto& socket : m_tracked_sockets) {
     const auto& fd          = socket.first;
     const auto& socket_info = socket.second;
 
-    bool should_rd = socket_info.rd_callback && !socket_info.is_executing_rd_callback;
+    //! a socket marked for untracking is not polled anymore: its owner may have closed it already
+    bool should_rd = socket_info.rd_callback && !socket_info.is_executing_rd_callback && !socket_info.marked_for_untrack;
     if (should_rd) {
-      FD_SET(fd, &m_rd_set);
+      FD_SET(fd, &m_select_sets->rd_set);
     }
 
-    bool should_wr = socket_info.wr_callback && !socket_info.is_executing_wr_callback;
+    bool should_wr = socket_info.wr_callback && !socket_info.is_executing_wr_callback && !socket_info.marked_for_untrack;
     if (should_wr) {
-      FD_SET(fd, &m_wr_set);
+      FD_SET(fd, &m_select_sets->wr_set);
     }
 
     if (should_rd || should_wr || socket_info.marked_for_untrack) {
@@ -263,28 +562,75 @@ io_service::init_poll_fds_info(void) {
   return ndfs + 1;
 }
 
+//!
+//! scheduled tasks
+//!
+
+void
+io_service::schedule(std::uint32_t delay_msecs, utils::thread_pool::task_t&& task) {
+  {
+    std::lock_guard<std::mutex> lock(m_timers_mtx);
+    m_timers.emplace(std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_msecs), std::move(task));
+  }
+
+  //! the poll may be waiting past the new deadline
+  wake_up();
+}
+
 //!
 //! track & untrack socket
 //!
 
+static std::shared_ptr<io_service::event_callback_t>
+make_shared_callback(io_service::event_callback_t&& callback) {
+  if (!callback) { return nullptr; }
+
+  return std::make_shared<io_service::event_callback_t>(std::move(callback));
+}
+
 void
-io_service::track(const tcp_socket& socket, const event_callback_t& rd_callback, const event_callback_t& wr_callback) {
+io_service::track(const tcp_socket& socket, const event_callback_t& rd_callback, const event_callback_t& wr_callback, utils::thread_pool::priority prio) {
   std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
 
   __TACOPIE_LOG(debug, "track new socket");
 
   auto& track_info                    = m_tracked_sockets[socket.get_fd()];
-  track_info.rd_callback              = rd_callback;
-  track_info.wr_callback              = wr_callback;
+  track_info.rd_callback              = make_shared_callback(event_callback_t(rd_callback));
+  track_info.wr_callback              = make_shared_callback(event_callback_t(wr_callback));
   track_info.marked_for_untrack       = false;
   track_info.is_executing_rd_callback = false;
   track_info.is_executing_wr_callback = false;
+  track_info.priority                 = prio;
 
-  m_notifier.notify();
+  if (track_info.strand) { track_info.strand->set_priority(prio); }
+
+  wake_up();
+}
+
+void
+io_service::set_priority(const tcp_socket& socket, utils::thread_pool::priority prio) {
+  std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
+
+  __TACOPIE_LOG(debug, "update socket priority");
+
+  auto& track_info    = m_tracked_sockets[socket.get_fd()];
+  track_info.priority = prio;
+
+  if (track_info.strand) { track_info.strand->set_priority(prio); }
 }
 
 void
 io_service::set_rd_callback(const tcp_socket& socket, const event_callback_t& event_callback) {
+  set_rd_callback(socket, event_callback_t(event_callback));
+}
+
+void
+io_service::set_rd_callback(const tcp_socket& socket, event_callback_t&& event_callback) {
+  set_rd_callback(socket, make_shared_callback(std::move(event_callback)));
+}
+
+void
+io_service::set_rd_callback(const tcp_socket& socket, const std::shared_ptr<event_callback_t>& event_callback) {
   std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
 
   __TACOPIE_LOG(debug, "update read socket tracking callback");
@@ -292,11 +638,26 @@ io_service::set_rd_callback(const tcp_socket& socket, const event_callback_t& ev
   auto& track_info       = m_tracked_sockets[socket.get_fd()];
   track_info.rd_callback = event_callback;
 
-  m_notifier.notify();
+  wake_up();
+}
+
+void
+io_service::set_rd_callback(const tcp_socket& socket, std::nullptr_t) {
+  set_rd_callback(socket, std::shared_ptr<event_callback_t>());
 }
 
 void
 io_service::set_wr_callback(const tcp_socket& socket, const event_callback_t& event_callback) {
+  set_wr_callback(socket, event_callback_t(event_callback));
+}
+
+void
+io_service::set_wr_callback(const tcp_socket& socket, event_callback_t&& event_callback) {
+  set_wr_callback(socket, make_shared_callback(std::move(event_callback)));
+}
+
+void
+io_service::set_wr_callback(const tcp_socket& socket, const std::shared_ptr<event_callback_t>& event_callback) {
   std::lock_guard<std::mutex> lock(m_tracked_sockets_mtx);
 
   __TACOPIE_LOG(debug, "update write socket tracking callback");
@@ -304,7 +665,12 @@ io_service::set_wr_callback(const tcp_socket& socket, const event_callback_t& ev
   auto& track_info       = m_tracked_sockets[socket.get_fd()];
   track_info.wr_callback = event_callback;
 
-  m_notifier.notify();
+  wake_up();
+}
+
+void
+io_service::set_wr_callback(const tcp_socket& socket, std::nullptr_t) {
+  set_wr_callback(socket, std::shared_ptr<event_callback_t>());
 }
 
 void
@@ -325,7 +691,7 @@ io_service::untrack(const tcp_socket& socket) {
     m_wait_for_removal_condvar.notify_all();
   }
 
-  m_notifier.notify();
+  wake_up();
 }
 
 //!
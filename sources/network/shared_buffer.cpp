@@ -0,0 +1,84 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/network/shared_buffer.hpp>
+
+namespace tacopie {
+
+//!
+//! ctors
+//!
+
+shared_buffer::shared_buffer(std::vector<char> bytes) {
+  std::vector<std::vector<char>> slices(1);
+  slices[0] = std::move(bytes);
+
+  init(std::move(slices));
+}
+
+shared_buffer::shared_buffer(const std::string& bytes)
+: shared_buffer(std::vector<char>(bytes.begin(), bytes.end())) {}
+
+shared_buffer::shared_buffer(std::vector<std::vector<char>> slices) {
+  init(std::move(slices));
+}
+
+void
+shared_buffer::init(std::vector<std::vector<char>>&& slices) {
+  auto content    = std::make_shared<storage>();
+  content->size   = 0;
+  content->slices = std::move(slices);
+
+  for (const auto& slice : content->slices) { content->size += slice.size(); }
+
+  m_storage = std::move(content);
+}
+
+//!
+//! content information
+//!
+
+shared_buffer::operator bool(void) const {
+  return m_storage != nullptr;
+}
+
+std::size_t
+shared_buffer::size(void) const {
+  return m_storage ? m_storage->size : 0;
+}
+
+std::size_t
+shared_buffer::nb_slices(void) const {
+  return m_storage ? m_storage->slices.size() : 0;
+}
+
+const std::vector<char>&
+shared_buffer::get_slice(std::size_t index) const {
+  return m_storage->slices[index];
+}
+
+std::size_t
+shared_buffer::use_count(void) const {
+  return static_cast<std::size_t>(m_storage.use_count());
+}
+
+} // namespace tacopie
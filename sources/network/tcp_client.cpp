@@ -24,6 +24,9 @@
 #include <tacopie/utils/error.hpp>
 #include <tacopie/utils/logger.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace tacopie {
 
 //!
@@ -31,14 +34,35 @@ namespace tacopie {
 //!
 
 tcp_client::tcp_client(void)
-: m_disconnection_handler(nullptr) {
-  m_io_service = get_default_io_service();
+: tcp_client(get_default_io_service()) {}
+
+tcp_client::tcp_client(const std::shared_ptr<tacopie::io_service>& io_service)
+: m_io_service(io_service)
+, m_polled_for_read(false)
+, m_zerocopy_next_id(0)
+, m_disconnection_handler(nullptr)
+, m_is_connecting(false)
+, m_connect_complete_on_disconnect(false) {
+  if (!m_io_service) { __TACOPIE_THROW(error, "tcp_client: null io_service"); }
+
+  m_callback_guard         = std::make_shared<callback_guard>();
+  m_callback_guard->busy   = false;
+  m_callback_guard->client = this;
+  m_rd_callback            = std::make_shared<io_service::event_callback_t>(make_io_callback(&tcp_client::on_read_available));
+  m_wr_callback            = std::make_shared<io_service::event_callback_t>(make_io_callback(&tcp_client::on_write_available));
   __TACOPIE_LOG(debug, "create tcp_client");
 }
 
 tcp_client::~tcp_client(void) {
   __TACOPIE_LOG(debug, "destroy tcp_client");
-  disconnect(true);
+
+  //! taken for good: callbacks still queued do nothing, waits while another thread executes client code (never user callbacks, so never for long)
+  while (m_callback_guard->busy.exchange(true, std::memory_order_acquire)) { std::this_thread::yield(); }
+
+  //! no need to wait for the removal: callbacks the io service may still run do nothing
+  //! no user code runs from here: the dropped requests are released without being completed, their futures broken
+  dropped_requests dropped;
+  disconnect(false, dropped);
 }
 
 //!
@@ -47,12 +71,26 @@ tcp_client::~tcp_client(void) {
 //!
 
 tcp_client::tcp_client(tcp_socket&& socket)
-: m_io_service(get_default_io_service())
+: tcp_client(std::move(socket), get_default_io_service()) {}
+
+tcp_client::tcp_client(tcp_socket&& socket, const std::shared_ptr<tacopie::io_service>& io_service)
+: m_io_service(io_service)
 , m_socket(std::move(socket))
-, m_disconnection_handler(nullptr) {
-  m_is_connected = true;
+, m_polled_for_read(false)
+, m_zerocopy_next_id(0)
+, m_disconnection_handler(nullptr)
+, m_is_connecting(false)
+, m_connect_complete_on_disconnect(false) {
+  if (!m_io_service) { __TACOPIE_THROW(error, "tcp_client: null io_service"); }
+
+  m_callback_guard         = std::make_shared<callback_guard>();
+  m_callback_guard->busy   = false;
+  m_callback_guard->client = this;
+  m_rd_callback            = std::make_shared<io_service::event_callback_t>(make_io_callback(&tcp_client::on_read_available));
+  m_wr_callback            = std::make_shared<io_service::event_callback_t>(make_io_callback(&tcp_client::on_write_available));
+  m_is_connected           = true;
   __TACOPIE_LOG(debug, "create tcp_client");
-  m_io_service->track(m_socket);
+  m_io_service->track(m_socket, nullptr, nullptr, m_priority);
 }
 
 //!
@@ -79,7 +117,7 @@ tcp_client::connect(const std::string& host, std::uint32_t port, std::uint32_t t
 
   try {
     m_socket.connect(host, port, timeout_msecs);
-    m_io_service->track(m_socket);
+    get_io_service()->track(m_socket, nullptr, nullptr, m_priority);
   }
   catch (const tacopie_error& e) {
     m_socket.close();
@@ -91,20 +129,76 @@ tcp_client::connect(const std::string& host, std::uint32_t port, std::uint32_t t
   __TACOPIE_LOG(info, "tcp_client connected");
 }
 
+void
+tcp_client::async_connect(const std::string& host, std::uint32_t port, const async_connect_callback_t& callback) {
+  start_async_connect(host, port, callback, false);
+}
+
+void
+tcp_client::async_connect(const std::string& host, std::uint32_t port, const async_connect_callback_t& callback, complete_on_disconnect_t) {
+  start_async_connect(host, port, callback, true);
+}
+
+void
+tcp_client::start_async_connect(const std::string& host, std::uint32_t port, const async_connect_callback_t& callback, bool complete_on_disconnect) {
+  std::lock_guard<std::mutex> lock(m_connect_mtx);
+
+  if (is_connected() || m_is_connecting) { __TACOPIE_THROW(warn, "tcp_client is already connected"); }
+
+  m_socket.connect_async(host, port);
+
+  m_connect_callback                = callback;
+  m_connect_complete_on_disconnect = complete_on_disconnect;
+  m_is_connecting                  = true;
+
+  //! the socket becomes writable once the connection completes (or fails)
+  m_io_service->track(m_socket, nullptr, make_io_callback(&tcp_client::on_connect_available), m_priority);
+
+  __TACOPIE_LOG(info, "tcp_client connecting");
+}
+
 void
 tcp_client::disconnect(bool wait_for_removal) {
-  if (!is_connected()) { return; }
+  dropped_requests dropped;
+  disconnect(wait_for_removal, dropped);
+
+  //! every request completes exactly once: the dropped ones fail, outside of the locks (callbacks may issue new requests or release this client)
+  dropped.fail();
+}
+
+void
+tcp_client::disconnect(bool wait_for_removal, dropped_requests& dropped) {
+  bool was_connecting;
+
+  {
+    std::lock_guard<std::mutex> lock(m_connect_mtx);
+    was_connecting  = m_is_connecting;
+    m_is_connecting = false;
+
+    //! taken here: on_connect_available is not called anymore once the socket is untracked
+    if (m_connect_complete_on_disconnect) { dropped.connect_callback = std::move(m_connect_callback); }
+    m_connect_callback = nullptr;
+  }
+
+  //! a pending async_connect is cancelled the same way
+  if (!is_connected() && !was_connecting) { return; }
 
   //! update state
   m_is_connected = false;
 
-  //! clear all pending requests
-  clear_read_requests();
-  clear_write_requests();
+  //! clear all pending requests, completed as failures once the socket is closed
+  clear_read_requests(dropped.reads);
+  clear_write_requests(dropped.writes);
 
   //! remove socket from io service and wait for removal if necessary
-  m_io_service->untrack(m_socket);
-  if (wait_for_removal) { m_io_service->wait_for_removal(m_socket); }
+  //! untracked under the lock: a concurrent migration either sees the client disconnected or is done with the tracking
+  std::shared_ptr<tacopie::io_service> io_service;
+  {
+    std::lock_guard<std::mutex> lock(m_io_service_mtx);
+    io_service = m_io_service;
+    io_service->untrack(m_socket);
+  }
+  if (wait_for_removal) { io_service->wait_for_removal(m_socket); }
 
   //! close the socket
   m_socket.close();
@@ -112,33 +206,36 @@ tcp_client::disconnect(bool wait_for_removal) {
   __TACOPIE_LOG(info, "tcp_client disconnected");
 }
 
+void
+tcp_client::dropped_requests::fail(void) {
+  if (connect_callback) { connect_callback(false); }
+  for (auto& on_completion : reads) { on_completion.fail(); }
+  for (auto& on_completion : writes) { on_completion.fail(); }
+}
+
 //!
 //! Clear pending requests
 //!
 void
-tcp_client::clear_read_requests(void) {
+tcp_client::clear_read_requests(std::vector<completion<read_result>>& completions) {
   std::lock_guard<std::mutex> lock(m_read_requests_mtx);
 
-  std::queue<read_request> empty;
-  std::swap(m_read_requests, empty);
+  for (auto& request : m_read_requests) { completions.push_back(std::move(request.on_completion)); }
+
+  m_read_requests.clear();
+  m_zerocopy_buffers.clear();
+  m_polled_for_read = false;
 }
 
 void
-tcp_client::clear_write_requests(void) {
+tcp_client::clear_write_requests(std::vector<completion<write_result>>& completions) {
   std::lock_guard<std::mutex> lock(m_write_requests_mtx);
 
-  std::queue<write_request> empty;
-  std::swap(m_write_requests, empty);
-}
+  for (auto& request : m_write_requests) { completions.push_back(std::move(request.on_completion)); }
 
-//!
-//! Call disconnection handler
-//!
-void
-tcp_client::call_disconnection_handler(void) {
-  if (m_disconnection_handler) {
-    m_disconnection_handler();
-  }
+  m_write_requests.clear();
+  m_pending_write_size = 0;
+  m_zerocopy_next_id   = 0;
 }
 
 //!
@@ -146,20 +243,29 @@ tcp_client::call_disconnection_handler(void) {
 //!
 
 void
-tcp_client::on_read_available(fd_t) {
+tcp_client::on_read_available(fd_t, callback_scope& scope) {
   __TACOPIE_LOG(info, "read available");
 
   read_result result;
-  auto callback = process_read(result);
+  auto on_completion = process_read(result);
+
+  //! taken before completing the requests: a completion may release the last reference to this client
+  disconnection_handler_t disconnection_handler;
+  dropped_requests dropped;
 
   if (!result.success) {
     __TACOPIE_LOG(warn, "read operation failure");
-    disconnect();
+    disconnection_handler = m_disconnection_handler;
+    disconnect(false, dropped);
   }
 
-  if (callback) { callback(result); }
+  //! this client is not used past this point
+  scope.leave();
 
-  if (!result.success) { call_disconnection_handler(); }
+  dropped.fail();
+  if (on_completion) { on_completion(result); }
+
+  if (disconnection_handler) { disconnection_handler(); }
 }
 
 //!
@@ -167,72 +273,401 @@ tcp_client::on_read_available(fd_t) {
 //!
 
 void
-tcp_client::on_write_available(fd_t) {
+tcp_client::on_write_available(fd_t, callback_scope& scope) {
   __TACOPIE_LOG(info, "write available");
 
-  write_result result;
-  auto callback = process_write(result);
+  //! completions (and their callbacks) must outlive any access to this instance: a callback may release the last reference to this client
+  std::vector<write_completion_t> completions;
+  bool success = process_write(completions);
+  disconnection_handler_t disconnection_handler;
+  dropped_requests dropped;
 
-  if (!result.success) {
+  if (!success) {
     __TACOPIE_LOG(warn, "write operation failure");
-    disconnect();
+    disconnection_handler = m_disconnection_handler;
+    disconnect(false, dropped);
   }
 
-  if (callback) { callback(result); }
+  //! this client is not used past this point
+  scope.leave();
+
+  dropped.fail();
+
+  for (auto& completion : completions) {
+    if (completion.first) { completion.first(completion.second); }
+  }
+
+  if (disconnection_handler) { disconnection_handler(); }
+}
+
+//!
+//! io service connect callback
+//!
+
+void
+tcp_client::on_connect_available(fd_t, callback_scope& scope) {
+  __TACOPIE_LOG(info, "connection available");
+
+  bool success = false;
+
+  //! kept locally: the callback may release the last reference to this client
+  async_connect_callback_t callback;
+
+  {
+    std::lock_guard<std::mutex> lock(m_connect_mtx);
+
+    callback           = std::move(m_connect_callback);
+    m_connect_callback = nullptr;
+
+    //! finished under the lock: otherwise, disconnect may close the socket (and the fd be reused) meanwhile
+    //! a connection cancelled by disconnect fails, the socket has already been released
+    if (m_is_connecting) {
+      try {
+        m_socket.finish_connect();
+        success = true;
+      }
+      catch (const tacopie::tacopie_error&) {
+        success = false;
+      }
+
+      if (success) {
+        m_io_service->set_wr_callback(m_socket, nullptr);
+        m_is_connected  = true;
+        m_is_connecting = false;
+        __TACOPIE_LOG(info, "tcp_client connected");
+      }
+      else {
+        m_io_service->untrack(m_socket);
+        m_socket.close();
+        m_is_connecting = false;
+        __TACOPIE_LOG(warn, "tcp_client connection failure");
+      }
+    }
+  }
+
+  //! this client is not used past this point
+  scope.leave();
+
+  if (callback) { callback(success); }
+}
+
+io_service::event_callback_t
+tcp_client::make_io_callback(void (tcp_client::*callback)(fd_t, callback_scope&)) {
+  std::shared_ptr<callback_guard> guard = m_callback_guard;
+
+  return [guard, callback](fd_t fd) {
+    callback_scope scope(*guard);
+
+    if (scope.entered()) { (guard->client->*callback)(fd, scope); }
+  };
+}
+
+//!
+//! callback guard
+//!
+
+tcp_client::callback_scope::callback_scope(callback_guard& guard)
+: m_guard(guard.busy.exchange(true, std::memory_order_acquire) ? nullptr : &guard) {}
+
+tcp_client::callback_scope::~callback_scope(void) {
+  leave();
+}
+
+bool
+tcp_client::callback_scope::entered(void) const {
+  return m_guard != nullptr;
+}
 
-  if (!result.success) { call_disconnection_handler(); }
+void
+tcp_client::callback_scope::leave(void) {
+  if (!m_guard) { return; }
+
+  m_guard->busy.store(false, std::memory_order_release);
+  m_guard = nullptr;
 }
 
 //!
 //! process read & write operations when available
 //!
 
-tcp_client::async_read_callback_t
+tcp_client::completion<tcp_client::read_result>
 tcp_client::process_read(read_result& result) {
-  std::lock_guard<std::mutex> lock(m_read_requests_mtx);
+  result.success = true;
+  result.error   = 0;
+  result.eof     = false;
 
-  if (m_read_requests.empty()) { return nullptr; }
+  //! held across recv: disconnect closes the socket once it has cleared the requests, never while this thread still reads from it (the fd could be reused meanwhile)
+  //! recv never waits for data, so async_read is not held for long
+  std::lock_guard<std::mutex> lock(m_read_requests_mtx);
 
-  const auto& request = m_read_requests.front();
-  auto callback       = request.async_read_callback;
+  //! zero-copy notifications also make the socket readable
+  bool had_zerocopy_buffers = !m_zerocopy_buffers.empty();
+  bool notified             = had_zerocopy_buffers && release_zerocopy_buffers();
 
-  try {
-    result.buffer  = m_socket.recv(request.size);
-    result.success = true;
+  if (m_read_requests.empty()) {
+    //! readable without notification: unread data, which would make the socket readable again and again until a read is requested
+    //! the buffers still held are then released by the next read or zero-copy write
+    if (had_zerocopy_buffers && (m_zerocopy_buffers.empty() || !notified)) { poll_for_read(false); }
+    return completion<read_result>();
   }
-  catch (const tacopie::tacopie_error&) {
-    result.success = false;
+
+  auto& request = m_read_requests.front();
+
+  //! the socket may be readable because of its error queue only: recv must not wait for data
+  result.buffer.resize(request.size);
+  tcp_socket::io_result io = m_socket.recv(result.buffer.data(), request.size, std::nothrow, true);
+
+  if (io.would_block()) {
+    //! nothing to read after all: the request stays in front
+    poll_for_read(true);
+    result.buffer.clear();
+    return completion<read_result>();
   }
 
-  m_read_requests.pop();
+  auto on_completion = std::move(request.on_completion);
+  m_read_requests.pop_front();
+
+  if (m_read_requests.empty() && m_zerocopy_buffers.empty()) { poll_for_read(false); }
 
-  if (m_read_requests.empty()) { m_io_service->set_rd_callback(m_socket, nullptr); }
+  result.buffer.resize(io.size);
+  result.success = io.success();
+  result.error   = io.error;
+  result.eof     = io.eof;
 
-  return callback;
+  return on_completion;
 }
 
-tcp_client::async_write_callback_t
-tcp_client::process_write(write_result& result) {
+bool
+tcp_client::process_write(std::vector<write_completion_t>& completions) {
   std::lock_guard<std::mutex> lock(m_write_requests_mtx);
 
-  if (m_write_requests.empty()) { return nullptr; }
+  if (m_write_requests.empty()) { return true; }
 
-  const auto& request = m_write_requests.front();
-  auto callback       = request.async_write_callback;
+  std::size_t zerocopy_threshold = m_zerocopy_threshold;
+  const auto& front              = m_write_requests.front();
 
-  try {
-    result.size    = m_socket.send(request.buffer, request.buffer.size());
-    result.success = true;
+  if (front.file) { return process_file_write(completions); }
+  if (zerocopy_threshold && front.buffer.size() >= zerocopy_threshold) { return process_zerocopy_write(completions); }
+
+  //! gather as many pending requests as possible in a single system call, up to the next file or zero-copy request
+  //! each request starts from its first unwritten byte, a shared buffer uses one iovec per slice
+  tcp_socket::const_buffer buffers[__TACOPIE_MAX_IOVEC];
+  std::size_t nb_buffers = 0;
+
+  //! number of bytes gathered for each request
+  std::size_t request_sizes[__TACOPIE_MAX_IOVEC];
+  std::size_t nb_requests = 0;
+
+  for (const auto& request : m_write_requests) {
+    if (nb_buffers == __TACOPIE_MAX_IOVEC || nb_requests == __TACOPIE_MAX_IOVEC || request.file) { break; }
+    if (zerocopy_threshold && request.buffer.size() >= zerocopy_threshold) { break; }
+
+    if (!request.shared) {
+      buffers[nb_buffers].data = request.buffer.data() + request.written;
+      buffers[nb_buffers].size = request.buffer.size() - request.written;
+      ++nb_buffers;
+
+      request_sizes[nb_requests++] = request.buffer.size() - request.written;
+      continue;
+    }
+
+    std::size_t skipped      = request.written;
+    std::size_t request_size = 0;
+
+    for (std::size_t i = 0; i < request.shared.nb_slices() && nb_buffers < __TACOPIE_MAX_IOVEC; ++i) {
+      const auto& slice = request.shared.get_slice(i);
+
+      if (skipped >= slice.size()) {
+        skipped -= slice.size();
+        continue;
+      }
+
+      buffers[nb_buffers].data = slice.data() + skipped;
+      buffers[nb_buffers].size = slice.size() - skipped;
+      request_size += buffers[nb_buffers].size;
+      skipped = 0;
+      ++nb_buffers;
+    }
+
+    request_sizes[nb_requests++] = request_size;
   }
-  catch (const tacopie::tacopie_error&) {
-    result.success = false;
+
+  //! never wait for space in the send buffer: a peer which stops reading must not hold the io service worker
+  tcp_socket::io_result io = m_socket.sendv(buffers, nb_buffers, std::nothrow, true);
+
+  //! nothing could be sent without blocking: the requests stay queued until the next write availability
+  if (io.would_block()) { return true; }
+
+  bool success          = io.success();
+  std::size_t remaining = io.size;
+
+  //! dispatch the written bytes to the requests, in order
+  for (std::size_t i = 0; i < nb_requests; ++i) {
+    if (success && i > 0 && remaining == 0 && request_sizes[i] > 0) { break; }
+
+    auto& request       = m_write_requests.front();
+    std::size_t written = success ? std::min(remaining, request_sizes[i]) : 0;
+    remaining -= written;
+
+    //! partially written requests stay in front until entirely written
+    request.written += written;
+    m_pending_write_size -= written;
+    if (success && request.written < request.size()) { break; }
+
+    write_result result;
+    result.success = success;
+    result.size    = request.written;
+    result.error   = io.error;
+
+    m_pending_write_size -= request.size() - request.written;
+
+    //! the buffer is not needed anymore: hand it back so that the caller can reuse its storage
+    if (success) { result.buffer = std::move(request.buffer); }
+
+    completions.push_back({std::move(request.on_completion), std::move(result)});
+    m_write_requests.pop_front();
   }
 
-  m_write_requests.pop();
+  if (m_write_requests.empty()) { m_io_service->set_wr_callback(m_socket, nullptr); }
+
+  return success;
+}
+
+bool
+tcp_client::process_file_write(std::vector<write_completion_t>& completions) {
+  auto& request = m_write_requests.front();
+  auto& file    = *request.file;
+
+  std::size_t chunk_size   = std::min<std::size_t>(file.remaining, __TACOPIE_SENDFILE_CHUNK_SIZE);
+  //! never wait for space in the send buffer, as for the other writes
+  tcp_socket::io_result io = m_socket.sendfile(file.fd, file.offset, chunk_size, std::nothrow, true);
+
+  //! nothing could be sent without blocking: retry on the next write availability
+  if (io.would_block()) { return true; }
+
+  file.offset += io.size;
+  file.remaining -= io.size;
+  file.sent += io.size;
+
+  bool success = io.success();
+
+  //! more to send: the request stays in front, other sockets are served in between chunks
+  if (success && file.remaining > 0 && io.size > 0) { return true; }
+
+  write_result result;
+  result.success = success;
+  result.size    = file.sent;
+  result.error   = io.error;
+
+  m_pending_write_size -= request.size();
+  completions.push_back({std::move(request.on_completion), std::move(result)});
+  m_write_requests.pop_front();
+
+  if (m_write_requests.empty()) { m_io_service->set_wr_callback(m_socket, nullptr); }
+
+  return success;
+}
+
+bool
+tcp_client::process_zerocopy_write(std::vector<write_completion_t>& completions) {
+  auto& request            = m_write_requests.front();
+  std::size_t request_size = request.size();
+  bool first_send          = request.written == 0;
+
+  tcp_socket::io_result io;
+
+  {
+    //! held across the send: the notification of this send can only be read once its buffer is registered
+    std::lock_guard<std::mutex> lock(m_read_requests_mtx);
+
+    //! never wait for space in the send buffer, as for the other writes
+    io = m_socket.send_zerocopy(request.buffer.data() + request.written, request.buffer.size() - request.written, std::nothrow, true);
+
+    //! nothing could be sent without blocking: retry on the next write availability
+    if (io.would_block()) { return true; }
+
+    if (io.success()) { request.written += io.size; }
+
+    //! the socket is not polled for read when unread data is pending: notifications are also read here
+    if (!m_zerocopy_buffers.empty()) { release_zerocopy_buffers(); }
+
+    //! the kernel reads the buffer asynchronously: hold it until the notifications of all its sends
+    if (request.written && is_connected()) {
+      if (io.success()) {
+        if (first_send) { m_zerocopy_buffers.push_back({m_zerocopy_next_id, 0, 0, true, std::vector<char>()}); }
+        ++m_zerocopy_buffers.back().nb_sends;
+        poll_for_read(true);
+      }
+
+      auto& zerocopy = m_zerocopy_buffers.back();
+      if (!io.success() || request.written == request.buffer.size()) {
+        zerocopy.sending = false;
+        zerocopy.buffer  = std::move(request.buffer);
+        if (zerocopy.nb_released == zerocopy.nb_sends) { m_zerocopy_buffers.pop_back(); }
+      }
+    }
+  }
+
+  bool success = io.success();
+
+  if (success) {
+    ++m_zerocopy_next_id;
+
+    //! partially sent: the request stays in front until entirely sent, from its first unsent byte
+    if (request.written < request.buffer.size()) { return true; }
+  }
+
+  m_pending_write_size -= request_size;
+
+  write_result result;
+  result.success = success;
+  result.size    = request.written;
+  result.error   = io.error;
+
+  completions.push_back({std::move(request.on_completion), std::move(result)});
+  m_write_requests.pop_front();
 
   if (m_write_requests.empty()) { m_io_service->set_wr_callback(m_socket, nullptr); }
 
-  return callback;
+  return success;
+}
+
+bool
+tcp_client::release_zerocopy_buffers(void) {
+  tcp_socket::zerocopy_completion notification;
+  bool notified = false;
+
+  for (;;) {
+    tcp_socket::io_result io = m_socket.recv_zerocopy_completion(notification, std::nothrow);
+
+    if (io.error) { break; }
+    if (!io.size) { continue; }
+
+    notified = true;
+
+    //! ids wrap around: compare offsets from the first released id
+    std::uint32_t range = notification.last - notification.first;
+    for (auto& zerocopy : m_zerocopy_buffers) {
+      for (std::uint32_t i = 0; i < zerocopy.nb_sends; ++i) {
+        if (static_cast<std::uint32_t>(zerocopy.first_id + i - notification.first) <= range) { ++zerocopy.nb_released; }
+      }
+    }
+  }
+
+  auto it = std::remove_if(m_zerocopy_buffers.begin(), m_zerocopy_buffers.end(), [](const zerocopy_buffer& zerocopy) {
+    return !zerocopy.sending && zerocopy.nb_released == zerocopy.nb_sends;
+  });
+  m_zerocopy_buffers.erase(it, m_zerocopy_buffers.end());
+
+  return notified;
+}
+
+void
+tcp_client::poll_for_read(bool polled) {
+  if (polled == m_polled_for_read) { return; }
+
+  m_io_service->set_rd_callback(m_socket, polled ? m_rd_callback : nullptr);
+  m_polled_for_read = polled;
 }
 
 //!
@@ -241,11 +676,91 @@ tcp_client::process_write(write_result& result) {
 
 void
 tcp_client::async_read(const read_request& request) {
+  push_read_request({request.size, completion<read_result>(async_read_callback_t(request.async_read_callback))});
+}
+
+void
+tcp_client::async_read(const read_request& request, complete_on_disconnect_t) {
+  push_read_request({request.size, completion<read_result>(async_read_callback_t(request.async_read_callback), true)});
+}
+
+void
+tcp_client::async_write(const write_request& request) {
+  push_write_request({request.buffer, completion<write_result>(async_write_callback_t(request.async_write_callback)), nullptr, shared_buffer(), 0});
+}
+
+void
+tcp_client::async_write(write_request&& request) {
+  push_write_request({std::move(request.buffer), completion<write_result>(std::move(request.async_write_callback)), nullptr, shared_buffer(), 0});
+}
+
+void
+tcp_client::async_write(write_request&& request, complete_on_disconnect_t) {
+  push_write_request({std::move(request.buffer), completion<write_result>(std::move(request.async_write_callback), true), nullptr, shared_buffer(), 0});
+}
+
+void
+tcp_client::async_write(const shared_write_request& request) {
+  push_write_request({std::vector<char>(), completion<write_result>(async_write_callback_t(request.async_write_callback)), nullptr, request.buffer, 0});
+}
+
+utils::future<tcp_client::read_result>
+tcp_client::async_read(std::size_t size) {
+  utils::promise<read_result> promise(get_io_service()->get_callback_workers());
+  auto future = promise.get_future();
+
+  push_read_request({size, completion<read_result>(std::move(promise))});
+
+  return future;
+}
+
+utils::future<tcp_client::write_result>
+tcp_client::async_write(std::vector<char> buffer) {
+  utils::promise<write_result> promise(get_io_service()->get_callback_workers());
+  auto future = promise.get_future();
+
+  push_write_request({std::move(buffer), completion<write_result>(std::move(promise)), nullptr, shared_buffer(), 0});
+
+  return future;
+}
+
+utils::future<tcp_client::write_result>
+tcp_client::async_write(const shared_buffer& buffer) {
+  utils::promise<write_result> promise(get_io_service()->get_callback_workers());
+  auto future = promise.get_future();
+
+  push_write_request({std::vector<char>(), completion<write_result>(std::move(promise)), nullptr, buffer, 0});
+
+  return future;
+}
+
+void
+tcp_client::async_sendfile(const sendfile_request& request) {
+  std::unique_ptr<file_range> file(new file_range{request.fd, request.offset, request.size, 0});
+
+  push_write_request({std::vector<char>(), completion<write_result>(async_write_callback_t(request.async_write_callback)), std::move(file), shared_buffer(), 0});
+}
+
+utils::future<tcp_client::write_result>
+tcp_client::async_sendfile(int fd, std::uint64_t offset, std::size_t size) {
+  utils::promise<write_result> promise(get_io_service()->get_callback_workers());
+  auto future = promise.get_future();
+
+  std::unique_ptr<file_range> file(new file_range{fd, offset, size, 0});
+
+  push_write_request({std::vector<char>(), completion<write_result>(std::move(promise)), std::move(file), shared_buffer(), 0});
+
+  return future;
+}
+
+void
+tcp_client::push_read_request(pending_read_request&& request) {
   std::lock_guard<std::mutex> lock(m_read_requests_mtx);
 
   if (is_connected()) {
-    m_io_service->set_rd_callback(m_socket, std::bind(&tcp_client::on_read_available, this, std::placeholders::_1));
-    m_read_requests.push(request);
+    //! the socket is polled for read as long as requests are pending
+    poll_for_read(true);
+    m_read_requests.push_back(std::move(request));
   }
   else {
     __TACOPIE_THROW(warn, "tcp_client is disconnected");
@@ -253,12 +768,14 @@ tcp_client::async_read(const read_request& request) {
 }
 
 void
-tcp_client::async_write(const write_request& request) {
+tcp_client::push_write_request(pending_write_request&& request) {
   std::lock_guard<std::mutex> lock(m_write_requests_mtx);
 
   if (is_connected()) {
-    m_io_service->set_wr_callback(m_socket, std::bind(&tcp_client::on_write_available, this, std::placeholders::_1));
-    m_write_requests.push(request);
+    //! the socket is polled for write as long as requests are pending: only the first one needs to update the tracking
+    if (m_write_requests.empty()) { m_io_service->set_wr_callback(m_socket, m_wr_callback); }
+    m_pending_write_size += request.size();
+    m_write_requests.push_back(std::move(request));
   }
   else {
     __TACOPIE_THROW(warn, "tcp_client is disconnected");
@@ -282,11 +799,79 @@ tcp_client::get_socket(void) const {
 //!
 //! io_service getter
 //!
-const std::shared_ptr<tacopie::io_service>&
+std::shared_ptr<tacopie::io_service>
 tcp_client::get_io_service(void) const {
+  std::lock_guard<std::mutex> lock(m_io_service_mtx);
+
   return m_io_service;
 }
 
+//!
+//! io_service migration
+//!
+
+void
+tcp_client::set_io_service(const std::shared_ptr<tacopie::io_service>& io_service) {
+  if (!io_service) { __TACOPIE_THROW(error, "tcp_client::set_io_service: null io_service"); }
+
+  //! callbacks the previous io_service may still run find the callback guard busy while the callbacks of the new one execute client code, and conversely
+  std::lock_guard<std::mutex> connect_lock(m_connect_mtx);
+
+  if (m_is_connecting) { __TACOPIE_THROW(warn, "tcp_client is connecting: cannot migrate"); }
+
+  std::lock_guard<std::mutex> io_service_lock(m_io_service_mtx);
+  std::lock_guard<std::mutex> write_lock(m_write_requests_mtx);
+  std::lock_guard<std::mutex> read_lock(m_read_requests_mtx);
+
+  if (io_service == m_io_service) { return; }
+
+  std::shared_ptr<tacopie::io_service> previous = m_io_service;
+  m_io_service                                  = io_service;
+
+  if (!is_connected()) { return; }
+
+  //! polled by the new io_service before the previous one stops: readiness is level-triggered, no event can be lost in between
+  io_service->track(m_socket, nullptr, nullptr, m_priority);
+  if (m_polled_for_read) { io_service->set_rd_callback(m_socket, m_rd_callback); }
+  if (!m_write_requests.empty()) { io_service->set_wr_callback(m_socket, m_wr_callback); }
+
+  previous->untrack(m_socket);
+
+  __TACOPIE_LOG(info, "tcp_client migrated to another io_service");
+}
+
+//!
+//! priority
+//!
+
+void
+tcp_client::set_priority(utils::thread_pool::priority prio) {
+  m_priority = prio;
+
+  std::lock_guard<std::mutex> lock(m_io_service_mtx);
+  if (is_connected()) { m_io_service->set_priority(m_socket, prio); }
+}
+
+//!
+//! zero-copy writes
+//!
+
+void
+tcp_client::set_zerocopy_threshold(std::size_t threshold) {
+  if (threshold) { m_socket.set_zerocopy(true); }
+
+  m_zerocopy_threshold = threshold;
+}
+
+//!
+//! pending writes
+//!
+
+std::size_t
+tcp_client::get_pending_write_size(void) const {
+  return m_pending_write_size;
+}
+
 //!
 //! set on disconnection handler
 //!
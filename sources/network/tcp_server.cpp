@@ -25,6 +25,14 @@
 #include <tacopie/utils/logger.hpp>
 
 #include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/select.h>
+#include <unistd.h>
+#endif /* _WIN32 */
 
 namespace tacopie {
 
@@ -33,8 +41,17 @@ namespace tacopie {
 //!
 
 tcp_server::tcp_server(void)
-: m_io_service(get_default_io_service())
-, m_on_new_connection_callback(nullptr) { __TACOPIE_LOG(debug, "create tcp_server"); }
+: tcp_server(get_default_io_service()) {}
+
+tcp_server::tcp_server(const std::shared_ptr<tacopie::io_service>& io_service)
+: m_io_service(io_service)
+, m_clients_snapshot(std::make_shared<const clients_snapshot::clients_t>())
+, m_on_new_connection_callback(nullptr)
+, m_admission(std::make_shared<admission_state>()) {
+  if (!m_io_service) { __TACOPIE_THROW(error, "tcp_server: null io_service"); }
+
+  __TACOPIE_LOG(debug, "create tcp_server");
+}
 
 tcp_server::~tcp_server(void) {
   __TACOPIE_LOG(debug, "destroy tcp_server");
@@ -52,18 +69,315 @@ tcp_server::start(const std::string& host, std::uint32_t port, const on_new_conn
   m_socket.bind(host, port);
   m_socket.listen(__TACOPIE_CONNECTION_QUEUE_SIZE);
 
-  m_io_service->track(m_socket);
-  m_io_service->set_rd_callback(m_socket, std::bind(&tcp_server::on_read_available, this, std::placeholders::_1));
+  start_accepting(callback);
+}
+
+void
+tcp_server::take_over(const std::string& path, const on_new_connection_callback_t& callback) {
+  if (is_running()) { __TACOPIE_THROW(warn, "tcp_server is already running"); }
+
+  tcp_socket channel;
+  tcp_socket socket;
+
+  try {
+    channel.connect(path, 0);
+    socket = channel.recv_socket();
+  }
+  catch (const tacopie::tacopie_error&) {
+    channel.close();
+    throw;
+  }
+
+  channel.close();
+
+  if (socket.get_type() != tcp_socket::type::SERVER) {
+    socket.close();
+    __TACOPIE_THROW(error, "tcp_server::take_over: received socket is not a server socket");
+  }
+
+  m_socket = std::move(socket);
+
+  __TACOPIE_LOG(info, "tcp_server took over server socket");
+
+  start_accepting(callback);
+}
+
+void
+tcp_server::hand_over(const std::string& path, std::uint32_t timeout_msecs) {
+  if (!is_running()) { __TACOPIE_THROW(warn, "tcp_server is not running"); }
+
+#ifdef _WIN32
+  (void) path;
+  (void) timeout_msecs;
+  __TACOPIE_THROW(error, "tcp_server::hand_over: not supported on this platform");
+#else
+  //! a path left by a previous restart would make bind() fail
+  ::unlink(path.c_str());
+
+  tcp_socket listener;
+  tcp_socket channel;
+
+  //! flags of the server socket before switching it to non-blocking mode, -1 if not switched
+  int fd_flags = -1;
+
+  try {
+    listener.bind(path, 0);
+    listener.listen(1);
+
+    __TACOPIE_LOG(info, "tcp_server waiting for a process to take the server socket over");
+
+    if (timeout_msecs > 0) {
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET(listener.get_fd(), &set);
+
+      struct timeval tv;
+      tv.tv_sec  = timeout_msecs / 1000;
+      tv.tv_usec = (timeout_msecs % 1000) * 1000;
+
+      int ret;
+      do {
+        ret = ::select(listener.get_fd() + 1, &set, NULL, NULL, &tv);
+      } while (ret == -1 && errno == EINTR);
+
+      if (ret == -1) { __TACOPIE_THROW(error, "select() failure"); }
+      if (ret == 0) { __TACOPIE_THROW(error, "tcp_server::hand_over: no process took the server socket over before the timeout"); }
+    }
+
+    channel = listener.accept();
+
+    int flags = ::fcntl(m_socket.get_fd(), F_GETFL, 0);
+    if (flags == -1 || ::fcntl(m_socket.get_fd(), F_SETFL, flags | O_NONBLOCK) == -1) {
+      __TACOPIE_THROW(error, "fcntl() failure");
+    }
+    fd_flags = flags;
+
+    channel.send_socket(m_socket);
+  }
+  catch (const tacopie::tacopie_error&) {
+    //! not handed over: the server socket is back to its own mode
+    if (fd_flags != -1) { ::fcntl(m_socket.get_fd(), F_SETFL, fd_flags); }
+
+    channel.close();
+    listener.close();
+    ::unlink(path.c_str());
+    throw;
+  }
+
+  channel.close();
+  listener.close();
+  ::unlink(path.c_str());
+
+  __TACOPIE_LOG(info, "tcp_server handed server socket over");
+#endif /* _WIN32 */
+}
+
+void
+tcp_server::start_accepting(const on_new_connection_callback_t& callback) {
+#ifndef _WIN32
+  {
+    std::lock_guard<std::mutex> lock(m_admission->mtx);
+    m_reserve_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+  }
+#endif /* _WIN32 */
+
+  //! set before the first accept: connections pending in the backlog are processed as soon as the socket is tracked
   m_on_new_connection_callback = callback;
+  m_is_running                 = true;
 
-  m_is_running = true;
+  m_io_service->track(m_socket);
+  m_io_service->set_rd_callback(m_socket, std::bind(&tcp_server::on_read_available, this, std::placeholders::_1));
 
   __TACOPIE_LOG(info, "tcp_server running");
 }
 
 void
 tcp_server::stop(bool wait_for_removal, bool recursive_wait_for_removal) {
-  if (!is_running()) { return; }
+  std::shared_ptr<drain_state> drain;
+  {
+    std::lock_guard<std::mutex> lock(m_clients_mtx);
+    std::swap(drain, m_drain);
+  }
+
+  //! drain in progress: the remaining clients are disconnected right away
+  if (drain) { end_drain(drain); }
+
+  if (!stop_accepting(wait_for_removal)) { return; }
+
+  //! disconnected without the lock: waiting for removal must not block the callbacks of the clients
+  for (auto& client : take_clients()) {
+    client->disconnect(recursive_wait_for_removal && wait_for_removal);
+  }
+
+  __TACOPIE_LOG(info, "tcp_server stopped");
+}
+
+void
+tcp_server::drain(std::uint32_t timeout_msecs, const drain_progress_handler_t& progress_handler) {
+  auto drain                  = std::make_shared<drain_state>();
+  drain->progress             = {0, 0, 0, 0};
+  drain->progress_handler     = progress_handler;
+  drain->is_complete_reported = false;
+
+  if (!stop_accepting(true)) {
+    report_drain_progress(drain);
+    return;
+  }
+
+  __TACOPIE_LOG(info, "tcp_server draining");
+
+  {
+    std::lock_guard<std::mutex> lock(m_clients_mtx);
+
+    for (auto& client : m_clients) { drain->clients.emplace(client, false); }
+    drain->progress.nb_clients = m_clients.size();
+
+    m_clients.clear();
+    invalidate_clients_snapshot();
+    m_drain = drain;
+  }
+
+  //! first report, then one per flushed or closed client
+  report_drain_progress(drain);
+
+  std::vector<std::shared_ptr<tcp_client>> clients;
+  {
+    std::lock_guard<std::mutex> lock(drain->mtx);
+    for (const auto& client : drain->clients) { clients.push_back(client.first); }
+  }
+
+  for (const auto& client : clients) { flush_drained_client(drain, client); }
+
+  m_io_service->schedule(timeout_msecs, [drain] { end_drain(drain); });
+}
+
+void
+tcp_server::flush_drained_client(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client) {
+  //! weak reference: the client must not keep itself alive through its own request
+  std::weak_ptr<tcp_client> weak_client = client;
+
+  try {
+    //! writes are performed in order: the empty write completes once the pending ones are flushed
+    client->async_write({std::vector<char>(), [drain, weak_client](tcp_client::write_result& result) {
+                           auto flushed_client = weak_client.lock();
+                           if (flushed_client) { on_drained_client_flushed(drain, flushed_client, result.success); }
+                         }});
+  }
+  catch (const tacopie::tacopie_error&) {
+    //! already disconnected
+    on_drained_client_flushed(drain, client, false);
+  }
+}
+
+void
+tcp_server::on_drained_client_flushed(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client, bool success) {
+  {
+    std::lock_guard<std::mutex> lock(drain->mtx);
+
+    auto it = drain->clients.find(client);
+    if (it == drain->clients.end() || it->second) { return; }
+
+    it->second = true;
+    ++drain->progress.nb_flushed;
+  }
+
+  //! the peer reads everything sent so far, then end of file
+  if (success) {
+    try {
+      client->get_socket().shutdown(tcp_socket::shutdown_type::WRITE);
+    }
+    catch (const tacopie::tacopie_error&) {
+      __TACOPIE_LOG(warn, "could not half-close drained client");
+      success = false;
+    }
+  }
+
+  report_drain_progress(drain);
+
+  if (success) { discard_until_eof(drain, client); }
+  else { close_drained_client(drain, client); }
+}
+
+void
+tcp_server::discard_until_eof(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client) {
+  std::weak_ptr<tcp_client> weak_client = client;
+
+  try {
+    client->async_read({__TACOPIE_DRAIN_READ_SIZE, [drain, weak_client](tcp_client::read_result& result) {
+                          auto drained_client = weak_client.lock();
+                          if (!drained_client) { return; }
+
+                          //! failure: closed by the peer (or disconnected)
+                          if (result.success) { discard_until_eof(drain, drained_client); }
+                          else { close_drained_client(drain, drained_client); }
+                        }});
+  }
+  catch (const tacopie::tacopie_error&) {
+    close_drained_client(drain, client);
+  }
+}
+
+void
+tcp_server::close_drained_client(const std::shared_ptr<drain_state>& drain, const std::shared_ptr<tcp_client>& client) {
+  {
+    std::lock_guard<std::mutex> lock(drain->mtx);
+
+    auto it = drain->clients.find(client);
+    if (it == drain->clients.end()) { return; }
+
+    if (!it->second) { __TACOPIE_LOG(warn, "drained client disconnected with pending writes"); }
+
+    drain->clients.erase(it);
+    ++drain->progress.nb_closed;
+  }
+
+  //! without the lock: requests issued with complete_on_disconnect are completed by this thread, and may come back to the drain
+  //! never waits for removal: called from the io_service workers
+  client->disconnect(false);
+
+  report_drain_progress(drain);
+}
+
+void
+tcp_server::end_drain(const std::shared_ptr<drain_state>& drain) {
+  std::vector<std::shared_ptr<tcp_client>> clients;
+  {
+    std::lock_guard<std::mutex> lock(drain->mtx);
+    for (const auto& client : drain->clients) { clients.push_back(client.first); }
+  }
+
+  for (const auto& client : clients) { close_drained_client(drain, client); }
+}
+
+void
+tcp_server::report_drain_progress(const std::shared_ptr<drain_state>& drain) {
+  std::lock_guard<std::mutex> report_lock(drain->report_mtx);
+
+  if (drain->is_complete_reported) { return; }
+
+  drain_progress progress;
+  {
+    std::lock_guard<std::mutex> lock(drain->mtx);
+
+    progress                        = drain->progress;
+    progress.nb_pending_write_bytes = 0;
+
+    for (const auto& client : drain->clients) {
+      if (!client.second) { progress.nb_pending_write_bytes += client.first->get_pending_write_size(); }
+    }
+  }
+
+  if (progress.nb_closed == progress.nb_clients) {
+    drain->is_complete_reported = true;
+    __TACOPIE_LOG(info, "tcp_server drained");
+  }
+
+  if (drain->progress_handler) { drain->progress_handler(progress); }
+}
+
+bool
+tcp_server::stop_accepting(bool wait_for_removal) {
+  if (!is_running()) { return false; }
 
   m_is_running = false;
 
@@ -71,13 +385,26 @@ tcp_server::stop(bool wait_for_removal, bool recursive_wait_for_removal) {
   if (wait_for_removal) { m_io_service->wait_for_removal(m_socket); }
   m_socket.close();
 
-  std::lock_guard<std::mutex> lock(m_clients_mtx);
-  for (auto& client : m_clients) {
-    client->disconnect(recursive_wait_for_removal && wait_for_removal);
+#ifndef _WIN32
+  {
+    std::lock_guard<std::mutex> lock(m_admission->mtx);
+    if (m_reserve_fd != __TACOPIE_INVALID_FD) { ::close(m_reserve_fd); }
+    m_reserve_fd = __TACOPIE_INVALID_FD;
   }
-  m_clients.clear();
+#endif /* _WIN32 */
 
-  __TACOPIE_LOG(info, "tcp_server stopped");
+  return true;
+}
+
+std::unordered_set<std::shared_ptr<tacopie::tcp_client>>
+tcp_server::take_clients(void) {
+  std::unordered_set<std::shared_ptr<tacopie::tcp_client>> clients;
+
+  std::lock_guard<std::mutex> lock(m_clients_mtx);
+  std::swap(clients, m_clients);
+  invalidate_clients_snapshot();
+
+  return clients;
 }
 
 //!
@@ -86,16 +413,46 @@ tcp_server::stop(bool wait_for_removal, bool recursive_wait_for_removal) {
 
 void
 tcp_server::on_read_available(fd_t) {
+  __TACOPIE_LOG(info, "tcp_server received new connection");
+
+  int error;
+  tcp_socket socket = m_socket.accept(std::nothrow, error);
+
+  if (error) {
+    on_accept_failure(error);
+    return;
+  }
+
+  if (!admit(socket.get_host())) {
+    __TACOPIE_LOG(warn, "tcp_server rejected new connection: admission limit reached");
+    socket.close();
+    return;
+  }
+
   try {
-    __TACOPIE_LOG(info, "tcp_server received new connection");
+    tcp_socket::options client_options = get_client_options();
+    try {
+      socket.set_options(client_options);
+    }
+    catch (const tacopie::tacopie_error&) {
+      __TACOPIE_LOG(warn, "could not apply socket options to accepted client");
+    }
 
-    auto client = std::make_shared<tcp_client>(m_socket.accept());
+    auto client = make_client(std::move(socket));
 
     if (!m_on_new_connection_callback || !m_on_new_connection_callback(client)) {
       __TACOPIE_LOG(info, "connection handling delegated to tcp_server");
 
-      client->set_on_disconnection_handler(std::bind(&tcp_server::on_client_disconnected, this, client));
-      m_clients.push_back(client);
+      //! weak reference: the client must not keep itself alive through its own handler
+      std::weak_ptr<tcp_client> weak_client = client;
+      client->set_on_disconnection_handler([this, weak_client] {
+        auto disconnected_client = weak_client.lock();
+        if (disconnected_client) { on_client_disconnected(disconnected_client); }
+      });
+
+      std::lock_guard<std::mutex> lock(m_clients_mtx);
+      m_clients.insert(client);
+      invalidate_clients_snapshot();
     }
     else {
       __TACOPIE_LOG(info, "connection handled by tcp_server wrapper");
@@ -107,6 +464,137 @@ tcp_server::on_read_available(fd_t) {
   }
 }
 
+void
+tcp_server::on_accept_failure(int error) {
+#ifdef _WIN32
+  bool is_aborted       = error == WSAECONNRESET || error == WSAEWOULDBLOCK || error == WSAEINTR;
+  bool is_fd_exhaustion = error == WSAEMFILE || error == WSAENOBUFS;
+#else
+  bool is_aborted       = error == ECONNABORTED || error == EPROTO || error == EAGAIN || error == EWOULDBLOCK || error == EINTR;
+  bool is_fd_exhaustion = error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM;
+#endif /* _WIN32 */
+
+  //! the connection vanished before being accepted: nothing to do
+  if (is_aborted) { return; }
+
+  if (!is_fd_exhaustion) {
+    __TACOPIE_LOG(warn, "accept operation failure");
+    stop();
+    return;
+  }
+
+  __TACOPIE_LOG(warn, "tcp_server ran out of file descriptors: new connection dropped");
+
+  std::lock_guard<std::mutex> lock(m_admission->mtx);
+  ++m_admission->stats.nb_rejected_fd_exhaustion;
+
+#ifndef _WIN32
+  //! the pending connection would keep the server socket readable: free the reserve fd to accept and close it
+  if (m_reserve_fd == __TACOPIE_INVALID_FD) { return; }
+
+  ::close(m_reserve_fd);
+
+  int accept_error;
+  tcp_socket pending = m_socket.accept(std::nothrow, accept_error);
+  pending.close();
+
+  m_reserve_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+#endif /* _WIN32 */
+}
+
+//!
+//! admission control
+//!
+
+bool
+tcp_server::admit(const std::string& host) {
+  std::lock_guard<std::mutex> lock(m_admission->mtx);
+
+  auto& state      = *m_admission;
+  const auto& opts = state.options;
+
+  if (opts.max_connections && state.nb_connections >= opts.max_connections) {
+    ++state.stats.nb_rejected_max_connections;
+    return false;
+  }
+
+  if (opts.max_connections_per_host) {
+    auto it = state.nb_connections_per_host.find(host);
+
+    if (it != state.nb_connections_per_host.end() && it->second >= opts.max_connections_per_host) {
+      ++state.stats.nb_rejected_max_connections_per_host;
+      return false;
+    }
+  }
+
+  if (opts.accept_rate) {
+    auto now      = std::chrono::steady_clock::now();
+    double burst  = opts.accept_burst ? opts.accept_burst : opts.accept_rate;
+    double tokens = state.tokens + std::chrono::duration<double>(now - state.last_refill).count() * opts.accept_rate;
+
+    state.tokens      = tokens > burst ? burst : tokens;
+    state.last_refill = now;
+
+    if (state.tokens < 1) {
+      ++state.stats.nb_rejected_accept_rate;
+      return false;
+    }
+
+    state.tokens -= 1;
+  }
+
+  ++state.nb_connections;
+  ++state.nb_connections_per_host[host];
+
+  return true;
+}
+
+std::shared_ptr<tcp_client>
+tcp_server::make_client(tcp_socket&& socket) {
+  std::shared_ptr<admission_state> admission = m_admission;
+  std::string host                           = socket.get_host();
+
+  return std::shared_ptr<tcp_client>(new tcp_client(std::move(socket), m_io_service), [admission, host](tcp_client* client) {
+    delete client;
+
+    std::lock_guard<std::mutex> lock(admission->mtx);
+    --admission->nb_connections;
+
+    auto it = admission->nb_connections_per_host.find(host);
+    if (it != admission->nb_connections_per_host.end() && --it->second == 0) { admission->nb_connections_per_host.erase(it); }
+  });
+}
+
+void
+tcp_server::set_admission_options(const admission_options& opts) {
+  std::lock_guard<std::mutex> lock(m_admission->mtx);
+
+  m_admission->options     = opts;
+  m_admission->tokens      = opts.accept_burst ? opts.accept_burst : opts.accept_rate;
+  m_admission->last_refill = std::chrono::steady_clock::now();
+}
+
+tcp_server::admission_options
+tcp_server::get_admission_options(void) const {
+  std::lock_guard<std::mutex> lock(m_admission->mtx);
+
+  return m_admission->options;
+}
+
+tcp_server::admission_stats
+tcp_server::get_admission_stats(void) const {
+  std::lock_guard<std::mutex> lock(m_admission->mtx);
+
+  return m_admission->stats;
+}
+
+std::size_t
+tcp_server::get_nb_connections(void) const {
+  std::lock_guard<std::mutex> lock(m_admission->mtx);
+
+  return m_admission->nb_connections;
+}
+
 //!
 //! client disconnected
 //!
@@ -120,9 +608,8 @@ tcp_server::on_client_disconnected(const std::shared_ptr<tcp_client>& client) {
   __TACOPIE_LOG(debug, "handle server's client disconnection");
 
   std::lock_guard<std::mutex> lock(m_clients_mtx);
-  auto it = std::find(m_clients.begin(), m_clients.end(), client);
 
-  if (it != m_clients.end()) { m_clients.erase(it); }
+  if (m_clients.erase(client)) { invalidate_clients_snapshot(); }
 }
 
 //!
@@ -148,6 +635,22 @@ tcp_server::get_socket(void) const {
   return m_socket;
 }
 
+//!
+//! accepted clients socket options
+//!
+
+void
+tcp_server::set_client_options(const tcp_socket::options& opts) {
+  std::lock_guard<std::mutex> lock(m_client_options_mtx);
+  m_client_options = opts;
+}
+
+tcp_socket::options
+tcp_server::get_client_options(void) const {
+  std::lock_guard<std::mutex> lock(m_client_options_mtx);
+  return m_client_options;
+}
+
 //!
 //! io_service getter
 //!
@@ -157,12 +660,37 @@ tcp_server::get_io_service(void) const {
 }
 
 //!
-//! get client sockets
+//! get clients
 //!
 
-const std::list<std::shared_ptr<tacopie::tcp_client>>&
+tcp_server::clients_snapshot
 tcp_server::get_clients(void) const {
-  return m_clients;
+  //! fast path: no change since the last rebuild
+  auto clients = m_clients_snapshot.load();
+  if (clients) { return clients_snapshot(clients); }
+
+  std::lock_guard<std::mutex> lock(m_clients_mtx);
+
+  //! another caller may have rebuilt it while we were waiting for the lock
+  clients = m_clients_snapshot.load();
+  if (!clients) {
+    clients = std::make_shared<const clients_snapshot::clients_t>(m_clients.begin(), m_clients.end());
+    m_clients_snapshot.store(clients);
+  }
+
+  return clients_snapshot(clients);
+}
+
+void
+tcp_server::invalidate_clients_snapshot(void) {
+  m_clients_snapshot.store(nullptr);
+}
+
+std::size_t
+tcp_server::get_nb_clients(void) const {
+  std::lock_guard<std::mutex> lock(m_clients_mtx);
+
+  return m_clients.size();
 }
 
 //!
@@ -27,6 +27,7 @@
 #include <tacopie/utils/error.hpp>
 #include <tacopie/utils/logger.hpp>
 
+#include <algorithm>
 #include <cstring>
 
 #include <arpa/inet.h>
@@ -36,13 +37,73 @@
 #include <sys/select.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <sys/sendfile.h>
+#endif /* __linux__ */
+
+//! writing to a connection reset by the peer fails with EPIPE instead of raising SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define __TACOPIE_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define __TACOPIE_SEND_FLAGS 0
+#endif /* MSG_NOSIGNAL */
+
 namespace tacopie {
 
 void
 tcp_socket::connect(const std::string& host, std::uint32_t port, std::uint32_t timeout_msecs) {
+  start_connect(host, port, timeout_msecs > 0);
+
+  if (timeout_msecs > 0) {
+    timeval tv;
+    tv.tv_sec  = (timeout_msecs / 1000);
+    tv.tv_usec = ((timeout_msecs - (tv.tv_sec * 1000)) * 1000);
+
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(m_fd, &set);
+
+    //! 1 means we are connected.
+    //! 0/-1 means a timeout.
+    if (select(m_fd + 1, NULL, &set, NULL, &tv) == 1) {
+      try {
+        finish_connect();
+      }
+      catch (const tacopie_error& e) {
+        close();
+        throw e;
+      }
+    }
+    else {
+      close();
+      __TACOPIE_THROW(error, "connect() timed out");
+    }
+  }
+}
+
+void
+tcp_socket::connect_async(const std::string& host, std::uint32_t port) {
+  start_connect(host, port, true);
+}
+
+void
+tcp_socket::finish_connect(void) {
+  //! Make sure there are no async connection errors
+  int err       = 0;
+  socklen_t len = sizeof(err);
+  if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1 || err != 0) { __TACOPIE_THROW(error, "connect() failure"); }
+
+  //! Set back to blocking mode as the user of this class is expecting
+  if (fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) & (~O_NONBLOCK)) == -1) { __TACOPIE_THROW(error, "connect() set blocking failure"); }
+}
+
+void
+tcp_socket::start_connect(const std::string& host, std::uint32_t port, bool non_blocking) {
   //! Reset host and port
   m_host = host;
   m_port = port;
@@ -102,8 +163,8 @@ tcp_socket::connect(const std::string& host, std::uint32_t port, std::uint32_t t
     freeaddrinfo(result);
   }
 
-  if (timeout_msecs > 0) {
-    //! for timeout connection handling:
+  if (non_blocking) {
+    //! for timeout or asynchronous connection handling:
     //!  1. set socket to non blocking
     //!  2. connect
     //!  3. poll select
@@ -127,38 +188,419 @@ tcp_socket::connect(const std::string& host, std::uint32_t port, std::uint32_t t
     close();
     __TACOPIE_THROW(error, "connect() failure");
   }
+}
 
-  if (timeout_msecs > 0) {
-    timeval tv;
-    tv.tv_sec  = (timeout_msecs / 1000);
-    tv.tv_usec = ((timeout_msecs - (tv.tv_sec * 1000)) * 1000);
+//!
+//! client socket operations
+//!
 
-    fd_set set;
-    FD_ZERO(&set);
-    FD_SET(m_fd, &set);
+std::size_t
+tcp_socket::sendv(const const_buffer* buffers, std::size_t nb_buffers) {
+  io_result result = sendv(buffers, nb_buffers, std::nothrow);
 
-    //! 1 means we are connected.
-    //! 0/-1 means a timeout.
-    if (select(m_fd + 1, NULL, &set, NULL, &tv) == 1) {
-      //! Make sure there are no async connection errors
-      int err       = 0;
-      socklen_t len = sizeof(len);
-      if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1 || err != 0) {
-        close();
-        __TACOPIE_THROW(error, "connect() failure");
-      }
+  if (result.error) { __TACOPIE_THROW(error, "sendmsg() failure"); }
 
-      //! Set back to blocking mode as the user of this class is expecting
-      if (fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL, 0) & (~O_NONBLOCK)) == -1) {
-        close();
-        __TACOPIE_THROW(error, "connect() set blocking failure");
+  return result.size;
+}
+
+tcp_socket::io_result
+tcp_socket::sendv(const const_buffer* buffers, std::size_t nb_buffers, std::nothrow_t, bool non_blocking) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  if (nb_buffers > __TACOPIE_MAX_IOVEC) { nb_buffers = __TACOPIE_MAX_IOVEC; }
+
+  struct iovec iov[__TACOPIE_MAX_IOVEC];
+  for (std::size_t i = 0; i < nb_buffers; ++i) {
+    iov[i].iov_base = const_cast<char*>(buffers[i].data);
+    iov[i].iov_len  = buffers[i].size;
+  }
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = nb_buffers;
+
+  io_result result = {0, 0, false};
+
+  int flags = non_blocking ? MSG_DONTWAIT | __TACOPIE_SEND_FLAGS : __TACOPIE_SEND_FLAGS;
+
+  ssize_t wr_size = ::sendmsg(m_fd, &msg, flags);
+
+  if (wr_size == -1) {
+    result.error = errno;
+  }
+  else {
+    result.size = wr_size;
+  }
+
+  return result;
+}
+
+tcp_socket::io_result
+tcp_socket::send_zerocopy(const char* data, std::size_t size_to_write, std::nothrow_t, bool non_blocking) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  io_result result = {0, 0, false};
+
+#ifdef MSG_ZEROCOPY
+  int flags       = non_blocking ? MSG_DONTWAIT | MSG_ZEROCOPY | __TACOPIE_SEND_FLAGS : MSG_ZEROCOPY | __TACOPIE_SEND_FLAGS;
+  ssize_t wr_size = ::send(m_fd, data, size_to_write, flags);
+
+  if (wr_size == -1) {
+    result.error = errno;
+  }
+  else {
+    result.size = wr_size;
+  }
+#else
+  (void) data;
+  (void) size_to_write;
+  (void) non_blocking;
+  result.error = EOPNOTSUPP;
+#endif /* MSG_ZEROCOPY */
+
+  return result;
+}
+
+tcp_socket::io_result
+tcp_socket::recv_zerocopy_completion(zerocopy_completion& completion, std::nothrow_t) {
+  io_result result = {0, 0, false};
+
+#if defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+  //! notifications are read from the error queue as ancillary data, there is no payload
+  char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_control    = control;
+  msg.msg_controllen = sizeof(control);
+
+  if (::recvmsg(m_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) {
+    result.error = errno;
+    return result;
+  }
+
+  for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+    bool is_recverr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) || (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+    if (!is_recverr) { continue; }
+
+    struct sock_extended_err err;
+    std::memcpy(&err, CMSG_DATA(cm), sizeof(err));
+    if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) { continue; }
+
+    completion.first  = err.ee_info;
+    completion.last   = err.ee_data;
+    completion.copied = (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+    result.size       = 1;
+    return result;
+  }
+
+  //! not a zero-copy notification: consumed, nothing to report
+#else
+  (void) completion;
+  result.error = EOPNOTSUPP;
+#endif /* MSG_ZEROCOPY && SO_EE_ORIGIN_ZEROCOPY */
+
+  return result;
+}
+
+std::size_t
+tcp_socket::sendfile(int file_fd, std::uint64_t offset, std::size_t size) {
+  io_result result = sendfile(file_fd, offset, size, std::nothrow);
+
+  if (result.error) { __TACOPIE_THROW(error, "sendfile() failure"); }
+
+  return result.size;
+}
+
+#ifdef __linux__
+//!
+//! sendfile(2) and splice(2) take no per-call MSG_DONTWAIT: the socket is switched to non-blocking mode for the duration of the call
+//!
+class scoped_non_blocking {
+public:
+  scoped_non_blocking(int fd, bool enabled)
+  : m_fd(fd)
+  , m_flags(-1) {
+    if (!enabled) { return; }
+
+    int flags = ::fcntl(fd, F_GETFL, 0);
+
+    if (flags != -1 && !(flags & O_NONBLOCK) && ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1) { m_flags = flags; }
+  }
+
+  ~scoped_non_blocking(void) {
+    if (m_flags != -1) { ::fcntl(m_fd, F_SETFL, m_flags); }
+  }
+
+  scoped_non_blocking(const scoped_non_blocking&) = delete;
+  scoped_non_blocking& operator=(const scoped_non_blocking&) = delete;
+
+private:
+  int m_fd;
+
+  //! flags to restore, -1 if unchanged
+  int m_flags;
+};
+#endif /* __linux__ */
+
+tcp_socket::io_result
+tcp_socket::sendfile(int file_fd, std::uint64_t offset, std::size_t size, std::nothrow_t, bool non_blocking) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  io_result result = {0, 0, false};
+
+#ifdef __linux__
+  scoped_non_blocking non_blocking_guard(m_fd, non_blocking);
+
+  //! bytes left in the pipe by a previous call for another range: they will never be sent
+  if (m_splice_pipe.size && (m_splice_pipe.file_fd != file_fd || m_splice_pipe.offset != offset)) { close_splice_pipe(); }
+
+  //! the pipe is not used by sendfile(2): only try it when the pipe is empty, to keep the bytes in order
+  if (!m_splice_pipe.size) {
+    off_t file_offset = static_cast<off_t>(offset);
+    ssize_t wr_size   = ::sendfile(m_fd, file_fd, &file_offset, size);
+
+    if (wr_size != -1) {
+      result.size = wr_size;
+      return result;
+    }
+
+    //! EINVAL: the file does not support sendfile, other errors are reported
+    if (errno != EINVAL && errno != ENOSYS) {
+      result.error = errno;
+      return result;
+    }
+  }
+
+  //! move the bytes through a pipe instead, still without copying them to user space
+  if (m_splice_pipe.read_fd == -1) {
+    int pipe_fds[2];
+    if (::pipe(pipe_fds) == -1) {
+      result.error = errno;
+      return result;
+    }
+
+    m_splice_pipe.read_fd  = pipe_fds[0];
+    m_splice_pipe.write_fd = pipe_fds[1];
+  }
+
+  unsigned int splice_flags = non_blocking ? SPLICE_F_MOVE | SPLICE_F_NONBLOCK : SPLICE_F_MOVE;
+  bool splice_supported     = true;
+
+  while (result.size < size) {
+    //! refill the pipe once drained
+    if (!m_splice_pipe.size) {
+      loff_t splice_offset = static_cast<loff_t>(offset + result.size);
+      ssize_t in_size      = ::splice(file_fd, &splice_offset, m_splice_pipe.write_fd, NULL, size - result.size, splice_flags);
+
+      if (in_size == 0) { break; }
+
+      if (in_size == -1) {
+        if (errno == EINTR) { continue; }
+        splice_supported = result.size > 0 || errno != EINVAL;
+        if (splice_supported) { result.error = errno; }
+        break;
       }
+
+      m_splice_pipe.file_fd = file_fd;
+      m_splice_pipe.offset  = offset + result.size;
+      m_splice_pipe.size    = in_size;
     }
-    else {
-      close();
-      __TACOPIE_THROW(error, "connect() timed out");
+
+    //! the pipe may hold more than requested when a previous call left bytes in it
+    std::size_t to_send = std::min(m_splice_pipe.size, size - result.size);
+    ssize_t out_size    = ::splice(m_splice_pipe.read_fd, NULL, m_fd, NULL, to_send, splice_flags | SPLICE_F_MORE);
+
+    if (out_size == -1) {
+      if (errno == EINTR) { continue; }
+      result.error = errno;
+      break;
     }
+
+    m_splice_pipe.offset += out_size;
+    m_splice_pipe.size -= out_size;
+    result.size += out_size;
   }
+
+  if (splice_supported) {
+    //! the socket is full: report the progress made, the bytes left in the pipe are sent on the next call
+    if (result.size > 0 && result.would_block()) { result.error = 0; }
+    return result;
+  }
+
+  close_splice_pipe();
+#endif /* __linux__ */
+
+  //! copy through user space
+  char buffer[__TACOPIE_SENDFILE_COPY_BUFFER_SIZE];
+  std::size_t to_read = std::min(size, sizeof(buffer));
+
+  ssize_t rd_size = ::pread(file_fd, buffer, to_read, static_cast<off_t>(offset));
+
+  if (rd_size == -1) {
+    result.error = errno;
+    return result;
+  }
+
+  //! in non-blocking mode, the bytes read but not sent are read again by the next call
+  int flags = non_blocking ? MSG_DONTWAIT | __TACOPIE_SEND_FLAGS : __TACOPIE_SEND_FLAGS;
+
+  std::size_t sent = 0;
+  while (sent < static_cast<std::size_t>(rd_size)) {
+    ssize_t wr_size = ::send(m_fd, buffer + sent, rd_size - sent, flags);
+
+    if (wr_size == -1) {
+      if (errno == EINTR) { continue; }
+      result.error = errno;
+      break;
+    }
+
+    sent += wr_size;
+  }
+
+  result.size = sent;
+
+  //! the socket is full: report the progress made
+  if (result.size > 0 && result.would_block()) { result.error = 0; }
+
+  return result;
+}
+
+//!
+//! socket passing
+//! the description of the socket (port, type, host size, then host) is the payload, the descriptor travels as ancillary data with its first byte
+//!
+
+void
+tcp_socket::send_socket(const tcp_socket& socket) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  if (socket.m_host.size() > NI_MAXHOST) { __TACOPIE_THROW(error, "send_socket() failure: host too long"); }
+
+  std::uint32_t header[3] = {socket.m_port, static_cast<std::uint32_t>(socket.m_type), static_cast<std::uint32_t>(socket.m_host.size())};
+
+  std::vector<char> payload(reinterpret_cast<const char*>(header), reinterpret_cast<const char*>(header) + sizeof(header));
+  payload.insert(payload.end(), socket.m_host.begin(), socket.m_host.end());
+
+  struct iovec iov;
+  iov.iov_base = payload.data();
+  iov.iov_len  = payload.size();
+
+  char control[CMSG_SPACE(sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level     = SOL_SOCKET;
+  cm->cmsg_type      = SCM_RIGHTS;
+  cm->cmsg_len       = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cm), &socket.m_fd, sizeof(int));
+
+  ssize_t wr_size = ::sendmsg(m_fd, &msg, __TACOPIE_SEND_FLAGS);
+
+  if (wr_size == -1) { __TACOPIE_THROW(error, "sendmsg() failure"); }
+
+  //! the descriptor is attached to the first byte: the rest of the payload is sent normally
+  std::size_t sent = wr_size;
+  while (sent < payload.size()) {
+    wr_size = ::send(m_fd, payload.data() + sent, payload.size() - sent, __TACOPIE_SEND_FLAGS);
+
+    if (wr_size == -1) {
+      if (errno == EINTR) { continue; }
+      __TACOPIE_THROW(error, "send() failure");
+    }
+
+    sent += wr_size;
+  }
+}
+
+tcp_socket
+tcp_socket::recv_socket(void) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  std::uint32_t header[3];
+
+  struct iovec iov;
+  iov.iov_base = header;
+  iov.iov_len  = sizeof(header);
+
+  char control[CMSG_SPACE(sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control;
+  msg.msg_controllen = sizeof(control);
+
+#ifdef MSG_CMSG_CLOEXEC
+  int flags = MSG_CMSG_CLOEXEC;
+#else
+  int flags = 0;
+#endif /* MSG_CMSG_CLOEXEC */
+
+  ssize_t rd_size;
+  do {
+    rd_size = ::recvmsg(m_fd, &msg, flags);
+  } while (rd_size == -1 && errno == EINTR);
+
+  if (rd_size == -1) { __TACOPIE_THROW(error, "recvmsg() failure"); }
+  if (rd_size == 0) { __TACOPIE_THROW(error, "recvmsg() failure: connection closed by the peer"); }
+
+  fd_t fd = __TACOPIE_INVALID_FD;
+  for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+    if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) { std::memcpy(&fd, CMSG_DATA(cm), sizeof(int)); }
+  }
+
+  if (fd == __TACOPIE_INVALID_FD) { __TACOPIE_THROW(error, "recvmsg() failure: no socket received"); }
+
+  //! read the rest of the description, closing the received descriptor on failure
+  auto recv_all = [this](char* buffer, std::size_t size) {
+    while (size > 0) {
+      ssize_t size_read = ::recv(m_fd, buffer, size, 0);
+
+      if (size_read == -1 && errno == EINTR) { continue; }
+      if (size_read <= 0) { return false; }
+
+      buffer += size_read;
+      size -= size_read;
+    }
+
+    return true;
+  };
+
+  std::string host;
+  if (!recv_all(reinterpret_cast<char*>(header) + rd_size, sizeof(header) - rd_size)) {
+    ::close(fd);
+    __TACOPIE_THROW(error, "recv() failure: incomplete socket description");
+  }
+
+  //! the host size comes from the peer: bounded before allocating
+  if (header[1] > static_cast<std::uint32_t>(type::UNKNOWN) || header[2] > NI_MAXHOST) {
+    ::close(fd);
+    __TACOPIE_THROW(error, "recv_socket() failure: invalid socket description");
+  }
+
+  host.resize(header[2]);
+  if (!recv_all(&host[0], host.size())) {
+    ::close(fd);
+    __TACOPIE_THROW(error, "recv() failure: incomplete socket description");
+  }
+
+  return {fd, host, header[0], static_cast<type>(header[1])};
 }
 
 //!
@@ -237,9 +679,22 @@ tcp_socket::close(void) {
     ::close(m_fd);
   }
 
+  close_splice_pipe();
+
   m_fd   = __TACOPIE_INVALID_FD;
   m_type = type::UNKNOWN;
 }
+
+void
+tcp_socket::close_splice_pipe(void) {
+  if (m_splice_pipe.read_fd != -1) {
+    ::close(m_splice_pipe.read_fd);
+    ::close(m_splice_pipe.write_fd);
+  }
+
+  m_splice_pipe = {-1, -1, -1, 0, 0};
+}
+
 //!
 //! create a new socket if no socket has been initialized yet
 //!
@@ -33,6 +33,7 @@
 #include <tacopie/utils/typedefs.hpp>
 
 #include <cstring>
+#include <io.h>
 
 #ifdef __GNUC__
 #   include <Ws2tcpip.h>	   // Mingw / gcc on windows
@@ -55,6 +56,54 @@ namespace tacopie {
 
 void
 tcp_socket::connect(const std::string& host, std::uint32_t port, std::uint32_t timeout_msecs) {
+  start_connect(host, port, timeout_msecs > 0);
+
+  if (timeout_msecs > 0) {
+    timeval tv;
+    tv.tv_sec  = (timeout_msecs / 1000);
+    tv.tv_usec = ((timeout_msecs - (tv.tv_sec * 1000)) * 1000);
+
+    FD_SET set;
+    FD_ZERO(&set);
+    FD_SET(m_fd, &set);
+
+    //! 1 means we are connected.
+    //! 0 means a timeout.
+    if (select(static_cast<int>(m_fd) + 1, NULL, &set, NULL, &tv) == 1) {
+      try {
+        finish_connect();
+      }
+      catch (const tacopie_error& e) {
+        close();
+        throw e;
+      }
+    }
+    else {
+      close();
+      __TACOPIE_THROW(error, "connect() timed out");
+    }
+  }
+}
+
+void
+tcp_socket::connect_async(const std::string& host, std::uint32_t port) {
+  start_connect(host, port, true);
+}
+
+void
+tcp_socket::finish_connect(void) {
+  //! Make sure there are no async connection errors
+  int err = 0;
+  int len = sizeof(err);
+  if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &len) == -1 || err != 0) { __TACOPIE_THROW(error, "connect() failure"); }
+
+  //! Set back to blocking mode as the user of this class is expecting
+  u_long mode = 0;
+  if (ioctlsocket(m_fd, FIONBIO, &mode) != 0) { __TACOPIE_THROW(error, "connect() set blocking failure"); }
+}
+
+void
+tcp_socket::start_connect(const std::string& host, std::uint32_t port, bool non_blocking) {
   //! Reset host and port
   m_host = host;
   m_port = port;
@@ -103,8 +152,8 @@ tcp_socket::connect(const std::string& host, std::uint32_t port, std::uint32_t t
     freeaddrinfo(result);
   }
 
-  if (timeout_msecs > 0) {
-    //! for timeout connection handling:
+  if (non_blocking) {
+    //! for timeout or asynchronous connection handling:
     //!  1. set socket to non blocking
     //!  2. connect
     //!  3. poll select
@@ -130,39 +179,124 @@ tcp_socket::connect(const std::string& host, std::uint32_t port, std::uint32_t t
     close();
     __TACOPIE_THROW(error, "connect() failure");
   }
+}
 
-  if (timeout_msecs > 0) {
-    timeval tv;
-    tv.tv_sec  = (timeout_msecs / 1000);
-    tv.tv_usec = ((timeout_msecs - (tv.tv_sec * 1000)) * 1000);
+//!
+//! client socket operations
+//!
 
-    FD_SET set;
-    FD_ZERO(&set);
-    FD_SET(m_fd, &set);
+std::size_t
+tcp_socket::sendv(const const_buffer* buffers, std::size_t nb_buffers) {
+  io_result result = sendv(buffers, nb_buffers, std::nothrow);
 
-    //! 1 means we are connected.
-    //! 0 means a timeout.
-    if (select(static_cast<int>(m_fd) + 1, NULL, &set, NULL, &tv) == 1) {
-      //! Make sure there are no async connection errors
-      int err = 0;
-      int len = sizeof(len);
-      if (getsockopt(m_fd, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &len) == -1 || err != 0) {
-        close();
-        __TACOPIE_THROW(error, "connect() failure");
-      }
+  if (result.error) { __TACOPIE_THROW(error, "WSASend() failure"); }
 
-      //! Set back to blocking mode as the user of this class is expecting
-      u_long mode = 0;
-      if (ioctlsocket(m_fd, FIONBIO, &mode) != 0) {
-        close();
-        __TACOPIE_THROW(error, "connect() set blocking failure");
-      }
-    }
-    else {
-      close();
-      __TACOPIE_THROW(error, "connect() timed out");
+  return result.size;
+}
+
+tcp_socket::io_result
+tcp_socket::sendv(const const_buffer* buffers, std::size_t nb_buffers, std::nothrow_t, bool) {
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  if (nb_buffers > __TACOPIE_MAX_IOVEC) { nb_buffers = __TACOPIE_MAX_IOVEC; }
+
+  WSABUF bufs[__TACOPIE_MAX_IOVEC];
+  for (std::size_t i = 0; i < nb_buffers; ++i) {
+    bufs[i].buf = const_cast<char*>(buffers[i].data);
+    bufs[i].len = static_cast<ULONG>(buffers[i].size);
+  }
+
+  io_result result = {0, 0, false};
+
+  DWORD wr_size = 0;
+  if (WSASend(m_fd, bufs, static_cast<DWORD>(nb_buffers), &wr_size, 0, NULL, NULL) == SOCKET_ERROR) {
+    result.error = WSAGetLastError();
+  }
+  else {
+    result.size = wr_size;
+  }
+
+  return result;
+}
+
+tcp_socket::io_result
+tcp_socket::send_zerocopy(const char*, std::size_t, std::nothrow_t, bool) {
+  io_result result = {0, WSAEOPNOTSUPP, false};
+
+  return result;
+}
+
+tcp_socket::io_result
+tcp_socket::recv_zerocopy_completion(zerocopy_completion&, std::nothrow_t) {
+  io_result result = {0, WSAEOPNOTSUPP, false};
+
+  return result;
+}
+
+std::size_t
+tcp_socket::sendfile(int file_fd, std::uint64_t offset, std::size_t size) {
+  io_result result = sendfile(file_fd, offset, size, std::nothrow);
+
+  if (result.error) { __TACOPIE_THROW(error, "sendfile() failure"); }
+
+  return result.size;
+}
+
+tcp_socket::io_result
+tcp_socket::sendfile(int file_fd, std::uint64_t offset, std::size_t size, std::nothrow_t, bool non_blocking) {
+  (void) non_blocking;
+
+  create_socket_if_necessary();
+  check_or_set_type(type::CLIENT);
+
+  io_result result = {0, 0, false};
+
+  //! copy through user space
+  char buffer[__TACOPIE_SENDFILE_COPY_BUFFER_SIZE];
+  unsigned int to_read = static_cast<unsigned int>(size < sizeof(buffer) ? size : sizeof(buffer));
+
+  if (_lseeki64(file_fd, static_cast<__int64>(offset), SEEK_SET) == -1) {
+    result.error = ERROR_SEEK;
+    return result;
+  }
+
+  int rd_size = _read(file_fd, buffer, to_read);
+
+  if (rd_size == -1) {
+    result.error = ERROR_READ_FAULT;
+    return result;
+  }
+
+  int sent = 0;
+  while (sent < rd_size) {
+    int wr_size = ::send(m_fd, buffer + sent, rd_size - sent, 0);
+
+    if (wr_size == SOCKET_ERROR) {
+      result.error = WSAGetLastError();
+      break;
     }
+
+    sent += wr_size;
   }
+
+  result.size = sent;
+
+  return result;
+}
+
+//!
+//! socket passing
+//!
+
+void
+tcp_socket::send_socket(const tcp_socket&) {
+  __TACOPIE_THROW(error, "socket passing not supported on this platform");
+}
+
+tcp_socket
+tcp_socket::recv_socket(void) {
+  __TACOPIE_THROW(error, "socket passing not supported on this platform");
 }
 
 //!
@@ -233,6 +367,12 @@ tcp_socket::close(void) {
   m_fd   = __TACOPIE_INVALID_FD;
   m_type = type::UNKNOWN;
 }
+
+void
+tcp_socket::close_splice_pipe(void) {
+  //! files are always copied through user space: no pipe to close
+}
+
 //!
 //! create a new socket if no socket has been initialized yet
 //!
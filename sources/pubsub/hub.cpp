@@ -0,0 +1,355 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <tacopie/pubsub/hub.hpp>
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/logger.hpp>
+
+#include <algorithm>
+
+namespace tacopie {
+
+namespace pubsub {
+
+//!
+//! ctor & dtor
+//!
+
+hub::hub(void)
+: m_eviction_handler(nullptr) {
+  __TACOPIE_LOG(debug, "create pubsub hub");
+}
+
+hub::hub(const std::shared_ptr<tacopie::io_service>& io_service)
+: m_server(io_service)
+, m_eviction_handler(nullptr) {
+  __TACOPIE_LOG(debug, "create pubsub hub");
+}
+
+hub::~hub(void) {
+  __TACOPIE_LOG(debug, "destroy pubsub hub");
+
+  //! subscribers reference this instance in their callbacks: wait for all of them
+  stop(true, true);
+}
+
+//!
+//! start & stop
+//!
+
+void
+hub::start(const std::string& host, std::uint32_t port) {
+  m_server.start(host, port, std::bind(&hub::on_new_connection, this, std::placeholders::_1));
+
+  __TACOPIE_LOG(info, "pubsub hub running");
+}
+
+void
+hub::stop(bool wait_for_removal, bool recursive_wait_for_removal) {
+  //! stop accepting subscribers first
+  m_server.stop(wait_for_removal, recursive_wait_for_removal);
+
+  std::unordered_set<std::shared_ptr<subscriber>> subscribers;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::swap(subscribers, m_subscribers);
+    m_topics.clear();
+  }
+
+  for (const auto& sub : subscribers) {
+    sub->client->disconnect(wait_for_removal && recursive_wait_for_removal);
+  }
+}
+
+bool
+hub::is_running(void) const {
+  return m_server.is_running();
+}
+
+//!
+//! publish
+//!
+
+std::size_t
+hub::publish(const std::string& topic, std::vector<char> payload) {
+  auto message = encode(topic, std::move(payload));
+
+  std::size_t max_pending_bytes = m_max_pending_bytes;
+  bool evict                    = m_slow_consumer_policy == slow_consumer_policy::evict;
+  std::size_t nb_queued         = 0;
+
+  std::vector<std::shared_ptr<subscriber>> evicted;
+  std::vector<std::shared_ptr<subscriber>> disconnected;
+  eviction_handler_t eviction_handler;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mtx);
+
+    auto it = m_topics.find(topic);
+    if (it == m_topics.end()) { return 0; }
+
+    for (const auto& sub : it->second) {
+      const auto& client = sub->client;
+
+      if (client->get_pending_write_size() + message.size() > max_pending_bytes) {
+        if (evict) { evicted.push_back(sub); }
+        else { ++m_nb_dropped_messages; }
+
+        continue;
+      }
+
+      try {
+        //! all the subscribers share the same buffer: no per-subscriber copy
+        client->async_write({message, nullptr});
+        ++nb_queued;
+      }
+      catch (const tacopie_error&) {
+        disconnected.push_back(sub);
+      }
+    }
+
+    if (!evicted.empty()) { eviction_handler = m_eviction_handler; }
+  }
+
+  //! subscribers are removed outside of the topic iteration (removal reorders topic subscribers)
+  for (const auto& sub : disconnected) {
+    remove_subscriber(sub);
+  }
+
+  for (const auto& sub : evicted) {
+    __TACOPIE_LOG(warn, "pubsub hub evicts slow consumer");
+
+    ++m_nb_evictions;
+    remove_subscriber(sub);
+
+    if (eviction_handler) { eviction_handler(sub->client); }
+  }
+
+  return nb_queued;
+}
+
+std::size_t
+hub::publish(const std::string& topic, const std::string& payload) {
+  return publish(topic, std::vector<char>(payload.begin(), payload.end()));
+}
+
+shared_buffer
+hub::encode(const std::string& topic, std::vector<char>&& payload) {
+  std::string header = "MESSAGE " + topic + " " + std::to_string(payload.size()) + "\r\n";
+
+  std::vector<std::vector<char>> slices;
+  slices.reserve(3);
+  slices.emplace_back(header.begin(), header.end());
+  slices.push_back(std::move(payload));
+  slices.push_back({'\r', '\n'});
+
+  return shared_buffer(std::move(slices));
+}
+
+//!
+//! configuration
+//!
+
+void
+hub::set_max_pending_bytes(std::size_t max_pending_bytes) {
+  m_max_pending_bytes = max_pending_bytes;
+}
+
+void
+hub::set_slow_consumer_policy(slow_consumer_policy policy) {
+  m_slow_consumer_policy = policy;
+}
+
+void
+hub::set_on_eviction_handler(const eviction_handler_t& handler) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  m_eviction_handler = handler;
+}
+
+//!
+//! statistics
+//!
+
+std::size_t
+hub::get_nb_subscribers(void) const {
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  return m_subscribers.size();
+}
+
+std::size_t
+hub::get_nb_subscribers(const std::string& topic) const {
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  auto it = m_topics.find(topic);
+
+  return it == m_topics.end() ? 0 : it->second.size();
+}
+
+std::size_t
+hub::get_nb_dropped_messages(void) const {
+  return m_nb_dropped_messages;
+}
+
+std::size_t
+hub::get_nb_evictions(void) const {
+  return m_nb_evictions;
+}
+
+tcp_server&
+hub::get_tcp_server(void) {
+  return m_server;
+}
+
+//!
+//! subscribers handling
+//!
+
+bool
+hub::on_new_connection(const std::shared_ptr<tcp_client>& client) {
+  auto sub    = std::make_shared<subscriber>();
+  sub->client = client;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_subscribers.insert(sub);
+  }
+
+  //! weak reference: the client must not keep the subscriber alive
+  std::weak_ptr<subscriber> weak_sub = sub;
+
+  client->set_on_disconnection_handler([this, weak_sub] {
+    auto alive_sub = weak_sub.lock();
+    if (alive_sub) { remove_subscriber(alive_sub); }
+  });
+
+  async_read(sub);
+
+  return true;
+}
+
+void
+hub::async_read(const std::shared_ptr<subscriber>& sub) {
+  try {
+    sub->client->async_read({__TACOPIE_PUBSUB_READ_SIZE, std::bind(&hub::on_read, this, sub, std::placeholders::_1)});
+  }
+  catch (const tacopie_error&) {
+    remove_subscriber(sub);
+  }
+}
+
+void
+hub::on_read(const std::shared_ptr<subscriber>& sub, tcp_client::read_result& result) {
+  if (!result.success) {
+    remove_subscriber(sub);
+    return;
+  }
+
+  //! reads of a given client are serialized: the command buffer needs no locking
+  for (char c : result.buffer) {
+    if (c != '\n') {
+      sub->command.push_back(c);
+
+      if (sub->command.size() > __TACOPIE_PUBSUB_MAX_COMMAND_SIZE) {
+        __TACOPIE_LOG(warn, "pubsub command too large");
+        remove_subscriber(sub);
+        return;
+      }
+
+      continue;
+    }
+
+    if (!sub->command.empty() && sub->command.back() == '\r') { sub->command.pop_back(); }
+
+    execute_command(sub, sub->command);
+    sub->command.clear();
+  }
+
+  async_read(sub);
+}
+
+void
+hub::execute_command(const std::shared_ptr<subscriber>& sub, const std::string& command) {
+  static const std::string subscribe_cmd   = "SUBSCRIBE ";
+  static const std::string unsubscribe_cmd = "UNSUBSCRIBE ";
+
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  //! subscriber removed in the meantime (eviction or hub stopped)
+  if (!m_subscribers.count(sub)) { return; }
+
+  if (command.compare(0, subscribe_cmd.size(), subscribe_cmd) == 0 && command.size() > subscribe_cmd.size()) {
+    auto topic = command.substr(subscribe_cmd.size());
+
+    if (sub->topics.insert(topic).second) { m_topics[topic].push_back(sub); }
+  }
+  else if (command.compare(0, unsubscribe_cmd.size(), unsubscribe_cmd) == 0 && command.size() > unsubscribe_cmd.size()) {
+    auto topic = command.substr(unsubscribe_cmd.size());
+
+    if (sub->topics.erase(topic)) { remove_from_topic(sub, topic); }
+  }
+  else {
+    __TACOPIE_LOG(warn, "invalid pubsub command");
+  }
+}
+
+void
+hub::remove_subscriber(const std::shared_ptr<subscriber>& sub) {
+  {
+    std::lock_guard<std::mutex> lock(m_mtx);
+
+    if (!m_subscribers.erase(sub)) { return; }
+
+    for (const auto& topic : sub->topics) {
+      remove_from_topic(sub, topic);
+    }
+
+    sub->topics.clear();
+  }
+
+  __TACOPIE_LOG(debug, "remove pubsub subscriber");
+
+  sub->client->disconnect();
+}
+
+void
+hub::remove_from_topic(const std::shared_ptr<subscriber>& sub, const std::string& topic) {
+  auto it = m_topics.find(topic);
+  if (it == m_topics.end()) { return; }
+
+  auto& subscribers = it->second;
+  auto sub_it       = std::find(subscribers.begin(), subscribers.end(), sub);
+
+  if (sub_it != subscribers.end()) {
+    //! order of subscribers does not matter: swap and pop
+    std::swap(*sub_it, subscribers.back());
+    subscribers.pop_back();
+  }
+
+  if (subscribers.empty()) { m_topics.erase(it); }
+}
+
+} // namespace pubsub
+
+} // namespace tacopie
@@ -0,0 +1,227 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/resp/client.hpp>
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/logger.hpp>
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! ctor & dtor
+//!
+
+client::client(void)
+: m_is_writing(false)
+, m_disconnection_handler(nullptr) {
+  __TACOPIE_LOG(debug, "create resp client");
+}
+
+client::client(const std::shared_ptr<tacopie::io_service>& io_service)
+: m_client(io_service)
+, m_is_writing(false)
+, m_disconnection_handler(nullptr) {
+  __TACOPIE_LOG(debug, "create resp client");
+}
+
+client::~client(void) {
+  __TACOPIE_LOG(debug, "destroy resp client");
+
+  //! make sure no callback referencing this instance is still running before members are destroyed
+  m_client.disconnect(true);
+}
+
+//!
+//! connection handling
+//!
+
+void
+client::connect(const std::string& host, std::uint32_t port, std::uint32_t timeout_msecs) {
+  m_client.connect(host, port, timeout_msecs);
+  m_client.set_on_disconnection_handler(std::bind(&client::on_disconnection, this));
+
+  m_parser.reset();
+  async_read();
+}
+
+void
+client::disconnect(bool wait_for_removal) {
+  m_client.disconnect(wait_for_removal);
+  clear_pending();
+}
+
+bool
+client::is_connected(void) const {
+  return m_client.is_connected();
+}
+
+void
+client::set_on_disconnection_handler(const disconnection_handler_t& disconnection_handler) {
+  m_disconnection_handler = disconnection_handler;
+}
+
+void
+client::on_disconnection(void) {
+  __TACOPIE_LOG(warn, "resp client disconnected");
+
+  clear_pending();
+
+  if (m_disconnection_handler) { m_disconnection_handler(); }
+}
+
+void
+client::clear_pending(void) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  m_batch.clear();
+  m_is_writing = false;
+
+  std::queue<reply_callback_t> empty;
+  std::swap(m_callbacks, empty);
+}
+
+//!
+//! send commands
+//!
+
+client&
+client::send(const std::vector<std::string>& command, const reply_callback_t& callback) {
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  if (!is_connected()) { __TACOPIE_THROW(warn, "resp client is disconnected"); }
+
+  encoder::encode(m_batch, command);
+  m_callbacks.push(callback);
+
+  flush_batch();
+
+  return *this;
+}
+
+void
+client::flush_batch(void) {
+  if (m_is_writing || m_batch.empty()) { return; }
+
+  //! hand the batch over to the write queue without copying it
+  //! the buffer of the previous write takes its place: only one write is in flight, so two buffers are enough and stop growing once warm
+  std::vector<char> batch;
+  std::swap(batch, m_batch);
+  std::swap(m_batch, m_spare_batch);
+
+  std::size_t size = batch.size();
+  m_is_writing     = true;
+
+  m_client.async_write({std::move(batch), std::bind(&client::on_write, this, size, std::placeholders::_1)});
+}
+
+void
+client::on_write(std::size_t expected_size, tcp_client::write_result& result) {
+  if (!result.success) { return; }
+
+  if (result.size != expected_size) {
+    __TACOPIE_LOG(error, "resp client partial write");
+    m_client.disconnect();
+    on_disconnection();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  m_is_writing = false;
+
+  //! recycle the written buffer for the next batch
+  result.buffer.clear();
+  std::swap(m_spare_batch, result.buffer);
+
+  try {
+    flush_batch();
+  }
+  catch (const tacopie_error&) {
+    //! client got disconnected in the meantime, the disconnection handler takes care of the cleanup
+  }
+}
+
+//!
+//! receive replies
+//!
+
+void
+client::async_read(void) {
+  try {
+    m_client.async_read({__TACOPIE_RESP_READ_SIZE, std::bind(&client::on_read, this, std::placeholders::_1)});
+  }
+  catch (const tacopie_error&) {
+    //! client got disconnected in the meantime, the disconnection handler takes care of the cleanup
+  }
+}
+
+void
+client::on_read(tcp_client::read_result& result) {
+  if (!result.success) { return; }
+
+  m_parser.feed(std::move(result.buffer));
+
+  reply r;
+
+  while (true) {
+    try {
+      if (!m_parser.get_reply(r)) { break; }
+    }
+    catch (const tacopie_error&) {
+      __TACOPIE_LOG(error, "resp client received an invalid reply");
+      m_client.disconnect();
+      on_disconnection();
+      return;
+    }
+
+    reply_callback_t callback = nullptr;
+
+    {
+      std::lock_guard<std::mutex> lock(m_mtx);
+
+      if (!m_callbacks.empty()) {
+        callback = std::move(m_callbacks.front());
+        m_callbacks.pop();
+      }
+    }
+
+    if (callback) { callback(r); }
+  }
+
+  async_read();
+}
+
+//!
+//! getters
+//!
+
+tcp_client&
+client::get_tcp_client(void) {
+  return m_client;
+}
+
+} // namespace resp
+
+} // namespace tacopie
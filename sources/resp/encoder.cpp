@@ -0,0 +1,99 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/resp/encoder.hpp>
+
+#include <algorithm>
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! helpers
+//!
+
+static std::size_t
+nb_digits(std::size_t value) {
+  std::size_t nb = 1;
+
+  while (value >= 10) {
+    value /= 10;
+    ++nb;
+  }
+
+  return nb;
+}
+
+void
+encoder::encode_header(std::vector<char>& buffer, char prefix, std::size_t value) {
+  char digits[24];
+  std::size_t nb = 0;
+
+  do {
+    digits[nb++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+
+  buffer.push_back(prefix);
+  while (nb) { buffer.push_back(digits[--nb]); }
+  buffer.push_back('\r');
+  buffer.push_back('\n');
+}
+
+//!
+//! encoding
+//!
+
+std::size_t
+encoder::encoded_size(const std::vector<std::string>& command) {
+  //! *<nb>\r\n
+  std::size_t size = 3 + nb_digits(command.size());
+
+  //! $<size>\r\n<arg>\r\n
+  for (const auto& arg : command) {
+    size += 5 + nb_digits(arg.size()) + arg.size();
+  }
+
+  return size;
+}
+
+void
+encoder::encode(std::vector<char>& buffer, const std::vector<std::string>& command) {
+  //! grow geometrically: many commands are usually appended to the same batch
+  std::size_t required = buffer.size() + encoded_size(command);
+  if (required > buffer.capacity()) { buffer.reserve(std::max(required, 2 * buffer.capacity())); }
+
+  encode_header(buffer, '*', command.size());
+
+  for (const auto& arg : command) {
+    encode_header(buffer, '$', arg.size());
+    buffer.insert(buffer.end(), arg.begin(), arg.end());
+    buffer.push_back('\r');
+    buffer.push_back('\n');
+  }
+}
+
+} // namespace resp
+
+} // namespace tacopie
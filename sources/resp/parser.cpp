@@ -0,0 +1,257 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/resp/parser.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <cstring>
+#include <limits>
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! ctor
+//!
+
+parser::parser(void)
+: m_offset(0)
+, m_needed(0)
+, m_pending_pos(0) {}
+
+//!
+//! feed bytes
+//!
+
+void
+parser::feed(std::vector<char>&& buffer) {
+  if (m_offset == m_buffer.size()) {
+    //! nothing pending: take ownership of the received buffer
+    m_buffer = std::move(buffer);
+    m_offset = 0;
+    return;
+  }
+
+  feed(buffer.data(), buffer.size());
+}
+
+void
+parser::feed(const char* data, std::size_t size) {
+  //! discard consumed bytes, only the pending partial reply is moved
+  if (m_offset > 0) {
+    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_offset);
+    m_needed = m_needed > m_offset ? m_needed - m_offset : 0;
+    m_offset = 0;
+  }
+
+  m_buffer.insert(m_buffer.end(), data, data + size);
+}
+
+void
+parser::reset(void) {
+  m_buffer.clear();
+  m_offset      = 0;
+  m_needed      = 0;
+  m_pending_pos = 0;
+  m_frames.clear();
+  m_strings.clear();
+  m_pending.set_null();
+}
+
+//!
+//! build replies
+//!
+
+bool
+parser::get_reply(reply& reply) {
+  if (m_offset == m_buffer.size() || m_buffer.size() < m_needed) { return false; }
+
+  //! parse element by element, resuming the partial reply where the previous call stopped
+  while (true) {
+    resp::reply& element = m_frames.empty() ? m_pending : m_frames.back().array->get_elements()[m_frames.back().index];
+    std::size_t pos      = m_offset + m_pending_pos;
+    parse_status status  = parse(pos, element);
+
+    if (status == parse_status::incomplete) { return false; }
+
+    m_pending_pos = pos - m_offset;
+
+    if (status == parse_status::array_started) {
+      if (m_frames.size() >= __TACOPIE_RESP_MAX_NESTING) { __TACOPIE_THROW(error, "RESP reply nested too deeply"); }
+
+      m_frames.push_back({&element, 0});
+      continue;
+    }
+
+    //! the element is complete: move to the next one, closing the arrays completed along the way
+    while (!m_frames.empty() && ++m_frames.back().index == m_frames.back().array->get_elements().size()) { m_frames.pop_back(); }
+
+    if (m_frames.empty()) { break; }
+  }
+
+  //! the buffer does not move anymore until the next feed: strings can point into it
+  const char* base = m_buffer.data() + m_offset;
+  for (const auto& string : m_strings) { string.first->set_string(string.first->get_type(), base + string.second, string.first->size()); }
+  m_strings.clear();
+
+  m_offset += m_pending_pos;
+  m_pending_pos = 0;
+  m_needed      = 0;
+
+  //! the previous reply of the caller is recycled for the next one (array elements keep their capacity)
+  std::swap(reply, m_pending);
+
+  return true;
+}
+
+bool
+parser::find_line_end(std::size_t pos, std::size_t& line_end) const {
+  const char* begin = m_buffer.data() + pos;
+  const char* cr    = static_cast<const char*>(std::memchr(begin, '\r', m_buffer.size() - pos));
+
+  if (!cr) { return false; }
+
+  line_end = cr - m_buffer.data();
+
+  //! need the \n following the \r
+  if (line_end + 1 >= m_buffer.size()) { return false; }
+
+  if (m_buffer[line_end + 1] != '\n') { __TACOPIE_THROW(error, "invalid RESP line terminator"); }
+
+  return true;
+}
+
+std::int64_t
+parser::parse_integer(std::size_t begin, std::size_t end) const {
+  bool negative = false;
+
+  if (begin < end && (m_buffer[begin] == '-' || m_buffer[begin] == '+')) {
+    negative = m_buffer[begin] == '-';
+    ++begin;
+  }
+
+  //! 19 digits at most: the value is accumulated unsigned and checked against the int64 range, it cannot wrap
+  if (begin == end || end - begin > 19) { __TACOPIE_THROW(error, "invalid RESP integer"); }
+
+  std::uint64_t value = 0;
+  for (; begin < end; ++begin) {
+    char c = m_buffer[begin];
+
+    if (c < '0' || c > '9') { __TACOPIE_THROW(error, "invalid RESP integer"); }
+
+    value = value * 10 + static_cast<std::uint64_t>(c - '0');
+  }
+
+  std::uint64_t max = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + (negative ? 1 : 0);
+  if (value > max) { __TACOPIE_THROW(error, "RESP integer out of range"); }
+
+  if (!negative) { return static_cast<std::int64_t>(value); }
+
+  //! the magnitude of the minimum value does not fit in an int64
+  return value == max ? std::numeric_limits<std::int64_t>::min() : -static_cast<std::int64_t>(value);
+}
+
+parser::parse_status
+parser::parse(std::size_t& pos, reply& reply) {
+  if (pos >= m_buffer.size()) { return parse_status::incomplete; }
+
+  std::size_t line_end;
+  if (!find_line_end(pos + 1, line_end)) { return parse_status::incomplete; }
+
+  char prefix      = m_buffer[pos];
+  std::size_t next = line_end + 2;
+
+  switch (prefix) {
+  case '+':
+  case '-':
+    reply.set_string(prefix == '+' ? reply::type::simple_string : reply::type::error, nullptr, line_end - pos - 1);
+    m_strings.push_back({&reply, pos + 1 - m_offset});
+    pos = next;
+    return parse_status::complete;
+
+  case ':':
+    reply.set_integer(parse_integer(pos + 1, line_end));
+    pos = next;
+    return parse_status::complete;
+
+  case '$': {
+    std::int64_t size = parse_integer(pos + 1, line_end);
+
+    if (size < 0) {
+      reply.set_null();
+      pos = next;
+      return parse_status::complete;
+    }
+
+    if (size > __TACOPIE_RESP_MAX_BULK_SIZE) { __TACOPIE_THROW(error, "RESP bulk string too large"); }
+
+    std::size_t end = next + static_cast<std::size_t>(size);
+
+    //! remember how many bytes we need before trying again
+    if (end + 2 > m_buffer.size()) {
+      m_needed = end + 2;
+      return parse_status::incomplete;
+    }
+
+    if (m_buffer[end] != '\r' || m_buffer[end + 1] != '\n') { __TACOPIE_THROW(error, "invalid RESP bulk string terminator"); }
+
+    reply.set_string(reply::type::bulk_string, nullptr, static_cast<std::size_t>(size));
+    m_strings.push_back({&reply, next - m_offset});
+    pos = end + 2;
+    return parse_status::complete;
+  }
+
+  case '*': {
+    std::int64_t nb_elements = parse_integer(pos + 1, line_end);
+
+    if (nb_elements < 0) {
+      reply.set_null();
+      pos = next;
+      return parse_status::complete;
+    }
+
+    if (nb_elements > __TACOPIE_RESP_MAX_ARRAY_SIZE) { __TACOPIE_THROW(error, "RESP array too large"); }
+
+    //! each element takes at least 3 bytes: do not allocate anything before that much data is available
+    std::size_t min_end = next + 3 * static_cast<std::size_t>(nb_elements);
+    if (min_end > m_buffer.size()) {
+      m_needed = min_end;
+      return parse_status::incomplete;
+    }
+
+    reply.set_array();
+    reply.get_elements().resize(static_cast<std::size_t>(nb_elements));
+
+    pos = next;
+    return nb_elements ? parse_status::array_started : parse_status::complete;
+  }
+
+  default:
+    __TACOPIE_THROW(error, "invalid RESP reply type");
+  }
+}
+
+} // namespace resp
+
+} // namespace tacopie
@@ -0,0 +1,135 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/resp/reply.hpp>
+
+namespace tacopie {
+
+namespace resp {
+
+//!
+//! ctor
+//!
+
+reply::reply(void)
+: m_type(type::null)
+, m_data(nullptr)
+, m_size(0)
+, m_integer(0) {}
+
+//!
+//! setters
+//!
+
+void
+reply::set_string(type t, const char* data, std::size_t size) {
+  m_type    = t;
+  m_data    = data;
+  m_size    = size;
+  m_integer = 0;
+  m_elements.clear();
+}
+
+void
+reply::set_integer(std::int64_t value) {
+  m_type    = type::integer;
+  m_data    = nullptr;
+  m_size    = 0;
+  m_integer = value;
+  m_elements.clear();
+}
+
+void
+reply::set_array(void) {
+  m_type    = type::array;
+  m_data    = nullptr;
+  m_size    = 0;
+  m_integer = 0;
+  m_elements.clear();
+}
+
+void
+reply::set_null(void) {
+  m_type    = type::null;
+  m_data    = nullptr;
+  m_size    = 0;
+  m_integer = 0;
+  m_elements.clear();
+}
+
+//!
+//! type information
+//!
+
+reply::type
+reply::get_type(void) const {
+  return m_type;
+}
+
+bool
+reply::is_error(void) const {
+  return m_type == type::error;
+}
+
+bool
+reply::is_null(void) const {
+  return m_type == type::null;
+}
+
+//!
+//! getters
+//!
+
+const char*
+reply::data(void) const {
+  return m_data;
+}
+
+std::size_t
+reply::size(void) const {
+  return m_size;
+}
+
+std::string
+reply::as_string(void) const {
+  return m_data ? std::string(m_data, m_size) : std::string();
+}
+
+std::int64_t
+reply::as_integer(void) const {
+  return m_integer;
+}
+
+std::vector<reply>&
+reply::get_elements(void) {
+  return m_elements;
+}
+
+const std::vector<reply>&
+reply::get_elements(void) const {
+  return m_elements;
+}
+
+} // namespace resp
+
+} // namespace tacopie
@@ -0,0 +1,174 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/utils/cpu_affinity.hpp>
+#include <tacopie/utils/logger.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif /* _WIN32 */
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! thread affinity
+//!
+
+#ifdef _WIN32
+static bool
+set_native_thread_affinity(HANDLE thread, const cpu_list_t& cpus) {
+  DWORD_PTR mask = 0;
+
+  if (cpus.empty()) {
+    DWORD_PTR system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &mask, &system_mask)) { return false; }
+  }
+
+  for (auto cpu : cpus) {
+    if (cpu >= sizeof(DWORD_PTR) * 8) {
+      __TACOPIE_LOG(warn, "cpu id out of the supported range for thread affinity");
+      return false;
+    }
+
+    mask |= static_cast<DWORD_PTR>(1) << cpu;
+  }
+
+  return SetThreadAffinityMask(thread, mask) != 0;
+}
+#elif defined(__linux__)
+static bool
+set_native_thread_affinity(pthread_t thread, const cpu_list_t& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  if (cpus.empty()) {
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) { CPU_SET(cpu, &set); }
+  }
+
+  for (auto cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      __TACOPIE_LOG(warn, "cpu id out of the supported range for thread affinity");
+      return false;
+    }
+
+    CPU_SET(cpu, &set);
+  }
+
+  return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+#endif /* _WIN32 */
+
+bool
+set_thread_affinity(std::thread& thread, const cpu_list_t& cpus) {
+#if defined(_WIN32) || defined(__linux__)
+  return set_native_thread_affinity(thread.native_handle(), cpus);
+#else
+  (void) thread;
+  (void) cpus;
+  __TACOPIE_LOG(warn, "thread affinity is not supported on this platform");
+  return false;
+#endif /* _WIN32 || __linux__ */
+}
+
+bool
+set_current_thread_affinity(const cpu_list_t& cpus) {
+#ifdef _WIN32
+  return set_native_thread_affinity(GetCurrentThread(), cpus);
+#elif defined(__linux__)
+  return set_native_thread_affinity(pthread_self(), cpus);
+#else
+  (void) cpus;
+  __TACOPIE_LOG(warn, "thread affinity is not supported on this platform");
+  return false;
+#endif /* _WIN32 */
+}
+
+//!
+//! sysfs topology
+//!
+
+cpu_list_t
+parse_cpu_list(const std::string& list) {
+  cpu_list_t cpus;
+  std::stringstream ss(list);
+  std::string range;
+
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") { continue; }
+
+    std::size_t dash  = range.find('-');
+    std::size_t first = std::strtoul(range.c_str(), nullptr, 10);
+    std::size_t last  = dash == std::string::npos ? first : std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+
+    for (std::size_t cpu = first; cpu <= last; ++cpu) { cpus.push_back(cpu); }
+  }
+
+  return cpus;
+}
+
+static std::string
+read_sysfs_line(const std::string& path) {
+  std::ifstream file(path);
+  std::string line;
+
+  if (file) { std::getline(file, line); }
+
+  return line;
+}
+
+cpu_list_t
+get_numa_node_cpus(int node) {
+  if (node < 0) { return {}; }
+
+  return parse_cpu_list(read_sysfs_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+}
+
+int
+get_network_interface_numa_node(const std::string& network_interface) {
+  std::string node = read_sysfs_line("/sys/class/net/" + network_interface + "/device/numa_node");
+
+  //! -1 is reported by the kernel when the device is not attached to a specific node
+  return node.empty() ? -1 : std::atoi(node.c_str());
+}
+
+cpu_list_t
+get_network_interface_cpus(const std::string& network_interface) {
+  cpu_list_t cpus = parse_cpu_list(read_sysfs_line("/sys/class/net/" + network_interface + "/device/local_cpulist"));
+
+  if (cpus.empty()) { cpus = get_numa_node_cpus(get_network_interface_numa_node(network_interface)); }
+
+  return cpus;
+}
+
+} // namespace utils
+
+} // namespace tacopie
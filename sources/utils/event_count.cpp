@@ -0,0 +1,106 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/utils/event_count.hpp>
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! epoch & waiters helpers
+//!
+
+static const std::uint64_t k_waiter = 1;
+static const std::uint64_t k_epoch  = static_cast<std::uint64_t>(1) << 32;
+
+static std::uint32_t
+get_epoch(std::uint64_t state) {
+  return static_cast<std::uint32_t>(state >> 32);
+}
+
+static std::uint32_t
+get_nb_waiters(std::uint64_t state) {
+  return static_cast<std::uint32_t>(state & 0xffffffff);
+}
+
+//!
+//! wait
+//!
+
+std::uint32_t
+event_count::prepare_wait(void) {
+  return get_epoch(m_state.fetch_add(k_waiter, std::memory_order_seq_cst));
+}
+
+void
+event_count::cancel_wait(void) {
+  m_state.fetch_sub(k_waiter, std::memory_order_seq_cst);
+}
+
+void
+event_count::commit_wait(std::uint32_t key) {
+  std::unique_lock<std::mutex> lock(m_mtx);
+
+  m_condvar.wait(lock, [&] { return get_epoch(m_state.load(std::memory_order_seq_cst)) != key; });
+
+  m_state.fetch_sub(k_waiter, std::memory_order_seq_cst);
+}
+
+//!
+//! notify
+//!
+
+void
+event_count::notify_one(void) {
+  notify(false);
+}
+
+void
+event_count::notify_all(void) {
+  notify(true);
+}
+
+void
+event_count::notify(bool all) {
+  //! read-modify-write rather than a plain load: orders the state change published by the caller before the waiters check (a waiter either sees the change or is seen here)
+  std::uint64_t state = m_state.fetch_add(0, std::memory_order_seq_cst);
+
+  if (get_nb_waiters(state) == 0) { return; }
+
+  m_state.fetch_add(k_epoch, std::memory_order_seq_cst);
+
+  //! taking the lock guarantees that waiters that checked the epoch before the increment are now blocked on the condvar
+  std::lock_guard<std::mutex> lock(m_mtx);
+
+  if (all) {
+    m_condvar.notify_all();
+  }
+  else {
+    m_condvar.notify_one();
+  }
+}
+
+} // namespace utils
+
+} // namespace tacopie
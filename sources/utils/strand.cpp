@@ -0,0 +1,169 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/logger.hpp>
+#include <tacopie/utils/strand.hpp>
+
+namespace tacopie {
+
+namespace utils {
+
+//!
+//! ctor
+//!
+
+strand::strand(thread_pool& pool, thread_pool::priority prio)
+: m_pool(pool)
+, m_priority(prio)
+, m_is_scheduled(false) {}
+
+void
+strand::set_priority(thread_pool::priority prio) {
+  m_priority = prio;
+}
+
+//!
+//! post tasks
+//!
+
+void
+strand::post(thread_pool::task_t&& task) {
+  if (enqueue(std::move(task))) { schedule(); }
+}
+
+void
+strand::post(thread_pool::task_t&& task, thread_pool::task_batch_t& batch) {
+  if (enqueue(std::move(task))) { batch.emplace_back(make_run_task(), m_priority); }
+}
+
+bool
+strand::enqueue(thread_pool::task_t&& task) {
+  std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+  m_tasks.push(std::move(task));
+
+  //! an execution is already pending: it will pick the task up
+  if (m_is_scheduled) { return false; }
+
+  m_is_scheduled = true;
+  return true;
+}
+
+strand&
+strand::operator<<(thread_pool::task_t&& task) {
+  post(std::move(task));
+
+  return *this;
+}
+
+//!
+//! execution
+//!
+
+void
+strand::schedule(void) {
+  m_pool.add_task(make_run_task(), m_priority);
+}
+
+thread_pool::task_t
+strand::make_run_task(void) {
+  return run_task(shared_from_this());
+}
+
+void
+strand::unschedule(void) {
+  std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+  m_is_scheduled = false;
+}
+
+void
+strand::run(void) {
+  for (std::size_t i = 0; i < __TACOPIE_STRAND_MAX_BATCH_SIZE; ++i) {
+    thread_pool::task_t task;
+
+    {
+      std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+      if (m_tasks.empty()) {
+        m_is_scheduled = false;
+        return;
+      }
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+
+    try {
+      task();
+    }
+    catch (const std::exception&) {
+      __TACOPIE_LOG(warn, "uncatched exception propagated up to the strand.")
+    }
+  }
+
+  //! batch complete: give the worker back to the pool and continue later if tasks remain
+  {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    if (m_tasks.empty()) {
+      m_is_scheduled = false;
+      return;
+    }
+  }
+
+  try {
+    schedule();
+  }
+  catch (const tacopie_error&) {
+    //! the strand has been unscheduled: the remaining tasks are executed along with the next task posted
+    __TACOPIE_LOG(warn, "strand execution rejected by the thread pool, remaining tasks delayed until the next post.")
+  }
+}
+
+//!
+//! run task
+//!
+
+strand::run_task::run_task(const std::shared_ptr<strand>& owner)
+: m_strand(owner) {}
+
+strand::run_task::run_task(run_task&& other) noexcept
+: m_strand(std::move(other.m_strand)) {}
+
+strand::run_task::~run_task(void) {
+  if (m_strand) { m_strand->unschedule(); }
+}
+
+void
+strand::run_task::operator()(void) {
+  //! executed: the strand is in charge of its scheduled flag from now on
+  std::shared_ptr<strand> self = std::move(m_strand);
+
+  self->run();
+}
+
+} // namespace utils
+
+} // namespace tacopie
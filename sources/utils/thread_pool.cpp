@@ -20,9 +20,12 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <tacopie/utils/error.hpp>
 #include <tacopie/utils/logger.hpp>
 #include <tacopie/utils/thread_pool.hpp>
 
+#include <algorithm>
+
 namespace tacopie {
 
 namespace utils {
@@ -31,8 +34,20 @@ namespace utils {
 //! ctor & dtor
 //!
 
-thread_pool::thread_pool(std::size_t nb_threads) {
+thread_pool::thread_pool(std::size_t nb_threads, scheduling_policy policy, std::size_t queue_size, overflow_policy overflow)
+: m_policy(policy)
+, m_overflow(overflow) {
   __TACOPIE_LOG(debug, "create thread_pool");
+
+  if (m_policy == scheduling_policy::lock_free) { m_queue.reset(new mpmc_queue<task_t>(queue_size)); }
+
+  set_priority_weights(__TACOPIE_THREAD_POOL_HIGH_PRIORITY_WEIGHT, __TACOPIE_THREAD_POOL_NORMAL_PRIORITY_WEIGHT, __TACOPIE_THREAD_POOL_LOW_PRIORITY_WEIGHT);
+
+  if (m_policy == scheduling_policy::work_stealing) {
+    m_slots.reset(new worker_slot[__TACOPIE_THREAD_POOL_MAX_STEALING_WORKERS]);
+    for (std::size_t i = 0; i < __TACOPIE_THREAD_POOL_MAX_STEALING_WORKERS; ++i) { m_slots[i].pool = this; }
+  }
+
   set_nb_threads(nb_threads);
 }
 
@@ -49,10 +64,13 @@ void
 thread_pool::run(void) {
   __TACOPIE_LOG(debug, "start run() worker");
 
+  //! work_stealing workers own a deque for the tasks they submit
+  if (m_policy == scheduling_policy::work_stealing) { s_current_slot = acquire_slot(); }
+
   while (true) {
     auto res     = fetch_task_or_stop();
     bool stopped = res.first;
-    task_t task  = res.second;
+    task_t task  = std::move(res.second);
 
     //! if thread has been requested to stop, stop it here
     if (stopped) {
@@ -63,6 +81,14 @@ thread_pool::run(void) {
     if (task) {
       __TACOPIE_LOG(debug, "execute task");
 
+      bool is_autoscaling = m_is_autoscaling;
+      std::chrono::steady_clock::time_point start;
+
+      if (is_autoscaling) {
+        ++m_nb_started_tasks;
+        start = std::chrono::steady_clock::now();
+      }
+
       try {
         task();
       }
@@ -70,10 +96,23 @@ thread_pool::run(void) {
         __TACOPIE_LOG(warn, "uncatched exception propagated up to the threadpool.")
       }
 
+      if (is_autoscaling) { m_busy_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(); }
+
       __TACOPIE_LOG(debug, "execution complete");
     }
   }
 
+  if (m_policy == scheduling_policy::work_stealing) {
+    release_slot(s_current_slot);
+    s_current_slot = nullptr;
+  }
+
+  //! retired after the pool shrank: let set_nb_threads join this thread
+  if (!m_should_stop) {
+    std::lock_guard<std::mutex> lock(m_workers_mtx);
+    m_retired_workers.push_back(std::this_thread::get_id());
+  }
+
   __TACOPIE_LOG(debug, "stop run() worker");
 }
 
@@ -85,12 +124,22 @@ void
 thread_pool::stop(void) {
   if (!is_running()) { return; }
 
+  disable_autoscaling();
+
   m_should_stop = true;
-  m_tasks_condvar.notify_all();
+  notify_all_workers();
+
+  //! join outside of the lock: retiring workers need it
+  std::list<std::thread> workers;
+  {
+    std::lock_guard<std::mutex> lock(m_workers_mtx);
+    workers.swap(m_workers);
+    m_retired_workers.clear();
+  }
 
-  for (auto& worker : m_workers) { worker.join(); }
+  for (auto& worker : workers) { worker.join(); }
 
-  m_workers.clear();
+  if (m_policy == scheduling_policy::work_stealing) { clear_slots(); }
 
   __TACOPIE_LOG(debug, "thread_pool stopped");
 }
@@ -103,6 +152,16 @@ thread_pool::is_running(void) const {
   return !m_should_stop;
 }
 
+thread_pool::scheduling_policy
+thread_pool::get_scheduling_policy(void) const {
+  return m_policy;
+}
+
+thread_pool::overflow_policy
+thread_pool::get_overflow_policy(void) const {
+  return m_overflow;
+}
+
 //!
 //! whether the current thread should stop or not
 //!
@@ -117,6 +176,9 @@ thread_pool::should_stop(void) const {
 
 std::pair<bool, thread_pool::task_t>
 thread_pool::fetch_task_or_stop(void) {
+  if (m_policy == scheduling_policy::work_stealing) { return fetch_task_or_stop_work_stealing(); }
+  if (m_policy == scheduling_policy::lock_free) { return fetch_task_or_stop_lock_free(); }
+
   std::unique_lock<std::mutex> lock(m_tasks_mtx);
 
   __TACOPIE_LOG(debug, "waiting to fetch task");
@@ -130,7 +192,7 @@ thread_pool::fetch_task_or_stop(void) {
 
   task_t task = std::move(m_tasks.front());
   m_tasks.pop();
-  return {false, task};
+  return {false, std::move(task)};
 }
 
 //!
@@ -138,41 +200,662 @@ thread_pool::fetch_task_or_stop(void) {
 //!
 
 void
-thread_pool::add_task(const task_t& task) {
-  std::lock_guard<std::mutex> lock(m_tasks_mtx);
+thread_pool::add_task(task_t&& task, priority prio) {
+  if (m_is_autoscaling) { ++m_nb_submitted_tasks; }
 
-  __TACOPIE_LOG(debug, "add task to thread_pool");
+  if (m_policy == scheduling_policy::work_stealing) {
+    add_task_work_stealing(std::move(task), prio);
+  }
+  else if (m_policy == scheduling_policy::lock_free) {
+    add_task_lock_free(std::move(task), prio);
+  }
+  else {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    __TACOPIE_LOG(debug, "add task to thread_pool");
+
+    m_tasks.push(std::move(task), static_cast<std::size_t>(prio));
+    m_tasks_condvar.notify_one();
+  }
 
-  m_tasks.push(task);
-  m_tasks_condvar.notify_one();
+  //! called outside of the lock: the handler may submit tasks or take locks of its own
+  if (m_task_added_handler) { m_task_added_handler(); }
 }
 
 thread_pool&
-thread_pool::operator<<(const task_t& task) {
-  add_task(task);
+thread_pool::operator<<(task_t&& task) {
+  add_task(std::move(task));
 
   return *this;
 }
 
+//!
+//! add batches of tasks to thread pool
+//!
+
+void
+thread_pool::add_tasks(task_batch_t& tasks) {
+  std::size_t nb_tasks    = tasks.size();
+  std::size_t nb_rejected = 0;
+
+  if (!nb_tasks) { return; }
+
+  if (m_is_autoscaling) { m_nb_submitted_tasks += nb_tasks; }
+
+  __TACOPIE_LOG(debug, "add batch of tasks to thread_pool");
+
+  if (m_policy == scheduling_policy::lock_free) {
+    //! the ring needs no lock: only the wake up is batched
+    for (auto& task : tasks) {
+      if (!push_task_lock_free(std::move(task.first), task.second)) { ++nb_rejected; }
+    }
+  }
+  else {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    for (auto& task : tasks) { m_tasks.push(std::move(task.first), static_cast<std::size_t>(task.second)); }
+
+    if (m_policy == scheduling_policy::work_stealing) {
+      m_nb_injected_tasks += nb_tasks;
+      m_nb_queued_tasks += nb_tasks;
+    }
+  }
+
+  tasks.clear();
+  notify_workers(nb_tasks - nb_rejected);
+
+  if (m_task_added_handler && nb_tasks > nb_rejected) { m_task_added_handler(); }
+
+  if (nb_rejected) { __TACOPIE_THROW(warn, "thread_pool queue is full"); }
+}
+
+void
+thread_pool::add_tasks(std::vector<task_t>& tasks, priority prio) {
+  task_batch_t batch;
+  batch.reserve(tasks.size());
+
+  for (auto& task : tasks) { batch.emplace_back(std::move(task), prio); }
+
+  tasks.clear();
+  add_tasks(batch);
+}
+
+void
+thread_pool::set_task_added_handler(const task_added_handler_t& handler) {
+  m_task_added_handler = handler;
+}
+
+//!
+//! execute pending tasks on the calling thread
+//!
+
+std::size_t
+thread_pool::run_pending_tasks(std::size_t max_nb_tasks) {
+  std::size_t nb_executed = 0;
+
+  while (!max_nb_tasks || nb_executed < max_nb_tasks) {
+    task_t task = nullptr;
+
+    if (m_policy == scheduling_policy::work_stealing) {
+      if (!try_fetch_task(get_current_slot(), task)) { break; }
+    }
+    else if (m_policy == scheduling_policy::lock_free) {
+      if (!try_fetch_task_lock_free(task)) { break; }
+    }
+    else {
+      std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+      if (m_tasks.empty()) { break; }
+
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+    }
+
+    ++nb_executed;
+
+    if (!task) { continue; }
+
+    try {
+      task();
+    }
+    catch (const std::exception&) {
+      __TACOPIE_LOG(warn, "uncatched exception propagated up to the threadpool.")
+    }
+  }
+
+  return nb_executed;
+}
+
+void
+thread_pool::notify_workers(std::size_t nb_tasks) {
+  //! a single task wakes a single worker, a batch at least as large as the pool wakes them all
+  bool notify_all = nb_tasks >= m_max_nb_threads;
+
+  if (m_policy == scheduling_policy::lock_free) {
+    if (notify_all) {
+      m_not_empty_event.notify_all();
+    }
+    else {
+      for (std::size_t i = 0; i < nb_tasks; ++i) { m_not_empty_event.notify_one(); }
+    }
+
+    return;
+  }
+
+  //! work_stealing workers only park when they found nothing to steal: no need to wake more workers than parked ones
+  if (m_policy == scheduling_policy::work_stealing) {
+    std::size_t nb_sleeping_threads = m_nb_sleeping_threads;
+
+    if (!nb_sleeping_threads) { return; }
+
+    notify_all = notify_all || nb_tasks >= nb_sleeping_threads;
+  }
+
+  std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+  if (notify_all) {
+    m_tasks_condvar.notify_all();
+  }
+  else {
+    for (std::size_t i = 0; i < nb_tasks; ++i) { m_tasks_condvar.notify_one(); }
+  }
+}
+
+//!
+//! work stealing
+//!
+
+thread_local thread_pool::worker_slot* thread_pool::s_current_slot = nullptr;
+
+void
+thread_pool::add_task_work_stealing(task_t&& task, priority prio) {
+  worker_slot* slot = get_current_slot();
+
+  if (slot && prio == priority::normal) {
+    //! submitted by one of our workers: keep it local, other workers will steal it if needed
+    slot->deque.push(new task_t(std::move(task)));
+    ++m_nb_queued_tasks;
+  }
+  else {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    m_tasks.push(std::move(task), static_cast<std::size_t>(prio));
+    ++m_nb_injected_tasks;
+    ++m_nb_queued_tasks;
+  }
+
+  //! m_nb_queued_tasks is incremented before checking for sleeping workers, and parking workers check m_nb_queued_tasks after registering as sleeping: no wakeup can be lost
+  if (m_nb_sleeping_threads > 0) {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+    m_tasks_condvar.notify_one();
+  }
+}
+
+bool
+thread_pool::try_fetch_task(worker_slot* slot, task_t& task) {
+  task_t* stolen = nullptr;
+
+  //! own deque first (LIFO: most recently submitted tasks are the hottest in cache)
+  if (slot && slot->deque.pop(stolen)) {
+    --m_nb_queued_tasks;
+    task = std::move(*stolen);
+    delete stolen;
+    return true;
+  }
+
+  //! then the injection queue: take a batch to amortize the lock, extra tasks go to our deque so that other workers can steal them
+  if (m_nb_injected_tasks > 0) {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    if (!m_tasks.empty()) {
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+      --m_nb_injected_tasks;
+      --m_nb_queued_tasks;
+
+      if (slot) {
+        std::size_t nb_workers = std::max<std::size_t>(m_nb_running_threads, 1);
+        std::size_t batch_size = std::min<std::size_t>(m_tasks.size() / nb_workers, __TACOPIE_THREAD_POOL_INJECTION_BATCH_SIZE);
+
+        for (std::size_t i = 0; i < batch_size; ++i) {
+          slot->deque.push(new task_t(std::move(m_tasks.front())));
+          m_tasks.pop();
+          --m_nb_injected_tasks;
+        }
+      }
+
+      return true;
+    }
+  }
+
+  //! finally, steal from the other workers, starting after our own slot to spread the thieves
+  std::size_t nb_slots = m_nb_used_slots;
+  std::size_t start    = slot ? static_cast<std::size_t>(slot - m_slots.get()) + 1 : 0;
+
+  for (std::size_t i = 0; i < nb_slots; ++i) {
+    worker_slot& victim = m_slots[(start + i) % nb_slots];
+
+    if (&victim == slot || victim.deque.empty()) { continue; }
+
+    if (victim.deque.steal(stolen)) {
+      --m_nb_queued_tasks;
+      task = std::move(*stolen);
+      delete stolen;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::pair<bool, thread_pool::task_t>
+thread_pool::fetch_task_or_stop_work_stealing(void) {
+  worker_slot* slot    = get_current_slot();
+  std::size_t nb_spins = 0;
+  task_t task          = nullptr;
+
+  while (true) {
+    if (should_stop()) {
+      std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+      if (should_stop()) {
+        --m_nb_running_threads;
+        return {true, nullptr};
+      }
+    }
+
+    if (try_fetch_task(slot, task)) { return {false, std::move(task)}; }
+
+    //! spin briefly before parking: new tasks often come right after
+    if (nb_spins++ < __TACOPIE_THREAD_POOL_SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    __TACOPIE_LOG(debug, "parking work stealing worker");
+
+    std::unique_lock<std::mutex> lock(m_tasks_mtx);
+    ++m_nb_sleeping_threads;
+    m_tasks_condvar.wait(lock, [&] { return should_stop() || m_nb_queued_tasks > 0; });
+    --m_nb_sleeping_threads;
+
+    nb_spins = 0;
+  }
+}
+
+thread_pool::worker_slot*
+thread_pool::get_current_slot(void) const {
+  worker_slot* slot = s_current_slot;
+
+  return slot && slot->pool == this ? slot : nullptr;
+}
+
+thread_pool::worker_slot*
+thread_pool::acquire_slot(void) {
+  for (std::size_t i = 0; i < __TACOPIE_THREAD_POOL_MAX_STEALING_WORKERS; ++i) {
+    if (!m_slots[i].in_use.exchange(true)) {
+      //! make the slot visible to thieves
+      std::size_t nb_used_slots = m_nb_used_slots;
+      while (nb_used_slots < i + 1 && !m_nb_used_slots.compare_exchange_weak(nb_used_slots, i + 1)) {}
+
+      return &m_slots[i];
+    }
+  }
+
+  //! all slots are used: this worker only consumes from the injection queue and steals
+  __TACOPIE_LOG(warn, "no work stealing slot available for worker");
+  return nullptr;
+}
+
+void
+thread_pool::release_slot(worker_slot* slot) {
+  if (!slot) { return; }
+
+  //! hand the pending tasks over to the remaining workers
+  task_t* task = nullptr;
+
+  while (slot->deque.pop(task)) {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    m_tasks.push(std::move(*task), static_cast<std::size_t>(priority::normal));
+    delete task;
+    ++m_nb_injected_tasks;
+    m_tasks_condvar.notify_one();
+  }
+
+  slot->in_use = false;
+}
+
+void
+thread_pool::clear_slots(void) {
+  task_t* task = nullptr;
+
+  for (std::size_t i = 0; i < m_nb_used_slots; ++i) {
+    while (m_slots[i].deque.pop(task)) { delete task; }
+  }
+}
+
+//!
+//! lock free
+//!
+
+void
+thread_pool::add_task_lock_free(task_t&& task, priority prio) {
+  if (!push_task_lock_free(std::move(task), prio)) { __TACOPIE_THROW(warn, "thread_pool queue is full"); }
+
+  m_not_empty_event.notify_one();
+}
+
+bool
+thread_pool::push_task_lock_free(task_t&& task, priority prio) {
+  while (!m_queue->try_push(task)) {
+    if (m_overflow == overflow_policy::reject) { return false; }
+
+    if (m_overflow == overflow_policy::spill) {
+      std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+      m_tasks.push(std::move(task), static_cast<std::size_t>(prio));
+      ++m_nb_injected_tasks;
+      break;
+    }
+
+    //! block: wait for a worker to free a cell
+    std::uint32_t key = m_not_full_event.prepare_wait();
+
+    //! stopping: the task would not be executed anyway
+    if (m_should_stop) {
+      m_not_full_event.cancel_wait();
+      return true;
+    }
+
+    if (m_queue->try_push(task)) {
+      m_not_full_event.cancel_wait();
+      break;
+    }
+
+    m_not_full_event.commit_wait(key);
+  }
+
+  return true;
+}
+
+bool
+thread_pool::try_fetch_task_lock_free(task_t& task) {
+  if (m_queue->try_pop(task)) {
+    if (m_overflow == overflow_policy::block) { m_not_full_event.notify_one(); }
+    return true;
+  }
+
+  //! spilled tasks are only looked at once the ring is empty
+  if (m_nb_injected_tasks > 0) {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+    if (!m_tasks.empty()) {
+      task = std::move(m_tasks.front());
+      m_tasks.pop();
+      --m_nb_injected_tasks;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+std::pair<bool, thread_pool::task_t>
+thread_pool::fetch_task_or_stop_lock_free(void) {
+  std::size_t nb_spins = 0;
+  task_t task          = nullptr;
+
+  while (true) {
+    if (should_stop()) {
+      std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+      if (should_stop()) {
+        --m_nb_running_threads;
+        return {true, nullptr};
+      }
+    }
+
+    if (try_fetch_task_lock_free(task)) { return {false, std::move(task)}; }
+
+    //! spin briefly before parking: new tasks often come right after
+    if (nb_spins++ < __TACOPIE_THREAD_POOL_SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    __TACOPIE_LOG(debug, "parking lock free worker");
+
+    std::uint32_t key = m_not_empty_event.prepare_wait();
+
+    if (should_stop() || !m_queue->empty() || m_nb_injected_tasks > 0) {
+      m_not_empty_event.cancel_wait();
+    }
+    else {
+      m_not_empty_event.commit_wait(key);
+    }
+
+    nb_spins = 0;
+  }
+}
+
+void
+thread_pool::notify_all_workers(void) {
+  {
+    std::lock_guard<std::mutex> lock(m_tasks_mtx);
+    m_tasks_condvar.notify_all();
+  }
+
+  m_not_empty_event.notify_all();
+  m_not_full_event.notify_all();
+}
+
 //!
 //! adjust number of threads
 //!
 void
 thread_pool::set_nb_threads(std::size_t nb_threads) {
+  std::lock_guard<std::mutex> lock(m_workers_mtx);
+
   m_max_nb_threads = nb_threads;
 
+  //! join the workers that exited since last call
+  for (const auto& id : m_retired_workers) {
+    auto it = std::find_if(m_workers.begin(), m_workers.end(), [&](const std::thread& worker) { return worker.get_id() == id; });
+
+    if (it != m_workers.end()) {
+      it->join();
+      m_workers.erase(it);
+    }
+  }
+  m_retired_workers.clear();
+
   //! if we increased the number of threads, spawn them
   while (m_nb_running_threads < m_max_nb_threads) {
     ++m_nb_running_threads;
     m_workers.push_back(std::thread(std::bind(&thread_pool::run, this)));
+
+    if (!m_cpu_affinity.empty()) { apply_cpu_affinity(m_workers.back(), m_workers.size() - 1); }
   }
 
   //! otherwise, wake up threads to make them stop if necessary (until we get the right amount of threads)
   if (m_nb_running_threads > m_max_nb_threads) {
-    m_tasks_condvar.notify_all();
+    notify_all_workers();
   }
 }
 
+//!
+//! priorities
+//!
+
+void
+thread_pool::set_priority_weights(std::size_t high, std::size_t normal, std::size_t low) {
+  std::lock_guard<std::mutex> lock(m_tasks_mtx);
+
+  m_tasks.set_weight(static_cast<std::size_t>(priority::high), high);
+  m_tasks.set_weight(static_cast<std::size_t>(priority::normal), normal);
+  m_tasks.set_weight(static_cast<std::size_t>(priority::low), low);
+}
+
+//!
+//! cpu affinity
+//!
+
+void
+thread_pool::set_cpu_affinity(const cpu_list_t& cpus, bool pin_each_worker) {
+  std::lock_guard<std::mutex> lock(m_workers_mtx);
+
+  m_cpu_affinity    = cpus;
+  m_pin_each_worker = pin_each_worker;
+
+  std::size_t index = 0;
+  for (auto& worker : m_workers) { apply_cpu_affinity(worker, index++); }
+}
+
+void
+thread_pool::apply_cpu_affinity(std::thread& worker, std::size_t index) {
+  bool applied;
+
+  if (m_pin_each_worker && !m_cpu_affinity.empty()) {
+    applied = set_thread_affinity(worker, {m_cpu_affinity[index % m_cpu_affinity.size()]});
+  }
+  else {
+    applied = set_thread_affinity(worker, m_cpu_affinity);
+  }
+
+  if (!applied) { __TACOPIE_LOG(warn, "could not set thread_pool worker cpu affinity"); }
+}
+
+//!
+//! autoscaling
+//!
+
+void
+thread_pool::enable_autoscaling(const autoscaling_config& config) {
+  std::lock_guard<std::mutex> lock(m_autoscaling_mtx);
+
+  m_autoscaling_config = config;
+
+  if (m_is_autoscaling) { return; }
+
+  m_nb_submitted_tasks = 0;
+  m_nb_started_tasks   = 0;
+  m_busy_time_ns       = 0;
+  m_is_autoscaling     = true;
+
+  m_autoscaler = std::thread(std::bind(&thread_pool::autoscale, this));
+}
+
+void
+thread_pool::disable_autoscaling(void) {
+  {
+    std::lock_guard<std::mutex> lock(m_autoscaling_mtx);
+
+    if (!m_is_autoscaling) { return; }
+
+    m_is_autoscaling = false;
+    m_autoscaling_condvar.notify_all();
+  }
+
+  m_autoscaler.join();
+}
+
+bool
+thread_pool::is_autoscaling(void) const {
+  return m_is_autoscaling;
+}
+
+thread_pool::autoscaling_metrics
+thread_pool::get_autoscaling_metrics(void) {
+  std::lock_guard<std::mutex> lock(m_autoscaling_mtx);
+
+  return m_autoscaling_metrics;
+}
+
+void
+thread_pool::autoscale(void) {
+  __TACOPIE_LOG(debug, "start autoscale() worker");
+
+  auto last_sample            = std::chrono::steady_clock::now();
+  std::uint64_t last_busy     = m_busy_time_ns;
+  std::uint64_t last_started  = m_nb_started_tasks;
+  std::size_t nb_up_samples   = 0;
+  std::size_t nb_down_samples = 0;
+
+  std::unique_lock<std::mutex> lock(m_autoscaling_mtx);
+
+  while (true) {
+    m_autoscaling_condvar.wait_for(lock, m_autoscaling_config.interval, [&] { return !m_is_autoscaling; });
+
+    if (!m_is_autoscaling) { break; }
+
+    const auto& config      = m_autoscaling_config;
+    auto now                = std::chrono::steady_clock::now();
+    double elapsed_ns       = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_sample).count());
+    std::uint64_t busy      = m_busy_time_ns;
+    std::uint64_t started   = m_nb_started_tasks;
+    std::uint64_t submitted = m_nb_submitted_tasks;
+
+    std::size_t nb_threads      = m_max_nb_threads;
+    std::size_t nb_queued_tasks = submitted > started ? static_cast<std::size_t>(submitted - started) : 0;
+    double utilization          = nb_threads && elapsed_ns > 0 ? static_cast<double>(busy - last_busy) / (elapsed_ns * nb_threads) : 0;
+    double dequeue_rate         = elapsed_ns > 0 ? static_cast<double>(started - last_started) / elapsed_ns : 0;
+
+    //! nothing dequeued while tasks are waiting: the tasks waited at least the whole interval
+    double queueing_delay_ns = 0;
+    if (nb_queued_tasks) { queueing_delay_ns = dequeue_rate > 0 ? nb_queued_tasks / dequeue_rate : elapsed_ns; }
+
+    last_sample  = now;
+    last_busy    = busy;
+    last_started = started;
+
+    //! hysteresis: a decision requires several consecutive samples in the same direction
+    bool overloaded  = queueing_delay_ns > std::chrono::duration_cast<std::chrono::nanoseconds>(config.scale_up_queueing_delay).count() || utilization > config.scale_up_utilization;
+    bool underloaded = !nb_queued_tasks && utilization < config.scale_down_utilization;
+
+    nb_up_samples = overloaded ? nb_up_samples + 1 : 0;
+    nb_down_samples = underloaded ? nb_down_samples + 1 : 0;
+
+    std::size_t target = nb_threads;
+    auto decision      = autoscaling_decision::none;
+
+    if (nb_threads < config.min_nb_threads) {
+      target = config.min_nb_threads;
+    }
+    else if (nb_threads > config.max_nb_threads) {
+      target = config.max_nb_threads;
+    }
+    else if (nb_up_samples >= config.scale_up_samples && nb_threads < config.max_nb_threads) {
+      target        = nb_threads + 1;
+      decision      = autoscaling_decision::scale_up;
+      nb_up_samples = 0;
+      ++m_autoscaling_metrics.nb_scale_ups;
+    }
+    else if (nb_down_samples >= config.scale_down_samples && nb_threads > config.min_nb_threads) {
+      target        = nb_threads - 1;
+      decision      = autoscaling_decision::scale_down;
+      nb_down_samples = 0;
+      ++m_autoscaling_metrics.nb_scale_downs;
+    }
+
+    m_autoscaling_metrics.nb_threads      = target;
+    m_autoscaling_metrics.nb_queued_tasks = nb_queued_tasks;
+    m_autoscaling_metrics.utilization     = utilization;
+    m_autoscaling_metrics.queueing_delay  = std::chrono::microseconds(static_cast<std::int64_t>(queueing_delay_ns / 1000));
+    m_autoscaling_metrics.last_decision   = decision;
+
+    if (target != nb_threads) {
+      __TACOPIE_LOG(info, decision == autoscaling_decision::scale_down ? "thread_pool autoscaling: retire a worker" : "thread_pool autoscaling: add a worker");
+
+      lock.unlock();
+      set_nb_threads(target);
+      lock.lock();
+    }
+  }
+
+  __TACOPIE_LOG(debug, "stop autoscale() worker");
+}
+
 } // namespace utils
 
 } // namespace tacopie
@@ -0,0 +1,299 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <tacopie/http/request_parser.hpp>
+
+#include <string>
+
+using namespace tacopie;
+
+static void
+feed(http::request_parser& parser, const std::string& bytes) {
+  parser.feed(bytes.data(), bytes.size());
+}
+
+static std::string
+to_string(const http::slice* slice) {
+  return slice ? slice->to_string() : "";
+}
+
+TEST(HttpRequestParser, SimpleRequest) {
+  http::request_parser parser;
+  http::request request;
+
+  feed(parser, "GET /index.html HTTP/1.1\r\nHost: localhost\r\nX-Empty:\r\nX-Spaces: \t value \t\r\n\r\n");
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("GET", request.get_method().to_string());
+  EXPECT_EQ("/index.html", request.get_target().to_string());
+  EXPECT_EQ(1U, request.get_version_minor());
+  EXPECT_EQ(3U, request.get_nb_headers());
+  EXPECT_EQ("localhost", to_string(request.find_header("HOST")));
+  EXPECT_EQ("", to_string(request.find_header("x-empty")));
+  EXPECT_EQ("value", to_string(request.find_header("x-spaces")));
+  EXPECT_EQ(nullptr, request.find_header("content-length"));
+  EXPECT_EQ(0U, request.get_body().size);
+  EXPECT_TRUE(request.keep_alive());
+
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+}
+
+TEST(HttpRequestParser, HeadFedByteByByte) {
+  std::string bytes = "POST /submit HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+  http::request_parser parser;
+  http::request request;
+
+  //! the request is complete with its last byte only
+  for (std::size_t i = 0; i + 1 < bytes.size(); ++i) {
+    feed(parser, bytes.substr(i, 1));
+    ASSERT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+  }
+
+  feed(parser, bytes.substr(bytes.size() - 1));
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("POST", request.get_method().to_string());
+  EXPECT_EQ("hello", request.get_body().to_string());
+}
+
+TEST(HttpRequestParser, BodyAcrossFeeds) {
+  http::request_parser parser;
+  http::request request;
+
+  feed(parser, "PUT /data HTTP/1.1\r\nContent-Length: 10\r\n\r\n0123");
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+
+  //! still short of the announced body: the header section is not parsed again
+  feed(parser, "456");
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+
+  feed(parser, "789GET / HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("PUT", request.get_method().to_string());
+  EXPECT_EQ("0123456789", request.get_body().to_string());
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("GET", request.get_method().to_string());
+  EXPECT_EQ(0U, request.get_body().size);
+}
+
+TEST(HttpRequestParser, PipelinedRequests) {
+  http::request_parser parser;
+  http::request request;
+
+  std::string bytes = "GET /a HTTP/1.1\r\n\r\n"
+                      "POST /b HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+                      "DELETE /c HTTP/1.1\r\n\r\n";
+  parser.feed(std::vector<char>(bytes.begin(), bytes.end()));
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("/a", request.get_target().to_string());
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("/b", request.get_target().to_string());
+  EXPECT_EQ("abc", request.get_body().to_string());
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("/c", request.get_target().to_string());
+
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+}
+
+TEST(HttpRequestParser, PartialRequestKeptAcrossRvalueFeed) {
+  http::request_parser parser;
+  http::request request;
+
+  std::string first  = "GET /a HTTP/1.1\r\n\r\nGET /b HT";
+  std::string second = "TP/1.1\r\n\r\n";
+
+  parser.feed(std::vector<char>(first.begin(), first.end()));
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("/a", request.get_target().to_string());
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+
+  //! a partial request is pending: the new bytes are appended to it
+  parser.feed(std::vector<char>(second.begin(), second.end()));
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("/b", request.get_target().to_string());
+}
+
+TEST(HttpRequestParser, LeadingEmptyLines) {
+  http::request_parser parser;
+  http::request request;
+
+  feed(parser, "\r\n\r\nGET / HTTP/1.1\r\n\r\n");
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("GET", request.get_method().to_string());
+  EXPECT_EQ("/", request.get_target().to_string());
+
+  //! empty lines after a request and across feeds
+  feed(parser, "\r\n\r");
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+
+  feed(parser, "\nPOST /next HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("POST", request.get_method().to_string());
+  EXPECT_EQ("/next", request.get_target().to_string());
+}
+
+TEST(HttpRequestParser, HeadRequestWithoutBody) {
+  http::request_parser parser;
+  http::request request;
+
+  feed(parser, "HEAD /resource HTTP/1.1\r\n\r\nGET /next HTTP/1.1\r\n\r\n");
+
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("HEAD", request.get_method().to_string());
+  EXPECT_EQ(0U, request.get_body().size);
+
+  //! no body is expected: the following request is not swallowed
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("/next", request.get_target().to_string());
+}
+
+TEST(HttpRequestParser, ConnectionHandling) {
+  struct {
+    const char* head;
+    bool keep_alive;
+  } cases[] = {
+    {"GET / HTTP/1.1\r\n\r\n", true},
+    {"GET / HTTP/1.1\r\nConnection: close\r\n\r\n", false},
+    {"GET / HTTP/1.1\r\nConnection: Keep-Alive\r\n\r\n", true},
+    {"GET / HTTP/1.1\r\nConnection: upgrade, CLOSE\r\n\r\n", false},
+    {"GET / HTTP/1.0\r\n\r\n", false},
+    {"GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", true},
+    {"GET / HTTP/1.0\r\nConnection: close\r\n\r\n", false},
+  };
+
+  for (const auto& c : cases) {
+    http::request_parser parser;
+    http::request request;
+
+    feed(parser, c.head);
+    ASSERT_EQ(http::request_parser::status::complete, parser.parse(request)) << c.head;
+    EXPECT_EQ(c.keep_alive, request.keep_alive()) << c.head;
+  }
+}
+
+TEST(HttpRequestParser, BadRequests) {
+  const char* heads[] = {
+    "GET /\r\n\r\n",
+    "GET  / HTTP/1.1\r\n\r\n",
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET / HTTP/1.1\r\nno colon\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: a\r\n folded\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length:\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\nabc",
+  };
+
+  for (const char* head : heads) {
+    http::request_parser parser;
+    http::request request;
+
+    feed(parser, head);
+    EXPECT_EQ(http::request_parser::status::bad_request, parser.parse(request)) << head;
+  }
+}
+
+TEST(HttpRequestParser, TransferEncodingNotImplemented) {
+  http::request_parser parser;
+  http::request request;
+
+  feed(parser, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n");
+
+  EXPECT_EQ(http::request_parser::status::not_implemented, parser.parse(request));
+}
+
+TEST(HttpRequestParser, HeaderLimits) {
+  //! header section larger than __TACOPIE_HTTP_MAX_HEADER_SIZE, still incomplete
+  {
+    http::request_parser parser;
+    http::request request;
+
+    feed(parser, "GET / HTTP/1.1\r\nX-Large: " + std::string(__TACOPIE_HTTP_MAX_HEADER_SIZE, 'a'));
+    EXPECT_EQ(http::request_parser::status::header_too_large, parser.parse(request));
+  }
+
+  //! header section larger than __TACOPIE_HTTP_MAX_HEADER_SIZE, complete
+  {
+    http::request_parser parser;
+    http::request request;
+
+    feed(parser, "GET / HTTP/1.1\r\nX-Large: " + std::string(__TACOPIE_HTTP_MAX_HEADER_SIZE, 'a') + "\r\n\r\n");
+    EXPECT_EQ(http::request_parser::status::header_too_large, parser.parse(request));
+  }
+
+  //! more than __TACOPIE_HTTP_MAX_HEADERS header fields
+  {
+    http::request_parser parser;
+    http::request request;
+
+    std::string head = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i <= __TACOPIE_HTTP_MAX_HEADERS; ++i) { head += "X-Field: " + std::to_string(i) + "\r\n"; }
+    feed(parser, head + "\r\n");
+
+    EXPECT_EQ(http::request_parser::status::header_too_large, parser.parse(request));
+  }
+}
+
+TEST(HttpRequestParser, BodyLimits) {
+  //! largest accepted body
+  {
+    http::request_parser parser;
+    http::request request;
+
+    feed(parser, "POST / HTTP/1.1\r\nContent-Length: " + std::to_string(__TACOPIE_HTTP_MAX_BODY_SIZE) + "\r\n\r\n");
+    EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+  }
+
+  const std::string lengths[] = {
+    std::to_string(__TACOPIE_HTTP_MAX_BODY_SIZE + 1),
+    "18446744073709551616",
+    "99999999999999999999999999999999999999",
+  };
+
+  for (const auto& length : lengths) {
+    http::request_parser parser;
+    http::request request;
+
+    feed(parser, "POST / HTTP/1.1\r\nContent-Length: " + length + "\r\n\r\n");
+    EXPECT_EQ(http::request_parser::status::payload_too_large, parser.parse(request)) << length;
+  }
+}
+
+TEST(HttpRequestParser, Reset) {
+  http::request_parser parser;
+  http::request request;
+
+  feed(parser, "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\n01");
+  EXPECT_EQ(http::request_parser::status::incomplete, parser.parse(request));
+
+  parser.reset();
+
+  feed(parser, "GET / HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(http::request_parser::status::complete, parser.parse(request));
+  EXPECT_EQ("GET", request.get_method().to_string());
+}
@@ -0,0 +1,488 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/io_service.hpp>
+#include <tacopie/network/tcp_client.hpp>
+#include <tacopie/network/tcp_server.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+
+using namespace tacopie;
+
+namespace {
+
+//!
+//! server sending back everything it receives, on the first free port from 36780
+//!
+struct echo_server {
+  echo_server(void)
+  : echo_server(get_default_io_service()) {}
+
+  explicit echo_server(const std::shared_ptr<io_service>& service)
+  : server(service) {
+    echo = [this](const std::shared_ptr<tcp_client>& client) {
+      std::weak_ptr<tcp_client> weak_client = client;
+
+      auto on_read = [this, weak_client](tcp_client::read_result& result) {
+        auto client = weak_client.lock();
+        if (!client || !result.success) { return; }
+
+        try {
+          client->async_write({std::move(result.buffer), nullptr});
+          echo(client);
+        }
+        catch (const tacopie_error&) {
+          //! disconnected meanwhile
+        }
+      };
+
+      client->async_read({1024, on_read});
+    };
+
+    for (port = 36780;; ++port) {
+      try {
+        server.start("127.0.0.1", port, [this](const std::shared_ptr<tcp_client>& client) {
+          echo(client);
+          return false;
+        });
+        break;
+      }
+      catch (const tacopie_error&) {
+        if (port == 36880) { throw; }
+      }
+    }
+  }
+
+  ~echo_server(void) {
+    server.stop(true);
+  }
+
+  std::function<void(const std::shared_ptr<tcp_client>&)> echo;
+  tcp_server server;
+  std::uint32_t port;
+};
+
+//!
+//! client exchanging one byte at a time with an echo server
+//!
+struct ping_pong {
+  ping_pong(const std::shared_ptr<io_service>& service, std::uint32_t port)
+  : client(service) {
+    client.connect("127.0.0.1", port);
+  }
+
+  void
+  start(std::size_t nb_round_trips) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      nb_remaining = nb_round_trips;
+    }
+
+    send();
+  }
+
+  void
+  send(void) {
+    client.async_read({1, std::bind(&ping_pong::on_read, this, std::placeholders::_1)});
+    client.async_write({std::vector<char>(1, 'p'), nullptr});
+  }
+
+  void
+  on_read(tcp_client::read_result& result) {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (!result.success) {
+      failed = true;
+    }
+    else if (--nb_remaining) {
+      send();
+    }
+
+    cv.notify_all();
+  }
+
+  bool
+  wait_for_completion(std::uint32_t timeout_msecs) {
+    std::unique_lock<std::mutex> lock(mtx);
+    return cv.wait_for(lock, std::chrono::milliseconds(timeout_msecs), [this] { return failed || !nb_remaining; }) && !failed;
+  }
+
+  tcp_client client;
+  std::size_t nb_remaining = 0;
+  bool failed              = false;
+  std::mutex mtx;
+  std::condition_variable cv;
+};
+
+//!
+//! \return id of the thread running the tasks of a single worker io_service
+//!
+std::thread::id
+worker_thread_id(io_service& service) {
+  std::promise<std::thread::id> id;
+  service.get_callback_workers().add_task([&id] { id.set_value(std::this_thread::get_id()); });
+
+  return id.get_future().get();
+}
+
+} // namespace
+
+TEST(IoService, PollStateRelocatedWhileTrafficFlows) {
+  echo_server server;
+
+  auto service = std::make_shared<io_service>();
+  service->set_nb_workers(2);
+
+  std::vector<std::unique_ptr<ping_pong>> clients;
+  for (int i = 0; i < 8; ++i) { clients.emplace_back(new ping_pong(service, server.port)); }
+  for (auto& client : clients) { client->start(200); }
+
+  //! the poll thread reallocates its state over and over (no cpu restriction, so that it never fails) while callbacks are in flight
+  std::atomic<bool> done(false);
+  std::thread relocations([&] {
+    while (!done) {
+      service->set_poll_cpu_affinity({}, true);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  for (auto& client : clients) { EXPECT_TRUE(client->wait_for_completion(10000)); }
+
+  done = true;
+  relocations.join();
+
+  //! sockets tracked before the relocations are still polled
+  for (auto& client : clients) { client->start(10); }
+  for (auto& client : clients) { EXPECT_TRUE(client->wait_for_completion(10000)); }
+
+  for (auto& client : clients) { client->client.disconnect(true); }
+}
+
+TEST(IoService, MigratedClientKeepsItsPendingReadOnTheNewService) {
+  echo_server server;
+
+  auto previous = std::make_shared<io_service>();
+  auto next     = std::make_shared<io_service>();
+  std::thread::id next_worker = worker_thread_id(*next);
+
+  tcp_client client(previous);
+  client.connect("127.0.0.1", server.port);
+
+  std::promise<std::pair<std::string, std::thread::id>> read;
+  auto on_read = [&read](tcp_client::read_result& result) {
+    read.set_value({std::string(result.buffer.begin(), result.buffer.end()), std::this_thread::get_id()});
+  };
+
+  //! issued before the migration, completed by the new io_service once the echo comes back
+  client.async_read({3, on_read});
+  client.set_io_service(next);
+  EXPECT_EQ(next, client.get_io_service());
+
+  //! the previous io_service is not needed anymore
+  previous.reset();
+
+  client.async_write({{'a', 'b', 'c'}, nullptr});
+
+  auto future = read.get_future();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+
+  auto result = future.get();
+  EXPECT_EQ("abc", result.first);
+  EXPECT_EQ(next_worker, result.second);
+
+  client.disconnect(true);
+}
+
+TEST(IoService, ClientsMigrateBackAndForthWhileTrafficFlows) {
+  echo_server server;
+
+  std::shared_ptr<io_service> services[] = {std::make_shared<io_service>(), std::make_shared<io_service>()};
+
+  std::vector<std::unique_ptr<ping_pong>> clients;
+  for (int i = 0; i < 4; ++i) { clients.emplace_back(new ping_pong(services[0], server.port)); }
+  for (auto& client : clients) { client->start(2000); }
+
+  //! every client moves to the other io_service over and over, with requests in flight
+  std::atomic<bool> done(false);
+  std::size_t nb_rounds = 0;
+  std::thread migrations([&] {
+    while (!done) {
+      const auto& target = services[++nb_rounds % 2];
+      for (auto& client : clients) { client->client.set_io_service(target); }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  for (auto& client : clients) { EXPECT_TRUE(client->wait_for_completion(10000)); }
+
+  done = true;
+  migrations.join();
+  EXPECT_LT(0U, nb_rounds);
+
+  //! every round trip went through, whichever io_service the client ended up on
+  for (auto& client : clients) {
+    EXPECT_EQ(services[nb_rounds % 2], client->client.get_io_service());
+    client->start(10);
+  }
+  for (auto& client : clients) { EXPECT_TRUE(client->wait_for_completion(10000)); }
+
+  for (auto& client : clients) { client->client.disconnect(true); }
+}
+
+TEST(IoService, MigrationIsRefusedWhileConnecting) {
+  auto service = std::make_shared<io_service>();
+  tcp_client client;
+  std::promise<bool> connected;
+
+  //! non routable address: the connection stays pending (or fails right away, depending on the network)
+  try {
+    client.async_connect("10.255.255.1", 9, [&connected](bool success) { connected.set_value(success); }, tcp_client::complete_on_disconnect_t{});
+  }
+  catch (const tacopie_error&) {
+    return;
+  }
+
+  bool refused = false;
+  try {
+    client.set_io_service(service);
+  }
+  catch (const tacopie_error&) {
+    refused = true;
+  }
+
+  EXPECT_NE(refused, client.get_io_service() == service);
+
+  //! the connect callback runs exactly once, whether the connection failed or was cancelled
+  client.disconnect(true);
+
+  auto future = connected.get_future();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+  EXPECT_FALSE(future.get());
+}
+
+TEST(IoService, ServersAndTheirClientsRunOnTheirOwnService) {
+  std::shared_ptr<io_service> services[] = {std::make_shared<io_service>(), std::make_shared<io_service>()};
+
+  echo_server first(services[0]);
+  echo_server second(services[1]);
+  EXPECT_EQ(services[0], first.server.get_io_service());
+  EXPECT_EQ(services[1], second.server.get_io_service());
+
+  auto clients_service = std::make_shared<io_service>();
+  ping_pong first_client(clients_service, first.port);
+  ping_pong second_client(clients_service, second.port);
+
+  first_client.start(100);
+  second_client.start(100);
+  EXPECT_TRUE(first_client.wait_for_completion(10000));
+  EXPECT_TRUE(second_client.wait_for_completion(10000));
+
+  //! the accepted clients are monitored by the io_service of their server, not by the default one
+  ASSERT_EQ(1U, first.server.get_nb_clients());
+  ASSERT_EQ(1U, second.server.get_nb_clients());
+  for (const auto& client : first.server.get_clients()) { EXPECT_EQ(services[0], client->get_io_service()); }
+  for (const auto& client : second.server.get_clients()) { EXPECT_EQ(services[1], client->get_io_service()); }
+
+  first_client.client.disconnect(true);
+  second_client.client.disconnect(true);
+}
+
+TEST(IoService, DefaultServiceIsReplacedConcurrently) {
+  std::shared_ptr<io_service> initial = get_default_io_service();
+
+  //! caller_driven instances: no thread to start and join at each replacement
+  std::atomic<std::size_t> nb_null(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([i, &nb_null] {
+      for (int j = 0; j < 500; ++j) {
+        if (i % 2) {
+          set_default_io_service(std::make_shared<io_service>(io_service::run_mode::caller_driven));
+        }
+        else if (!get_default_io_service()) {
+          ++nb_null;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) { thread.join(); }
+  EXPECT_EQ(0U, nb_null);
+
+  //! clients built meanwhile keep the io_service they were built with
+  set_default_io_service(initial);
+  EXPECT_EQ(initial, get_default_io_service());
+}
+
+TEST(IoService, CallerDrivenOnlyWhenRequested) {
+  io_service service;
+
+  EXPECT_EQ(io_service::run_mode::poll_thread, service.get_run_mode());
+  EXPECT_THROW(service.run_once(1), tacopie_error);
+  EXPECT_THROW(service.poll_nonblocking(), tacopie_error);
+}
+
+TEST(IoService, PollNonblockingRunsThePendingTasksOnTheCallingThread) {
+  io_service service(io_service::run_mode::caller_driven);
+
+  EXPECT_EQ(0U, service.poll_nonblocking());
+
+  std::vector<std::thread::id> threads;
+  for (int i = 0; i < 3; ++i) {
+    service.get_callback_workers().add_task([&threads] { threads.push_back(std::this_thread::get_id()); });
+  }
+
+  EXPECT_EQ(3U, service.poll_nonblocking());
+  EXPECT_EQ(std::vector<std::thread::id>(3, std::this_thread::get_id()), threads);
+  EXPECT_EQ(0U, service.poll_nonblocking());
+}
+
+TEST(IoService, RunOnceWaitsForTheTimeout) {
+  io_service service(io_service::run_mode::caller_driven);
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(0U, service.run_once(50));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(45));
+}
+
+TEST(IoService, TaskSubmittedFromAnotherThreadWakesRunOnceUp) {
+  io_service service(io_service::run_mode::caller_driven);
+
+  std::atomic<bool> executed(false);
+  std::thread::id executing_thread;
+  auto task = [&] {
+    executing_thread = std::this_thread::get_id();
+    executed         = true;
+  };
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool done = false;
+
+  //! stops the io_service if the task did not wake it up, so that a regression fails instead of hanging
+  std::thread submitter([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    service.get_callback_workers().add_task(task);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    if (!cv.wait_for(lock, std::chrono::seconds(5), [&] { return done; })) { service.stop(); }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  while (!executed && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) { service.run_once(); }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    done = true;
+  }
+  cv.notify_all();
+  submitter.join();
+
+  EXPECT_TRUE(executed);
+  EXPECT_EQ(std::this_thread::get_id(), executing_thread);
+}
+
+TEST(IoService, RunExecutesTheSubmittedTasksUntilStopped) {
+  io_service service(io_service::run_mode::caller_driven);
+
+  std::thread::id driving_thread;
+  std::atomic<std::size_t> nb_executed(0);
+  std::atomic<bool> foreign_thread(false);
+  auto count = [&] {
+    if (std::this_thread::get_id() != driving_thread) { foreign_thread = true; }
+    ++nb_executed;
+  };
+
+  std::thread driver([&] {
+    driving_thread = std::this_thread::get_id();
+    service.run();
+  });
+
+  //! one by one, by batch, and delayed
+  std::vector<utils::thread_pool::task_t> batch;
+  for (int i = 0; i < 100; ++i) {
+    service.get_callback_workers().add_task(count);
+    batch.emplace_back(count);
+  }
+  service.get_callback_workers().add_tasks(batch);
+  service.schedule(20, count);
+
+  for (int i = 0; i < 5000 && nb_executed < 201; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+  service.stop();
+  driver.join();
+
+  EXPECT_EQ(201U, nb_executed);
+  EXPECT_FALSE(foreign_thread);
+}
+
+TEST(IoService, BurstOfTasksWhileNotDrivenDoesNotBlockTheSubmitter) {
+  io_service service(io_service::run_mode::caller_driven);
+
+  //! more submissions than the notifier can buffer: the driving thread is notified once until it wakes up
+  std::size_t nb_tasks = 200000;
+  std::atomic<std::size_t> nb_executed(0);
+  std::thread submitter([&] {
+    for (std::size_t i = 0; i < nb_tasks; ++i) {
+      service.get_callback_workers().add_task([&nb_executed] { ++nb_executed; });
+    }
+  });
+  submitter.join();
+
+  EXPECT_EQ(nb_tasks, service.poll_nonblocking());
+  EXPECT_EQ(nb_tasks, nb_executed);
+}
+
+TEST(IoService, CallerDrivenSocketCallbacksRunInRunOnce) {
+  echo_server server;
+
+  auto service = std::make_shared<io_service>(io_service::run_mode::caller_driven);
+  ping_pong client(service, server.port);
+  client.start(50);
+
+  auto is_done = [&client] {
+    std::lock_guard<std::mutex> lock(client.mtx);
+    return client.failed || !client.nb_remaining;
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  while (!is_done() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) { service->run_once(100); }
+  EXPECT_TRUE(client.wait_for_completion(0));
+
+  //! removal completes on the next run
+  client.client.disconnect();
+  EXPECT_EQ(0U, service->poll_nonblocking());
+}
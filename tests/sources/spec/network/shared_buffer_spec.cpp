@@ -0,0 +1,182 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/shared_buffer.hpp>
+#include <tacopie/network/tcp_client.hpp>
+#include <tacopie/network/tcp_server.hpp>
+#include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tacopie;
+
+TEST(SharedBuffer, NullBuffer) {
+  shared_buffer buffer;
+
+  EXPECT_FALSE(buffer);
+  EXPECT_EQ(0u, buffer.size());
+  EXPECT_EQ(0u, buffer.nb_slices());
+  EXPECT_EQ(0u, buffer.use_count());
+}
+
+TEST(SharedBuffer, Slices) {
+  shared_buffer single(std::string("hello"));
+  EXPECT_TRUE(single);
+  EXPECT_EQ(5u, single.size());
+  ASSERT_EQ(1u, single.nb_slices());
+  EXPECT_EQ("hello", std::string(single.get_slice(0).begin(), single.get_slice(0).end()));
+
+  std::vector<std::vector<char>> slices = {{'h', 'e', 'a', 'd'}, {}, {'b', 'o', 'd', 'y', '!'}};
+  shared_buffer chain(std::move(slices));
+  EXPECT_EQ(9u, chain.size());
+  ASSERT_EQ(3u, chain.nb_slices());
+  EXPECT_EQ(0u, chain.get_slice(1).size());
+  EXPECT_EQ('!', chain.get_slice(2).back());
+}
+
+TEST(SharedBuffer, CopiesShareTheBytes) {
+  std::vector<char> bytes(1024, 'x');
+  const char* data = bytes.data();
+
+  //! moved in: no copy of the bytes, even when built
+  shared_buffer buffer(std::move(bytes));
+  EXPECT_EQ(data, buffer.get_slice(0).data());
+  EXPECT_EQ(1u, buffer.use_count());
+
+  {
+    std::vector<shared_buffer> copies(10, buffer);
+    EXPECT_EQ(11u, buffer.use_count());
+
+    for (const auto& copy : copies) { EXPECT_EQ(data, copy.get_slice(0).data()); }
+  }
+
+  EXPECT_EQ(1u, buffer.use_count());
+
+  shared_buffer assigned;
+  assigned = buffer;
+  EXPECT_EQ(2u, buffer.use_count());
+
+  assigned = shared_buffer();
+  EXPECT_EQ(1u, buffer.use_count());
+}
+
+TEST(SharedBuffer, FanOutHoldsTheBufferUntilWritten) {
+  const std::size_t nb_peers = 4;
+
+  std::vector<std::shared_ptr<tcp_client>> clients;
+  std::mutex clients_mtx;
+
+  //! server keeping every connection, on the first free port from 36880
+  tcp_server server;
+  std::uint32_t port = 36880;
+  for (;; ++port) {
+    try {
+      server.start("127.0.0.1", port, [&](const std::shared_ptr<tcp_client>& client) {
+        std::lock_guard<std::mutex> lock(clients_mtx);
+        clients.push_back(client);
+        return true;
+      });
+      break;
+    }
+    catch (const tacopie_error&) {
+      if (port == 36980) { throw; }
+    }
+  }
+
+  std::vector<std::unique_ptr<tcp_socket>> peers;
+  for (std::size_t i = 0; i < nb_peers; ++i) {
+    peers.emplace_back(new tcp_socket);
+    peers.back()->connect("127.0.0.1", port);
+  }
+
+  for (int i = 0; i < 5000; ++i) {
+    {
+      std::lock_guard<std::mutex> lock(clients_mtx);
+      if (clients.size() == nb_peers) { break; }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  //! larger than the socket buffers: the writes stay pending as long as the peers do not read
+  std::size_t size = 32 * 1024 * 1024;
+  shared_buffer buffer{std::vector<char>(size, 'x')};
+  std::atomic<std::size_t> nb_written(0);
+
+  auto on_written = [&](tcp_client::write_result& result) {
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(size, result.size);
+    ++nb_written;
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(clients_mtx);
+    ASSERT_EQ(nb_peers, clients.size());
+
+    for (auto& client : clients) { client->async_write({buffer, on_written}); }
+  }
+
+  //! one reference per pending write, the bytes are not copied
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(0u, nb_written.load());
+  EXPECT_EQ(nb_peers + 1, buffer.use_count());
+
+  //! each peer receives the whole buffer
+  std::vector<std::thread> readers;
+  std::atomic<std::size_t> nb_received(0);
+
+  for (auto& peer : peers) {
+    tcp_socket* socket = peer.get();
+
+    readers.emplace_back([socket, size, &nb_received] {
+      std::size_t received = 0;
+
+      while (received < size) {
+        auto bytes = socket->recv(size - received);
+        if (bytes.empty()) { break; }
+        received += bytes.size();
+      }
+
+      nb_received += received;
+    });
+  }
+
+  for (auto& reader : readers) { reader.join(); }
+  EXPECT_EQ(nb_peers * size, nb_received.load());
+
+  //! released by each client once written, before its completion callback runs
+  for (int i = 0; i < 5000 && nb_written < nb_peers; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  EXPECT_EQ(nb_peers, nb_written.load());
+  EXPECT_EQ(1u, buffer.use_count());
+
+  for (auto& peer : peers) { peer->close(); }
+  server.stop(true);
+}
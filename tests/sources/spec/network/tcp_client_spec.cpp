@@ -0,0 +1,379 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/tcp_client.hpp>
+#include <tacopie/network/tcp_server.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <vector>
+
+using namespace tacopie;
+
+namespace {
+
+//!
+//! start a server accepting (and keeping) every connection, on the first free port from 36480
+//!
+std::uint32_t
+start_server(tcp_server& server) {
+  for (std::uint32_t port = 36480;; ++port) {
+    try {
+      server.start("127.0.0.1", port, [](const std::shared_ptr<tcp_client>&) { return false; });
+      return port;
+    }
+    catch (const tacopie_error&) {
+      if (port == 36580) { throw; }
+    }
+  }
+}
+
+//!
+//! start a server handing every connection to on_accept, on the first free port from 36480
+//!
+std::uint32_t
+start_server(tcp_server& server, const tcp_server::on_new_connection_callback_t& on_accept) {
+  for (std::uint32_t port = 36480;; ++port) {
+    try {
+      server.start("127.0.0.1", port, on_accept);
+      return port;
+    }
+    catch (const tacopie_error&) {
+      if (port == 36580) { throw; }
+    }
+  }
+}
+
+//!
+//! enable zero-copy writes, false if not supported by the platform
+//!
+bool
+enable_zerocopy(tcp_client& client, std::size_t threshold) {
+  try {
+    client.set_zerocopy_threshold(threshold);
+    return true;
+  }
+  catch (const tacopie_error&) {
+    return false;
+  }
+}
+
+} // namespace
+
+TEST(TcpClient, DisconnectFailsOnlyTheRequestsAskingForIt) {
+  tcp_server server;
+  std::uint32_t port = start_server(server);
+
+  tcp_client client;
+  client.connect("127.0.0.1", port);
+
+  std::vector<int> completed;
+  for (int i = 0; i < 4; ++i) {
+    auto on_read = [&completed, i](tcp_client::read_result& result) {
+      EXPECT_FALSE(result.success);
+      completed.push_back(i);
+    };
+
+    if (i % 2) { client.async_read({1024, on_read}, tcp_client::complete_on_disconnect_t{}); }
+    else { client.async_read({1024, on_read}); }
+  }
+
+  auto on_written = [&completed](tcp_client::write_result& result) {
+    EXPECT_FALSE(result.success);
+    completed.push_back(4);
+  };
+
+  //! larger than the socket buffers: still pending when disconnecting
+  client.async_write({std::vector<char>(64 * 1024 * 1024, 'a'), on_written}, tcp_client::complete_on_disconnect_t{});
+
+  client.disconnect(true);
+
+  //! completed by disconnect itself, in order, the other callbacks are dropped
+  EXPECT_EQ(std::vector<int>({1, 3, 4}), completed);
+
+  server.stop(true);
+}
+
+TEST(TcpClient, DestructorCallsNoCallback) {
+  tcp_server server;
+  std::uint32_t port = start_server(server);
+
+  std::atomic<int> nb_called(0);
+  auto on_read = [&nb_called](tcp_client::read_result&) { ++nb_called; };
+
+  tacopie::utils::future<tcp_client::read_result> result;
+  {
+    tcp_client client;
+    client.connect("127.0.0.1", port);
+
+    client.async_read({1024, on_read});
+    client.async_read({1024, on_read}, tcp_client::complete_on_disconnect_t{});
+    result = client.async_read(1024);
+  }
+
+  //! no user code runs from the destructor, the futures are broken
+  EXPECT_EQ(0, nb_called);
+  EXPECT_THROW(result.get(), tacopie_error);
+
+  server.stop(true);
+}
+
+TEST(TcpClient, DisconnectBreaksPendingFutures) {
+  tcp_server server;
+  std::uint32_t port = start_server(server);
+
+  tcp_client client;
+  client.connect("127.0.0.1", port);
+
+  auto result = client.async_read(1024);
+  client.disconnect(true);
+
+  EXPECT_THROW(result.get(), tacopie_error);
+
+  server.stop(true);
+}
+
+TEST(TcpClient, DisconnectCancelsPendingConnect) {
+  tcp_client client;
+  std::promise<bool> connected;
+
+  //! non routable address: the connection stays pending (or fails right away, depending on the network)
+  try {
+    client.async_connect("10.255.255.1", 9, [&connected](bool success) { connected.set_value(success); }, tcp_client::complete_on_disconnect_t{});
+  }
+  catch (const tacopie_error&) {
+    return;
+  }
+
+  client.disconnect(true);
+
+  auto future = connected.get_future();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+  EXPECT_FALSE(future.get());
+}
+
+TEST(TcpClient, DisconnectWhileReadInFlight) {
+  //! the peer streams data: the client is reading on the io service worker when disconnect is called from this thread
+  std::function<void(const std::shared_ptr<tcp_client>&)> stream = [&](const std::shared_ptr<tcp_client>& client) {
+    std::weak_ptr<tcp_client> weak_client = client;
+
+    auto on_written = [&, weak_client](tcp_client::write_result& result) {
+      auto client = weak_client.lock();
+
+      try {
+        if (client && result.success) { stream(client); }
+      }
+      catch (const tacopie_error&) {
+        //! disconnected meanwhile
+      }
+    };
+
+    client->async_write({std::vector<char>(64 * 1024, 'x'), on_written});
+  };
+
+  tcp_server server;
+  std::uint32_t port = start_server(server, [&](const std::shared_ptr<tcp_client>& client) {
+    stream(client);
+    return false;
+  });
+
+  for (int i = 0; i < 50; ++i) {
+    std::atomic<int> nb_issued(0);
+    std::atomic<int> nb_completed(0);
+    std::function<void(tcp_client::read_result&)> on_read;
+
+    //! one io service per round, destroyed before the callback: its workers are joined once done with the round
+    auto service = std::make_shared<io_service>();
+    tcp_client client(service);
+    client.connect("127.0.0.1", port);
+
+    auto read = [&] {
+      try {
+        ++nb_issued;
+        client.async_read({4 * 1024 * 1024, on_read}, tcp_client::complete_on_disconnect_t{});
+      }
+      catch (const tacopie_error&) {
+        //! disconnected meanwhile
+        --nb_issued;
+      }
+    };
+
+    //! counted last: the client is not used anymore once every request has completed
+    on_read = [&](tcp_client::read_result& result) {
+      if (result.success) { read(); }
+      ++nb_completed;
+    };
+
+    read();
+    read();
+    std::this_thread::sleep_for(std::chrono::milliseconds(i % 5));
+
+    //! not waiting for the removal: the socket is closed while the worker may still be in process_read
+    client.disconnect();
+    EXPECT_FALSE(client.is_connected());
+
+    //! every request completes exactly once, and none is issued anymore
+    for (int j = 0; j < 5000 && nb_completed != nb_issued; ++j) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+    EXPECT_EQ(nb_issued.load(), nb_completed.load());
+  }
+
+  server.stop(true);
+}
+
+TEST(TcpClient, ClientsReleasingEachOtherFromCallbacksDoNotDeadlock) {
+  std::vector<std::shared_ptr<tcp_client>> peers;
+  std::mutex peers_mtx;
+
+  tcp_server server;
+  std::uint32_t port = start_server(server, [&](const std::shared_ptr<tcp_client>& client) {
+    std::lock_guard<std::mutex> lock(peers_mtx);
+    peers.push_back(client);
+    return true;
+  });
+
+  //! two workers: both callbacks run at the same time, on different threads
+  auto service = std::make_shared<io_service>();
+  service->set_nb_workers(2);
+
+  auto first  = std::make_shared<tcp_client>(service);
+  auto second = std::make_shared<tcp_client>(service);
+  first->connect("127.0.0.1", port);
+  second->connect("127.0.0.1", port);
+
+  //! each callback waits for the other one, then releases the other client
+  std::mutex mtx;
+  std::condition_variable cv;
+  int nb_arrived  = 0;
+  int nb_released = 0;
+
+  auto release = [&](std::shared_ptr<tcp_client>& other) {
+    std::unique_lock<std::mutex> lock(mtx);
+    ++nb_arrived;
+    cv.notify_all();
+    cv.wait_for(lock, std::chrono::seconds(2), [&] { return nb_arrived == 2; });
+
+    std::shared_ptr<tcp_client> released = std::move(other);
+    lock.unlock();
+    released.reset();
+
+    lock.lock();
+    ++nb_released;
+    cv.notify_all();
+  };
+
+  first->async_read({1, [&](tcp_client::read_result&) { release(second); }});
+  second->async_read({1, [&](tcp_client::read_result&) { release(first); }});
+
+  {
+    std::unique_lock<std::mutex> lock(peers_mtx);
+    while (peers.size() < 2) {
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      lock.lock();
+    }
+    for (auto& peer : peers) { peer->async_write({std::vector<char>(1, 'x'), nullptr}); }
+  }
+
+  std::unique_lock<std::mutex> lock(mtx);
+  EXPECT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return nb_released == 2; }));
+  lock.unlock();
+
+  for (auto& peer : peers) { peer->disconnect(true); }
+  server.stop(true);
+}
+
+TEST(TcpClient, ZerocopyWriteLargerThanTheSendBufferIsEntirelySent) {
+  std::size_t size = 16 * 1024 * 1024;
+  std::promise<std::vector<char>> received;
+  std::shared_ptr<tcp_client> peer;
+  std::vector<char> data;
+
+  //! the peer reads everything before completing
+  std::function<void(tcp_client::read_result&)> on_read = [&](tcp_client::read_result& result) {
+    if (!result.success) { return; }
+    data.insert(data.end(), result.buffer.begin(), result.buffer.end());
+    if (data.size() == size) { return received.set_value(data); }
+    peer->async_read({size - data.size(), on_read});
+  };
+
+  tcp_server server;
+  std::uint32_t port = start_server(server, [&](const std::shared_ptr<tcp_client>& client) {
+    peer = client;
+    peer->async_read({size, on_read});
+    return true;
+  });
+
+  tcp_client client;
+  client.connect("127.0.0.1", port);
+  if (!enable_zerocopy(client, 1024)) { return server.stop(true); }
+
+  std::vector<char> buffer(size);
+  for (std::size_t i = 0; i < size; ++i) { buffer[i] = static_cast<char>(i % 251); }
+
+  auto written = client.async_write(std::vector<char>(buffer));
+  EXPECT_EQ(size, written.get().size);
+
+  auto future = received.get_future();
+  ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(10)));
+  EXPECT_TRUE(future.get() == buffer);
+
+  client.disconnect(true);
+  peer->disconnect(true);
+  server.stop(true);
+}
+
+TEST(TcpClient, ZerocopyBuffersHeldWithUnreadDataDoNotSpin) {
+  //! the peer never reads, and sends a byte which is never read either
+  tcp_server server;
+  std::uint32_t port = start_server(server, [](const std::shared_ptr<tcp_client>& client) {
+    client->async_write({std::vector<char>(1, 'x'), nullptr});
+    return false;
+  });
+
+  tcp_client client;
+  client.connect("127.0.0.1", port);
+  if (!enable_zerocopy(client, 1024)) { return server.stop(true); }
+
+  //! more than the socket buffers hold: part of it stays in the send queue, not released by the kernel
+  client.async_write({std::vector<char>(16 * 1024 * 1024, 'a'), nullptr});
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  //! the workers are idle, waiting for write availability
+  std::clock_t start = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  double cpu_secs = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+
+  EXPECT_LT(cpu_secs, 0.1);
+
+  client.disconnect(true);
+  server.stop(true);
+}
@@ -0,0 +1,447 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/tcp_client.hpp>
+#include <tacopie/network/tcp_server.hpp>
+#include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
+using namespace tacopie;
+
+namespace {
+
+//!
+//! server keeping every connection, and a socket connected to it, on the first free port from 36680
+//!
+struct connected_server {
+  connected_server(void) {
+    for (std::uint32_t port = 36680;; ++port) {
+      try {
+        server.start("127.0.0.1", port);
+        peer.connect("127.0.0.1", port);
+        break;
+      }
+      catch (const tacopie_error&) {
+        if (port == 36780) { throw; }
+      }
+    }
+
+    while (server.get_nb_clients() == 0) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  }
+
+  ~connected_server(void) {
+    peer.close();
+    server.stop(true);
+  }
+
+  std::shared_ptr<tcp_client>
+  get_client(void) {
+    return *server.get_clients().begin();
+  }
+
+  tcp_server server;
+  tcp_socket peer;
+};
+
+//!
+//! drain progress reported to the progress handler
+//!
+struct drain_reports {
+  tcp_server::drain_progress_handler_t
+  handler(void) {
+    return [this](const tcp_server::drain_progress& progress) {
+      std::lock_guard<std::mutex> lock(mtx);
+      last = progress;
+      ++nb_reports;
+      cv.notify_all();
+    };
+  }
+
+  bool
+  wait_for_completion(std::uint32_t timeout_msecs) {
+    std::unique_lock<std::mutex> lock(mtx);
+    return cv.wait_for(lock, std::chrono::milliseconds(timeout_msecs), [this] { return nb_reports && last.nb_closed == last.nb_clients; });
+  }
+
+  tcp_server::drain_progress
+  get_last(void) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return last;
+  }
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  tcp_server::drain_progress last = {0, 0, 0, 0};
+  std::size_t nb_reports          = 0;
+};
+
+//!
+//! wait until the predicate holds, for at most timeout_msecs
+//!
+template <typename Predicate>
+bool
+wait_until(Predicate predicate, std::uint32_t timeout_msecs = 5000) {
+  for (std::uint32_t i = 0; i < timeout_msecs && !predicate(); ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+  return predicate();
+}
+
+//!
+//! \return whether the remote host closed the connection within the timeout
+//!
+bool
+is_closed_by_server(tcp_socket& socket, std::uint32_t timeout_msecs) {
+  char buffer[64];
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_msecs);
+
+  while (std::chrono::steady_clock::now() < deadline) {
+    auto io = socket.recv(buffer, sizeof(buffer), std::nothrow, true);
+
+    if (io.would_block()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    if (!io.success()) { return true; }
+  }
+
+  return false;
+}
+
+//!
+//! number of admission rejections, whatever the reason
+//!
+std::size_t
+nb_rejected(const tcp_server& server) {
+  tcp_server::admission_stats stats = server.get_admission_stats();
+
+  return stats.nb_rejected_max_connections + stats.nb_rejected_max_connections_per_host + stats.nb_rejected_accept_rate + stats.nb_rejected_fd_exhaustion;
+}
+
+} // namespace
+
+TEST(TcpServer, DrainFlushesAndWaitsForThePeerToClose) {
+  connected_server connection;
+  drain_reports reports;
+
+  //! queued before the peer reads anything, along with incoming data nobody reads
+  std::size_t size = 4 * 1024 * 1024;
+  connection.get_client()->async_write({std::vector<char>(size, 'a'), nullptr});
+  connection.peer.send({'b', 'c'}, 2);
+
+  auto start = std::chrono::steady_clock::now();
+  connection.server.drain(5000, reports.handler());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+  EXPECT_FALSE(connection.server.is_running());
+
+  //! everything written is received, then end of file: no reset
+  std::vector<char> buffer(64 * 1024);
+  std::size_t received = 0;
+
+  while (true) {
+    tcp_socket::io_result io = connection.peer.recv(buffer.data(), buffer.size(), std::nothrow);
+    if (!io.success()) {
+      EXPECT_TRUE(io.eof);
+      break;
+    }
+    received += io.size;
+  }
+  EXPECT_EQ(size, received);
+
+  //! the server side stays open until the peer closes
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(0U, reports.get_last().nb_closed);
+
+  connection.peer.send({'d'}, 1);
+  connection.peer.close();
+
+  ASSERT_TRUE(reports.wait_for_completion(2000));
+  tcp_server::drain_progress progress = reports.get_last();
+  EXPECT_EQ(1U, progress.nb_clients);
+  EXPECT_EQ(1U, progress.nb_flushed);
+  EXPECT_EQ(1U, progress.nb_closed);
+  EXPECT_EQ(0U, progress.nb_pending_write_bytes);
+}
+
+TEST(TcpServer, DrainDisconnectsClientsStillOpenAtTheDeadline) {
+  connected_server connection;
+  drain_reports reports;
+
+  //! the peer never reads: more than the socket buffers can hold stays pending
+  connection.get_client()->async_write({std::vector<char>(32 * 1024 * 1024, 'a'), nullptr});
+
+  auto start = std::chrono::steady_clock::now();
+  connection.server.drain(200, reports.handler());
+
+  ASSERT_TRUE(reports.wait_for_completion(2000));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+
+  tcp_server::drain_progress progress = reports.get_last();
+  EXPECT_EQ(1U, progress.nb_clients);
+  EXPECT_EQ(0U, progress.nb_flushed);
+  EXPECT_EQ(1U, progress.nb_closed);
+}
+
+TEST(TcpServer, StopEndsDrainInProgress) {
+  connected_server connection;
+  drain_reports reports;
+
+  connection.server.drain(60000, reports.handler());
+  EXPECT_FALSE(reports.wait_for_completion(100));
+
+  connection.server.stop();
+
+  ASSERT_TRUE(reports.wait_for_completion(2000));
+  EXPECT_EQ(1U, reports.get_last().nb_closed);
+}
+
+TEST(TcpServer, ClientsSnapshotIsRebuiltOnlyAfterAChange) {
+  connected_server connection;
+  std::uint32_t port = connection.server.get_socket().get_port();
+
+  //! no change in between: the same list is shared
+  auto before = connection.server.get_clients();
+  EXPECT_EQ(&*before.begin(), &*connection.server.get_clients().begin());
+
+  tcp_socket peer;
+  peer.connect("127.0.0.1", port);
+  ASSERT_TRUE(wait_until([&] { return connection.server.get_nb_clients() == 2; }));
+
+  //! the connection marked it stale: the next call rebuilds it, older snapshots are left untouched
+  auto after = connection.server.get_clients();
+  EXPECT_EQ(2U, after.size());
+  EXPECT_EQ(1U, before.size());
+  EXPECT_NE(&*before.begin(), &*after.begin());
+  EXPECT_EQ(&*after.begin(), &*connection.server.get_clients().begin());
+
+  //! a disconnection marks it stale as well
+  auto on_read = [](tcp_client::read_result&) {};
+  for (const auto& client : after) { client->async_read({1024, on_read}); }
+
+  peer.close();
+  ASSERT_TRUE(wait_until([&] { return connection.server.get_nb_clients() == 1; }));
+  EXPECT_EQ(1U, connection.server.get_clients().size());
+  EXPECT_EQ(2U, after.size());
+}
+
+TEST(TcpServer, AcceptRateAdmitsABurstThenTheSustainedRate) {
+  connected_server connection;
+  std::uint32_t port = connection.server.get_socket().get_port();
+
+  tcp_server::admission_options opts;
+  opts.accept_rate  = 2;
+  opts.accept_burst = 3;
+  connection.server.set_admission_options(opts);
+
+  //! the bucket starts full: the burst is admitted, the rest is closed
+  std::vector<tcp_socket> peers(6);
+  for (auto& peer : peers) { peer.connect("127.0.0.1", port); }
+
+  auto all_processed = [&] { return connection.server.get_nb_clients() + nb_rejected(connection.server) == 7; };
+  ASSERT_TRUE(wait_until(all_processed));
+  EXPECT_EQ(4U, connection.server.get_nb_clients());
+  EXPECT_EQ(3U, connection.server.get_admission_stats().nb_rejected_accept_rate);
+
+  std::size_t nb_closed = 0;
+  for (auto& peer : peers) { nb_closed += is_closed_by_server(peer, 200); }
+  EXPECT_EQ(3U, nb_closed);
+
+  //! one token is back after half a second
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+  tcp_socket late_peer;
+  late_peer.connect("127.0.0.1", port);
+
+  EXPECT_TRUE(wait_until([&] { return connection.server.get_nb_clients() == 5; }));
+  EXPECT_EQ(3U, connection.server.get_admission_stats().nb_rejected_accept_rate);
+
+  for (auto& peer : peers) { peer.close(); }
+  late_peer.close();
+}
+
+TEST(TcpServer, MaxConnectionsSlotIsReleasedWithTheClient) {
+  connected_server connection;
+  std::uint32_t port = connection.server.get_socket().get_port();
+
+  tcp_server::admission_options opts;
+  opts.max_connections = 2;
+  connection.server.set_admission_options(opts);
+
+  tcp_socket admitted;
+  admitted.connect("127.0.0.1", port);
+  ASSERT_TRUE(wait_until([&] { return connection.server.get_nb_clients() == 2; }));
+
+  tcp_socket rejected;
+  rejected.connect("127.0.0.1", port);
+  EXPECT_TRUE(is_closed_by_server(rejected, 5000));
+  EXPECT_EQ(1U, connection.server.get_admission_stats().nb_rejected_max_connections);
+
+  //! the slot is freed once the last reference to the disconnected client is gone: reading lets the server notice the disconnection
+  auto on_read = [](tcp_client::read_result&) {};
+  for (const auto& client : connection.server.get_clients()) { client->async_read({1024, on_read}); }
+
+  admitted.close();
+  ASSERT_TRUE(wait_until([&] { return connection.server.get_nb_connections() == 1; }));
+
+  tcp_socket next;
+  next.connect("127.0.0.1", port);
+  EXPECT_TRUE(wait_until([&] { return connection.server.get_nb_clients() == 2; }));
+  EXPECT_EQ(1U, connection.server.get_admission_stats().nb_rejected_max_connections);
+
+  rejected.close();
+  next.close();
+}
+
+TEST(TcpServer, MaxConnectionsPerHost) {
+  connected_server connection;
+  std::uint32_t port = connection.server.get_socket().get_port();
+
+  tcp_server::admission_options opts;
+  opts.max_connections_per_host = 1;
+  connection.server.set_admission_options(opts);
+
+  //! the connected peer already uses the only slot of 127.0.0.1
+  tcp_socket peer;
+  peer.connect("127.0.0.1", port);
+
+  EXPECT_TRUE(is_closed_by_server(peer, 5000));
+  EXPECT_EQ(1U, connection.server.get_admission_stats().nb_rejected_max_connections_per_host);
+  EXPECT_EQ(1U, connection.server.get_nb_clients());
+
+  peer.close();
+}
+
+#ifndef _WIN32
+TEST(TcpServer, AcceptSurvivesFileDescriptorExhaustion) {
+  connected_server connection;
+  std::uint32_t port = connection.server.get_socket().get_port();
+
+  //! raw socket, created beforehand and connected without any name resolution: no descriptor is left once the limit is reached
+  int peer = ::socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_NE(-1, peer);
+
+  struct timeval recv_timeout = {5, 0};
+  ::setsockopt(peer, SOL_SOCKET, SO_RCVTIMEO, &recv_timeout, sizeof(recv_timeout));
+
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  struct rlimit initial_limit;
+  ASSERT_EQ(0, ::getrlimit(RLIMIT_NOFILE, &initial_limit));
+
+  std::vector<int> fillers;
+  int lowest_free_fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+  ASSERT_NE(-1, lowest_free_fd);
+  fillers.push_back(lowest_free_fd);
+
+  struct rlimit lowered_limit = initial_limit;
+  lowered_limit.rlim_cur      = lowest_free_fd + 16;
+  ASSERT_EQ(0, ::setrlimit(RLIMIT_NOFILE, &lowered_limit));
+
+  for (int fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC); fd != -1; fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC)) { fillers.push_back(fd); }
+  EXPECT_EQ(EMFILE, errno);
+
+  //! the reserve descriptor lets the server accept and close the connection instead of spinning on it
+  ASSERT_EQ(0, ::connect(peer, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+  EXPECT_TRUE(wait_until([&] { return connection.server.get_admission_stats().nb_rejected_fd_exhaustion >= 1; }));
+
+  char byte;
+  EXPECT_GE(0, ::recv(peer, &byte, 1, 0));
+  EXPECT_TRUE(connection.server.is_running());
+
+  for (int fd : fillers) { ::close(fd); }
+  ASSERT_EQ(0, ::setrlimit(RLIMIT_NOFILE, &initial_limit));
+
+  tcp_socket next;
+  next.connect("127.0.0.1", port);
+  EXPECT_TRUE(wait_until([&] { return connection.server.get_nb_clients() == 2; }));
+
+  ::close(peer);
+  next.close();
+}
+
+TEST(TcpServer, HandOverTimesOutAndRestoresTheServerSocket) {
+  connected_server connection;
+  std::string path = "/tmp/tacopie_hand_over_spec_" + std::to_string(::getpid()) + ".sock";
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_THROW(connection.server.hand_over(path, 100), tacopie_error);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(5000));
+
+  EXPECT_TRUE(connection.server.is_running());
+  EXPECT_EQ(0, ::fcntl(connection.server.get_socket().get_fd(), F_GETFL, 0) & O_NONBLOCK);
+  EXPECT_NE(0, ::access(path.c_str(), F_OK));
+}
+
+TEST(TcpServer, HandOverPassesTheServerSocket) {
+  connected_server connection;
+  std::string path = "/tmp/tacopie_hand_over_spec_" + std::to_string(::getpid()) + ".sock";
+
+  tcp_server next;
+  std::thread taking_over([&] {
+    //! the path exists once hand_over listens on it
+    for (int i = 0; i < 500 && !next.is_running(); ++i) {
+      try {
+        next.take_over(path);
+      }
+      catch (const tacopie_error&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+  });
+
+  EXPECT_NO_THROW(connection.server.hand_over(path, 5000));
+  taking_over.join();
+
+  ASSERT_TRUE(next.is_running());
+  EXPECT_EQ(connection.server.get_socket().get_port(), next.get_socket().get_port());
+  EXPECT_NE(0, ::fcntl(next.get_socket().get_fd(), F_GETFL, 0) & O_NONBLOCK);
+
+  next.stop(true);
+}
+#endif /* _WIN32 */
@@ -0,0 +1,194 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/tcp_server.hpp>
+#include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif /* _WIN32 */
+
+using namespace tacopie;
+
+namespace {
+
+//!
+//! connected socket, to a server started on the first free port from 36580
+//!
+struct connected_socket {
+  connected_socket(void) {
+    for (std::uint32_t port = 36580;; ++port) {
+      try {
+        server.start("127.0.0.1", port);
+        socket.connect("127.0.0.1", port);
+        return;
+      }
+      catch (const tacopie_error&) {
+        if (port == 36680) { throw; }
+      }
+    }
+  }
+
+  ~connected_socket(void) {
+    socket.close();
+    server.stop(true);
+  }
+
+  tcp_server server;
+  tcp_socket socket;
+};
+
+} // namespace
+
+#ifndef _WIN32
+static int
+get_int_option(const tcp_socket& socket, int level, int name) {
+  int value      = 0;
+  socklen_t size = sizeof(value);
+  EXPECT_EQ(0, ::getsockopt(socket.get_fd(), level, name, &value, &size));
+  return value;
+}
+#endif /* _WIN32 */
+
+TEST(TcpSocket, SetOptionsAppliesEachOption) {
+  connected_socket connection;
+  tcp_socket& socket = connection.socket;
+
+  tcp_socket::options opts;
+  opts.nodelay   = 1;
+  opts.keepalive = 1;
+  socket.set_options(opts);
+
+#ifndef _WIN32
+  EXPECT_NE(0, get_int_option(socket, IPPROTO_TCP, TCP_NODELAY));
+  EXPECT_NE(0, get_int_option(socket, SOL_SOCKET, SO_KEEPALIVE));
+#endif /* _WIN32 */
+}
+
+#if defined(__linux__)
+TEST(TcpSocket, SetOptionsFailureDoesNotStopTheNextOptions) {
+  connected_socket connection;
+  tcp_socket& socket = connection.socket;
+
+  tcp_socket::options opts;
+  //! out of the range accepted by linux (at most 127 probes)
+  opts.keepalive_count    = 1000;
+  opts.nodelay            = 1;
+  opts.user_timeout_msecs = 1234;
+
+  try {
+    socket.set_options(opts);
+    FAIL() << "set_options should report the failed option";
+  }
+  catch (const tacopie_error& e) {
+    EXPECT_NE(std::string::npos, std::string(e.what()).find("TCP_KEEPCNT"));
+    EXPECT_EQ(std::string::npos, std::string(e.what()).find("TCP_USER_TIMEOUT"));
+  }
+
+  //! applied anyway, before and after the failing option
+  EXPECT_NE(0, get_int_option(socket, IPPROTO_TCP, TCP_NODELAY));
+  EXPECT_EQ(1234, get_int_option(socket, IPPROTO_TCP, TCP_USER_TIMEOUT));
+}
+#endif /* __linux__ */
+
+#ifndef _WIN32
+TEST(TcpSocket, NonBlockingSendfileReportsPartialProgress) {
+  connected_socket connection;
+  tcp_socket& socket = connection.socket;
+
+  //! far more than the socket buffers can hold: the server never reads
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(nullptr, file);
+  std::vector<char> chunk(1024 * 1024, 'x');
+  for (int i = 0; i < 64; ++i) { ASSERT_EQ(chunk.size(), std::fwrite(chunk.data(), 1, chunk.size(), file)); }
+  ASSERT_EQ(0, std::fflush(file));
+
+  std::size_t size            = 64 * chunk.size();
+  tcp_socket::io_result first = socket.sendfile(fileno(file), 0, size, std::nothrow, true);
+
+  EXPECT_TRUE(first.success());
+  EXPECT_GT(first.size, 0U);
+  EXPECT_LT(first.size, size);
+
+  //! the socket is full: no progress, without waiting
+  tcp_socket::io_result second = socket.sendfile(fileno(file), first.size, size - first.size, std::nothrow, true);
+  EXPECT_TRUE(second.would_block());
+  EXPECT_EQ(0U, second.size);
+
+  //! the socket is left in blocking mode
+  EXPECT_EQ(0, ::fcntl(socket.get_fd(), F_GETFL, 0) & O_NONBLOCK);
+
+  std::fclose(file);
+}
+#endif /* _WIN32 */
+
+#ifndef _WIN32
+TEST(TcpSocket, RecvSocketRejectsOversizedHost) {
+  int fds[2];
+  ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  tcp_socket channel(fds[0], "", 0, tcp_socket::type::CLIENT);
+
+  //! server socket description claiming a 4GiB host, sent with a descriptor
+  std::uint32_t header[3] = {8080, static_cast<std::uint32_t>(tcp_socket::type::SERVER), 0xFFFFFFFF};
+
+  struct iovec iov;
+  iov.iov_base = header;
+  iov.iov_len  = sizeof(header);
+
+  char control[CMSG_SPACE(sizeof(int))];
+  std::memset(control, 0, sizeof(control));
+
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control;
+  msg.msg_controllen = sizeof(control);
+
+  struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level     = SOL_SOCKET;
+  cm->cmsg_type      = SCM_RIGHTS;
+  cm->cmsg_len       = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cm), &fds[1], sizeof(int));
+
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(header)), ::sendmsg(fds[1], &msg, 0));
+
+  //! rejected right away, without waiting for the host bytes (the sender stays connected)
+  EXPECT_THROW(channel.recv_socket(), tacopie_error);
+
+  channel.close();
+  ::close(fds[1]);
+}
+#endif /* _WIN32 */
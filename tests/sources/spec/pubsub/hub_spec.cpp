@@ -0,0 +1,295 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/io_service.hpp>
+#include <tacopie/network/tcp_socket.hpp>
+#include <tacopie/pubsub/hub.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tacopie;
+
+namespace {
+
+//!
+//! hub started on the first free port from 36980
+//!
+struct running_hub {
+  running_hub(void)
+  : running_hub(get_default_io_service()) {}
+
+  explicit running_hub(const std::shared_ptr<io_service>& service)
+  : hub(service) {
+    for (port = 36980;; ++port) {
+      try {
+        hub.start("127.0.0.1", port);
+        break;
+      }
+      catch (const tacopie_error&) {
+        if (port == 37080) { throw; }
+      }
+    }
+  }
+
+  ~running_hub(void) {
+    hub.stop(true);
+  }
+
+  pubsub::hub hub;
+  std::uint32_t port;
+};
+
+//!
+//! subscriber connection, driven from the test thread
+//!
+struct subscriber {
+  explicit subscriber(std::uint32_t port) {
+    socket.connect("127.0.0.1", port);
+  }
+
+  void
+  send(const std::string& commands) {
+    socket.send(std::vector<char>(commands.begin(), commands.end()), commands.size());
+  }
+
+  //!
+  //! \return the next size bytes, or what has been received when the timeout expires (empty on eof)
+  //!
+  std::string
+  read(std::size_t size, std::uint32_t timeout_msecs = 5000) {
+    std::string bytes;
+    std::vector<char> buffer(size);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_msecs);
+
+    while (bytes.size() < size && std::chrono::steady_clock::now() < deadline) {
+      auto io = socket.recv(buffer.data(), size - bytes.size(), std::nothrow, true);
+
+      if (io.would_block()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+
+      if (!io.success() || io.eof) { break; }
+
+      bytes.append(buffer.data(), io.size);
+    }
+
+    return bytes;
+  }
+
+  tcp_socket socket;
+};
+
+//!
+//! \return whether the condition became true before the timeout
+//!
+bool
+wait_until(const std::function<bool(void)>& condition, std::uint32_t timeout_msecs = 5000) {
+  for (std::uint32_t i = 0; i < timeout_msecs && !condition(); ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+  return condition();
+}
+
+} // namespace
+
+TEST(PubsubHub, PublishToTheSubscribersOfATopic) {
+  running_hub running;
+  auto& hub = running.hub;
+
+  subscriber first(running.port);
+  subscriber second(running.port);
+  subscriber other(running.port);
+
+  first.send("SUBSCRIBE news\n");
+  second.send("SUBSCRIBE news\r\n");
+  other.send("SUBSCRIBE sport\n");
+
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("news") == 2 && hub.get_nb_subscribers("sport") == 1; }));
+  EXPECT_EQ(3u, hub.get_nb_subscribers());
+
+  EXPECT_EQ(2u, hub.publish("news", "hello"));
+  EXPECT_EQ(0u, hub.publish("weather", "sunny"));
+
+  std::string message = "MESSAGE news 5\r\nhello\r\n";
+  EXPECT_EQ(message, first.read(message.size()));
+  EXPECT_EQ(message, second.read(message.size()));
+
+  //! other topics are not received
+  EXPECT_EQ("", other.read(1, 100));
+
+  //! the payload is not interpreted
+  std::string payload("a\r\nb\0c", 6);
+  EXPECT_EQ(1u, hub.publish("sport", std::vector<char>(payload.begin(), payload.end())));
+
+  message = "MESSAGE sport 6\r\n" + payload + "\r\n";
+  EXPECT_EQ(message, other.read(message.size()));
+}
+
+TEST(PubsubHub, CommandsSplitAndPipelined) {
+  running_hub running;
+  auto& hub = running.hub;
+
+  subscriber sub(running.port);
+
+  //! several commands in one write, a command over several writes
+  sub.send("SUBSCRIBE a\nSUBSCRIBE b\r\nSUBS");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("a") == 1 && hub.get_nb_subscribers("b") == 1; }));
+  EXPECT_EQ(0u, hub.get_nb_subscribers("c"));
+
+  sub.send("CRIBE c\n");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("c") == 1; }));
+
+  //! subscribing twice is a no-op, invalid commands are ignored
+  sub.send("SUBSCRIBE a\nSUBSCRIBE\nPING\n\n");
+  EXPECT_EQ(1u, hub.publish("a", "1"));
+
+  std::string message = "MESSAGE a 1\r\n1\r\n";
+  EXPECT_EQ(message, sub.read(message.size()));
+  EXPECT_EQ("", sub.read(1, 100));
+}
+
+TEST(PubsubHub, Unsubscribe) {
+  running_hub running;
+  auto& hub = running.hub;
+
+  subscriber sub(running.port);
+
+  sub.send("SUBSCRIBE a\nSUBSCRIBE b\n");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("a") == 1 && hub.get_nb_subscribers("b") == 1; }));
+
+  sub.send("UNSUBSCRIBE a\nUNSUBSCRIBE unknown\n");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("a") == 0; }));
+
+  //! still connected and subscribed to the other topic
+  EXPECT_EQ(1u, hub.get_nb_subscribers());
+  EXPECT_EQ(0u, hub.publish("a", "x"));
+  EXPECT_EQ(1u, hub.publish("b", "y"));
+
+  std::string message = "MESSAGE b 1\r\ny\r\n";
+  EXPECT_EQ(message, sub.read(message.size()));
+}
+
+TEST(PubsubHub, DisconnectedSubscribersAreRemoved) {
+  running_hub running;
+  auto& hub = running.hub;
+
+  subscriber leaving(running.port);
+  subscriber staying(running.port);
+
+  leaving.send("SUBSCRIBE a\n");
+  staying.send("SUBSCRIBE a\n");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("a") == 2; }));
+
+  leaving.socket.close();
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers() == 1; }));
+
+  EXPECT_EQ(1u, hub.get_nb_subscribers("a"));
+  EXPECT_EQ(1u, hub.publish("a", "x"));
+}
+
+TEST(PubsubHub, SlowConsumersMissMessagesWithTheDropPolicy) {
+  running_hub running;
+  auto& hub = running.hub;
+
+  hub.set_slow_consumer_policy(pubsub::hub::slow_consumer_policy::drop);
+  hub.set_max_pending_bytes(1024 * 1024);
+
+  subscriber sub(running.port);
+  sub.send("SUBSCRIBE a\n");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("a") == 1; }));
+
+  //! the subscriber does not read: once the socket buffers are full, the pending bytes reach the limit
+  std::size_t nb_queued = 0;
+  for (int i = 0; i < 200; ++i) { nb_queued += hub.publish("a", std::vector<char>(256 * 1024, 'x')); }
+
+  EXPECT_LT(nb_queued, 200u);
+  EXPECT_EQ(200u - nb_queued, hub.get_nb_dropped_messages());
+  EXPECT_EQ(0u, hub.get_nb_evictions());
+
+  //! still subscribed
+  EXPECT_EQ(1u, hub.get_nb_subscribers("a"));
+}
+
+TEST(PubsubHub, SlowConsumersAreEvictedWithTheEvictPolicy) {
+  running_hub running;
+  auto& hub = running.hub;
+
+  std::atomic<int> nb_evicted(0);
+  hub.set_on_eviction_handler([&](const std::shared_ptr<tcp_client>& client) {
+    EXPECT_FALSE(client->is_connected());
+    ++nb_evicted;
+  });
+  hub.set_max_pending_bytes(1024 * 1024);
+
+  subscriber slow(running.port);
+  subscriber idle(running.port);
+  slow.send("SUBSCRIBE a\n");
+  idle.send("SUBSCRIBE b\n");
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("a") == 1 && hub.get_nb_subscribers("b") == 1; }));
+
+  for (int i = 0; i < 200 && hub.get_nb_evictions() == 0; ++i) { hub.publish("a", std::vector<char>(256 * 1024, 'x')); }
+
+  EXPECT_EQ(1u, hub.get_nb_evictions());
+  EXPECT_EQ(1, nb_evicted);
+  EXPECT_EQ(0u, hub.get_nb_subscribers("a"));
+  EXPECT_EQ(0u, hub.get_nb_dropped_messages());
+
+  //! the other subscribers are not affected
+  EXPECT_EQ(1u, hub.get_nb_subscribers());
+  EXPECT_EQ(1u, hub.publish("b", "x"));
+}
+
+TEST(PubsubHub, RunsOnTheInjectedIoService) {
+  auto service = std::make_shared<io_service>(io_service::run_mode::caller_driven);
+  running_hub running(service);
+  auto& hub = running.hub;
+
+  subscriber sub(running.port);
+  sub.send("SUBSCRIBE news\n");
+
+  //! nothing is processed until the io_service is driven
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(0u, hub.get_nb_subscribers());
+
+  std::thread driver([&service] { service->run(); });
+
+  ASSERT_TRUE(wait_until([&] { return hub.get_nb_subscribers("news") == 1; }));
+  EXPECT_EQ(1u, hub.publish("news", "hello"));
+
+  std::string message = "MESSAGE news 5\r\nhello\r\n";
+  EXPECT_EQ(message, sub.read(message.size()));
+
+  //! stopped while the io_service is still driven: stop waits for the removal of the sockets
+  hub.stop(true);
+  service->stop();
+  driver.join();
+}
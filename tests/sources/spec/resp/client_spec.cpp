@@ -0,0 +1,195 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/network/tcp_server.hpp>
+#include <tacopie/resp/client.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tacopie;
+
+namespace {
+
+//!
+//! in-process fake redis: replies to every command with its last argument as a bulk string
+//!
+class fake_redis {
+public:
+  fake_redis(void)
+  : m_port(36380)
+  , m_nb_reads(0) {
+    //! the server closes connections first: its previous ports may still be in TIME_WAIT, pick the next free one
+    for (;; ++m_port) {
+      try {
+        m_server.start("127.0.0.1", m_port, [this](const std::shared_ptr<tcp_client>& client) {
+          auto connection = std::make_shared<fake_connection>(client);
+
+          {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_connections.push_back(connection);
+          }
+
+          read(connection);
+          return false;
+        });
+        return;
+      }
+      catch (const tacopie_error&) {
+        if (m_port == 36480) { throw; }
+      }
+    }
+  }
+
+  ~fake_redis(void) {
+    m_server.stop(true, true);
+  }
+
+  std::uint32_t
+  get_port(void) const {
+    return m_port;
+  }
+
+  std::size_t
+  get_nb_reads(void) const {
+    return m_nb_reads;
+  }
+
+  void
+  disconnect_all(void) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    for (const auto& connection : m_connections) { connection->client->disconnect(); }
+  }
+
+private:
+  struct fake_connection {
+    explicit fake_connection(const std::shared_ptr<tcp_client>& client)
+    : client(client) {}
+
+    std::shared_ptr<tcp_client> client;
+    resp::parser parser;
+  };
+
+  void
+  read(const std::shared_ptr<fake_connection>& connection) {
+    std::weak_ptr<fake_connection> weak = connection;
+
+    connection->client->async_read({4096, [this, weak](tcp_client::read_result& result) {
+                                      auto connection = weak.lock();
+                                      if (!connection || !result.success) { return; }
+
+                                      ++m_nb_reads;
+                                      connection->parser.feed(std::move(result.buffer));
+
+                                      std::string replies;
+                                      resp::reply command;
+                                      while (connection->parser.get_reply(command)) {
+                                        std::string argument = command.get_elements().back().as_string();
+                                        replies += "$" + std::to_string(argument.size()) + "\r\n" + argument + "\r\n";
+                                      }
+
+                                      if (!replies.empty()) { connection->client->async_write({std::vector<char>(replies.begin(), replies.end()), nullptr}); }
+
+                                      read(connection);
+                                    }});
+  }
+
+  tcp_server m_server;
+  std::uint32_t m_port;
+  std::mutex m_mtx;
+  std::vector<std::shared_ptr<fake_connection>> m_connections;
+  std::atomic<std::size_t> m_nb_reads;
+};
+
+} // namespace
+
+TEST(RespClient, PipelinedRepliesInOrder) {
+  fake_redis redis;
+
+  resp::client client;
+  client.connect("127.0.0.1", redis.get_port());
+
+  const std::size_t nb_commands = 10000;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::size_t nb_replies = 0;
+  bool in_order          = true;
+
+  for (std::size_t i = 0; i < nb_commands; ++i) {
+    client.send({"ECHO", std::to_string(i)}, [&, i](resp::reply& reply) {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      in_order = in_order && reply.as_string() == std::to_string(i) && nb_replies == i;
+      if (++nb_replies == nb_commands) { cv.notify_all(); }
+    });
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&] { return nb_replies == nb_commands; }));
+  }
+
+  EXPECT_TRUE(in_order);
+
+  //! commands sent while a write is in flight are batched: far fewer reads than commands on the server side
+  EXPECT_LT(redis.get_nb_reads(), nb_commands);
+
+  client.disconnect(true);
+}
+
+TEST(RespClient, DisconnectionHandler) {
+  fake_redis redis;
+
+  resp::client client;
+  client.connect("127.0.0.1", redis.get_port());
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool disconnected = false;
+
+  client.set_on_disconnection_handler([&] {
+    std::lock_guard<std::mutex> lock(mtx);
+    disconnected = true;
+    cv.notify_all();
+  });
+
+  std::atomic<bool> replied(false);
+  client.send({"PING", "pong"}, [&](resp::reply& reply) { replied = reply.as_string() == "pong"; });
+
+  for (int i = 0; i < 1000 && !replied; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }
+  EXPECT_TRUE(replied);
+
+  redis.disconnect_all();
+
+  std::unique_lock<std::mutex> lock(mtx);
+  EXPECT_TRUE(cv.wait_for(lock, std::chrono::seconds(5), [&] { return disconnected; }));
+  EXPECT_FALSE(client.is_connected());
+}
@@ -0,0 +1,186 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/resp/parser.hpp>
+#include <tacopie/utils/error.hpp>
+
+#include <limits>
+#include <string>
+
+using namespace tacopie;
+
+static void
+feed(resp::parser& parser, const std::string& bytes) {
+  parser.feed(bytes.data(), bytes.size());
+}
+
+TEST(RespParser, SimpleTypes) {
+  resp::parser parser;
+  resp::reply reply;
+
+  feed(parser, "+OK\r\n-ERR failure\r\n:-42\r\n$5\r\nhello\r\n$-1\r\n*-1\r\n*0\r\n");
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(resp::reply::type::simple_string, reply.get_type());
+  EXPECT_EQ("OK", reply.as_string());
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_TRUE(reply.is_error());
+  EXPECT_EQ("ERR failure", reply.as_string());
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(-42, reply.as_integer());
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(resp::reply::type::bulk_string, reply.get_type());
+  EXPECT_EQ("hello", reply.as_string());
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_TRUE(reply.is_null());
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_TRUE(reply.is_null());
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(resp::reply::type::array, reply.get_type());
+  EXPECT_TRUE(reply.get_elements().empty());
+
+  EXPECT_FALSE(parser.get_reply(reply));
+}
+
+TEST(RespParser, NestedArrayFedByteByByte) {
+  std::string bytes = "*3\r\n$3\r\nfoo\r\n*2\r\n:1\r\n+bar\r\n$-1\r\n+NEXT\r\n";
+  resp::parser parser;
+  resp::reply reply;
+
+  //! the array is complete with its last byte only
+  std::size_t array_size = bytes.find("+NEXT");
+  for (std::size_t i = 0; i < array_size; ++i) {
+    feed(parser, bytes.substr(i, 1));
+    ASSERT_EQ(i + 1 == array_size, parser.get_reply(reply));
+  }
+
+  ASSERT_EQ(3U, reply.get_elements().size());
+  EXPECT_EQ("foo", reply.get_elements()[0].as_string());
+  ASSERT_EQ(2U, reply.get_elements()[1].get_elements().size());
+  EXPECT_EQ(1, reply.get_elements()[1].get_elements()[0].as_integer());
+  EXPECT_EQ("bar", reply.get_elements()[1].get_elements()[1].as_string());
+  EXPECT_TRUE(reply.get_elements()[2].is_null());
+
+  feed(parser, bytes.substr(array_size));
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ("NEXT", reply.as_string());
+}
+
+TEST(RespParser, LargeArrayFedInChunks) {
+  const std::size_t nb_elements = 10000;
+  std::string bytes             = "*" + std::to_string(nb_elements) + "\r\n";
+
+  for (std::size_t i = 0; i < nb_elements; ++i) {
+    std::string value = "value" + std::to_string(i);
+    bytes += "$" + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+  }
+
+  resp::parser parser;
+  resp::reply reply;
+
+  //! the buffer of the parser is reallocated while the reply is partial: strings must still point to the right bytes
+  for (std::size_t i = 0; i < bytes.size(); i += 7) {
+    EXPECT_FALSE(parser.get_reply(reply));
+    feed(parser, bytes.substr(i, 7));
+  }
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  ASSERT_EQ(nb_elements, reply.get_elements().size());
+
+  for (std::size_t i = 0; i < nb_elements; ++i) { ASSERT_EQ("value" + std::to_string(i), reply.get_elements()[i].as_string()); }
+}
+
+TEST(RespParser, RvalueFeedTakesOwnership) {
+  std::string bytes = "$3\r\nabc\r\n";
+  std::vector<char> buffer(bytes.begin(), bytes.end());
+  const char* data = buffer.data();
+
+  resp::parser parser;
+  resp::reply reply;
+
+  parser.feed(std::move(buffer));
+
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(data + 4, reply.data());
+  EXPECT_EQ("abc", reply.as_string());
+}
+
+TEST(RespParser, IntegerBounds) {
+  resp::parser parser;
+  resp::reply reply;
+
+  feed(parser, ":9223372036854775807\r\n:-9223372036854775808\r\n");
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(std::numeric_limits<std::int64_t>::max(), reply.as_integer());
+  ASSERT_TRUE(parser.get_reply(reply));
+  EXPECT_EQ(std::numeric_limits<std::int64_t>::min(), reply.as_integer());
+
+  const char* invalid[] = {":9223372036854775808\r\n", ":-9223372036854775809\r\n", ":123456789012345678901234567890\r\n", ":\r\n", ":12a\r\n"};
+
+  for (const char* bytes : invalid) {
+    parser.reset();
+    feed(parser, bytes);
+    EXPECT_THROW(parser.get_reply(reply), tacopie_error) << bytes;
+  }
+}
+
+TEST(RespParser, RejectsOversizedCounts) {
+  const char* invalid[] = {"*99999999999999999\r\n", "*4611686018427387904\r\n", "$99999999999999999\r\n", "*1048577\r\n"};
+  resp::reply reply;
+
+  for (const char* bytes : invalid) {
+    resp::parser parser;
+    feed(parser, bytes);
+    EXPECT_THROW(parser.get_reply(reply), tacopie_error) << bytes;
+  }
+}
+
+TEST(RespParser, RejectsDeepNesting) {
+  std::string bytes;
+  for (unsigned int i = 0; i <= __TACOPIE_RESP_MAX_NESTING; ++i) { bytes += "*1\r\n"; }
+  bytes += ":1\r\n";
+
+  resp::parser parser;
+  resp::reply reply;
+
+  feed(parser, bytes);
+  EXPECT_THROW(parser.get_reply(reply), tacopie_error);
+}
+
+TEST(RespParser, RejectsInvalidStream) {
+  const char* invalid[] = {"?\r\n", "+OK\rX", "$3\r\nabcd\r\n"};
+  resp::reply reply;
+
+  for (const char* bytes : invalid) {
+    resp::parser parser;
+    feed(parser, bytes);
+    EXPECT_THROW(parser.get_reply(reply), tacopie_error) << bytes;
+  }
+}
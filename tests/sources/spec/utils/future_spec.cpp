@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/future.hpp>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+using namespace tacopie::utils;
+
+TEST(Future, GetValue) {
+  promise<int> p;
+  future<int> f = p.get_future();
+
+  EXPECT_FALSE(f.is_ready());
+  p.set_value(42);
+
+  EXPECT_TRUE(f.is_ready());
+  EXPECT_EQ(42, f.get());
+  EXPECT_FALSE(f.valid());
+}
+
+TEST(Future, BrokenPromise) {
+  future<int> f;
+
+  {
+    promise<int> p;
+    f = p.get_future();
+  }
+
+  EXPECT_THROW(f.get(), tacopie::tacopie_error);
+}
+
+TEST(Future, ThenChain) {
+  promise<int> p;
+  future<std::string> f = p.get_future().then([](int& value) { return value * 2; }).then([](int& value) { return std::to_string(value); });
+
+  p.set_value(21);
+  EXPECT_EQ("42", f.get());
+}
+
+TEST(Future, ThenMutableCallable) {
+  promise<int> p;
+  int result = 0;
+
+  //! non-const call operator: the continuation is invoked as an lvalue
+  p.get_future().then([&result](int& value) mutable { result = value; });
+  p.set_value(42);
+
+  EXPECT_EQ(42, result);
+}
+
+TEST(Future, ThenBrokenPromiseBreaksTheChain) {
+  future<int> f;
+  bool called = false;
+
+  {
+    promise<int> p;
+    f = p.get_future().then([&called](int& value) {
+      called = true;
+      return value;
+    });
+  }
+
+  EXPECT_THROW(f.get(), tacopie::tacopie_error);
+  EXPECT_FALSE(called);
+}
+
+TEST(Future, ThenAfterCompletionOnExecutor) {
+  thread_pool pool(1);
+  promise<int> p(pool);
+  future<int> f = p.get_future();
+  std::promise<std::pair<int, std::thread::id>> executed;
+
+  p.set_value(42);
+
+  //! already completed: posted to the executor instead of running on the calling thread
+  f.then([&executed](int& value) { executed.set_value({value, std::this_thread::get_id()}); });
+
+  auto result = executed.get_future().get();
+  EXPECT_EQ(42, result.first);
+  EXPECT_NE(std::this_thread::get_id(), result.second);
+}
+
+TEST(Future, ThenDroppedByStoppedExecutorReleasesState) {
+  auto guard = std::make_shared<int>(0);
+  future<int> next;
+
+  {
+    thread_pool pool(0);
+    promise<int> p(pool);
+    future<int> f = p.get_future();
+
+    p.set_value(42);
+    next = f.then([guard](int& value) { return value; });
+
+    EXPECT_EQ(2, guard.use_count());
+  }
+
+  //! the executor never ran the continuation: it is dropped, which releases its captures and breaks the chained future
+  EXPECT_EQ(1, guard.use_count());
+  EXPECT_THROW(next.get(), tacopie::tacopie_error);
+}
@@ -0,0 +1,131 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/utils/mpmc_queue.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace tacopie::utils;
+
+//!
+//! The stress tests are meant to be run on a -fsanitize=thread build as well:
+//!   cmake -DBUILD_TESTS=ON -DCMAKE_CXX_FLAGS="-fsanitize=thread -g -O1" -DCMAKE_EXE_LINKER_FLAGS=-fsanitize=thread
+//!
+
+TEST(MpmcQueue, CapacityRoundedUpToPowerOfTwo) {
+  EXPECT_EQ(2u, mpmc_queue<int>(0).capacity());
+  EXPECT_EQ(2u, mpmc_queue<int>(2).capacity());
+  EXPECT_EQ(8u, mpmc_queue<int>(5).capacity());
+  EXPECT_EQ(1024u, mpmc_queue<int>(1024).capacity());
+}
+
+TEST(MpmcQueue, FullAndEmpty) {
+  mpmc_queue<int> queue(4);
+  int value = 0;
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.try_pop(value));
+
+  for (int i = 0; i < 4; ++i) {
+    value = i;
+    EXPECT_TRUE(queue.try_push(value));
+  }
+
+  value = 4;
+  EXPECT_FALSE(queue.try_push(value));
+  EXPECT_EQ(4, value);
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(i, value);
+  }
+
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.try_pop(value));
+}
+
+TEST(MpmcQueue, MoveOnlyElements) {
+  mpmc_queue<std::unique_ptr<int>> queue(2);
+  std::unique_ptr<int> value(new int(42));
+
+  EXPECT_TRUE(queue.try_push(value));
+  EXPECT_FALSE(value);
+
+  EXPECT_TRUE(queue.try_pop(value));
+  ASSERT_TRUE(value);
+  EXPECT_EQ(42, *value);
+}
+
+TEST(MpmcQueue, StressEveryElementPoppedOnce) {
+  const std::size_t nb_producers          = 4;
+  const std::size_t nb_consumers          = 4;
+  const std::size_t nb_values_by_producer = 50000;
+  const std::size_t nb_values             = nb_producers * nb_values_by_producer;
+
+  //! small capacity: producers and consumers keep wrapping around and hitting the full and empty cases
+  mpmc_queue<std::size_t> queue(16);
+  std::unique_ptr<std::atomic<int>[]> nb_pops(new std::atomic<int>[nb_values]);
+  for (std::size_t i = 0; i < nb_values; ++i) { nb_pops[i] = 0; }
+
+  std::atomic<std::size_t> nb_popped(0);
+  std::vector<std::thread> threads;
+
+  for (std::size_t p = 0; p < nb_producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (std::size_t i = 0; i < nb_values_by_producer; ++i) {
+        std::size_t value = p * nb_values_by_producer + i;
+        while (!queue.try_push(value)) { std::this_thread::yield(); }
+      }
+    });
+  }
+
+  for (std::size_t c = 0; c < nb_consumers; ++c) {
+    threads.emplace_back([&] {
+      std::size_t value;
+
+      while (nb_popped < nb_values) {
+        if (!queue.try_pop(value)) {
+          std::this_thread::yield();
+          continue;
+        }
+
+        ++nb_pops[value];
+        ++nb_popped;
+      }
+    });
+  }
+
+  for (auto& thread : threads) { thread.join(); }
+
+  EXPECT_TRUE(queue.empty());
+
+  std::size_t nb_errors = 0;
+  for (std::size_t i = 0; i < nb_values; ++i) {
+    if (nb_pops[i] != 1) { ++nb_errors; }
+  }
+  EXPECT_EQ(0u, nb_errors);
+}
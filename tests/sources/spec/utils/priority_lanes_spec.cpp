@@ -0,0 +1,119 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <gtest/gtest.h>
+
+#include <tacopie/utils/priority_lanes.hpp>
+
+#include <string>
+
+using namespace tacopie::utils;
+
+//!
+//! pop n elements, each one being the index of its lane
+//!
+static std::string
+pop(priority_lanes<int, 3>& lanes, std::size_t n) {
+  std::string order;
+
+  for (std::size_t i = 0; i < n && !lanes.empty(); ++i) {
+    order += std::to_string(lanes.front());
+    lanes.pop();
+  }
+
+  return order;
+}
+
+TEST(PriorityLanes, FifoWithinALane) {
+  priority_lanes<int, 3> lanes;
+
+  for (int i = 0; i < 5; ++i) { lanes.push(int(i), 1); }
+
+  EXPECT_EQ(5u, lanes.size());
+  EXPECT_EQ("01234", pop(lanes, 5));
+  EXPECT_TRUE(lanes.empty());
+}
+
+TEST(PriorityLanes, WeightedRoundRobin) {
+  priority_lanes<int, 3> lanes;
+  lanes.set_weight(0, 3);
+  lanes.set_weight(1, 2);
+  lanes.set_weight(2, 1);
+
+  for (int i = 0; i < 6; ++i) {
+    lanes.push(0, 0);
+    lanes.push(1, 1);
+    lanes.push(2, 2);
+  }
+
+  //! under contention, each round serves every lane according to its weight, highest lane first
+  EXPECT_EQ("000112000112", pop(lanes, 12));
+
+  //! empty lanes are skipped, the remaining ones share the rounds
+  EXPECT_EQ("112222", pop(lanes, 6));
+  EXPECT_TRUE(lanes.empty());
+}
+
+TEST(PriorityLanes, LowerLanesAreNeverStarved) {
+  priority_lanes<int, 3> lanes;
+  lanes.set_weight(0, 4);
+  lanes.set_weight(1, 1);
+  lanes.set_weight(2, 1);
+
+  lanes.push(2, 2);
+
+  //! the higher lane is refilled continuously: the lower lane is served within a round anyway
+  std::string order;
+  for (int i = 0; i < 6; ++i) {
+    lanes.push(0, 0);
+    order += pop(lanes, 1);
+  }
+
+  EXPECT_EQ("000020", order);
+}
+
+TEST(PriorityLanes, LaneBecomingBusyIsServedWithinTheCurrentRound) {
+  priority_lanes<int, 3> lanes;
+  lanes.set_weight(0, 1);
+  lanes.set_weight(1, 4);
+
+  //! lane 1 alone: served continuously
+  for (int i = 0; i < 6; ++i) { lanes.push(1, 1); }
+  EXPECT_EQ("11", pop(lanes, 2));
+
+  //! lane 0 becomes busy: served first, then lane 1 uses the credits left in the current round
+  for (int i = 0; i < 3; ++i) { lanes.push(0, 0); }
+  EXPECT_EQ("0110110", pop(lanes, 7));
+  EXPECT_TRUE(lanes.empty());
+}
+
+TEST(PriorityLanes, ZeroWeightIsClampedToOne) {
+  priority_lanes<int, 3> lanes;
+  lanes.set_weight(0, 0);
+
+  lanes.push(0, 0);
+  lanes.push(0, 0);
+  lanes.push(1, 1);
+
+  EXPECT_EQ("010", pop(lanes, 3));
+}
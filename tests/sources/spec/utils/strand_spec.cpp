@@ -0,0 +1,88 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/strand.hpp>
+
+#include <memory>
+#include <vector>
+
+using namespace tacopie::utils;
+
+TEST(Strand, TasksExecutedInOrder) {
+  thread_pool pool(0);
+  auto s = std::make_shared<strand>(pool);
+  std::vector<int> executed;
+
+  for (int i = 0; i < 100; ++i) { s->post([&executed, i] { executed.push_back(i); }); }
+
+  while (pool.run_pending_tasks()) {}
+
+  ASSERT_EQ(100u, executed.size());
+  for (int i = 0; i < 100; ++i) { EXPECT_EQ(i, executed[i]); }
+}
+
+TEST(Strand, RescheduledAfterRejection) {
+  thread_pool pool(0, thread_pool::scheduling_policy::lock_free, 2, thread_pool::overflow_policy::reject);
+  auto s = std::make_shared<strand>(pool);
+  std::vector<int> executed;
+
+  //! fill the pool queue: the strand execution is rejected
+  pool.add_task([] {});
+  pool.add_task([] {});
+  EXPECT_THROW(s->post([&executed] { executed.push_back(0); }), tacopie::tacopie_error);
+
+  while (pool.run_pending_tasks()) {}
+  EXPECT_TRUE(executed.empty());
+
+  //! the strand is not stuck as scheduled: the next post runs both tasks, in order
+  s->post([&executed] { executed.push_back(1); });
+  while (pool.run_pending_tasks()) {}
+
+  ASSERT_EQ(2u, executed.size());
+  EXPECT_EQ(0, executed[0]);
+  EXPECT_EQ(1, executed[1]);
+}
+
+TEST(Strand, RescheduledAfterBatchRejection) {
+  thread_pool pool(0, thread_pool::scheduling_policy::lock_free, 2, thread_pool::overflow_policy::reject);
+  auto s = std::make_shared<strand>(pool);
+  std::vector<int> executed;
+
+  pool.add_task([] {});
+  pool.add_task([] {});
+
+  thread_pool::task_batch_t batch;
+  s->post([&executed] { executed.push_back(0); }, batch);
+  EXPECT_THROW(pool.add_tasks(batch), tacopie::tacopie_error);
+
+  while (pool.run_pending_tasks()) {}
+
+  s->post([&executed] { executed.push_back(1); });
+  while (pool.run_pending_tasks()) {}
+
+  ASSERT_EQ(2u, executed.size());
+  EXPECT_EQ(0, executed[0]);
+  EXPECT_EQ(1, executed[1]);
+}
@@ -0,0 +1,128 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/utils/task.hpp>
+#include <tacopie/utils/thread_pool.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+
+using namespace tacopie::utils;
+
+//!
+//! counting allocator: every allocation of the test binary goes through it
+//!
+static std::atomic<std::size_t> nb_allocations(0);
+
+void*
+operator new(std::size_t size) {
+  ++nb_allocations;
+
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) { throw std::bad_alloc(); }
+
+  return ptr;
+}
+
+void
+operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+TEST(Task, SmallCallableDoesNotAllocate) {
+  int nb_calls = 0;
+  auto shared  = std::make_shared<int>(42);
+
+  std::size_t nb_allocations_before = nb_allocations;
+
+  task t([&nb_calls, shared] { nb_calls += *shared; });
+  task moved(std::move(t));
+  t = std::move(moved);
+  t();
+
+  EXPECT_EQ(nb_allocations_before, nb_allocations);
+  EXPECT_EQ(42, nb_calls);
+}
+
+TEST(Task, LargeCallableAllocatesOnce) {
+  struct large_callable {
+    char data[__TACOPIE_TASK_INLINE_SIZE * 2];
+    int* nb_calls;
+
+    void
+    operator()(void) {
+      ++*nb_calls;
+    }
+  };
+
+  int nb_calls = 0;
+  large_callable callable;
+  callable.nb_calls = &nb_calls;
+
+  std::size_t nb_allocations_before = nb_allocations;
+
+  task t(callable);
+  task moved(std::move(t));
+  moved();
+
+  EXPECT_EQ(nb_allocations_before + 1, nb_allocations);
+  EXPECT_EQ(1, nb_calls);
+}
+
+TEST(Task, ThreadPoolSteadyStateDoesNotAllocate) {
+  const std::size_t nb_tasks = 100000;
+
+  for (auto policy : {thread_pool::scheduling_policy::fifo, thread_pool::scheduling_policy::lock_free}) {
+    thread_pool pool(2, policy);
+    auto callback = std::make_shared<std::function<void(std::size_t)>>([](std::size_t) {});
+    std::atomic<std::size_t> nb_done(0);
+
+    //! warm up: let the queues reach their steady-state capacity
+    for (std::size_t i = 0; i < 2000; ++i) { pool << [i, callback, &nb_done] { (*callback)(i); ++nb_done; }; }
+    while (nb_done < 2000) { std::this_thread::yield(); }
+
+    std::size_t nb_allocations_before = nb_allocations;
+
+    for (std::size_t i = 0; i < nb_tasks; ++i) {
+      pool << [i, callback, &nb_done] { (*callback)(i); ++nb_done; };
+
+      //! keep the number of queued tasks in the warmed-up range
+      if (i % 1000 == 0) {
+        while (nb_done < 2000 + i) { std::this_thread::yield(); }
+      }
+    }
+    while (nb_done < 2000 + nb_tasks) { std::this_thread::yield(); }
+
+    EXPECT_EQ(nb_allocations_before, nb_allocations);
+  }
+}
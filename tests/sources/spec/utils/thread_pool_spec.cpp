@@ -0,0 +1,327 @@
+// MIT License
+//
+// Copyright (c) 2016-2017 Simon Ninon <simon.ninon@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <tacopie/utils/error.hpp>
+#include <tacopie/utils/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tacopie::utils;
+
+TEST(ThreadPool, RunPendingTasksFromAnotherPoolWorker) {
+  thread_pool worker_pool(1, thread_pool::scheduling_policy::work_stealing);
+  thread_pool caller_driven_pool(0, thread_pool::scheduling_policy::work_stealing);
+
+  std::atomic<bool> local_task_done(false);
+  std::atomic<bool> pending_task_done(false);
+  std::promise<std::size_t> nb_executed;
+
+  caller_driven_pool.add_task([&] { pending_task_done = true; });
+
+  worker_pool.add_task([&] {
+    //! queued in the deque of this worker: must not be executed by the other pool
+    worker_pool.add_task([&] { local_task_done = true; });
+
+    std::size_t nb_pending = caller_driven_pool.run_pending_tasks();
+    nb_executed.set_value(local_task_done ? 0 : nb_pending);
+  });
+
+  EXPECT_EQ(1u, nb_executed.get_future().get());
+  EXPECT_TRUE(pending_task_done);
+
+  for (int i = 0; i < 1000 && !local_task_done; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  EXPECT_TRUE(local_task_done);
+}
+
+TEST(ThreadPool, AddTaskFromAnotherPoolWorker) {
+  thread_pool worker_pool(1, thread_pool::scheduling_policy::work_stealing);
+  thread_pool caller_driven_pool(0, thread_pool::scheduling_policy::work_stealing);
+
+  std::promise<void> submitted;
+
+  //! submitted from a worker of another pool: goes to the injection queue of caller_driven_pool
+  worker_pool.add_task([&] {
+    caller_driven_pool.add_task([] {});
+    submitted.set_value();
+  });
+
+  submitted.get_future().wait();
+  EXPECT_EQ(1u, caller_driven_pool.run_pending_tasks());
+}
+
+TEST(ThreadPool, LockFreeStressWithOverflowPolicies) {
+  thread_pool::overflow_policy policies[] = {thread_pool::overflow_policy::spill, thread_pool::overflow_policy::block, thread_pool::overflow_policy::reject};
+
+  for (auto policy : policies) {
+    const std::size_t nb_producers         = 3;
+    const std::size_t nb_tasks_by_producer = 5000;
+    std::atomic<std::size_t> nb_executed(0);
+    std::atomic<std::size_t> nb_rejected(0);
+
+    {
+      //! tiny queue: the overflow policy is hit continuously
+      thread_pool pool(4, thread_pool::scheduling_policy::lock_free, 16, policy);
+      std::vector<std::thread> producers;
+
+      for (std::size_t i = 0; i < nb_producers; ++i) {
+        producers.emplace_back([&] {
+          for (std::size_t j = 0; j < nb_tasks_by_producer; ++j) {
+            try {
+              pool.add_task([&] { ++nb_executed; });
+            }
+            catch (const tacopie::tacopie_error&) {
+              ++nb_rejected;
+            }
+          }
+        });
+      }
+
+      //! resize while tasks are being submitted
+      pool.set_nb_threads(1);
+      pool.set_nb_threads(3);
+
+      for (auto& producer : producers) { producer.join(); }
+
+      std::size_t nb_expected = nb_producers * nb_tasks_by_producer - nb_rejected;
+      for (int i = 0; i < 20000 && nb_executed < nb_expected; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+
+      EXPECT_EQ(nb_expected, nb_executed);
+    }
+
+    if (policy != thread_pool::overflow_policy::reject) { EXPECT_EQ(0u, nb_rejected); }
+  }
+}
+
+TEST(ThreadPool, AutoscalingGrowsQuicklyAndShrinksSlowly) {
+  thread_pool pool(1);
+
+  thread_pool::autoscaling_config config;
+  config.min_nb_threads     = 1;
+  config.max_nb_threads     = 3;
+  config.interval           = std::chrono::milliseconds(10);
+  config.scale_up_samples   = 2;
+  config.scale_down_samples = 15;
+  pool.enable_autoscaling(config);
+
+  //! tasks blocked until released: the queue does not drain, whatever the number of workers
+  std::mutex mtx;
+  std::condition_variable cv;
+  bool released = false;
+  std::atomic<int> nb_done(0);
+
+  for (int i = 0; i < 8; ++i) {
+    pool.add_task([&] {
+      std::unique_lock<std::mutex> lock(mtx);
+      cv.wait(lock, [&] { return released; });
+      ++nb_done;
+    });
+  }
+
+  //! grows one worker at a time, up to the maximum
+  for (int i = 0; i < 5000 && pool.get_autoscaling_metrics().nb_threads < 3; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  std::this_thread::sleep_for(5 * config.interval);
+
+  auto metrics = pool.get_autoscaling_metrics();
+  EXPECT_EQ(3u, metrics.nb_threads);
+  EXPECT_EQ(2u, metrics.nb_scale_ups);
+  EXPECT_EQ(0u, metrics.nb_scale_downs);
+  EXPECT_GT(metrics.nb_queued_tasks, 0u);
+
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    released = true;
+  }
+  cv.notify_all();
+  auto released_at = std::chrono::steady_clock::now();
+
+  //! shrinks only after scale_down_samples consecutive idle samples
+  for (int i = 0; i < 5000 && pool.get_autoscaling_metrics().nb_threads == 3; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  auto first_scale_down = std::chrono::steady_clock::now() - released_at;
+
+  EXPECT_EQ(2u, pool.get_autoscaling_metrics().nb_threads);
+  EXPECT_GE(first_scale_down, (config.scale_down_samples - 1) * config.interval);
+  EXPECT_EQ(8, nb_done);
+
+  //! down to the minimum, never below
+  for (int i = 0; i < 5000 && pool.get_autoscaling_metrics().nb_threads > 1; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+  std::this_thread::sleep_for(2 * config.scale_down_samples * config.interval);
+
+  metrics = pool.get_autoscaling_metrics();
+  EXPECT_EQ(1u, metrics.nb_threads);
+  EXPECT_EQ(2u, metrics.nb_scale_ups);
+  EXPECT_EQ(2u, metrics.nb_scale_downs);
+
+  pool.disable_autoscaling();
+}
+
+TEST(ThreadPool, AutoscalingIgnoresShortBursts) {
+  thread_pool pool(1);
+
+  thread_pool::autoscaling_config config;
+  config.min_nb_threads     = 1;
+  config.max_nb_threads     = 4;
+  config.interval           = std::chrono::milliseconds(50);
+  config.scale_up_samples   = 4;
+  config.scale_down_samples = 4;
+  pool.enable_autoscaling(config);
+
+  //! overloaded for about one sample, then idle: not enough consecutive samples to grow
+  pool.add_task([] { std::this_thread::sleep_for(std::chrono::milliseconds(60)); });
+  for (int i = 0; i < 100; ++i) { pool.add_task([] {}); }
+
+  std::this_thread::sleep_for(10 * config.interval);
+
+  auto metrics = pool.get_autoscaling_metrics();
+  EXPECT_EQ(1u, metrics.nb_threads);
+  EXPECT_EQ(0u, metrics.nb_scale_ups);
+
+  pool.disable_autoscaling();
+}
+
+TEST(ThreadPool, PriorityClassesShareTheWorkersByWeight) {
+  thread_pool pool(1);
+  pool.set_priority_weights(3, 2, 1);
+
+  //! the single worker is held while the tasks of each class are queued, lowest priority first
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  pool.add_task([released] { released.wait(); }, thread_pool::priority::high);
+
+  std::mutex mtx;
+  std::string order;
+  thread_pool::priority priorities[] = {thread_pool::priority::low, thread_pool::priority::normal, thread_pool::priority::high};
+  const char names[]                 = {'l', 'n', 'h'};
+
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 12; ++j) {
+      char name = names[i];
+      auto task = [&, name] {
+        std::lock_guard<std::mutex> lock(mtx);
+        order += name;
+      };
+
+      pool.add_task(task, priorities[i]);
+    }
+  }
+
+  release.set_value();
+  for (int i = 0; i < 5000; ++i) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if (order.size() == 36) { break; }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::lock_guard<std::mutex> lock(mtx);
+  ASSERT_EQ(36u, order.size());
+
+  //! every round of 6 tasks serves each class according to its weight: low priority tasks are never starved
+  for (std::size_t round = 0; round < 4; ++round) {
+    std::string tasks = order.substr(round * 6, 6);
+
+    EXPECT_EQ(3, std::count(tasks.begin(), tasks.end(), 'h')) << order;
+    EXPECT_EQ(2, std::count(tasks.begin(), tasks.end(), 'n')) << order;
+    EXPECT_EQ(1, std::count(tasks.begin(), tasks.end(), 'l')) << order;
+  }
+}
+
+TEST(ThreadPool, AddTasksKeepsTheBatchOrder) {
+  thread_pool::scheduling_policy policies[] = {thread_pool::scheduling_policy::fifo, thread_pool::scheduling_policy::work_stealing, thread_pool::scheduling_policy::lock_free};
+
+  for (auto policy : policies) {
+    //! no worker: the tasks are executed in queue order by run_pending_tasks
+    thread_pool pool(0, policy);
+    std::vector<int> order;
+
+    thread_pool::task_batch_t batch;
+    batch.reserve(64);
+    for (int i = 0; i < 50; ++i) { batch.emplace_back([&order, i] { order.push_back(i); }, thread_pool::priority::normal); }
+
+    pool.add_tasks(batch);
+
+    //! moved from and cleared, the storage is kept for the next batch
+    EXPECT_TRUE(batch.empty());
+    EXPECT_EQ(64u, batch.capacity());
+
+    std::vector<thread_pool::task_t> tasks;
+    for (int i = 50; i < 100; ++i) { tasks.push_back([&order, i] { order.push_back(i); }); }
+
+    pool.add_tasks(tasks);
+    EXPECT_TRUE(tasks.empty());
+
+    EXPECT_EQ(100u, pool.run_pending_tasks());
+    ASSERT_EQ(100u, order.size());
+    for (int i = 0; i < 100; ++i) { EXPECT_EQ(i, order[i]); }
+  }
+}
+
+TEST(ThreadPool, AddTasksDispatchesEachTaskToItsPriorityClass) {
+  thread_pool pool(0);
+  pool.set_priority_weights(2, 1, 1);
+
+  std::string order;
+  thread_pool::task_batch_t batch;
+
+  for (int i = 0; i < 3; ++i) {
+    batch.emplace_back([&order] { order += 'l'; }, thread_pool::priority::low);
+    batch.emplace_back([&order] { order += 'n'; }, thread_pool::priority::normal);
+    batch.emplace_back([&order] { order += 'h'; }, thread_pool::priority::high);
+  }
+
+  pool.add_tasks(batch);
+  EXPECT_EQ(9u, pool.run_pending_tasks());
+  EXPECT_EQ("hhnlhnlnl", order);
+}
+
+TEST(ThreadPool, AddTasksRejectsWhatDoesNotFit) {
+  //! lock_free ring of 16 cells, no worker to drain it
+  thread_pool pool(0, thread_pool::scheduling_policy::lock_free, 16, thread_pool::overflow_policy::reject);
+  std::vector<int> order;
+
+  thread_pool::task_batch_t batch;
+  for (int i = 0; i < 20; ++i) { batch.emplace_back([&order, i] { order.push_back(i); }, thread_pool::priority::normal); }
+
+  //! the tasks that fit are enqueued in order, the others are dropped, then the error is reported
+  EXPECT_THROW(pool.add_tasks(batch), tacopie::tacopie_error);
+  EXPECT_TRUE(batch.empty());
+
+  EXPECT_EQ(16u, pool.run_pending_tasks());
+  ASSERT_EQ(16u, order.size());
+  for (int i = 0; i < 16; ++i) { EXPECT_EQ(i, order[i]); }
+
+  //! room again once drained
+  batch.emplace_back([&order] { order.push_back(-1); }, thread_pool::priority::normal);
+  EXPECT_NO_THROW(pool.add_tasks(batch));
+  EXPECT_EQ(1u, pool.run_pending_tasks());
+  EXPECT_EQ(-1, order.back());
+}